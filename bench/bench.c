@@ -0,0 +1,244 @@
+/*
+ * bench.c - off-target renderer benchmark (`make bench`).
+ *
+ * Builds main.c unchanged (its main() renamed) against the in-memory MI_RGN
+ * mock and drives it synchronously: every step parses one payload, runs a
+ * channel push, forces an LVGL refresh and commits the canvas. Scripted
+ * scenarios cover bar sweeps, text churn and asset_updates storms; -f replays
+ * one JSON payload per line from a file instead. Each scenario reports
+ * steps/s, frames/s, flushed pixels per frame, the per-stage profiler and the
+ * LVGL heap high-water mark.
+ *
+ *   bench_osd [-c config.json] [-n steps] [-s bars|text|updates|all] [-f payloads.txt]
+ */
+#ifndef OSD_PROFILE
+#define OSD_PROFILE
+#endif
+
+static const char *g_bench_config_path = "waybeam_osd.json";
+#define CONFIG_PATH g_bench_config_path
+#define main osd_main
+#include "../main.c"
+#undef main
+
+#include "mock_mi.h"
+
+typedef enum {
+    BENCH_BARS = 0,
+    BENCH_TEXT,
+    BENCH_UPDATES,
+    BENCH_FILE,
+    BENCH_SCENARIO_COUNT
+} bench_scenario_t;
+
+static const char *const g_bench_names[BENCH_SCENARIO_COUNT] = {"bars", "text", "updates", "file"};
+
+typedef struct {
+    char **lines;
+    int count;
+} bench_script_t;
+
+static int g_bench_base_x[ASSET_POOL_MAX];
+
+static int bench_triangle(int step, int speed)
+{
+    int t = (step * speed) % 200;
+    return t < 100 ? t : 200 - t;
+}
+
+// Every bank-0 value sweeps at its own speed so bars cross each other
+static int bench_bars_payload(int step, char *buf, size_t sz)
+{
+    int off = snprintf(buf, sz, "{\"values\":[");
+    for (int i = 0; i < UDP_VALUE_COUNT && off < (int)sz; i++) {
+        off += snprintf(buf + off, sz - (size_t)off, "%s%d", i ? "," : "", bench_triangle(step, i + 1));
+    }
+    if (off < (int)sz) off += snprintf(buf + off, sz - (size_t)off, "]}");
+    return off;
+}
+
+// Texts change every step and grow/shrink so labels relayout now and then
+static int bench_text_payload(int step, char *buf, size_t sz)
+{
+    int off = snprintf(buf, sz, "{\"texts\":[");
+    for (int i = 0; i < UDP_TEXT_COUNT && off < (int)sz; i++) {
+        int v = bench_triangle(step, i + 1);
+        off += snprintf(buf + off, sz - (size_t)off, "%s\"%c%d %s\"", i ? "," : "", 'A' + i, v * (i + 1) * 37,
+                        (step / 25 + i) % 3 == 0 ? "dBm" : "");
+    }
+    if (off < (int)sz) off += snprintf(buf + off, sz - (size_t)off, "]}");
+    return off;
+}
+
+// Moves and recolours every asset each step and flips one asset off/on
+static int bench_updates_payload(int step, char *buf, size_t sz)
+{
+    int off = snprintf(buf, sz, "{\"asset_updates\":[");
+    for (int i = 0; i < asset_count && off < (int)sz; i++) {
+        int enabled = !(step % 50 == 0 && i == (step / 50) % asset_count);
+        off += snprintf(buf + off, sz - (size_t)off, "%s{\"id\":%d,\"x\":%d,\"bar_color\":%d,\"enabled\":%s}",
+                        i ? "," : "", assets[i].cfg.id, g_bench_base_x[i] + bench_triangle(step, 2) / 8,
+                        (step / 10 + i) % 8, enabled ? "true" : "false");
+    }
+    if (off < (int)sz) off += snprintf(buf + off, sz - (size_t)off, "]}");
+    return off;
+}
+
+static int bench_payload(bench_scenario_t sc, const bench_script_t *script, int step, char *buf, size_t sz)
+{
+    int len = 0;
+    switch (sc) {
+        case BENCH_BARS:
+            len = bench_bars_payload(step, buf, sz);
+            break;
+        case BENCH_TEXT:
+            len = bench_text_payload(step, buf, sz);
+            break;
+        case BENCH_UPDATES:
+            len = bench_updates_payload(step, buf, sz);
+            break;
+        case BENCH_FILE:
+        default:
+            if (script->count == 0) return 0;
+            len = snprintf(buf, sz, "%s", script->lines[step % script->count]);
+            break;
+    }
+    return len < (int)sz ? len : (int)sz - 1;
+}
+
+static int bench_load_script(const char *path, bench_script_t *script)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "bench: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    char line[UDP_MAX_PACKET + 2];
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+        char **grown = realloc(script->lines, sizeof(*grown) * (size_t)(script->count + 1));
+        if (!grown) break;
+        script->lines = grown;
+        script->lines[script->count] = strdup(line);
+        if (script->lines[script->count]) script->count++;
+    }
+    fclose(f);
+    return script->count > 0 ? 0 : -1;
+}
+
+static void bench_run(bench_scenario_t sc, const bench_script_t *script, int steps)
+{
+    char buf[UDP_MAX_PACKET + 1];
+    memset(g_prof_cur, 0, sizeof(g_prof_cur));
+    unsigned long commits_before = mock_rgn_commits();
+    flush_counters_t stores_before = g_flush_counters;
+
+    uint64_t start = monotonic_us64();
+    for (int step = 0; step < steps; step++) {
+        int len = bench_payload(sc, script, step, buf, sizeof(buf));
+        if (len > 0) parse_udp_datagram(buf, (size_t)len, NULL, 0);
+        push_channel_updates();
+        bars_ease_tick(monotonic_ms64());
+        render_and_commit(1);
+    }
+    uint64_t elapsed = monotonic_us64() - start;
+    if (elapsed == 0) elapsed = 1;
+
+    const prof_acc_t *flush = &g_prof_cur[PROF_FLUSH];
+    uint32_t frames = g_prof_cur[PROF_COMMIT].count;
+    memcpy(g_prof_last, g_prof_cur, sizeof(g_prof_last));
+    char stages[512];
+    prof_format(stages, sizeof(stages), "\n    ");
+    lv_mem_monitor_t mon;
+    memset(&mon, 0, sizeof(mon));
+    lv_mem_monitor(&mon);
+
+    printf("%s: %d steps in %.1f ms, %.0f steps/s, %u frames (%.0f fps), %lu canvas commits\n",
+           g_bench_names[sc], steps, (double)elapsed / 1000.0, steps * 1e6 / (double)elapsed,
+           frames, frames * 1e6 / (double)elapsed, mock_rgn_commits() - commits_before);
+    printf("  flushed px/frame %llu\n",
+           (unsigned long long)(flush->count ? flush->pixels / flush->count : 0));
+    printf("  canvas px converted %llu, zero spans %llu, unchanged %llu\n",
+           (unsigned long long)(g_flush_counters.converted - stores_before.converted),
+           (unsigned long long)(g_flush_counters.zeroed - stores_before.zeroed),
+           (unsigned long long)(g_flush_counters.skipped - stores_before.skipped));
+    printf("  us min/avg/max xcount:\n    %s\n", stages);
+    printf("  lvgl heap high-water %u of %u bytes\n", (unsigned)mon.max_used, (unsigned)mon.total_size);
+}
+
+static void bench_usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-c config.json] [-n steps] [-s bars|text|updates|all] [-f payloads.txt]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    int steps = 2000;
+    int only = -1;  // -1 = every scripted scenario
+    const char *script_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:n:s:f:h")) != -1) {
+        switch (opt) {
+            case 'c':
+                g_bench_config_path = optarg;
+                break;
+            case 'n':
+                steps = clamp_int(atoi(optarg), 1, 10000000);
+                break;
+            case 's':
+                only = -1;
+                for (int i = 0; i < BENCH_FILE; i++) {
+                    if (strcmp(optarg, g_bench_names[i]) == 0) only = i;
+                }
+                if (only < 0 && strcmp(optarg, "all") != 0) {
+                    bench_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'f':
+                script_path = optarg;
+                break;
+            default:
+                bench_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    bench_script_t script = {NULL, 0};
+    if (script_path && bench_load_script(script_path, &script) != 0) return 1;
+
+    if (asset_pool_init() != 0) {
+        fprintf(stderr, "bench: failed to allocate the asset/channel pool\n");
+        return 1;
+    }
+    reset_channels();
+    load_config(assets, &asset_count);
+    compute_osd_geometry();
+    mi_region_init();
+    init_lvgl();
+    lv_obj_set_style_bg_opa(lv_scr_act(), LV_OPA_TRANSP, LV_PART_MAIN);
+    create_assets();
+    if (g_region_auto) region_replan();
+    idle_init();
+    for (int i = 0; i < asset_count && i < ASSET_POOL_MAX; i++) g_bench_base_x[i] = assets[i].cfg.x;
+
+    update_assets_from_channels();
+    render_and_commit(1);
+    printf("bench: %dx%d, %d assets, %d region(s), config %s\n",
+           osd_width, osd_height, asset_count, g_region_count, g_bench_config_path);
+
+    if (script.count > 0) {
+        bench_run(BENCH_FILE, &script, steps);
+    } else {
+        for (int i = 0; i < BENCH_FILE; i++) {
+            if (only < 0 || only == i) bench_run((bench_scenario_t)i, &script, steps);
+        }
+    }
+
+    cleanup_resources();
+    for (int i = 0; i < script.count; i++) free(script.lines[i]);
+    free(script.lines);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * fuzz_parse.c - libFuzzer harness for the datagram parsers (`make fuzz_parse`).
+ *
+ * Builds main.c unchanged against the in-memory MI_RGN mock, loads the
+ * config once, and feeds every input through parse_udp_datagram() exactly as
+ * the receive thread would (capped at UDP_MAX_PACKET and terminated), then
+ * through a channel push so staged asset_updates are applied, and finally
+ * through the json_get_*_range lookups. Start from the shared corpus in a
+ * scratch directory so new inputs do not land in the tree:
+ *
+ *   mkdir -p fuzz_work && ./fuzz_parse -max_len=1280 fuzz_work bench/corpus
+ *
+ * FUZZ_CONFIG selects the config (default waybeam_osd.json).
+ */
+static const char *g_fuzz_config_path = "waybeam_osd.json";
+#define CONFIG_PATH g_fuzz_config_path
+#define main osd_main
+#include "../main.c"
+#undef main
+
+#include "mock_mi.h"
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    (void)argc;
+    (void)argv;
+    const char *cfg = getenv("FUZZ_CONFIG");
+    if (cfg && cfg[0]) g_fuzz_config_path = cfg;
+    if (asset_pool_init() != 0) abort();
+    reset_channels();
+    load_config(assets, &asset_count);
+    compute_osd_geometry();
+    mi_region_init();
+    init_lvgl();
+    create_assets();
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static char buf[UDP_MAX_PACKET + 1];
+    if (size > UDP_MAX_PACKET) return 0;  // discarded unread by the receive path
+    memcpy(buf, data, size);
+    buf[size] = '\0';
+
+    parse_udp_datagram(buf, size, NULL, 0);
+    push_channel_updates();
+
+    int v;
+    float fv;
+    char str[64];
+    json_get_int_range(buf, buf + size, "x", &v);
+    json_get_float_range(buf, buf + size, "min", &fv);
+    json_get_bool_range(buf, buf + size, "enabled", &v);
+    json_get_string_range(buf, buf + size, "label", str, sizeof(str));
+    int ints[ASSET_INDEX_MAX];
+    int count = 0;
+    json_get_int_array_range(buf, buf + size, "value_indices", ints, ASSET_INDEX_MAX, &count, -1);
+    return 0;
+}
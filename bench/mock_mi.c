@@ -0,0 +1,157 @@
+/*
+ * mock_mi.c - in-memory MI_RGN / MI_SYS stand-ins for the benchmark build.
+ *
+ * Each region gets a heap canvas sized from its create attributes; commits
+ * only count, so the renderer sees a single-buffered driver. Nothing here
+ * touches hardware, which lets `make bench` run on the host or on a target
+ * without the Sigmastar libraries.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mi_sys.h"
+#include "mi_rgn.h"
+
+#include "mock_mi.h"
+
+#define MOCK_RGN_MAX 64
+
+typedef struct {
+    int used;
+    MI_RGN_Attr_t attr;
+    MI_RGN_CanvasInfo_t canvas;
+} mock_region_t;
+
+static mock_region_t g_mock_regions[MOCK_RGN_MAX];
+static unsigned long g_mock_commits = 0;
+
+static MI_U32 mock_stride(MI_RGN_PixelFormat_e fmt, MI_U32 width)
+{
+    switch (fmt) {
+        case E_MI_RGN_PIXEL_FORMAT_I4:
+            return (width + 1) / 2;
+        case E_MI_RGN_PIXEL_FORMAT_I8:
+            return width;
+        case E_MI_RGN_PIXEL_FORMAT_ARGB8888:
+            return width * 4;
+        default:
+            return width * 2;
+    }
+}
+
+static mock_region_t *mock_region(MI_RGN_HANDLE h)
+{
+    if (h >= MOCK_RGN_MAX || !g_mock_regions[h].used) return NULL;
+    return &g_mock_regions[h];
+}
+
+unsigned long mock_rgn_commits(void)
+{
+    return g_mock_commits;
+}
+
+MI_S32 MI_RGN_Init(MI_RGN_PaletteTable_t *pstPaletteTable)
+{
+    (void)pstPaletteTable;
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_RGN_DeInit(void)
+{
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_RGN_Create(MI_RGN_HANDLE hHandle, MI_RGN_Attr_t *pstRegion)
+{
+    if (hHandle >= MOCK_RGN_MAX || !pstRegion || g_mock_regions[hHandle].used) return -1;
+    mock_region_t *r = &g_mock_regions[hHandle];
+    MI_U32 w = pstRegion->stOsdInitParam.stSize.u32Width;
+    MI_U32 h = pstRegion->stOsdInitParam.stSize.u32Height;
+    MI_U32 stride = mock_stride(pstRegion->stOsdInitParam.ePixelFmt, w);
+    void *buf = calloc((size_t)stride * h, 1);
+    if (!buf) return -1;
+    memset(r, 0, sizeof(*r));
+    r->used = 1;
+    r->attr = *pstRegion;
+    r->canvas.virtAddr = (MI_VIRT)buf;
+    r->canvas.stSize.u32Width = w;
+    r->canvas.stSize.u32Height = h;
+    r->canvas.u32Stride = stride;
+    r->canvas.ePixelFmt = pstRegion->stOsdInitParam.ePixelFmt;
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_RGN_Destroy(MI_RGN_HANDLE hHandle)
+{
+    mock_region_t *r = mock_region(hHandle);
+    if (!r) return -1;
+    free((void *)r->canvas.virtAddr);
+    memset(r, 0, sizeof(*r));
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_RGN_AttachToChn(MI_RGN_HANDLE hHandle, MI_RGN_ChnPort_t *pstChnPort, MI_RGN_ChnPortParam_t *pstChnAttr)
+{
+    (void)pstChnPort;
+    (void)pstChnAttr;
+    return mock_region(hHandle) ? MI_RGN_OK : -1;
+}
+
+MI_S32 MI_RGN_DetachFromChn(MI_RGN_HANDLE hHandle, MI_RGN_ChnPort_t *pstChnPort)
+{
+    (void)pstChnPort;
+    return mock_region(hHandle) ? MI_RGN_OK : -1;
+}
+
+MI_S32 MI_RGN_GetCanvasInfo(MI_RGN_HANDLE hHandle, MI_RGN_CanvasInfo_t *pstCanvasInfo)
+{
+    mock_region_t *r = mock_region(hHandle);
+    if (!r || !pstCanvasInfo) return -1;
+    *pstCanvasInfo = r->canvas;
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_RGN_UpdateCanvas(MI_RGN_HANDLE hHandle)
+{
+    if (!mock_region(hHandle)) return -1;
+    g_mock_commits++;
+    return MI_RGN_OK;
+}
+
+MI_S32 MI_SYS_MMA_Alloc(MI_U8 *pstMMAHeapName, MI_U32 u32BlkSize, MI_PHY *phyAddr)
+{
+    (void)pstMMAHeapName;
+    (void)u32BlkSize;
+    (void)phyAddr;
+    return -1;  // no MMA: the renderer falls back to malloc'd buffers
+}
+
+MI_S32 MI_SYS_MMA_Free(MI_PHY phyAddr)
+{
+    (void)phyAddr;
+    return MI_SUCCESS;
+}
+
+MI_S32 MI_SYS_Mmap(MI_U64 phyAddr, MI_U32 u32Size, void **ppVirtualAddress, MI_BOOL bCache)
+{
+    (void)phyAddr;
+    (void)u32Size;
+    (void)bCache;
+    if (ppVirtualAddress) *ppVirtualAddress = NULL;
+    return -1;
+}
+
+MI_S32 MI_SYS_Munmap(void *pVirtualAddress, MI_U32 u32Size)
+{
+    (void)pVirtualAddress;
+    (void)u32Size;
+    return MI_SUCCESS;
+}
+
+MI_S32 MI_SYS_FlushInvCache(void *pVirtualAddress, MI_U32 u32Length)
+{
+    (void)pVirtualAddress;
+    (void)u32Length;
+    return MI_SUCCESS;
+}
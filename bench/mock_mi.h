@@ -0,0 +1,10 @@
+/*
+ * mock_mi.h - counters exposed by the in-memory MI_RGN mock (bench builds only).
+ */
+#ifndef MOCK_MI_H
+#define MOCK_MI_H
+
+/* MI_RGN_UpdateCanvas calls since startup */
+unsigned long mock_rgn_commits(void);
+
+#endif /* MOCK_MI_H */
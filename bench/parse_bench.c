@@ -0,0 +1,184 @@
+/*
+ * parse_bench.c - payload parser microbenchmark (`make parse_bench`).
+ *
+ * Builds main.c unchanged against the in-memory MI_RGN mock like bench.c, but
+ * times only the ingest parsers: for every payload in the corpus (one raw
+ * datagram per file, the same files fuzz_parse.c starts from) it runs the
+ * header scan plus the JSON or binary packet parser n times and reports
+ * ns/packet. A second column times a sweep of json_get_*_range lookups over
+ * the same bytes, the path config and per-asset parsing take.
+ *
+ *   parse_bench [-c config.json] [-n iterations] [corpus dir or file ...]
+ */
+static const char *g_bench_config_path = "waybeam_osd.json";
+#define CONFIG_PATH g_bench_config_path
+#define main osd_main
+#include "../main.c"
+#undef main
+
+#include <dirent.h>
+
+#include "mock_mi.h"
+
+#define PARSE_BENCH_FILES_MAX 256
+
+typedef struct {
+    char name[64];
+    char data[UDP_MAX_PACKET + 1];
+    size_t len;
+} parse_sample_t;
+
+static parse_sample_t *g_samples = NULL;
+static int g_sample_count = 0;
+
+static int sample_load(const char *path)
+{
+    if (g_sample_count >= PARSE_BENCH_FILES_MAX) return -1;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "parse_bench: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    parse_sample_t *s = &g_samples[g_sample_count];
+    s->len = fread(s->data, 1, UDP_MAX_PACKET, f);
+    fclose(f);
+    s->data[s->len] = '\0';  // the receive path terminates every datagram too
+    const char *base = strrchr(path, '/');
+    snprintf(s->name, sizeof(s->name), "%s", base ? base + 1 : path);
+    g_sample_count++;
+    return 0;
+}
+
+static int sample_name_cmp(const void *a, const void *b)
+{
+    return strcmp(((const parse_sample_t *)a)->name, ((const parse_sample_t *)b)->name);
+}
+
+static int samples_load(const char *path)
+{
+    DIR *dir = opendir(path);
+    if (!dir) return sample_load(path);
+    int first = g_sample_count;
+    struct dirent *de;
+    while ((de = readdir(dir))) {
+        if (de->d_name[0] == '.') continue;
+        char full[512];
+        snprintf(full, sizeof(full), "%s/%s", path, de->d_name);
+        sample_load(full);
+    }
+    closedir(dir);
+    qsort(g_samples + first, (size_t)(g_sample_count - first), sizeof(*g_samples), sample_name_cmp);
+    return 0;
+}
+
+// The ingest path minus socket and seq bookkeeping, so repeats are never dropped as duplicates
+static int parse_once(const parse_sample_t *s)
+{
+    int rc;
+    if (s->len >= 2 && (uint8_t)s->data[0] == OSD_BIN_MAGIC0 && (uint8_t)s->data[1] == OSD_BIN_MAGIC1) {
+        rc = parse_udp_binary((const uint8_t *)s->data, s->len);
+    } else {
+        long long src = -1;
+        long long seq = -1;
+        udp_header_scan(s->data, s->len, &src, &seq);
+        rc = parse_udp_packet(s->data, s->len);
+    }
+    g_update_pending_count = 0;
+    g_lat_query = 0;
+    g_udp_stats_query = 0;
+    return rc;
+}
+
+// Keys an asset object is searched for while the config is parsed
+static int range_sweep(const parse_sample_t *s)
+{
+    static const char *const keys[] = {"id", "type", "x", "y", "value_index", "bar_color", "enabled", "min", "max"};
+    const char *start = s->data;
+    const char *end = s->data + s->len;
+    int hits = 0;
+    int v;
+    float fv;
+    char buf[64];
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+        hits += json_get_int_range(start, end, keys[k], &v) == 0;
+    }
+    hits += json_get_float_range(start, end, "min", &fv) == 0;
+    hits += json_get_bool_range(start, end, "enabled", &v) == 0;
+    hits += json_get_string_range(start, end, "label", buf, sizeof(buf)) == 0;
+    return hits;
+}
+
+static void parse_bench_usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-c config.json] [-n iterations] [corpus dir or file ...]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 20000;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:n:h")) != -1) {
+        switch (opt) {
+            case 'c':
+                g_bench_config_path = optarg;
+                break;
+            case 'n':
+                iterations = clamp_int(atoi(optarg), 1, 100000000);
+                break;
+            default:
+                parse_bench_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    g_samples = calloc(PARSE_BENCH_FILES_MAX, sizeof(*g_samples));
+    if (!g_samples) return 1;
+    if (optind >= argc) samples_load("bench/corpus");
+    for (int i = optind; i < argc; i++) samples_load(argv[i]);
+    if (g_sample_count == 0) {
+        fprintf(stderr, "parse_bench: no payloads\n");
+        return 1;
+    }
+
+    // Full init so staged asset_updates that overflow the merge table have real assets to land on
+    if (asset_pool_init() != 0) {
+        fprintf(stderr, "parse_bench: failed to allocate the asset/channel pool\n");
+        return 1;
+    }
+    reset_channels();
+    load_config(assets, &asset_count);
+    compute_osd_geometry();
+    mi_region_init();
+    init_lvgl();
+    create_assets();
+
+    printf("%-28s %6s %4s %10s %9s %10s\n", "payload", "bytes", "rc", "ns/packet", "MB/s", "range ns");
+    uint64_t total_ns = 0;
+    for (int i = 0; i < g_sample_count; i++) {
+        const parse_sample_t *s = &g_samples[i];
+        int rc = parse_once(s);
+        for (int w = 0; w < iterations / 10; w++) parse_once(s);
+
+        uint64_t start = monotonic_us64();
+        for (int n = 0; n < iterations; n++) parse_once(s);
+        uint64_t parse_us = monotonic_us64() - start;
+
+        volatile int sink = 0;
+        start = monotonic_us64();
+        for (int n = 0; n < iterations; n++) sink += range_sweep(s);
+        uint64_t range_us = monotonic_us64() - start;
+        (void)sink;
+
+        double ns = (double)parse_us * 1000.0 / iterations;
+        double mbs = ns > 0.0 ? (double)s->len * 1000.0 / ns : 0.0;
+        printf("%-28s %6zu %4d %10.0f %9.1f %10.0f\n", s->name, s->len, rc, ns, mbs,
+               (double)range_us * 1000.0 / iterations);
+        total_ns += (uint64_t)ns;
+    }
+    printf("%d payloads, %d iterations each, mean %.0f ns/packet\n", g_sample_count, iterations,
+           (double)total_ns / g_sample_count);
+
+    cleanup_resources();
+    free(g_samples);
+    return 0;
+}
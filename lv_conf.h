@@ -69,7 +69,12 @@
 
 #if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
     /** Size of memory available for `lv_malloc()` in bytes (>= 2kB) */
-    #define LV_MEM_SIZE (64 * 1024U)          /**< [bytes] */
+    /* `make LV_MEM_KB=32` shrinks the built-in pool; `lvgl_heap` in the config can grow it at startup */
+    #ifdef OSD_LV_MEM_KB
+        #define LV_MEM_SIZE (OSD_LV_MEM_KB * 1024U)
+    #else
+        #define LV_MEM_SIZE (64 * 1024U)          /**< [bytes] */
+    #endif
 
     /** Size of the memory expand for `lv_malloc()` in bytes */
     #define LV_MEM_POOL_EXPAND_SIZE 0
@@ -107,7 +112,12 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+/* `make MT=1` builds the multi-core profile: pthread OS layer plus OSD_DRAW_UNITS software draw units */
+#ifdef OSD_LVGL_MT
+    #define LV_USE_OS   LV_OS_PTHREAD
+#else
+    #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -192,7 +202,11 @@
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
      *  - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #ifdef OSD_LVGL_MT
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    OSD_DRAW_UNITS
+    #else
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -425,7 +439,8 @@
 
 /** Add a custom handler when assert happens e.g. to restart MCU. */
 #define LV_ASSERT_HANDLER_INCLUDE <stdint.h>
-#define LV_ASSERT_HANDLER while(1);     /**< Halt by default */
+/* The OSD counts failures (osd_lvgl_assert in main.c) and keeps running instead of halting */
+#define LV_ASSERT_HANDLER { extern void osd_lvgl_assert(void); osd_lvgl_assert(); }
 
 /*-------------
  * Debug
@@ -7,72 +7,262 @@
 #include <poll.h>
 #include <signal.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <net/if.h>
 #include <fcntl.h>
 #include <ctype.h>
 #include <time.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sched.h>
 
 #include "lvgl/lvgl.h"
 #include "lvgl/src/draw/lv_draw_private.h"
 #include "mi_sys.h"
 #include "mi_rgn.h"
 #include "mi_vpe.h"
+#include "osd_shm.h"
+#include "osd_image.h"
+#ifdef OSD_FONTS
+#include "osd_fonts.h"
+#endif
+
+#if defined(OSD_USE_NEON) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define OSD_NEON_ENABLED 1
+#else
+#define OSD_NEON_ENABLED 0
+#endif
+
+#if defined(OSD_USE_GFX)
+#include "mi_gfx.h"
+#define OSD_GFX_ENABLED 1
+#else
+#define OSD_GFX_ENABLED 0
+#endif
+
+#if defined(OSD_PROFILE)
+#define OSD_PROFILE_ENABLED 1
+#else
+#define OSD_PROFILE_ENABLED 0
+#endif
 
 #define DEFAULT_SCREEN_WIDTH 1280   // fallback resolution if config is absent
 #define DEFAULT_SCREEN_HEIGHT 720
-#define BUF_ROWS 60  // partial buffer height
+#define DEFAULT_RENDER_ROWS 60      // partial buffer height
+#define DEFAULT_RENDER_PASS_COST_PX 4096
+#define OSD_REGION_MAX 4            // most MI_RGN regions used by region_mode: auto
+#ifndef CONFIG_PATH
 #define CONFIG_PATH "/etc/waybeam_osd.json"
+#endif
 #define UDP_PORT 7777
 #define UDP_MAX_PACKET 1280
-#define UDP_VALUE_COUNT 8
+#define UDP_VALUE_COUNT 8     // UDP slots below the system bank (0-7)
 #define SYSTEM_VALUE_COUNT 8
-#define TOTAL_VALUE_COUNT (UDP_VALUE_COUNT + SYSTEM_VALUE_COUNT)
 #define UDP_TEXT_COUNT 8
 #define SYSTEM_TEXT_COUNT 8
-#define TOTAL_TEXT_COUNT (UDP_TEXT_COUNT + SYSTEM_TEXT_COUNT)
-#define TEXT_SLOT_MAX_CHARS 96
+#define UDP_CHANNEL_MAX 48    // udp_channels ceiling; entries past 7 map to slots 16+
+#define TOTAL_VALUE_COUNT (g_udp_channels + SYSTEM_VALUE_COUNT)
+#define TOTAL_TEXT_COUNT (g_udp_channels + SYSTEM_TEXT_COUNT)
+#define UDP_SRC_MAX 256       // sender ids 0-255 in "src"
+#define DERIVED_SLOT_BASE (UDP_CHANNEL_MAX + SYSTEM_VALUE_COUNT)  // filter/computed outputs are slots 56-63
+#define DERIVED_SLOT_MAX 8
+#define VALUE_SLOT_COUNT (DERIVED_SLOT_BASE + DERIVED_SLOT_MAX)     // width of the value dirty mask
+#define DEFAULT_MAX_ASSETS 8
+#define ASSET_POOL_MAX 64     // one bit per asset in the dirty masks
+#define ASSET_INDEX_MAX 16    // text_indices / value_indices entries per asset
+#define GRAPH_FILL_OPA LV_OPA_30  // area under a graph line
+#define GAUGE_TRACK_OPA LV_OPA_30 // unfilled part of a gauge ring
+#define TEXT_SLOT_MAX_CHARS 96  // system descriptors, and the default UDP text capacity
 #define TEXT_SLOT_LEN (TEXT_SLOT_MAX_CHARS + 1)
+#define TEXT_SLOT_CAP_MAX 1023  // largest configurable UDP text capacity (text_slot_len)
+#define LOW_PRIORITY_HZ 4       // refresh cap of priority "low" assets without max_rate_hz
 
-enum {
-    SYS_VALUE_TEMP = 0,
-    SYS_VALUE_CPU_LOAD,
-    SYS_VALUE_ENCODER_FPS,
-    SYS_VALUE_ENCODER_BITRATE,
-    SYS_VALUE_RESERVED4,
-    SYS_VALUE_RESERVED5,
-    SYS_VALUE_RESERVED6,
-    SYS_VALUE_RESERVED7,
-};
+// Sources the system value slots 8-15 are mapped to with system_slots
+typedef enum {
+    SYS_SRC_NONE = 0,           // slot left alone
+    SYS_SRC_TEMP,
+    SYS_SRC_CPU_LOAD,
+    SYS_SRC_ENC_FPS,
+    SYS_SRC_ENC_KBPS,
+    SYS_SRC_ENC_FPS_10S,
+    SYS_SRC_ENC_KBPS_10S,
+    SYS_SRC_ENC1_FPS,           // VENC channel 1 (sub stream)
+    SYS_SRC_ENC1_KBPS,
+    SYS_SRC_MEM_FREE,           // MiB
+    SYS_SRC_MEM_AVAIL,          // MiB
+    SYS_SRC_MEM_USED_PCT,
+    SYS_SRC_CPU_CORE,           // arg = core
+    SYS_SRC_NET_RX_KBPS,        // iface from /proc/net/dev
+    SYS_SRC_NET_TX_KBPS,
+    SYS_SRC_NET_RX_PPS,
+    SYS_SRC_NET_TX_PPS,
+    SYS_SRC_COUNT
+} sys_source_t;
+
+typedef struct {
+    uint8_t source;             // sys_source_t
+    uint8_t arg;
+    char iface[16];
+} sys_slot_map_t;
 
-// LVGL buffers - allocated at runtime for ARGB8888 (32-bit per pixel)
-static lv_color_t *buf1 = NULL;
-static lv_color_t *buf2 = NULL;
+// Sources that come out of one read share a schedule (see system_periods)
+typedef enum {
+    SYS_GROUP_TEMP = 0,         // sysfs thermal zone
+    SYS_GROUP_CPU,              // /proc/stat, aggregate and per-core
+    SYS_GROUP_VENC,             // mi_venc proc file, both channels
+    SYS_GROUP_MEM,              // /proc/meminfo
+    SYS_GROUP_NET,              // /proc/net/dev
+    SYS_GROUP_COUNT
+} sys_group_t;
+
+static const char *const g_sys_group_names[SYS_GROUP_COUNT] = {"temp", "cpu", "encoder", "mem", "net"};
+
+// LVGL buffers - allocated at runtime for ARGB8888 (32-bit per pixel). The flush
+// converts synchronously, so a second buffer is only allocated when requested.
+static uint8_t *buf1 = NULL;
+static uint8_t *buf2 = NULL;
+
+typedef enum {
+    RENDER_MODE_PARTIAL = 0,
+    RENDER_MODE_DIRECT,
+} render_mode_t;
+
+// Canvas pixel format. Indexed formats map LVGL output onto a palette built
+// from the configured colors, cutting canvas size and VPE read bandwidth.
+typedef enum {
+    PIXEL_FORMAT_ARGB4444 = 0,
+    PIXEL_FORMAT_I8,
+    PIXEL_FORMAT_I4,
+    PIXEL_FORMAT_ARGB1555,
+    PIXEL_FORMAT_COUNT
+} pixel_format_t;
+
+typedef enum {
+    REGION_MODE_SINGLE = 0,
+    REGION_MODE_AUTO,
+} region_mode_t;
+
+#define OSD_PORT_MAX 4
 
 typedef struct {
     int width;
     int height;
     int osd_x;
     int osd_y;
+    sys_slot_map_t system_slots[SYSTEM_VALUE_COUNT];
+    int osd_port[OSD_PORT_MAX];     // VPE output ports the region is attached to
+    int osd_port_count;
+    int osd_port_x[OSD_PORT_MAX];   // per-port origin, defaults to osd_x/osd_y
+    int osd_port_y[OSD_PORT_MAX];
+    int osd_port_xy_count;
     int show_stats;
     int idle_ms;
     int system_refresh_ms;
+    int system_period_ms[SYS_GROUP_COUNT];  // per source group, 0 = system_refresh_ms
     int udp_stats;
+    int render_rows;
+    int render_buffers;
+    int render_pass_cost_px;  // coalescing price of one render pass, 0 = LVGL's own joins only
+    render_mode_t render_mode;
+    pixel_format_t pixel_format;
+    region_mode_t region_mode;
+    int region_max;
+    int gfx_accel;
+    int shm_transport;
+    int frame_sync;
+    int frame_rate;         // frame_sync tick rate, 0 = follow the encoder
+    int deep_idle;          // sleep until input or the next deadline instead of every idle_ms
+    int latency_stats;      // packet-to-pixel histograms in the stats widget and over UDP
+    int profile_stats;      // per-stage profiler lines in the stats widget (PROFILE=1 builds)
+    int rx_thread;          // drain udp_sock on a dedicated thread into an SPSC ring
+    int udp_rcvbuf;         // SO_RCVBUF request in bytes, 0 = kernel default
+    int udp_reuseport;      // SO_REUSEPORT so several OSD instances share the port
+    char udp_multicast[16]; // IPv4 group to join, "" = unicast only
+    char udp_multicast_iface[IF_NAMESIZE]; // interface name or IPv4 address, "" = kernel choice
+    int16_t value_owner[UDP_CHANNEL_MAX];  // src allowed to write values[i], -1 = anyone
+    int16_t text_owner[UDP_CHANNEL_MAX];   // src allowed to write texts[i], -1 = anyone
+    int render_cpus;        // CPU mask for the render loop and LVGL draw threads, 0 = unpinned
+    int cpu_affinity;       // CPU mask for the whole process, 0 = unpinned
+    int sched_policy;       // SCHED_OTHER, SCHED_FIFO or SCHED_RR
+    int sched_priority;     // real-time priority for FIFO/RR
+    int mlock;              // mlockall() and pre-fault the render buffers and canvases
+    int governor;           // throttle pushes/stats and shed noncritical assets under load
+    int governor_cpu_high;  // engage at or above this CPU load (%)
+    int governor_cpu_low;   // release once below this CPU load (%) for governor_hold_ms
+    int governor_fps_min;   // engage while the encoder runs below this FPS, 0 = ignore
+    int governor_push_ms;   // channel push interval while engaged
+    int governor_stats_ms;  // stats widget refresh while engaged
+    int governor_hold_ms;   // calm time required before releasing
+    int static_layers;      // pre-render static bar/graph parts and blit them
+    int flush_compare;      // skip 16-byte canvas chunks that already match
+    int metrics_port;       // UDP port answering metrics snapshots, 0 = off
+    int lvgl_heap_kb;       // total LVGL heap at startup, 0 = compile-time pool only
+    int lvgl_heap_auto;     // size the LVGL heap from max_assets instead
+    int heap_alarm_pct;     // warn once LVGL heap use reaches this share, 0 = off
+    int config_cache;       // keep a parsed copy of the config next to it for the next boot
+    int snapshot_ms;        // warm-restart snapshot period, 0 = off
+    char snapshot_path[96];
+    int hitch_ms;           // flight recorder deadline for one loop iteration, 0 = off
+    char hitch_file[96];    // hitch windows are appended here, empty = metrics port only
 } app_config_t;
 
 typedef enum {
     ASSET_BAR = 0,
     ASSET_TEXT,
+    ASSET_GRAPH,
+    ASSET_GAUGE,
+    ASSET_IMAGE,
+    ASSET_TYPE_COUNT,
 } asset_type_t;
 
+typedef enum {
+    GRAPH_MODE_SWEEP = 0,   // redraw only the newest column, wipe cursor ahead of it
+    GRAPH_MODE_SCROLL,      // newest sample at the right edge, whole canvas per sample
+} graph_mode_t;
+
+// How an asset's refresh is paced relative to the channel push throttle
+typedef enum {
+    PRIORITY_NORMAL = 0,    // refreshed on every push
+    PRIORITY_HIGH,          // a change to its inputs pushes at once, past max_ms and the governor
+    PRIORITY_LOW,           // coalesced to LOW_PRIORITY_HZ unless max_rate_hz says otherwise
+} asset_priority_t;
+
 typedef enum {
     ORIENTATION_RIGHT = 0,
     ORIENTATION_LEFT,
     ORIENTATION_CENTER,
 } asset_orientation_t;
 
+// Value-range style override, first match wins (see asset_rules_eval)
+#define ASSET_RULE_MAX 4
+#define RULE_OPEN_BOUND 1e30f
+
+enum {
+    RULE_SET_BAR_COLOR = 1u << 0,
+    RULE_SET_TEXT_COLOR = 1u << 1,
+    RULE_SET_BACKGROUND = 1u << 2,
+    RULE_SET_HIDE = 1u << 3,
+};
+
+typedef struct {
+    float above;            // matches above <= value < below
+    float below;
+    uint32_t sets;          // RULE_SET_* fields the rule overrides
+    uint32_t bar_color;
+    uint32_t text_color;
+    int background;
+} asset_rule_t;
+
 typedef struct {
     asset_type_t type;
     int id;
@@ -90,26 +280,166 @@ typedef struct {
     int bg_opacity_pct;
     char label[64];
     int text_index;
-    int text_indices[8];
+    int text_indices[ASSET_INDEX_MAX];
     int text_indices_count;
-    int value_indices[8];
+    int value_indices[ASSET_INDEX_MAX];
     int value_indices_count;
     int text_inline;
     char inline_separator[16];
     int rounded_outline;
     int segments;
     asset_orientation_t orientation;
+    int tabular_digits;     // label font with equal-width digits and cached ASCII glyphs
+    int font_size;          // label font size 12/14/16, 0 = LV_FONT_DEFAULT
+    int font_bpp;           // 1/2 = subsetted fonts from `make fonts`, 4 = built-in Montserrat
+    int history;            // graph ring length, 0 = one sample per pixel column
+    int interval_ms;        // graph sample period
+    graph_mode_t graph_mode;
+    int noncritical;        // hidden while the load governor is engaged
+    int smooth_ms;          // bar easing time constant, 0 = jump to each value
+    asset_priority_t priority;
+    int max_rate_hz;        // refresh cap, 0 = every push
+    asset_rule_t rules[ASSET_RULE_MAX];
+    int rule_count;
+    char image[96];         // image assets: osd_image.h blob path
 } asset_cfg_t;
 
+// Live state of a graph asset: the sample ring and the ARGB8888 pixels the
+// canvas object points at. Allocated with the visual, freed with it.
+typedef struct {
+    float *ring;            // normalised 0..1 samples, next write at head
+    int len;
+    int head;
+    int count;
+    uint32_t *buf;          // w * h pixels, 0xAARRGGBB
+    int w;
+    int h;
+    uint64_t next_ms;       // next sample deadline
+} graph_state_t;
+
+#define GAUGE_STEPS 100     // one bucket per percent
+
+// Live state of a gauge asset: the ring coverage rasterised once at create and
+// its pixels grouped by percent step, plus the canvas pixels tinted from them
+typedef struct {
+    uint32_t *buf;          // w * h pixels, 0xAARRGGBB
+    uint8_t *mask;          // w * h ring coverage, A8
+    uint32_t *order;        // ring pixel indices grouped by step
+    uint32_t start[GAUGE_STEPS + 1];  // first order[] entry of each step
+    lv_area_t step_box[GAUGE_STEPS];  // canvas-relative bounding box of each step
+    int w;
+    int h;
+    int drawn;              // filled steps currently painted
+} gauge_state_t;
+
+// Live state of an image asset: the mapped blob and, for indexed canvases, its
+// pixels as palette indices
+typedef struct {
+    void *map;              // whole blob, read-only
+    size_t map_len;
+    const uint16_t *px;     // frames * w * h ARGB4444 pixels inside map
+    uint8_t *idx;           // same pixels as palette indices, NULL on direct-color canvases
+    uint16_t *argb1555;     // same pixels as ARGB1555, ARGB1555 canvases only
+    int w;
+    int h;
+    int frames;
+    int frame;              // frame currently shown
+} image_state_t;
+
+// Pre-rasterised lit segment for segmented bars. Segments differ by at most a
+// pixel of remainder plus the missing gap on the last one, so a handful of
+// widths covers a bar; rebuilt when the size or colour changes.
+#define SEG_SPRITE_MAX 4
+
+typedef struct {
+    int w;
+    int h;
+    uint32_t color;
+    uint32_t *px;           // w * h pixels, 0xAARRGGBB
+    lv_image_dsc_t dsc;
+} seg_sprite_t;
+
+// Pre-rendered static parts of a bar or graph container (see static_layers)
+typedef struct {
+    uint32_t *px;           // w * h pixels, 0xAARRGGBB, container-sized
+    int w;
+    int h;
+    lv_image_dsc_t dsc;
+    int stale;              // restyled since the last build
+    int active;             // the current container draw blits the layer
+    int has_border;         // the bar outline is baked in
+    int has_label;          // the static label is baked in
+    lv_area_t bar_area;     // container-relative geometry the layer was built for
+    lv_area_t label_area;
+    char label_text[64];
+} static_layer_t;
+
+// LVGL objects of a hidden visual, kept per type so enable/disable toggles and
+// type swaps unhide and restyle instead of deleting and reallocating
+typedef struct {
+    lv_obj_t *container_obj;
+    lv_obj_t *obj;
+    lv_obj_t *label_obj;
+    graph_state_t *graph;
+    gauge_state_t *gauge;
+    image_state_t *image;
+} asset_parked_t;
+
 typedef struct {
     asset_cfg_t cfg;
     lv_obj_t *container_obj;
     lv_obj_t *obj;
     lv_obj_t *label_obj;
-    int last_pct;
-    char last_label_text[1024];
+    graph_state_t *graph;
+    gauge_state_t *gauge;
+    image_state_t *image;
+    asset_type_t visual_type;   // type the live objects were built for
+    asset_parked_t parked[ASSET_TYPE_COUNT];
+    seg_sprite_t *seg_sprites;  // SEG_SPRITE_MAX entries once a segmented bar draws
+    static_layer_t *static_layer;
+    int rule_active;            // matching rule + 1, 0 = base style
+    int rule_hidden;            // the active rule hides the asset
+    uint32_t rule_base_color;   // styles to restore when no rule matches
+    uint32_t rule_base_text_color;
+    int rule_base_bg_style;
+    int label_extent_w;         // label text extent at the last layout, -1 unknown
+    int label_extent_h;
 } asset_t;
 
+// Per-frame asset state, one dense array per field and indexed like assets[].
+// Derived from asset_cfg_t whenever the channel index is rebuilt, so the bar
+// walk on every channel push never touches the cold config and label strings.
+enum {
+    ASSET_HOT_ENABLED = 1u << 0,
+    ASSET_HOT_BAR = 1u << 1,
+};
+
+typedef struct {
+    uint8_t *flags;
+    int16_t *value_index;  // clamped slot feeding the bar fill
+    int16_t *last_pct;
+    int16_t *target_pct;   // latest channel percentage for easing bars
+    int32_t *pos_q8;       // eased position, percent in Q8 fixed point
+    uint16_t *smooth_ms;   // easing time constant, 0 = none
+    uint16_t *min_gap_ms;  // shortest time between refreshes, 0 = none
+    uint64_t *refreshed_ms;  // last rate-limited refresh
+    float *min;
+    float *range;          // max - min, at least 1
+} asset_hot_t;
+
+// Last text handed to an asset's label, indexed like assets[] and kept out of
+// asset_t so the per-push walk strides over small structs. The hash and full
+// length reject a changed text without touching the stored prefix, which
+// confirms a match for texts up to LABEL_CACHE_LEN - 1 bytes.
+#define LABEL_CACHE_LEN 128
+
+typedef struct {
+    uint32_t hash;          // FNV-1a of the full text
+    uint16_t len;           // full length, clamped to 0xFFFF
+    uint16_t valid;
+    char text[LABEL_CACHE_LEN];
+} label_cache_t;
+
 typedef struct {
     uint32_t color;
     lv_opa_t opa;
@@ -134,25 +464,90 @@ static int osd_width = DEFAULT_SCREEN_WIDTH;
 static int osd_height = DEFAULT_SCREEN_HEIGHT;
 static int osd_offset_x = 0;
 static int osd_offset_y = 0;
-static asset_t assets[8];
+static asset_t *assets = NULL;      // pool of g_asset_capacity entries (max_assets)
+static int g_asset_capacity = DEFAULT_MAX_ASSETS;
+static asset_hot_t g_hot;
+static label_cache_t *g_label_cache = NULL;  // g_asset_capacity entries
 static int asset_count = 0;
+static int g_udp_channels = UDP_VALUE_COUNT;
 static int rgn_pos_x = 0;
 static int rgn_pos_y = 0;
 
-#define MAX_ASSETS (int)(sizeof(assets) / sizeof(assets[0]))
+#define MAX_ASSETS g_asset_capacity
 
 // Sigmastar RGN
 static MI_RGN_PaletteTable_t g_stPaletteTable = {};
-static MI_RGN_HANDLE hRgnHandle;
-static MI_RGN_ChnPort_t stVpeChnPort;
-static MI_RGN_Attr_t stRgnAttr;
-static MI_RGN_ChnPortParam_t stRgnChnAttr;
-static MI_RGN_CanvasInfo_t g_cached_canvas_info;
-static int g_canvas_info_valid = 0;
+typedef struct {
+    MI_RGN_ChnPort_t chn;
+    int x;                  // region origin on this port's frame
+    int y;
+} osd_port_t;
+
+// One rendered set of regions, attached to every configured VPE output port
+static osd_port_t g_ports[OSD_PORT_MAX];
+static int g_port_count = 0;
+static MI_RGN_PixelFormat_e g_rgn_pixel_fmt = E_MI_RGN_PIXEL_FORMAT_ARGB4444;
 static int g_canvas_dirty = 0;
 
+// How the driver hands out canvases across MI_RGN_UpdateCanvas. The first commits
+// probe it; once a stable single buffer or an A/B ping-pong is seen the swap is
+// tracked locally and MI_RGN_GetCanvasInfo is no longer called per frame.
+typedef enum {
+    CANVAS_SWAP_PROBING = 0,
+    CANVAS_SWAP_SINGLE,
+    CANVAS_SWAP_PINGPONG,
+    CANVAS_SWAP_QUERY,  // unrecognised pattern: re-query after every commit
+} canvas_swap_mode_t;
+
+// One MI_RGN handle covering a rectangle of the LVGL screen. "single" mode uses
+// one region for the whole canvas; "auto" plans up to region_max tight regions
+// around the visible assets so only painted areas are allocated and blended.
+typedef struct {
+    MI_RGN_HANDLE handle;
+    lv_area_t area;              // LVGL screen coordinates covered by the region
+    int dirty;                   // flushed since the last commit
+    MI_RGN_CanvasInfo_t canvas;  // canvas the next frame renders into
+    int canvas_valid;
+    canvas_swap_mode_t swap_mode;
+    MI_RGN_CanvasInfo_t slots[2];
+    int back;
+    int probe_commits;
+} osd_region_t;
+static osd_region_t g_regions[OSD_REGION_MAX];
+static int g_region_count = 0;
+static int g_region_replan = 0;
+static int g_region_auto = 0;  // region_mode at startup
+static int g_canvas_bpp = 16;  // bits per canvas pixel for the active pixel_format
+static pixel_format_t g_canvas_format = PIXEL_FORMAT_ARGB4444;  // pixel_format at startup
+static int g_image_live = 0;     // image asset visuals, live or pooled (see images_overlay)
+
+// Areas flushed since the last MI_RGN_UpdateCanvas (one LVGL frame). Past
+// FRAME_AREA_MAX entries only the union is kept.
+#define FRAME_AREA_MAX 16
+static lv_area_t g_frame_areas[FRAME_AREA_MAX];
+static lv_area_t g_frame_dirty_area;
+static int g_frame_flush_count = 0;
+static int g_render_direct = 0;
+static int g_render_rows = 0;         // rows held by each LVGL buffer
+static size_t g_render_buf_size = 0;
+
+// One main loop iteration for the hitch flight recorder (see hitch_record)
+typedef struct {
+    uint32_t start_ms;      // loop start, monotonic ms (low 32 bits)
+    uint32_t loop_us;       // whole iteration
+    uint32_t poll_us;       // blocked in poll()
+    uint32_t sys_us;        // refresh_system_values()
+    uint32_t frame_us;      // render_and_commit()
+    uint32_t commit_us;     // commit_canvas() inside it
+    uint32_t pixels;        // flushed by my_flush_cb
+    uint16_t rx;            // datagrams received
+    uint16_t assets;        // assets recomposed by the channel push
+} hitch_rec_t;
+
+static hitch_rec_t g_hitch_cur;  // filled in by the stages while the iteration runs
+
 // UI
-static lv_obj_t *stats_label = NULL;
+static lv_obj_t *stats_label = NULL;   // stats panel; one child label per line
 static uint32_t last_frame_ms = 0;
 static uint32_t last_loop_ms = 0;
 static uint32_t fps_value = 0;
@@ -162,16 +557,63 @@ static int idle_ms_applied = 100;
 static volatile sig_atomic_t stop_requested = 0;
 static volatile sig_atomic_t reload_requested = 0;
 static lv_timer_t *stats_timer = NULL;
+static lv_display_t *g_display = NULL;
 static const int max_ms = 32; // throttle channel pushes to ~30 fps
+#define STATS_REFRESH_MS 250
+#define STATS_LINE_MAX 40
+#define STATS_LINE_LEN 192
+
+// Stats panel lines: label objects are created on first use and only get new
+// text when their content differs from the cached copy
+static lv_obj_t *g_stats_lines[STATS_LINE_MAX];
+static char g_stats_text[STATS_LINE_MAX][STATS_LINE_LEN];
+static int g_stats_shown = 0;
+
+// Load governor (see governor_update)
+typedef struct {
+    int active;
+    uint64_t calm_since_ms;  // below both release marks since, 0 = not calm
+    uint64_t shed;           // noncritical assets hidden while active, bit per asset slot
+} governor_state_t;
+static governor_state_t g_gov;
 static int udp_sock = -1;
-static double udp_values[UDP_VALUE_COUNT] = {0};
+static double *udp_values = NULL;     // g_udp_channels entries
 static double system_values[SYSTEM_VALUE_COUNT] = {0};
-static char udp_texts[UDP_TEXT_COUNT][TEXT_SLOT_LEN] = {{0}};
+static double g_sys_cpu_load = 0.0;  // last aggregate CPU load and main encoder FPS, mapped or not
+static double g_sys_enc_fps = 0.0;
+// UDP text slots: length-prefixed strings in one arena, each with its own
+// capacity (text_slot_len / text_slot_lens). The hash and length let a resent
+// text be recognised without comparing the whole buffer.
+typedef struct {
+    char *text;             // cap + 1 bytes inside g_text_arena
+    uint16_t len;
+    uint16_t cap;
+    uint32_t hash;          // FNV-1a of text[0..len)
+} text_slot_t;
+
+static text_slot_t *udp_texts = NULL;     // g_udp_channels entries
+static char *g_text_arena = NULL;
+static char *g_text_scratch = NULL;       // unescape buffer, largest cap + 1
+static size_t g_text_cap_max = TEXT_SLOT_MAX_CHARS;
 static char system_texts[SYSTEM_TEXT_COUNT][TEXT_SLOT_LEN] = {{0}};
 static int idle_cap_ms = 100;
-static uint64_t last_system_refresh_ms = 0;
+static uint32_t g_sample_seen = 0;  // sampler sequence last copied into system_values
 static uint64_t last_channel_push_ms = 0;
 static bool pending_channel_flush = false;
+// One dirty bit per value/text slot (numbered as value_index/text_index) and,
+// per slot, the assets[] entries reading it; only assets hit by a dirty slot
+// are recomposed on a channel push.
+static uint64_t g_value_dirty = 0;
+static uint64_t g_text_dirty = 0;
+static int g_snapshot_dirty = 0;  // UDP banks or the asset set changed since the last snapshot
+static uint64_t *g_value_users = NULL;  // VALUE_SLOT_COUNT entries
+static uint64_t *g_text_users = NULL;   // TOTAL_TEXT_COUNT entries
+static uint64_t g_asset_force = 0;  // assets refreshed regardless of their inputs
+static uint64_t g_asset_offscreen = 0;  // laid out where they cannot reach the canvas (asset_set_box)
+static uint64_t g_asset_high = 0;       // priority high, rebuilt with the channel index
+static uint64_t g_asset_deferred = 0;   // dirty but held back by min_gap_ms
+static uint64_t g_asset_deferred_ms = 0;  // earliest time a deferred asset is due
+static int g_channel_deps_stale = 1;
 // -------------------------
 // Utility helpers
 // -------------------------
@@ -187,617 +629,877 @@ static float clamp_float(float v, float lo, float hi) {
     return v;
 }
 
-static void init_system_channels(void)
+// Config names and descriptors of the fixed sources, indexed by sys_source_t
+static const struct {
+    const char *name;
+    const char *label;
+} g_sys_source_names[SYS_SRC_CPU_CORE] = {
+    {"none", ""},
+    {"temp", "temp"},
+    {"cpu", "cpu"},
+    {"enc_fps", "enc fps"},
+    {"enc_kbps", "bitrate"},
+    {"enc_fps_10s", "enc fps 10s"},
+    {"enc_kbps_10s", "bitrate 10s"},
+    {"enc1_fps", "enc1 fps"},
+    {"enc1_kbps", "enc1 bitrate"},
+    {"mem_free", "mem free"},
+    {"mem_avail", "mem avail"},
+    {"mem_used", "mem used"},
+};
+
+// Interface rate suffixes, in SYS_SRC_NET_* order
+static const char *const g_sys_net_suffixes[4] = {"rx_kbps", "tx_kbps", "rx_pps", "tx_pps"};
+
+static void system_slots_default(sys_slot_map_t *map)
 {
-    memset(system_values, 0, sizeof(system_values));
-    memset(system_texts, 0, sizeof(system_texts));
-    static const char *defaults[SYSTEM_TEXT_COUNT] = {
-        "temp",
-        "cpu",
-        "enc fps",
-        "bitrate",
-        "sys4",
-        "sys5",
-        "sys6",
-        "sys7",
-    };
-    for (int i = 0; i < SYSTEM_TEXT_COUNT; i++) {
-        snprintf(system_texts[i], TEXT_SLOT_LEN, "%s", defaults[i]);
+    memset(map, 0, sizeof(*map) * SYSTEM_VALUE_COUNT);
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) map[i].source = (uint8_t)(SYS_SRC_TEMP + i);
+}
+
+// "temp", "cpu", "cpu1", "mem_avail", "wlan0:tx_kbps", ...; returns -1 for an unknown name
+static int parse_sys_source(const char *name, sys_slot_map_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < SYS_SRC_CPU_CORE; i++) {
+        if (strcmp(name, g_sys_source_names[i].name) == 0) {
+            out->source = (uint8_t)i;
+            return 0;
+        }
+    }
+    if (strncmp(name, "cpu", 3) == 0 && isdigit((unsigned char)name[3]) && name[4] == '\0') {
+        out->source = SYS_SRC_CPU_CORE;
+        out->arg = (uint8_t)(name[3] - '0');
+        return 0;
+    }
+    const char *colon = strchr(name, ':');
+    size_t iface_len = colon ? (size_t)(colon - name) : 0;
+    if (iface_len == 0 || iface_len >= sizeof(out->iface)) return -1;
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(colon + 1, g_sys_net_suffixes[i]) != 0) continue;
+        out->source = (uint8_t)(SYS_SRC_NET_RX_KBPS + i);
+        memcpy(out->iface, name, iface_len);
+        out->iface[iface_len] = '\0';
+        return 0;
     }
+    return -1;
 }
 
-static double get_value_channel(int idx)
+static void sys_source_label(const sys_slot_map_t *m, char *buf, size_t sz)
 {
-    if (idx < 0) return 0.0;
-    if (idx < UDP_VALUE_COUNT) return udp_values[idx];
-    idx -= UDP_VALUE_COUNT;
-    if (idx < SYSTEM_VALUE_COUNT) return system_values[idx];
-    return 0.0;
+    static const char *const net_labels[4] = {"rx kbps", "tx kbps", "rx pps", "tx pps"};
+    if (m->source == SYS_SRC_CPU_CORE) {
+        snprintf(buf, sz, "cpu%u", (unsigned)m->arg);
+    } else if (m->source >= SYS_SRC_NET_RX_KBPS && m->source < SYS_SRC_COUNT) {
+        snprintf(buf, sz, "%s %s", m->iface, net_labels[m->source - SYS_SRC_NET_RX_KBPS]);
+    } else {
+        snprintf(buf, sz, "%s", m->source < SYS_SRC_CPU_CORE ? g_sys_source_names[m->source].label : "");
+    }
 }
 
-static const char *get_text_channel(int idx)
+// Slot a fixed source is mapped to, -1 when it is not on screen
+static int system_slot_of(sys_source_t source)
 {
-    if (idx < 0) return "";
-    if (idx < UDP_TEXT_COUNT) return udp_texts[idx];
-    idx -= UDP_TEXT_COUNT;
-    if (idx < SYSTEM_TEXT_COUNT) return system_texts[idx];
-    return "";
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        if (g_cfg.system_slots[i].source == source) return i;
+    }
+    return -1;
 }
 
-static int to_canvas_x(int x)
+// Descriptors follow the slot mapping, so they are rewritten after every config load
+static void system_texts_label(void)
 {
-    return x - osd_offset_x;
+    for (int i = 0; i < SYSTEM_TEXT_COUNT && i < SYSTEM_VALUE_COUNT; i++) {
+        char label[TEXT_SLOT_LEN];
+        sys_source_label(&g_cfg.system_slots[i], label, sizeof(label));
+        if (strcmp(label, system_texts[i]) == 0) continue;
+        snprintf(system_texts[i], TEXT_SLOT_LEN, "%s", label);
+        g_text_dirty |= 1ull << (UDP_TEXT_COUNT + i);
+    }
 }
 
-static int to_canvas_y(int y)
+static void init_system_channels(void)
 {
-    return y - osd_offset_y;
+    memset(system_values, 0, sizeof(system_values));
+    memset(system_texts, 0, sizeof(system_texts));
+    g_value_dirty |= ((1ull << SYSTEM_VALUE_COUNT) - 1u) << UDP_VALUE_COUNT;
+    g_text_dirty |= ((1ull << SYSTEM_TEXT_COUNT) - 1u) << UDP_TEXT_COUNT;
+    system_texts_label();
 }
 
-static asset_orientation_t parse_orientation_string(const char *str, asset_orientation_t def)
+// Slot numbering stays 0-7 UDP, 8-15 system; UDP entries past 7 continue at 16
+static int udp_channel_slot(int i)
 {
-    if (!str) return def;
-    if (strcmp(str, "left") == 0) return ORIENTATION_LEFT;
-    if (strcmp(str, "center") == 0) return ORIENTATION_CENTER;
-    if (strcmp(str, "right") == 0) return ORIENTATION_RIGHT;
-    return def;
+    return i < UDP_VALUE_COUNT ? i : i + SYSTEM_VALUE_COUNT;
 }
 
-static int estimate_label_width_px(const asset_cfg_t *cfg)
+// Real slots are clamped into range; derived slots 56-63 are always valid
+static int clamp_value_slot(int v)
 {
-    if (!cfg) return 0;
-    if (cfg->label[0] != '\0') {
-        int len = (int)strlen(cfg->label);
-        int px = len * 10;
-        if (px < 48) px = 48;
-        if (px > 240) px = 240;
-        return px;
-    }
-    if (cfg->text_index >= 0 || cfg->text_indices_count > 0) {
-        return 160;
-    }
-    return 0;
+    if (v >= DERIVED_SLOT_BASE && v < VALUE_SLOT_COUNT) return v;
+    return clamp_int(v, 0, TOTAL_VALUE_COUNT - 1);
 }
 
-static void compute_osd_geometry(void)
+// -------------------------
+// Channel filters
+// -------------------------
+/*
+ * Up to DERIVED_SLOT_MAX filters from the "filters" config array, each reading
+ * one value slot and publishing into a derived slot (filter k is slot 56 + k):
+ * an exponential moving average, a small-window median, or the per-second rate
+ * of a counter based on receive timestamps. Inputs are fed on every arrival,
+ * before the unchanged-value check, so a counter that stops moving reads as
+ * rate 0 and an average keeps converging on a steady value. A filter may read
+ * an earlier filter's slot, which makes e.g. a smoothed rate.
+ */
+#define FILTER_MEDIAN_MAX 9
+
+typedef enum {
+    FILTER_EMA = 0,
+    FILTER_MEDIAN,
+    FILTER_RATE
+} filter_type_t;
+
+typedef struct {
+    filter_type_t type;
+    int input;              // value slot read
+    float alpha;            // EMA weight of a new sample, 0..1
+    int window;             // median samples
+    float scale;            // output multiplier
+    int primed;
+    double ema;
+    double ring[FILTER_MEDIAN_MAX];
+    int ring_len;
+    int ring_pos;
+    double last_in;         // rate: previous counter value and its receive time
+    uint64_t last_us;
+} channel_filter_t;
+
+static channel_filter_t g_filters[DERIVED_SLOT_MAX];
+static int g_filter_count = 0;
+static uint64_t g_filter_inputs = 0;    // slots read by at least one filter
+static double g_derived_values[DERIVED_SLOT_MAX];
+static uint64_t g_value_stamp_us = 0;   // receive time of the datagram being applied, 0 = now
+
+static uint64_t monotonic_us64(void);
+
+static double filter_median(const channel_filter_t *f)
 {
-    osd_offset_x = 0;
-    osd_offset_y = 0;
-    osd_width = g_cfg.width;
-    osd_height = g_cfg.height;
+    double tmp[FILTER_MEDIAN_MAX];
+    int n = f->ring_len;
+    for (int i = 0; i < n; i++) {
+        double v = f->ring[i];
+        int j = i;
+        for (; j > 0 && tmp[j - 1] > v; j--) tmp[j] = tmp[j - 1];
+        tmp[j] = v;
+    }
+    return (n & 1) ? tmp[n / 2] : (tmp[n / 2 - 1] + tmp[n / 2]) * 0.5;
+}
 
-    rgn_pos_x = g_cfg.osd_x;
-    rgn_pos_y = g_cfg.osd_y;
-    if (rgn_pos_x < 0) {
-        osd_offset_x -= rgn_pos_x;
-        rgn_pos_x = 0;
+// Returns 0 with *out set when the sample produced an output
+static int filter_step(channel_filter_t *f, double v, uint64_t us, double *out)
+{
+    switch (f->type) {
+        case FILTER_EMA:
+            f->ema = f->primed ? f->ema + f->alpha * (v - f->ema) : v;
+            f->primed = 1;
+            *out = f->ema;
+            return 0;
+        case FILTER_MEDIAN:
+            f->ring[f->ring_pos] = v;
+            f->ring_pos = (f->ring_pos + 1) % f->window;
+            if (f->ring_len < f->window) f->ring_len++;
+            *out = filter_median(f);
+            return 0;
+        case FILTER_RATE:
+        default: {
+            int primed = f->primed;
+            uint64_t dt = us - f->last_us;
+            double delta = v - f->last_in;
+            if (primed && dt == 0) return -1;  // several samples from one datagram
+            f->primed = 1;
+            f->last_in = v;
+            f->last_us = us;
+            if (!primed || delta < 0) return -1;  // first sample, or the counter restarted
+            *out = delta * 1e6 / (double)dt;
+            return 0;
+        }
     }
-    if (rgn_pos_y < 0) {
-        osd_offset_y -= rgn_pos_y;
-        rgn_pos_y = 0;
+}
+
+static void filters_feed(int slot, double v)
+{
+    if (!((g_filter_inputs >> slot) & 1u)) return;
+    uint64_t us = g_value_stamp_us ? g_value_stamp_us : monotonic_us64();
+    for (int k = 0; k < g_filter_count; k++) {
+        channel_filter_t *f = &g_filters[k];
+        double out = 0.0;
+        if (f->input != slot || filter_step(f, v, us, &out) != 0) continue;
+        out *= f->scale;
+        if (g_derived_values[k] != out) {
+            g_derived_values[k] = out;
+            g_value_dirty |= 1ull << (DERIVED_SLOT_BASE + k);
+        }
+        filters_feed(DERIVED_SLOT_BASE + k, out);  // inputs only point at lower filters
     }
+}
 
-    if (osd_width < 1) osd_width = 1;
-    if (osd_height < 1) osd_height = 1;
+// -------------------------
+// Computed slots
+// -------------------------
+/*
+ * "computed" config entries are arithmetic expressions over value slots, e.g.
+ * "(v0 + v1) / 2" or "v0 * 100 / v9", compiled at config load into a short
+ * postfix bytecode and published in the derived slots after the filters
+ * (filter count + j for computed entry j). A push re-evaluates only entries
+ * whose inputs are dirty, in config order, so an entry may read an earlier
+ * one. Supported: numbers, vN slot references, + - * / %, unary minus,
+ * parentheses and min(a,b), max(a,b), abs(x). Division by zero yields 0.
+ */
+#define EXPR_CODE_MAX 64
+#define EXPR_CONST_MAX 8
+#define EXPR_STACK_MAX 16
+#define EXPR_TEXT_MAX 128
+
+typedef enum {
+    EXPR_OP_CONST = 0,      // followed by a constant index
+    EXPR_OP_SLOT,           // followed by a slot number
+    EXPR_OP_ADD,
+    EXPR_OP_SUB,
+    EXPR_OP_MUL,
+    EXPR_OP_DIV,
+    EXPR_OP_MOD,
+    EXPR_OP_NEG,
+    EXPR_OP_MIN,
+    EXPR_OP_MAX,
+    EXPR_OP_ABS,
+} expr_op_t;
+
+typedef struct {
+    uint8_t code[EXPR_CODE_MAX];
+    int code_len;
+    double consts[EXPR_CONST_MAX];
+    int const_count;
+    uint64_t inputs;        // slots read
+    int evaluated;          // published at least once since the config load
+} computed_slot_t;
+
+typedef struct {
+    const char *p;
+    computed_slot_t *out;
+    int depth;
+    int max_slot;           // slots at or above this are not readable yet
+    const char *err;
+} expr_compiler_t;
+
+static computed_slot_t g_computed[DERIVED_SLOT_MAX];
+static int g_computed_count = 0;
+
+static double get_value_channel(int idx);
+static int expr_parse_sum(expr_compiler_t *x);
+
+static void expr_skip_ws(expr_compiler_t *x)
+{
+    while (*x->p && isspace((unsigned char)*x->p)) x->p++;
 }
 
-static int read_file(const char *path, char **out_buf, size_t *out_len)
+static int expr_emit(expr_compiler_t *x, uint8_t op, int operand, int depth_delta)
 {
-    FILE *f = fopen(path, "rb");
-    if (!f) return -1;
-    if (fseek(f, 0, SEEK_END) != 0) {
-        fclose(f);
+    int need = op <= EXPR_OP_SLOT ? 2 : 1;
+    if (x->out->code_len + need > EXPR_CODE_MAX) {
+        x->err = "expression too long";
         return -1;
     }
-    long len = ftell(f);
-    if (len < 0) {
-        fclose(f);
+    x->out->code[x->out->code_len++] = op;
+    if (need == 2) x->out->code[x->out->code_len++] = (uint8_t)operand;
+    x->depth += depth_delta;
+    if (x->depth > EXPR_STACK_MAX) {
+        x->err = "expression nested too deeply";
         return -1;
     }
-    rewind(f);
-    char *buf = (char *)malloc((size_t)len + 1);
-    if (!buf) {
-        fclose(f);
+    return 0;
+}
+
+static int expr_parse_primary(expr_compiler_t *x)
+{
+    expr_skip_ws(x);
+    const char *p = x->p;
+    if (*p == '(') {
+        x->p++;
+        if (expr_parse_sum(x) != 0) return -1;
+        expr_skip_ws(x);
+        if (*x->p != ')') {
+            x->err = "missing )";
+            return -1;
+        }
+        x->p++;
+        return 0;
+    }
+    if (*p == 'v' && isdigit((unsigned char)p[1])) {
+        char *end = NULL;
+        long slot = strtol(p + 1, &end, 10);
+        int real = slot < TOTAL_VALUE_COUNT;
+        if (!real && (slot < DERIVED_SLOT_BASE || slot >= x->max_slot)) {
+            x->err = "unknown or later slot";
+            return -1;
+        }
+        x->p = end;
+        x->out->inputs |= 1ull << slot;
+        return expr_emit(x, EXPR_OP_SLOT, (int)slot, 1);
+    }
+    static const struct {
+        const char *name;
+        expr_op_t op;
+        int args;
+    } funcs[] = {{"min", EXPR_OP_MIN, 2}, {"max", EXPR_OP_MAX, 2}, {"abs", EXPR_OP_ABS, 1}};
+    for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+        size_t n = strlen(funcs[i].name);
+        if (strncmp(p, funcs[i].name, n) != 0) continue;
+        x->p += n;
+        expr_skip_ws(x);
+        if (*x->p != '(') break;
+        x->p++;
+        for (int a = 0; a < funcs[i].args; a++) {
+            if (a > 0) {
+                expr_skip_ws(x);
+                if (*x->p != ',') {
+                    x->err = "missing argument";
+                    return -1;
+                }
+                x->p++;
+            }
+            if (expr_parse_sum(x) != 0) return -1;
+        }
+        expr_skip_ws(x);
+        if (*x->p != ')') {
+            x->err = "missing )";
+            return -1;
+        }
+        x->p++;
+        return expr_emit(x, (uint8_t)funcs[i].op, 0, 1 - funcs[i].args);
+    }
+    char *end = NULL;
+    double k = strtod(p, &end);
+    if (end == p) {
+        x->err = "unexpected character";
         return -1;
     }
-    size_t r = fread(buf, 1, (size_t)len, f);
-    fclose(f);
-    buf[r] = '\0';
-    *out_buf = buf;
-    if (out_len) *out_len = r;
-    return 0;
+    x->p = end;
+    if (x->out->const_count >= EXPR_CONST_MAX) {
+        x->err = "too many constants";
+        return -1;
+    }
+    x->out->consts[x->out->const_count] = k;
+    return expr_emit(x, EXPR_OP_CONST, x->out->const_count++, 1);
 }
 
-static const char *find_key(const char *json, const char *key)
+static int expr_parse_unary(expr_compiler_t *x)
 {
-    static char pattern[64];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
-    return strstr(json, pattern);
+    expr_skip_ws(x);
+    if (*x->p == '-') {
+        x->p++;
+        if (expr_parse_unary(x) != 0) return -1;
+        return expr_emit(x, EXPR_OP_NEG, 0, 0);
+    }
+    return expr_parse_primary(x);
 }
 
-static const char *find_key_range(const char *start, const char *end, const char *key)
+static int expr_parse_product(expr_compiler_t *x)
 {
-    static char pattern[64];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
-#if defined(_GNU_SOURCE)
-    return memmem(start, (size_t)(end - start), pattern, strlen(pattern));
-#else
-    const char *p = start;
-    size_t plen = strlen(pattern);
-    while (p && p + plen <= end) {
-        const char *hit = strstr(p, pattern);
-        if (!hit || hit >= end) return NULL;
-        return hit;
+    if (expr_parse_unary(x) != 0) return -1;
+    for (;;) {
+        expr_skip_ws(x);
+        char c = *x->p;
+        if (c != '*' && c != '/' && c != '%') return 0;
+        x->p++;
+        if (expr_parse_unary(x) != 0) return -1;
+        uint8_t op = c == '*' ? EXPR_OP_MUL : (c == '/' ? EXPR_OP_DIV : EXPR_OP_MOD);
+        if (expr_emit(x, op, 0, -1) != 0) return -1;
     }
-    return NULL;
-#endif
 }
 
-static int json_get_int(const char *json, const char *key, int *out)
+static int expr_parse_sum(expr_compiler_t *x)
 {
-    const char *p = find_key(json, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p) return -1;
-    p++;
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) return -1;
-    *out = (int)strtol(p, NULL, 0);
-    return 0;
+    if (expr_parse_product(x) != 0) return -1;
+    for (;;) {
+        expr_skip_ws(x);
+        char c = *x->p;
+        if (c != '+' && c != '-') return 0;
+        x->p++;
+        if (expr_parse_product(x) != 0) return -1;
+        if (expr_emit(x, c == '+' ? EXPR_OP_ADD : EXPR_OP_SUB, 0, -1) != 0) return -1;
+    }
 }
 
-static int json_get_float(const char *json, const char *key, float *out)
+// Compiles text for the derived slot `slot`; returns NULL or an error message
+static const char *expr_compile(const char *text, int slot, computed_slot_t *out)
 {
-    const char *p = find_key(json, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p) return -1;
-    p++;
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) return -1;
-    *out = (float)strtod(p, NULL);
-    return 0;
+    memset(out, 0, sizeof(*out));
+    expr_compiler_t x = {text, out, 0, slot, NULL};
+    if (expr_parse_sum(&x) != 0) return x.err;
+    expr_skip_ws(&x);
+    if (*x.p) return "trailing characters";
+    return NULL;
 }
 
-static int json_get_bool(const char *json, const char *key, int *out)
+// fmod() without libm. Past 2^63 (or for NaN/inf) the quotient cannot be truncated, and the
+// remainder is lost to double precision anyway, so such operands give 0
+static double expr_mod(double a, double b)
 {
-    const char *p = find_key(json, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p) return -1;
-    p++;
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!strncmp(p, "true", 4)) {
-        *out = 1;
-        return 0;
-    }
-    if (!strncmp(p, "false", 5)) {
-        *out = 0;
-        return 0;
-    }
-    return -1;
+    if (b == 0.0) return 0.0;
+    double q = a / b;
+    if (!(q > -9.2e18 && q < 9.2e18)) return 0.0;
+    return a - b * (double)(long long)q;
 }
 
-static int json_get_int_range(const char *start, const char *end, const char *key, int *out)
+static double expr_eval(const computed_slot_t *c)
 {
-    const char *p = find_key_range(start, end, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p || p >= end) return -1;
-    p++;
-    while (p < end && isspace((unsigned char)*p)) p++;
-    if (p >= end) return -1;
-    *out = (int)strtol(p, NULL, 0);
-    return 0;
+    double st[EXPR_STACK_MAX];
+    int sp = 0;
+    for (int i = 0; i < c->code_len; i++) {
+        uint8_t op = c->code[i];
+        double b = sp > 0 ? st[sp - 1] : 0.0;
+        double a = sp > 1 ? st[sp - 2] : 0.0;
+        switch (op) {
+            case EXPR_OP_CONST:
+                st[sp++] = c->consts[c->code[++i]];
+                break;
+            case EXPR_OP_SLOT:
+                st[sp++] = get_value_channel(c->code[++i]);
+                break;
+            case EXPR_OP_NEG:
+                st[sp - 1] = -b;
+                break;
+            case EXPR_OP_ABS:
+                st[sp - 1] = b < 0 ? -b : b;
+                break;
+            default:
+                sp--;
+                if (op == EXPR_OP_ADD) a += b;
+                else if (op == EXPR_OP_SUB) a -= b;
+                else if (op == EXPR_OP_MUL) a *= b;
+                else if (op == EXPR_OP_DIV) a = b != 0.0 ? a / b : 0.0;
+                else if (op == EXPR_OP_MOD) a = expr_mod(a, b);
+                else if (op == EXPR_OP_MIN) a = a < b ? a : b;
+                else a = a > b ? a : b;
+                st[sp - 1] = a;
+                break;
+        }
+    }
+    return sp > 0 ? st[0] : 0.0;
 }
 
-static int json_get_float_range(const char *start, const char *end, const char *key, float *out)
+// Call before the dirty slots are consumed; results mark their own slot dirty
+static void computed_update(void)
 {
-    const char *p = find_key_range(start, end, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p || p >= end) return -1;
-    p++;
-    while (p < end && isspace((unsigned char)*p)) p++;
-    if (p >= end) return -1;
-    *out = (float)strtod(p, NULL);
-    return 0;
+    for (int j = 0; j < g_computed_count; j++) {
+        computed_slot_t *c = &g_computed[j];
+        if (c->evaluated && !(g_value_dirty & c->inputs)) continue;
+        c->evaluated = 1;
+        int k = g_filter_count + j;
+        double v = expr_eval(c);
+        if (g_derived_values[k] == v) continue;
+        g_derived_values[k] = v;
+        g_value_dirty |= 1ull << (DERIVED_SLOT_BASE + k);
+    }
 }
 
-static int json_get_bool_range(const char *start, const char *end, const char *key, int *out)
+static double get_value_channel(int idx)
 {
-    const char *p = find_key_range(start, end, key);
-    if (!p) return -1;
-    p = strchr(p, ':');
-    if (!p || p >= end) return -1;
-    p++;
-    while (p < end && isspace((unsigned char)*p)) p++;
-    if (p >= end) return -1;
-    if (!strncmp(p, "true", 4)) {
-        *out = 1;
-        return 0;
-    }
-    if (!strncmp(p, "false", 5)) {
-        *out = 0;
-        return 0;
-    }
-    return -1;
+    if (idx < 0) return 0.0;
+    if (idx >= DERIVED_SLOT_BASE) return idx < VALUE_SLOT_COUNT ? g_derived_values[idx - DERIVED_SLOT_BASE] : 0.0;
+    if (idx < UDP_VALUE_COUNT) return udp_values[idx];
+    idx -= UDP_VALUE_COUNT;
+    if (idx < SYSTEM_VALUE_COUNT) return system_values[idx];
+    idx -= SYSTEM_VALUE_COUNT;
+    if (idx < g_udp_channels - UDP_VALUE_COUNT) return udp_values[UDP_VALUE_COUNT + idx];
+    return 0.0;
 }
 
-static void json_get_int_array_range(const char *start, const char *end, const char *key, int *out, int max_count, int *out_count, int null_marker)
+static const char *get_text_channel(int idx)
 {
-    if (!out || max_count <= 0) return;
-    const char *p = find_key_range(start, end, key);
-    if (!p) return;
-    p = strchr(p, '[');
-    if (!p || p >= end) return;
-    p++;
-    int count = 0;
-    while (p < end && count < max_count) {
-        while (p < end && isspace((unsigned char)*p)) p++;
-        if (p >= end || *p == ']') break;
-        if (strncmp(p, "null", 4) == 0) {
-            out[count++] = null_marker;
-            p += 4;
-        } else {
-            char *endptr = NULL;
-            int v = (int)strtol(p, &endptr, 0);
-            if (!endptr || endptr == p || endptr > end) break;
-            out[count++] = v;
-            p = endptr;
-        }
-        while (p < end && *p != ',' && *p != ']') p++;
-        if (p < end && *p == ',') p++;
-    }
-    if (out_count) *out_count = count;
+    if (idx < 0) return "";
+    if (idx < UDP_TEXT_COUNT) return udp_texts[idx].text;
+    idx -= UDP_TEXT_COUNT;
+    if (idx < SYSTEM_TEXT_COUNT) return system_texts[idx];
+    idx -= SYSTEM_TEXT_COUNT;
+    if (idx < g_udp_channels - UDP_TEXT_COUNT) return udp_texts[UDP_TEXT_COUNT + idx].text;
+    return "";
 }
 
-static lv_opa_t pct_to_opa(int pct)
+// idx is the position in the UDP values[] array, not the slot number
+static void set_udp_value(int idx, double v)
 {
-    int clamped = clamp_int(pct, 0, 100);
-    return (lv_opa_t)((clamped * 255) / 100);
+    if (idx < 0 || idx >= g_udp_channels) return;
+    filters_feed(udp_channel_slot(idx), v);
+    if (udp_values[idx] == v) return;
+    udp_values[idx] = v;
+    g_value_dirty |= 1ull << udp_channel_slot(idx);
+    g_snapshot_dirty = 1;
 }
 
-static void apply_background_style(lv_obj_t *obj, int bg_style, int bg_opacity_pct, lv_part_t part);
-static void layout_bar_asset(asset_t *asset);
-static void layout_text_asset(asset_t *asset);
-static void bar_draw_event_cb(lv_event_t *e);
-static void destroy_asset_visual(asset_t *asset);
-static void create_asset_visual(asset_t *asset);
-static void maybe_attach_asset_label(asset_t *asset);
+static void mark_udp_text_dirty(int idx)
+{
+    if (idx < 0 || idx >= g_udp_channels) return;
+    g_text_dirty |= 1ull << udp_channel_slot(idx);
+}
 
-static asset_t *find_asset_by_id(int id)
+// idx is the position in the UDP texts[] array; text past the slot's capacity
+// is cut, and a text equal to the current one does not mark the slot dirty.
+// Returns 1 when the slot changed.
+static int set_udp_text(int idx, const char *src, size_t len)
 {
-    for (int i = 0; i < asset_count; i++) {
-        if (assets[i].cfg.id == id) return &assets[i];
-    }
-    return NULL;
+    if (idx < 0 || idx >= g_udp_channels) return 0;
+    text_slot_t *t = &udp_texts[idx];
+    if (len > t->cap) len = t->cap;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) hash = (hash ^ (uint8_t)src[i]) * 16777619u;
+    if (t->len == len && t->hash == hash && memcmp(t->text, src, len) == 0) return 0;
+    memmove(t->text, src, len);
+    t->text[len] = '\0';
+    t->len = (uint16_t)len;
+    t->hash = hash;
+    mark_udp_text_dirty(idx);
+    g_snapshot_dirty = 1;
+    return 1;
 }
 
-static void init_asset_defaults(asset_t *a, int id)
+static int asset_slot(const asset_t *asset)
 {
-    if (!a) return;
-    memset(a, 0, sizeof(*a));
-    a->cfg.type = ASSET_BAR;
-    a->cfg.id = id;
-    a->cfg.enabled = 1;
-    a->cfg.value_index = clamp_int(id, 0, TOTAL_VALUE_COUNT - 1);
-    a->cfg.x = 40;
-    a->cfg.y = 60 + id * 60;
-    a->cfg.width = 320;
-    a->cfg.height = 32;
-    a->cfg.min = 0.0f;
-    a->cfg.max = 1.0f;
-    a->cfg.color = 0x2266CC;
-    a->cfg.text_color = 0xFFFFFF;
-    a->cfg.bg_style = -1;
-    a->cfg.bg_opacity_pct = -1;
-    a->cfg.text_indices_count = 0;
-    a->cfg.value_indices_count = 0;
-    a->cfg.text_inline = 0;
-    a->cfg.text_index = -1;
-    for (int i = 0; i < 8; i++) {
-        a->cfg.value_indices[i] = -1;
-        a->cfg.text_indices[i] = -1;
-    }
-    a->cfg.inline_separator[0] = '\0';
-    a->cfg.orientation = ORIENTATION_RIGHT;
-    a->cfg.rounded_outline = 0;
-    a->cfg.segments = 0;
-    a->cfg.label[0] = '\0';
-    a->last_pct = -1;
-    a->last_label_text[0] = '\0';
+    return (int)(asset - assets);
 }
 
-static void style_bar_container(asset_t *asset, lv_color_t fallback_color, lv_opa_t fallback_opa)
+static void label_cache_reset(const asset_t *asset)
 {
-    if (!asset || !asset->container_obj) return;
+    g_label_cache[asset_slot(asset)].valid = 0;
+}
 
-    if (asset->cfg.bg_style >= 0) {
-        apply_background_style(asset->container_obj, asset->cfg.bg_style, asset->cfg.bg_opacity_pct, 0);
-    } else {
-        lv_obj_set_style_bg_color(asset->container_obj, fallback_color, 0);
-        lv_obj_set_style_bg_opa(asset->container_obj, fallback_opa, 0);
+// Records the text about to be shown; returns 0 when the label already shows it
+static int label_cache_update(const asset_t *asset, const char *text)
+{
+    label_cache_t *c = &g_label_cache[asset_slot(asset)];
+    uint32_t hash = 2166136261u;
+    size_t len = 0;
+    for (; text[len]; len++) hash = (hash ^ (uint8_t)text[len]) * 16777619u;
+    uint16_t len16 = len > 0xFFFF ? 0xFFFF : (uint16_t)len;
+    if (c->valid && c->hash == hash && c->len == len16 && strncmp(c->text, text, sizeof(c->text) - 1) == 0) {
+        return 0;
     }
+    c->hash = hash;
+    c->len = len16;
+    c->valid = 1;
+    snprintf(c->text, sizeof(c->text), "%s", text);
+    return 1;
+}
 
-    int radius = lv_obj_get_height(asset->container_obj) / 2;
-    if (radius < 6) radius = 6;
-    lv_obj_set_style_radius(asset->container_obj, radius, 0);
+// Called whenever an asset's config or visual changes so its inputs are re-indexed
+static void mark_asset_refresh(const asset_t *asset)
+{
+    int i = asset_slot(asset);
+    if (i >= 0 && i < MAX_ASSETS) g_asset_force |= 1ull << i;
+    g_channel_deps_stale = 1;
 }
 
-static void apply_asset_styles(asset_t *asset)
+static void channel_deps_add(uint64_t *users, int count, int idx, int asset_idx)
 {
-    if (!asset) return;
-    if (!asset->cfg.enabled) return;
-    const asset_cfg_t *cfg = &asset->cfg;
+    if (idx >= 0 && idx < count) users[idx] |= 1ull << asset_idx;
+}
 
-    switch (cfg->type) {
-        case ASSET_BAR: {
-            style_bar_container(asset, lv_color_hex(0x222222), LV_OPA_40);
-            if (asset->obj) {
-                int thickness = cfg->height > 0 ? cfg->height : (cfg->rounded_outline ? 20 : 32);
-                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_TRANSP, LV_PART_MAIN);
-                lv_obj_set_style_bg_color(asset->obj, lv_color_hex(cfg->color), LV_PART_INDICATOR);
-                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_COVER, LV_PART_INDICATOR);
-                lv_obj_set_style_radius(asset->obj, thickness / 2, LV_PART_MAIN);
-                lv_obj_set_style_radius(asset->obj, thickness / 2, LV_PART_INDICATOR);
-                lv_obj_set_style_border_width(asset->obj, cfg->rounded_outline ? 2 : 0, 0);
-                lv_obj_set_style_border_color(asset->obj, lv_color_hex(cfg->color), 0);
-                lv_obj_set_style_pad_all(asset->obj, cfg->rounded_outline ? 6 : 0, 0);
-            }
-            break;
+static void channel_deps_rebuild(void)
+{
+    memset(g_value_users, 0, sizeof(*g_value_users) * (size_t)VALUE_SLOT_COUNT);
+    memset(g_text_users, 0, sizeof(*g_text_users) * (size_t)TOTAL_TEXT_COUNT);
+    g_asset_high = 0;
+    for (int i = 0; i < asset_count; i++) {
+        const asset_cfg_t *cfg = &assets[i].cfg;
+        uint8_t flags = cfg->enabled ? ASSET_HOT_ENABLED : 0;
+        if (cfg->type == ASSET_BAR) flags |= ASSET_HOT_BAR;
+        g_hot.flags[i] = flags;
+        g_hot.value_index[i] = (int16_t)clamp_value_slot(cfg->value_index);
+        g_hot.smooth_ms[i] = (uint16_t)(cfg->type == ASSET_BAR ? cfg->smooth_ms : 0);
+        g_hot.min[i] = cfg->min;
+        g_hot.range[i] = (cfg->max <= cfg->min + 0.0001f) ? 1.0f : cfg->max - cfg->min;
+        int hz = cfg->max_rate_hz > 0 ? cfg->max_rate_hz : cfg->priority == PRIORITY_LOW ? LOW_PRIORITY_HZ : 0;
+        g_hot.min_gap_ms[i] = (uint16_t)(hz > 0 ? 1000 / hz : 0);
+        if (!cfg->enabled) continue;
+        if (cfg->priority == PRIORITY_HIGH) g_asset_high |= 1ull << i;
+        // update_assets_from_channels clamps value_index, so the bar always reads a slot
+        channel_deps_add(g_value_users, VALUE_SLOT_COUNT, g_hot.value_index[i], i);
+        for (int k = 0; k < cfg->value_indices_count; k++) {
+            channel_deps_add(g_value_users, VALUE_SLOT_COUNT, cfg->value_indices[k], i);
         }
-        case ASSET_TEXT:
-            if (asset->obj) {
-                apply_background_style(asset->obj, cfg->bg_style, cfg->bg_opacity_pct, 0);
-                lv_obj_set_style_text_color(asset->obj, lv_color_hex(cfg->text_color), 0);
-                lv_obj_set_style_text_opa(asset->obj, LV_OPA_COVER, 0);
-                int radius = 0;
-                int h = lv_obj_get_height(asset->obj);
-                if (h == 0 && cfg->height > 0) h = cfg->height;
-                if (cfg->rounded_outline) {
-                    radius = h > 0 ? h / 4 : 6;
-                    if (radius < 3) radius = 3;
-                    if (h > 0 && radius > h / 2) radius = h / 2;
-                    lv_obj_set_style_radius(asset->obj, radius, 0);
-                } else {
-                    lv_obj_set_style_radius(asset->obj, 0, 0);
-                }
-                int pad = cfg->rounded_outline ? 6 : 2;
-                lv_obj_set_style_pad_top(asset->obj, pad, 0);
-                lv_obj_set_style_pad_bottom(asset->obj, pad, 0);
-                lv_obj_set_style_pad_left(asset->obj, pad + 2, 0);
-                lv_obj_set_style_pad_right(asset->obj, pad + 2, 0);
-                lv_obj_set_style_clip_corner(asset->obj, cfg->rounded_outline ? 1 : 0, 0);
-            }
-            break;
-        default:
-            break;
-    }
-
-    if (asset->label_obj) {
-        if (cfg->type == ASSET_TEXT) {
-            apply_background_style(asset->label_obj, cfg->bg_style, cfg->bg_opacity_pct, 0);
-        } else {
-            lv_obj_set_style_bg_opa(asset->label_obj, LV_OPA_TRANSP, 0);
+        channel_deps_add(g_text_users, TOTAL_TEXT_COUNT, cfg->text_index, i);
+        for (int k = 0; k < cfg->text_indices_count; k++) {
+            channel_deps_add(g_text_users, TOTAL_TEXT_COUNT, cfg->text_indices[k], i);
         }
-        lv_obj_set_style_text_color(asset->label_obj, lv_color_hex(cfg->text_color), 0);
-        lv_obj_set_style_text_opa(asset->label_obj, LV_OPA_COVER, 0);
     }
+    g_channel_deps_stale = 0;
 }
 
-static void apply_background_style(lv_obj_t *obj, int bg_style, int bg_opacity_pct, lv_part_t part)
+// Assets whose inputs changed since the last push, leaving the dirty state alone
+static uint64_t dirty_asset_users(void)
 {
-    if (!obj) return;
-    if (bg_style < 0 || bg_style >= (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0]))) {
-        lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, part);
-        return;
-    }
+    if (g_channel_deps_stale) channel_deps_rebuild();
+    uint64_t todo = g_asset_force;
+    for (uint64_t m = g_value_dirty; m; m &= m - 1) todo |= g_value_users[__builtin_ctzll(m)];
+    // reset_channels marks all 64 bits; only the first TOTAL_TEXT_COUNT have a users entry
+    uint64_t text_slots = TOTAL_TEXT_COUNT >= 64 ? ~0ull : (1ull << TOTAL_TEXT_COUNT) - 1u;
+    for (uint64_t m = g_text_dirty & text_slots; m; m &= m - 1) todo |= g_text_users[__builtin_ctzll(m)];
+    return todo;
+}
 
-    lv_color_t c = lv_color_hex(g_bg_styles[bg_style].color);
-    lv_obj_set_style_bg_color(obj, c, part);
-    lv_opa_t opa = g_bg_styles[bg_style].opa;
-    if (bg_opacity_pct >= 0) {
-        opa = pct_to_opa(bg_opacity_pct);
-    }
-    lv_obj_set_style_bg_opa(obj, opa, part);
+// Assets whose inputs changed since the last push; clears the dirty state
+static uint64_t take_dirty_assets(void)
+{
+    uint64_t todo = dirty_asset_users();
+    g_value_dirty = 0;
+    g_text_dirty = 0;
+    g_asset_force = 0;
+    return todo;
+}
+
+static int to_canvas_x(int x)
+{
+    return x - osd_offset_x;
+}
+
+static int to_canvas_y(int y)
+{
+    return y - osd_offset_y;
 }
 
 /*
- * LVGL v9 draw task hook that replaces the indicator fill with segmented
- * rectangles when asset->cfg.segments > 1.
+ * An asset laid out entirely off the canvas is left out of channel pushes,
+ * bar easing and graph sampling; shared configs position assets for several
+ * resolutions and many never land on a given canvas. Content-sized boxes
+ * (auto-sized text, bar labels) are stale while skipped, so they only count
+ * as off the canvas on a side their growth cannot bring them back from.
+ * grow_x: 0 fixed width, 1 grows right, -1 grows left, 2 both ways;
+ * grow_y: 0 fixed height, 1 grows down.
  */
-static void bar_draw_event_cb(lv_event_t *e)
+static void asset_set_box(const asset_t *asset, int x, int y, int w, int h, int grow_x, int grow_y)
 {
-    asset_t *asset = (asset_t *)lv_event_get_user_data(e);
-    if (!asset || asset->cfg.segments <= 1) return;
+    int i = asset_slot(asset);
+    if (i < 0 || i >= MAX_ASSETS) return;
+    int off = (grow_x != -1 && grow_x != 2 && x >= osd_width) || (grow_x <= 0 && x + w <= 0) ||
+              y >= osd_height || (!grow_y && y + h <= 0);
+    uint64_t bit = 1ull << i;
+    if (off) {
+        g_asset_offscreen |= bit;
+    } else if (g_asset_offscreen & bit) {
+        g_asset_offscreen &= ~bit;
+        mark_asset_refresh(asset);  // catch up on what changed while skipped
+    }
+}
 
-    lv_draw_task_t *task = (lv_draw_task_t *)lv_event_get_param(e);
-    if (!task) return;
+static asset_orientation_t parse_orientation_string(const char *str, asset_orientation_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "left") == 0) return ORIENTATION_LEFT;
+    if (strcmp(str, "center") == 0) return ORIENTATION_CENTER;
+    if (strcmp(str, "right") == 0) return ORIENTATION_RIGHT;
+    return def;
+}
 
-    lv_draw_dsc_base_t *base = (lv_draw_dsc_base_t *)task->draw_dsc;
-    if (!base || base->part != LV_PART_INDICATOR) return;
+static asset_type_t parse_asset_type_string(const char *str, asset_type_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "bar") == 0) return ASSET_BAR;
+    if (strcmp(str, "text") == 0) return ASSET_TEXT;
+    if (strcmp(str, "graph") == 0) return ASSET_GRAPH;
+    if (strcmp(str, "gauge") == 0) return ASSET_GAUGE;
+    if (strcmp(str, "image") == 0) return ASSET_IMAGE;
+    return def;
+}
 
-    lv_draw_fill_dsc_t *fill_dsc = lv_draw_task_get_fill_dsc(task);
-    if (fill_dsc) fill_dsc->opa = LV_OPA_TRANSP;
-    lv_draw_border_dsc_t *border_dsc = lv_draw_task_get_border_dsc(task);
-    if (border_dsc) border_dsc->opa = LV_OPA_TRANSP;
+static asset_priority_t parse_priority_string(const char *str, asset_priority_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "normal") == 0) return PRIORITY_NORMAL;
+    if (strcmp(str, "high") == 0) return PRIORITY_HIGH;
+    if (strcmp(str, "low") == 0) return PRIORITY_LOW;
+    return def;
+}
 
-    int pct = asset->last_pct;
-    if (pct < 0) pct = 0;
-    if (pct > 100) pct = 100;
+static graph_mode_t parse_graph_mode_string(const char *str, graph_mode_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "sweep") == 0) return GRAPH_MODE_SWEEP;
+    if (strcmp(str, "scroll") == 0) return GRAPH_MODE_SCROLL;
+    return def;
+}
 
-    int segs = asset->cfg.segments;
-    lv_area_t track_area;
-    lv_obj_get_content_coords(base->obj, &track_area);
+static render_mode_t parse_render_mode_string(const char *str, render_mode_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "direct") == 0) return RENDER_MODE_DIRECT;
+    if (strcmp(str, "partial") == 0) return RENDER_MODE_PARTIAL;
+    return def;
+}
 
-    int total_w = lv_area_get_width(&track_area);
-    int total_h = lv_area_get_height(&task->area);
-    if (total_w <= 0 || total_h <= 0) return;
-
-    int seg_w = segs > 0 ? total_w / segs : total_w;
-    if (seg_w <= 0) {
-        segs = 1;
-        seg_w = total_w;
-    }
-    int remainder = total_w - seg_w * segs;
-    int gap = seg_w >= 14 ? 3 : (seg_w >= 8 ? 2 : (seg_w >= 5 ? 1 : 0));
-    int filled = (pct * segs + 99) / 100;
-    if (pct == 0) filled = 0;
-    if (filled > segs) filled = segs;
-
-    lv_draw_rect_dsc_t seg_dsc;
-    lv_draw_rect_dsc_init(&seg_dsc);
-    lv_obj_init_draw_rect_dsc(base->obj, LV_PART_INDICATOR, &seg_dsc);
-    seg_dsc.bg_opa = LV_OPA_COVER;
-    seg_dsc.border_opa = LV_OPA_TRANSP;
-    if (lv_color_to_int(seg_dsc.bg_color) == 0) {
-        seg_dsc.bg_color = lv_color_hex(asset->cfg.color);
-    }
-    seg_dsc.radius = total_h / 3;
-    if (seg_dsc.radius > total_h / 2) seg_dsc.radius = total_h / 2;
-
-    lv_base_dir_t dir = lv_obj_get_style_base_dir(base->obj, LV_PART_INDICATOR);
-    if (dir == LV_BASE_DIR_RTL) {
-        int x = track_area.x2 + 1;
-        for (int i = 0; i < filled; i++) {
-            int w = seg_w + (i < remainder ? 1 : 0);
-            int draw_w = w;
-            if (i < segs - 1 && gap < draw_w) draw_w -= gap;
-            if (draw_w <= 0) {
-                x -= w;
-                continue;
-            }
-            lv_area_t seg_area = task->area;
-            seg_area.x2 = x - 1;
-            seg_area.x1 = seg_area.x2 - draw_w + 1;
-            lv_draw_rect(base->layer, &seg_dsc, &seg_area);
-            x -= w;
-        }
-    } else {
-        int x = track_area.x1;
-        for (int i = 0; i < filled; i++) {
-            int w = seg_w + (i < remainder ? 1 : 0);
-            int draw_w = w;
-            if (i < segs - 1 && gap < draw_w) draw_w -= gap;
-            if (draw_w <= 0) {
-                x += w;
-                continue;
-            }
-            lv_area_t seg_area = task->area;
-            seg_area.x1 = x;
-            seg_area.x2 = x + draw_w - 1;
-            lv_draw_rect(base->layer, &seg_dsc, &seg_area);
-            x += w;
-        }
-    }
+static pixel_format_t parse_pixel_format_string(const char *str, pixel_format_t def)
+{
+    if (!str) return def;
+    if (strcmp(str, "argb4444") == 0) return PIXEL_FORMAT_ARGB4444;
+    if (strcmp(str, "i8") == 0) return PIXEL_FORMAT_I8;
+    if (strcmp(str, "i4") == 0) return PIXEL_FORMAT_I4;
+    if (strcmp(str, "argb1555") == 0) return PIXEL_FORMAT_ARGB1555;
+    return def;
 }
 
-static void layout_bar_asset(asset_t *asset)
+static region_mode_t parse_region_mode_string(const char *str, region_mode_t def)
 {
-    if (!asset || !asset->container_obj || !asset->obj) return;
-    const asset_cfg_t *cfg = &asset->cfg;
-    int pad_x = 8;
-    int pad_y = 6;
-    int bar_width = cfg->width > 0 ? cfg->width : (cfg->rounded_outline ? 200 : 320);
-    int bar_height = cfg->height > 0 ? cfg->height : (cfg->rounded_outline ? 20 : 32);
-    int label_width = 0;
-    int label_height = 0;
+    if (!str) return def;
+    if (strcmp(str, "auto") == 0) return REGION_MODE_AUTO;
+    if (strcmp(str, "single") == 0) return REGION_MODE_SINGLE;
+    return def;
+}
 
-    if (asset->label_obj) {
-        // Avoid a full layout pass when we already have cached label dimensions, but
-        // fall back to calculating them if they haven't been resolved yet. This keeps
-        // orientation changes from degenerating into repeated layouts while still
-        // giving left/right placement accurate sizing data.
-        label_width = lv_obj_get_width(asset->label_obj);
-        label_height = lv_obj_get_height(asset->label_obj);
-        if (label_width == 0 || label_height == 0) {
-            lv_obj_update_layout(asset->label_obj);
-            label_width = lv_obj_get_width(asset->label_obj);
-            label_height = lv_obj_get_height(asset->label_obj);
-        }
+static int parse_sched_policy_string(const char *str, int def)
+{
+    if (!str) return def;
+    if (strcmp(str, "other") == 0) return SCHED_OTHER;
+    if (strcmp(str, "fifo") == 0) return SCHED_FIFO;
+    if (strcmp(str, "rr") == 0) return SCHED_RR;
+    return def;
+}
+
+static int estimate_label_width_px(const asset_cfg_t *cfg)
+{
+    if (!cfg) return 0;
+    if (cfg->label[0] != '\0') {
+        int len = (int)strlen(cfg->label);
+        int px = len * 10;
+        if (px < 48) px = 48;
+        if (px > 240) px = 240;
+        return px;
+    }
+    if (cfg->text_index >= 0 || cfg->text_indices_count > 0) {
+        return 160;
     }
+    return 0;
+}
 
-    int extra_height = cfg->rounded_outline ? 4 : 0;
-    int container_height = bar_height;
-    if (label_height > container_height) container_height = label_height;
-    container_height += pad_y * 2 + extra_height;
-    int gap = (label_width > 0) ? pad_x : 0;
-    int tail_pad = pad_x + (label_width > 0 ? 4 : 0);
-    int container_width = pad_x + bar_width + gap + label_width + tail_pad;
+static void compute_osd_geometry(void)
+{
+    osd_offset_x = 0;
+    osd_offset_y = 0;
+    osd_width = g_cfg.width;
+    osd_height = g_cfg.height;
 
-    lv_obj_set_size(asset->container_obj, container_width, container_height);
-    int container_x = to_canvas_x(cfg->x);
-    if (cfg->orientation == ORIENTATION_LEFT) {
-        container_x -= container_width;
+    rgn_pos_x = g_cfg.osd_x;
+    rgn_pos_y = g_cfg.osd_y;
+    if (rgn_pos_x < 0) {
+        osd_offset_x -= rgn_pos_x;
+        rgn_pos_x = 0;
+    }
+    if (rgn_pos_y < 0) {
+        osd_offset_y -= rgn_pos_y;
+        rgn_pos_y = 0;
     }
-    lv_obj_set_pos(asset->container_obj, container_x, to_canvas_y(cfg->y));
-    int base_radius_height = bar_height + pad_y * 2 + extra_height;
-    int container_radius = base_radius_height / 2;
-    if (container_radius < 6) container_radius = 6;
-    if (container_radius > container_height / 2) container_radius = container_height / 2;
-    lv_obj_set_style_radius(asset->container_obj, container_radius, 0);
 
-    lv_obj_set_size(asset->obj, bar_width, bar_height);
-    lv_obj_set_style_radius(asset->obj, bar_height / 2, LV_PART_MAIN);
-    lv_obj_set_style_radius(asset->obj, bar_height / 2, LV_PART_INDICATOR);
-    lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_LTR, LV_PART_MAIN);
-    lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_LTR, LV_PART_INDICATOR);
+    if (osd_width < 1) osd_width = 1;
+    if (osd_height < 1) osd_height = 1;
+}
 
-    if (cfg->orientation == ORIENTATION_LEFT) {
-        lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_RTL, LV_PART_MAIN);
-        lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_RTL, LV_PART_INDICATOR);
-        int bar_x = pad_x + label_width + gap;
-        if (asset->label_obj) {
-            lv_obj_align(asset->label_obj, LV_ALIGN_LEFT_MID, pad_x, 0);
-        }
-        lv_obj_align(asset->obj, LV_ALIGN_LEFT_MID, bar_x, 0);
-    } else {
-        int label_x = pad_x + bar_width + gap;
-        lv_obj_align(asset->obj, LV_ALIGN_LEFT_MID, pad_x, 0);
-        if (asset->label_obj) {
-            lv_obj_align(asset->label_obj, LV_ALIGN_LEFT_MID, label_x, 0);
-        }
+static int read_file(const char *path, char **out_buf, size_t *out_len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    if (fseek(f, 0, SEEK_END) != 0) {
+        fclose(f);
+        return -1;
     }
+    long len = ftell(f);
+    if (len < 0) {
+        fclose(f);
+        return -1;
+    }
+    rewind(f);
+    char *buf = (char *)malloc((size_t)len + 1);
+    if (!buf) {
+        fclose(f);
+        return -1;
+    }
+    size_t r = fread(buf, 1, (size_t)len, f);
+    fclose(f);
+    buf[r] = '\0';
+    *out_buf = buf;
+    if (out_len) *out_len = r;
+    return 0;
 }
 
-static void layout_text_asset(asset_t *asset)
+static const char *find_key(const char *json, const char *key)
 {
-    if (!asset || !asset->obj) return;
-    const asset_cfg_t *cfg = &asset->cfg;
-    int width = cfg->width > 0 ? cfg->width : LV_SIZE_CONTENT;
-    int height = cfg->height > 0 ? cfg->height : LV_SIZE_CONTENT;
-    lv_obj_set_size(asset->obj, width, height);
+    static char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    return strstr(json, pattern);
+}
 
-    // Resolve content-driven size before anchoring so we can offset correctly
-    if (width == LV_SIZE_CONTENT || height == LV_SIZE_CONTENT) {
-        lv_obj_update_layout(asset->obj);
-        width = lv_obj_get_width(asset->obj);
-        height = lv_obj_get_height(asset->obj);
+static const char *find_key_range(const char *start, const char *end, const char *key)
+{
+    static char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+#if defined(_GNU_SOURCE)
+    return memmem(start, (size_t)(end - start), pattern, strlen(pattern));
+#else
+    const char *p = start;
+    size_t plen = strlen(pattern);
+    while (p && p + plen <= end) {
+        const char *hit = strstr(p, pattern);
+        if (!hit || hit >= end) return NULL;
+        return hit;
     }
+    return NULL;
+#endif
+}
 
-    lv_text_align_t align = LV_TEXT_ALIGN_LEFT;
-    int pos_x = to_canvas_x(cfg->x);
-    int pos_y = to_canvas_y(cfg->y);
-    switch (cfg->orientation) {
-        case ORIENTATION_CENTER:
-            align = LV_TEXT_ALIGN_CENTER;
-            pos_x -= width / 2;
-            break;
-        case ORIENTATION_LEFT:
-            align = LV_TEXT_ALIGN_RIGHT;
-            pos_x -= width;
-            break;
-        case ORIENTATION_RIGHT:
-        default:
-            align = LV_TEXT_ALIGN_LEFT;
-            break;
+static int json_get_int(const char *json, const char *key, int *out)
+{
+    const char *p = find_key(json, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p) return -1;
+    p++;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (!*p) return -1;
+    *out = (int)strtol(p, NULL, 0);
+    return 0;
+}
+
+static int json_get_float(const char *json, const char *key, float *out)
+{
+    const char *p = find_key(json, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p) return -1;
+    p++;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (!*p) return -1;
+    *out = (float)strtod(p, NULL);
+    return 0;
+}
+
+static int json_get_bool(const char *json, const char *key, int *out)
+{
+    const char *p = find_key(json, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p) return -1;
+    p++;
+    while (*p && isspace((unsigned char)*p)) p++;
+    if (!strncmp(p, "true", 4)) {
+        *out = 1;
+        return 0;
     }
-    lv_obj_set_style_text_align(asset->obj, align, LV_PART_MAIN | LV_STATE_DEFAULT);
-    lv_obj_set_pos(asset->obj, pos_x, pos_y);
+    if (!strncmp(p, "false", 5)) {
+        *out = 0;
+        return 0;
+    }
+    return -1;
 }
 
-static int json_get_string_range(const char *start, const char *end, const char *key, char *buf, size_t buf_sz)
+static int json_get_int_range(const char *start, const char *end, const char *key, int *out)
 {
     const char *p = find_key_range(start, end, key);
     if (!p) return -1;
@@ -805,1231 +1507,8145 @@ static int json_get_string_range(const char *start, const char *end, const char
     if (!p || p >= end) return -1;
     p++;
     while (p < end && isspace((unsigned char)*p)) p++;
-    if (p >= end || *p != '\"') return -1;
-    p++; // skip opening quote
-    const char *q = p;
-    while (q < end && *q && *q != '\"') q++;
-    size_t len = (size_t)(q - p);
-    if (q >= end || len + 1 > buf_sz) return -1;
-    memcpy(buf, p, len);
-    buf[len] = '\0';
+    if (p >= end) return -1;
+    *out = (int)strtol(p, NULL, 0);
     return 0;
 }
 
-static void set_defaults(void)
+static int json_get_float_range(const char *start, const char *end, const char *key, float *out)
 {
-    g_cfg.width = DEFAULT_SCREEN_WIDTH;
-    g_cfg.height = DEFAULT_SCREEN_HEIGHT;
-    g_cfg.osd_x = 0;
-    g_cfg.osd_y = 0;
-    g_cfg.show_stats = 1;
+    const char *p = find_key_range(start, end, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p || p >= end) return -1;
+    p++;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    if (p >= end) return -1;
+    *out = (float)strtod(p, NULL);
+    return 0;
+}
+
+static int json_get_bool_range(const char *start, const char *end, const char *key, int *out)
+{
+    const char *p = find_key_range(start, end, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p || p >= end) return -1;
+    p++;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    if (p >= end) return -1;
+    if (!strncmp(p, "true", 4)) {
+        *out = 1;
+        return 0;
+    }
+    if (!strncmp(p, "false", 5)) {
+        *out = 0;
+        return 0;
+    }
+    return -1;
+}
+
+static void json_get_int_array_range(const char *start, const char *end, const char *key, int *out, int max_count, int *out_count, int null_marker)
+{
+    if (!out || max_count <= 0) return;
+    const char *p = find_key_range(start, end, key);
+    if (!p) return;
+    p = strchr(p, '[');
+    if (!p || p >= end) return;
+    p++;
+    int count = 0;
+    while (p < end && count < max_count) {
+        while (p < end && isspace((unsigned char)*p)) p++;
+        if (p >= end || *p == ']') break;
+        if (strncmp(p, "null", 4) == 0) {
+            out[count++] = null_marker;
+            p += 4;
+        } else {
+            char *endptr = NULL;
+            int v = (int)strtol(p, &endptr, 0);
+            if (!endptr || endptr == p || endptr > end) break;
+            out[count++] = v;
+            p = endptr;
+        }
+        while (p < end && *p != ',' && *p != ']') p++;
+        if (p < end && *p == ',') p++;
+    }
+    if (out_count) *out_count = count;
+}
+
+static lv_opa_t pct_to_opa(int pct)
+{
+    int clamped = clamp_int(pct, 0, 100);
+    return (lv_opa_t)((clamped * 255) / 100);
+}
+
+static void apply_background_style(lv_obj_t *obj, int bg_style, int bg_opacity_pct, lv_part_t part);
+static void layout_bar_asset(asset_t *asset);
+static void layout_text_asset(asset_t *asset);
+static void bar_draw_event_cb(lv_event_t *e);
+static void destroy_asset_visual(asset_t *asset);
+static void create_asset_visual(asset_t *asset);
+static void maybe_attach_asset_label(asset_t *asset);
+static void graph_redraw(asset_t *asset);
+static void gauge_redraw(asset_t *asset);
+static void asset_visual_park(asset_t *asset);
+static int asset_visual_unpark(asset_t *asset);
+static void asset_visual_drop_parked(asset_t *asset);
+static void layout_asset(asset_t *asset);
+static void seg_sprites_free(asset_t *asset);
+static void apply_tabular_font(const asset_t *asset, lv_obj_t *obj);
+static int label_extent_unchanged(asset_t *asset, lv_obj_t *obj, const char *text);
+static void asset_set_shed(asset_t *asset, int hide);
+static void image_palette_add(const char *path);
+static void images_overlay(osd_region_t *r, const MI_RGN_CanvasInfo_t *info, const lv_area_t *clip);
+
+static asset_t *find_asset_by_id(int id)
+{
+    for (int i = 0; i < asset_count; i++) {
+        if (assets[i].cfg.id == id) return &assets[i];
+    }
+    return NULL;
+}
+
+static void init_asset_defaults(asset_t *a, int id)
+{
+    if (!a) return;
+    memset(a, 0, sizeof(*a));
+    a->cfg.type = ASSET_BAR;
+    a->cfg.id = id;
+    a->cfg.enabled = 1;
+    a->cfg.value_index = clamp_int(id, 0, TOTAL_VALUE_COUNT - 1);
+    a->cfg.x = 40;
+    a->cfg.y = 60 + id * 60;
+    a->cfg.width = 320;
+    a->cfg.height = 32;
+    a->cfg.min = 0.0f;
+    a->cfg.max = 1.0f;
+    a->cfg.color = 0x2266CC;
+    a->cfg.text_color = 0xFFFFFF;
+    a->cfg.bg_style = -1;
+    a->cfg.bg_opacity_pct = -1;
+    a->cfg.text_indices_count = 0;
+    a->cfg.value_indices_count = 0;
+    a->cfg.text_inline = 0;
+    a->cfg.text_index = -1;
+    for (int i = 0; i < ASSET_INDEX_MAX; i++) {
+        a->cfg.value_indices[i] = -1;
+        a->cfg.text_indices[i] = -1;
+    }
+    a->cfg.inline_separator[0] = '\0';
+    a->cfg.orientation = ORIENTATION_RIGHT;
+    a->cfg.rounded_outline = 0;
+    a->cfg.segments = 0;
+    a->cfg.tabular_digits = 0;
+    a->cfg.font_size = 0;
+    a->cfg.font_bpp = 4;
+    a->cfg.history = 0;
+    a->cfg.interval_ms = 100;
+    a->cfg.graph_mode = GRAPH_MODE_SWEEP;
+    a->cfg.smooth_ms = 0;
+    a->cfg.priority = PRIORITY_NORMAL;
+    a->cfg.max_rate_hz = 0;
+    a->cfg.label[0] = '\0';
+    a->label_extent_w = -1;
+    a->label_extent_h = 0;
+}
+
+static void style_bar_container(asset_t *asset, lv_color_t fallback_color, lv_opa_t fallback_opa)
+{
+    if (!asset || !asset->container_obj) return;
+
+    if (asset->cfg.bg_style >= 0) {
+        apply_background_style(asset->container_obj, asset->cfg.bg_style, asset->cfg.bg_opacity_pct, 0);
+    } else {
+        lv_obj_set_style_bg_color(asset->container_obj, fallback_color, 0);
+        lv_obj_set_style_bg_opa(asset->container_obj, fallback_opa, 0);
+    }
+
+    int radius = lv_obj_get_height(asset->container_obj) / 2;
+    if (radius < 6) radius = 6;
+    lv_obj_set_style_radius(asset->container_obj, radius, 0);
+}
+
+static void apply_asset_styles(asset_t *asset)
+{
+    if (!asset) return;
+    if (!asset->cfg.enabled) return;
+    const asset_cfg_t *cfg = &asset->cfg;
+    if (asset->static_layer) asset->static_layer->stale = 1;
+
+    switch (cfg->type) {
+        case ASSET_BAR: {
+            style_bar_container(asset, lv_color_hex(0x222222), LV_OPA_40);
+            seg_sprites_free(asset);
+            if (asset->obj) {
+                int thickness = cfg->height > 0 ? cfg->height : (cfg->rounded_outline ? 20 : 32);
+                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_TRANSP, LV_PART_MAIN);
+                lv_obj_set_style_bg_color(asset->obj, lv_color_hex(cfg->color), LV_PART_INDICATOR);
+                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_COVER, LV_PART_INDICATOR);
+                lv_obj_set_style_radius(asset->obj, thickness / 2, LV_PART_MAIN);
+                lv_obj_set_style_radius(asset->obj, thickness / 2, LV_PART_INDICATOR);
+                lv_obj_set_style_border_width(asset->obj, cfg->rounded_outline ? 2 : 0, 0);
+                lv_obj_set_style_border_color(asset->obj, lv_color_hex(cfg->color), 0);
+                lv_obj_set_style_pad_all(asset->obj, cfg->rounded_outline ? 6 : 0, 0);
+            }
+            break;
+        }
+        case ASSET_GRAPH:
+            style_bar_container(asset, lv_color_hex(0x222222), LV_OPA_40);
+            if (asset->obj) {
+                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_TRANSP, LV_PART_MAIN);
+                graph_redraw(asset);
+            }
+            break;
+        case ASSET_GAUGE:
+            style_bar_container(asset, lv_color_hex(0x222222), LV_OPA_40);
+            if (asset->obj) {
+                lv_obj_set_style_bg_opa(asset->obj, LV_OPA_TRANSP, LV_PART_MAIN);
+                gauge_redraw(asset);
+            }
+            break;
+        case ASSET_IMAGE:
+            if (asset->container_obj) lv_obj_set_style_bg_opa(asset->container_obj, LV_OPA_TRANSP, 0);
+            break;
+        case ASSET_TEXT:
+            if (asset->obj) {
+                apply_background_style(asset->obj, cfg->bg_style, cfg->bg_opacity_pct, 0);
+                lv_obj_set_style_text_color(asset->obj, lv_color_hex(cfg->text_color), 0);
+                lv_obj_set_style_text_opa(asset->obj, LV_OPA_COVER, 0);
+                int radius = 0;
+                int h = lv_obj_get_height(asset->obj);
+                if (h == 0 && cfg->height > 0) h = cfg->height;
+                if (cfg->rounded_outline) {
+                    radius = h > 0 ? h / 4 : 6;
+                    if (radius < 3) radius = 3;
+                    if (h > 0 && radius > h / 2) radius = h / 2;
+                    lv_obj_set_style_radius(asset->obj, radius, 0);
+                } else {
+                    lv_obj_set_style_radius(asset->obj, 0, 0);
+                }
+                int pad = cfg->rounded_outline ? 6 : 2;
+                lv_obj_set_style_pad_top(asset->obj, pad, 0);
+                lv_obj_set_style_pad_bottom(asset->obj, pad, 0);
+                lv_obj_set_style_pad_left(asset->obj, pad + 2, 0);
+                lv_obj_set_style_pad_right(asset->obj, pad + 2, 0);
+                lv_obj_set_style_clip_corner(asset->obj, cfg->rounded_outline ? 1 : 0, 0);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (asset->label_obj) {
+        if (cfg->type == ASSET_TEXT) {
+            apply_background_style(asset->label_obj, cfg->bg_style, cfg->bg_opacity_pct, 0);
+        } else {
+            lv_obj_set_style_bg_opa(asset->label_obj, LV_OPA_TRANSP, 0);
+        }
+        lv_obj_set_style_text_color(asset->label_obj, lv_color_hex(cfg->text_color), 0);
+        lv_obj_set_style_text_opa(asset->label_obj, LV_OPA_COVER, 0);
+    }
+}
+
+static void apply_background_style(lv_obj_t *obj, int bg_style, int bg_opacity_pct, lv_part_t part)
+{
+    if (!obj) return;
+    if (bg_style < 0 || bg_style >= (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0]))) {
+        lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, part);
+        return;
+    }
+
+    lv_color_t c = lv_color_hex(g_bg_styles[bg_style].color);
+    lv_obj_set_style_bg_color(obj, c, part);
+    lv_opa_t opa = g_bg_styles[bg_style].opa;
+    if (bg_opacity_pct >= 0) {
+        opa = pct_to_opa(bg_opacity_pct);
+    }
+    lv_obj_set_style_bg_opa(obj, opa, part);
+}
+
+// -------------------------
+// Tabular digit fonts
+// -------------------------
+// Wraps a built-in font so the digits share one advance (the widest digit,
+// each glyph centred in it) and printable ASCII resolves from a table built
+// once instead of the font's glyph search. Numeric labels then keep their
+// width while the digits change, and the width is a sum of cached advances.
+#define TABULAR_FONT_MAX 9  // 3 sizes x 3 bpp variants
+#define TABULAR_FIRST_CHAR 0x20
+#define TABULAR_GLYPH_COUNT (0x7F - TABULAR_FIRST_CHAR)
+
+typedef struct {
+    const lv_font_t *base;
+    lv_font_t font;
+    lv_font_glyph_dsc_t glyphs[TABULAR_GLYPH_COUNT];
+    uint8_t have[TABULAR_GLYPH_COUNT];
+} tabular_font_t;
+
+static tabular_font_t g_tabular_fonts[TABULAR_FONT_MAX];
+static int g_tabular_font_count = 0;
+
+static bool tabular_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    const tabular_font_t *tf = (const tabular_font_t *)font->user_data;
+    uint32_t slot = letter - TABULAR_FIRST_CHAR;
+    if (letter >= TABULAR_FIRST_CHAR && slot < TABULAR_GLYPH_COUNT && tf->have[slot]) {
+        *dsc = tf->glyphs[slot];
+        return true;
+    }
+    return tf->base->get_glyph_dsc(tf->base, dsc, letter, letter_next);
+}
+
+static const tabular_font_t *tabular_font_of(const lv_font_t *font)
+{
+    if (!font || font->get_glyph_dsc != tabular_get_glyph_dsc) return NULL;
+    return (const tabular_font_t *)font->user_data;
+}
+
+static const lv_font_t *tabular_font_for(const lv_font_t *base)
+{
+    if (!base || tabular_font_of(base)) return base;
+    for (int i = 0; i < g_tabular_font_count; i++) {
+        if (g_tabular_fonts[i].base == base) return &g_tabular_fonts[i].font;
+    }
+    if (g_tabular_font_count >= TABULAR_FONT_MAX) return base;
+
+    tabular_font_t *tf = &g_tabular_fonts[g_tabular_font_count++];
+    memset(tf, 0, sizeof(*tf));
+    tf->base = base;
+    // the glyph bitmaps are still fetched through base->dsc, which the copy shares
+    tf->font = *base;
+    tf->font.get_glyph_dsc = tabular_get_glyph_dsc;
+    tf->font.kerning = LV_FONT_KERNING_NONE;
+    tf->font.user_data = tf;
+
+    int digit_adv = 0;
+    for (uint32_t c = TABULAR_FIRST_CHAR; c < TABULAR_FIRST_CHAR + TABULAR_GLYPH_COUNT; c++) {
+        lv_font_glyph_dsc_t *g = &tf->glyphs[c - TABULAR_FIRST_CHAR];
+        if (!base->get_glyph_dsc(base, g, c, 0) || g->is_placeholder) continue;
+        tf->have[c - TABULAR_FIRST_CHAR] = 1;
+        if (c >= '0' && c <= '9' && g->adv_w > digit_adv) digit_adv = g->adv_w;
+    }
+    for (uint32_t c = '0'; c <= '9'; c++) {
+        lv_font_glyph_dsc_t *g = &tf->glyphs[c - TABULAR_FIRST_CHAR];
+        if (!tf->have[c - TABULAR_FIRST_CHAR]) continue;
+        g->ofs_x = (int16_t)(g->ofs_x + (digit_adv - g->adv_w) / 2);
+        g->adv_w = (uint16_t)digit_adv;
+    }
+    return &tf->font;
+}
+
+static void apply_tabular_font(const asset_t *asset, lv_obj_t *obj)
+{
+    if (!asset->cfg.tabular_digits || !obj) return;
+    lv_obj_set_style_text_font(obj, tabular_font_for(lv_obj_get_style_text_font(obj, LV_PART_MAIN)), 0);
+}
+
+// Subsetted 1/2-bpp fonts carry only the glyphs the OSD can show and blend with
+// fewer coverage levels than the 4-bit canvas resolves anyway. Builds without
+// FONTS=1, or sizes not generated, fall back to the built-in 4-bpp Montserrat.
+static const lv_font_t *label_font(int size, int bpp)
+{
+#ifdef OSD_FONTS
+    if (bpp == 1) return size == 12 ? &osd_font_12_1 : size == 16 ? &osd_font_16_1 : &osd_font_14_1;
+    if (bpp == 2) return size == 12 ? &osd_font_12_2 : size == 16 ? &osd_font_16_2 : &osd_font_14_2;
+#else
+    (void)bpp;
+#endif
+    return size == 12 ? &lv_font_montserrat_12 : size == 16 ? &lv_font_montserrat_16 : &lv_font_montserrat_14;
+}
+
+static void apply_label_font(const asset_t *asset, lv_obj_t *obj)
+{
+    if (!obj) return;
+    if (asset->cfg.font_size > 0 || asset->cfg.font_bpp != 4) {
+        lv_obj_set_style_text_font(obj, label_font(asset->cfg.font_size, asset->cfg.font_bpp), 0);
+    }
+    apply_tabular_font(asset, obj);
+}
+
+// Widest line and line count of text in a tabular font; -1 when a character
+// is outside the cached table and the width cannot be derived arithmetically
+static int tabular_text_extent(const tabular_font_t *tf, const char *text, int *max_w, int *lines)
+{
+    int w = 0;
+    *max_w = 0;
+    *lines = 1;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '\n') {
+            if (w > *max_w) *max_w = w;
+            w = 0;
+            (*lines)++;
+            continue;
+        }
+        uint32_t slot = (uint32_t)*p - TABULAR_FIRST_CHAR;
+        if (*p < TABULAR_FIRST_CHAR || slot >= TABULAR_GLYPH_COUNT || !tf->have[slot]) return -1;
+        w += tf->glyphs[slot].adv_w;
+    }
+    if (w > *max_w) *max_w = w;
+    return 0;
+}
+
+// True when a label's new text keeps the extent of the last layout, so
+// lv_label_set_text's own invalidation is all that is needed and the asset
+// skips lv_obj_update_layout and the container resize of layout_*_asset.
+// Tabular fonts sum cached advances; other text is measured the way the label
+// will lay it out, wrapping at the content width of fixed-width text boxes.
+static int label_extent_unchanged(asset_t *asset, lv_obj_t *obj, const char *text)
+{
+    const asset_cfg_t *cfg = &asset->cfg;
+    int wraps = cfg->type == ASSET_TEXT && cfg->width > 0;
+    if (wraps && cfg->height > 0) return 1;  // fixed box: layout ignores the content
+
+    const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    const tabular_font_t *tf = tabular_font_of(font);
+    int w = 0;
+    int h = 0;
+    int lines = 0;
+    if (tf && !wraps && tabular_text_extent(tf, text, &w, &lines) == 0) {
+        h = lines * font->line_height;
+    } else {
+        int max_w = LV_COORD_MAX;
+        if (wraps) {
+            max_w = cfg->width - lv_obj_get_style_pad_left(obj, LV_PART_MAIN) - lv_obj_get_style_pad_right(obj, LV_PART_MAIN);
+        }
+        lv_point_t size;
+        lv_text_get_size(&size, text, font, lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN),
+                         lv_obj_get_style_text_line_space(obj, LV_PART_MAIN), max_w, LV_TEXT_FLAG_NONE);
+        w = size.x;
+        h = size.y;
+    }
+    int same = asset->label_extent_w == w && asset->label_extent_h == h;
+    asset->label_extent_w = w;
+    asset->label_extent_h = h;
+    return same;
+}
+
+// -------------------------
+// Segmented bars
+// -------------------------
+typedef struct {
+    int segs;
+    int seg_w;
+    int remainder;  // the first `remainder` segments are one pixel wider
+    int gap;
+} seg_geom_t;
+
+static int seg_geom_init(seg_geom_t *g, int segs, int total_w)
+{
+    if (total_w <= 0 || segs <= 0) return -1;
+    g->segs = segs;
+    g->seg_w = total_w / segs;
+    if (g->seg_w <= 0) {
+        g->segs = 1;
+        g->seg_w = total_w;
+    }
+    g->remainder = total_w - g->seg_w * g->segs;
+    g->gap = g->seg_w >= 14 ? 3 : (g->seg_w >= 8 ? 2 : (g->seg_w >= 5 ? 1 : 0));
+    return 0;
+}
+
+static int seg_filled_count(const seg_geom_t *g, int pct)
+{
+    if (pct <= 0) return 0;
+    int filled = (pct * g->segs + 99) / 100;
+    return filled > g->segs ? g->segs : filled;
+}
+
+// Segment i as an offset from the fill origin plus its painted width
+static void seg_span(const seg_geom_t *g, int i, int *offset, int *draw_w)
+{
+    int w = g->seg_w + (i < g->remainder ? 1 : 0);
+    *offset = i * g->seg_w + (i < g->remainder ? i : g->remainder);
+    *draw_w = (i < g->segs - 1 && g->gap < w) ? w - g->gap : w;
+}
+
+// Maps segments [first, last) to screen columns of the track
+static void seg_columns(const seg_geom_t *g, const lv_area_t *track, int rtl, int first, int last, int *x1, int *x2)
+{
+    int off_a = 0;
+    int w_a = 0;
+    int off_b = 0;
+    int w_b = 0;
+    seg_span(g, first, &off_a, &w_a);
+    seg_span(g, last - 1, &off_b, &w_b);
+    if (rtl) {
+        *x2 = track->x2 - off_a;
+        *x1 = track->x2 - off_b - w_b + 1;
+    } else {
+        *x1 = track->x1 + off_a;
+        *x2 = track->x1 + off_b + w_b - 1;
+    }
+}
+
+static void seg_sprite_set_free(seg_sprite_t *sprites)
+{
+    if (!sprites) return;
+    for (int i = 0; i < SEG_SPRITE_MAX; i++) {
+        if (!sprites[i].px) continue;
+        lv_image_cache_drop(&sprites[i].dsc);
+        free(sprites[i].px);
+    }
+    free(sprites);
+}
+
+static void seg_sprites_free(asset_t *asset)
+{
+    seg_sprite_set_free(asset->seg_sprites);
+    asset->seg_sprites = NULL;
+}
+
+/*
+ * The draw hook runs while the frame is still being rendered. With more than
+ * one software draw unit (make MT=1) an image task queued earlier in the same
+ * refresh may still be blitting a sprite on another thread, so a set the
+ * hook outgrows is parked here and freed once the refresh has finished.
+ */
+#define SEG_RETIRED_MAX 16
+static seg_sprite_t *g_seg_retired[SEG_RETIRED_MAX];
+static int g_seg_retired_count = 0;
+
+static int seg_sprites_retire(asset_t *asset)
+{
+    if (g_seg_retired_count >= SEG_RETIRED_MAX) return -1;
+    g_seg_retired[g_seg_retired_count++] = asset->seg_sprites;
+    asset->seg_sprites = NULL;
+    return 0;
+}
+
+static void seg_sprites_reap(void)
+{
+    for (int i = 0; i < g_seg_retired_count; i++) seg_sprite_set_free(g_seg_retired[i]);
+    g_seg_retired_count = 0;
+}
+
+// Rounded rectangle with 4x4 supersampled corner coverage, same radius rule
+// the per-draw lv_draw_rect path used (a third of the height)
+static void seg_sprite_raster(seg_sprite_t *sp)
+{
+    int w = sp->w;
+    int h = sp->h;
+    int r = h / 3;
+    if (r > h / 2) r = h / 2;
+    if (r > w / 2) r = w / 2;
+    uint32_t rgb = sp->color & 0xFFFFFFu;
+    float rr = (float)r * (float)r;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int cx = x < r ? r : (x >= w - r ? w - r : -1);
+            int cy = y < r ? r : (y >= h - r ? h - r : -1);
+            int cover = 16;
+            if (cx >= 0 && cy >= 0) {
+                cover = 0;
+                for (int sy = 0; sy < 4; sy++) {
+                    for (int sx = 0; sx < 4; sx++) {
+                        float dx = (float)x + ((float)sx + 0.5f) * 0.25f - (float)cx;
+                        float dy = (float)y + ((float)sy + 0.5f) * 0.25f - (float)cy;
+                        if (dx * dx + dy * dy <= rr) cover++;
+                    }
+                }
+            }
+            uint32_t a = (uint32_t)(cover * 255 / 16);
+            sp->px[(size_t)y * (size_t)w + (size_t)x] = (a << 24) | rgb;
+        }
+    }
+
+    memset(&sp->dsc, 0, sizeof(sp->dsc));
+    sp->dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    sp->dsc.header.cf = LV_COLOR_FORMAT_ARGB8888;
+    sp->dsc.header.w = (uint32_t)w;
+    sp->dsc.header.h = (uint32_t)h;
+    sp->dsc.header.stride = (uint32_t)w * 4u;
+    sp->dsc.data_size = (uint32_t)w * (uint32_t)h * 4u;
+    sp->dsc.data = (const uint8_t *)sp->px;
+}
+
+static const lv_image_dsc_t *seg_sprite_get(asset_t *asset, int w, int h)
+{
+    if (w <= 0 || h <= 0) return NULL;
+    if (!asset->seg_sprites) {
+        asset->seg_sprites = calloc(SEG_SPRITE_MAX, sizeof(*asset->seg_sprites));
+        if (!asset->seg_sprites) return NULL;
+    }
+    seg_sprite_t *free_slot = NULL;
+    for (int i = 0; i < SEG_SPRITE_MAX; i++) {
+        seg_sprite_t *sp = &asset->seg_sprites[i];
+        if (!sp->px) {
+            if (!free_slot) free_slot = sp;
+            continue;
+        }
+        if (sp->w == w && sp->h == h && sp->color == asset->cfg.color) return &sp->dsc;
+    }
+    if (!free_slot) {
+        // geometry or colour moved on without a restyle; start over
+        if (seg_sprites_retire(asset) != 0) return NULL;
+        return seg_sprite_get(asset, w, h);
+    }
+    free_slot->px = malloc(sizeof(*free_slot->px) * (size_t)w * (size_t)h);
+    if (!free_slot->px) return NULL;
+    free_slot->w = w;
+    free_slot->h = h;
+    free_slot->color = asset->cfg.color;
+    seg_sprite_raster(free_slot);
+    return &free_slot->dsc;
+}
+
+// Fill of a continuous bar at pct inside its indicator track: columns
+// [*x1, *x2], growing from the left or, for RTL (orientation "left"), the right.
+static int bar_fill_extent(const lv_area_t *track, int rtl, int pct, int *x1, int *x2)
+{
+    int w = lv_area_get_width(track) * clamp_int(pct, 0, 100) / 100;
+    if (rtl) {
+        *x2 = track->x2;
+        *x1 = track->x2 - w + 1;
+    } else {
+        *x1 = track->x1;
+        *x2 = track->x1 + w - 1;
+    }
+    return w;
+}
+
+// The indicator track lv_bar would use: the object minus its main padding
+static void bar_track_area(lv_obj_t *bar, lv_area_t *track)
+{
+    lv_obj_get_coords(bar, track);
+    track->x1 += lv_obj_get_style_pad_left(bar, LV_PART_MAIN);
+    track->x2 -= lv_obj_get_style_pad_right(bar, LV_PART_MAIN);
+    track->y1 += lv_obj_get_style_pad_top(bar, LV_PART_MAIN);
+    track->y2 -= lv_obj_get_style_pad_bottom(bar, LV_PART_MAIN);
+}
+
+// -------------------------
+// Static layers
+// -------------------------
+/*
+ * With static_layers the parts of a bar or graph container that only change
+ * on a restyle or relayout are rendered once into a container-sized ARGB8888
+ * buffer through an offscreen canvas: the rounded background, a bar's outline
+ * and a label that is not bound to a text channel. While the layer still
+ * matches the live objects, the container's background fill task becomes one
+ * blit of that buffer and the outline and label tasks are dropped, so a value
+ * change re-renders copied pixels plus the moving fill instead of rounded
+ * corners, the border ring and glyphs. Any mismatch falls back to normal
+ * drawing for that pass and rebuilds the layer before the next one.
+ */
+static lv_obj_t *g_static_layer_canvas = NULL;
+
+static int static_layer_wants_border(const asset_t *asset)
+{
+    return asset->cfg.type == ASSET_BAR && asset->obj && lv_obj_get_style_border_width(asset->obj, LV_PART_MAIN) > 0;
+}
+
+static int static_layer_wants_label(const asset_t *asset)
+{
+    if (!asset->label_obj || lv_obj_get_parent(asset->label_obj) != asset->container_obj) return 0;
+    if (lv_obj_has_flag(asset->label_obj, LV_OBJ_FLAG_HIDDEN)) return 0;
+    if (asset->cfg.text_index >= 0 && asset->cfg.text_index < TOTAL_TEXT_COUNT) return 0;
+    return strlen(lv_label_get_text(asset->label_obj)) < sizeof(((static_layer_t *)0)->label_text);
+}
+
+static void obj_rel_area(lv_obj_t *obj, const lv_area_t *origin, int content, lv_area_t *out)
+{
+    if (content) {
+        lv_obj_get_content_coords(obj, out);
+    } else {
+        lv_obj_get_coords(obj, out);
+    }
+    lv_area_move(out, -origin->x1, -origin->y1);
+}
+
+static void static_layer_free(asset_t *asset)
+{
+    static_layer_t *l = asset->static_layer;
+    if (!l) return;
+    if (l->px) {
+        lv_image_cache_drop(&l->dsc);
+        free(l->px);
+    }
+    free(l);
+    asset->static_layer = NULL;
+}
+
+// True while the built layer still matches the live objects
+static int static_layer_current(asset_t *asset)
+{
+    const static_layer_t *l = asset->static_layer;
+    if (!l || l->stale || !l->px || !asset->container_obj) return 0;
+    lv_area_t cc;
+    lv_area_t a;
+    lv_obj_get_coords(asset->container_obj, &cc);
+    if (lv_area_get_width(&cc) != l->w || lv_area_get_height(&cc) != l->h) return 0;
+    if (l->has_border != static_layer_wants_border(asset)) return 0;
+    if (l->has_border) {
+        obj_rel_area(asset->obj, &cc, 0, &a);
+        if (memcmp(&a, &l->bar_area, sizeof(a)) != 0) return 0;
+    }
+    if (l->has_label != static_layer_wants_label(asset)) return 0;
+    if (l->has_label) {
+        obj_rel_area(asset->label_obj, &cc, 1, &a);
+        if (memcmp(&a, &l->label_area, sizeof(a)) != 0) return 0;
+        if (strcmp(lv_label_get_text(asset->label_obj), l->label_text) != 0) return 0;
+    }
+    return 1;
+}
+
+static void static_layer_build(asset_t *asset)
+{
+    static_layer_t *l = asset->static_layer;
+    lv_obj_t *cont = asset->container_obj;
+    l->stale = 0;
+    lv_area_t cc;
+    lv_obj_get_coords(cont, &cc);
+    int w = lv_area_get_width(&cc);
+    int h = lv_area_get_height(&cc);
+    if (l->px && (l->w != w || l->h != h)) {
+        lv_image_cache_drop(&l->dsc);
+        free(l->px);
+        l->px = NULL;
+    }
+    // Without a background there is no fill task to hang the blit on
+    if (w <= 0 || h <= 0 || lv_obj_get_style_bg_opa(cont, LV_PART_MAIN) < LV_OPA_MIN) return;
+    if (!l->px) {
+        l->px = malloc(sizeof(*l->px) * (size_t)w * (size_t)h);
+        if (!l->px) return;
+    } else {
+        lv_image_cache_drop(&l->dsc);
+    }
+    memset(l->px, 0, sizeof(*l->px) * (size_t)w * (size_t)h);
+    l->w = w;
+    l->h = h;
+
+    if (!g_static_layer_canvas) {
+        g_static_layer_canvas = lv_canvas_create(lv_scr_act());
+        lv_obj_add_flag(g_static_layer_canvas, LV_OBJ_FLAG_HIDDEN);
+    }
+    lv_canvas_set_buffer(g_static_layer_canvas, l->px, w, h, LV_COLOR_FORMAT_ARGB8888);
+    lv_layer_t layer;
+    lv_canvas_init_layer(g_static_layer_canvas, &layer);
+
+    lv_area_t full = {0, 0, w - 1, h - 1};
+    lv_draw_rect_dsc_t rect;
+    lv_draw_rect_dsc_init(&rect);
+    lv_obj_init_draw_rect_dsc(cont, LV_PART_MAIN, &rect);
+    lv_draw_rect(&layer, &rect, &full);
+
+    l->has_border = static_layer_wants_border(asset);
+    if (l->has_border) {
+        lv_draw_rect_dsc_init(&rect);
+        lv_obj_init_draw_rect_dsc(asset->obj, LV_PART_MAIN, &rect);
+        obj_rel_area(asset->obj, &cc, 0, &l->bar_area);
+        lv_draw_rect(&layer, &rect, &l->bar_area);
+    }
+
+    l->has_label = static_layer_wants_label(asset);
+    if (l->has_label) {
+        lv_draw_label_dsc_t label;
+        lv_draw_label_dsc_init(&label);
+        lv_obj_init_draw_label_dsc(asset->label_obj, LV_PART_MAIN, &label);
+        snprintf(l->label_text, sizeof(l->label_text), "%s", lv_label_get_text(asset->label_obj));
+        label.text = l->label_text;
+        // same flag lv_label passes for a content-sized label
+        if (lv_obj_get_style_width(asset->label_obj, LV_PART_MAIN) == LV_SIZE_CONTENT) label.flag |= LV_TEXT_FLAG_EXPAND;
+        obj_rel_area(asset->label_obj, &cc, 1, &l->label_area);
+        lv_draw_label(&layer, &label, &l->label_area);
+    }
+    lv_canvas_finish_layer(g_static_layer_canvas, &layer);
+
+    memset(&l->dsc, 0, sizeof(l->dsc));
+    l->dsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    l->dsc.header.cf = LV_COLOR_FORMAT_ARGB8888;
+    l->dsc.header.w = (uint32_t)w;
+    l->dsc.header.h = (uint32_t)h;
+    l->dsc.header.stride = (uint32_t)w * 4u;
+    l->dsc.data_size = (uint32_t)w * (uint32_t)h * 4u;
+    l->dsc.data = (const uint8_t *)l->px;
+}
+
+// Runs outside the refresh, so no draw unit can still be reading a rebuilt buffer
+static void static_layers_refresh(void)
+{
+    if (!g_cfg.static_layers) return;
+    int laid_out = 0;
+    for (int i = 0; i < asset_count; i++) {
+        asset_t *a = &assets[i];
+        if (!a->cfg.enabled || !a->container_obj) continue;
+        if (!a->static_layer) {
+            a->static_layer = calloc(1, sizeof(*a->static_layer));
+            if (!a->static_layer) continue;
+            a->static_layer->stale = 1;
+        }
+        if (!a->static_layer->stale) continue;
+        if (!laid_out) {
+            lv_obj_update_layout(lv_scr_act());
+            laid_out = 1;
+        }
+        static_layer_build(a);
+    }
+}
+
+// Container background fill: swapped for the layer blit while it is current
+static void static_layer_draw_event_cb(lv_event_t *e)
+{
+    asset_t *asset = (asset_t *)lv_event_get_user_data(e);
+    lv_draw_task_t *task = (lv_draw_task_t *)lv_event_get_param(e);
+    if (!asset || !task || !asset->static_layer) return;
+    lv_draw_dsc_base_t *base = (lv_draw_dsc_base_t *)task->draw_dsc;
+    if (!base || base->part != LV_PART_MAIN) return;
+    lv_draw_fill_dsc_t *fill_dsc = lv_draw_task_get_fill_dsc(task);
+    if (!fill_dsc) return;
+
+    static_layer_t *l = asset->static_layer;
+    l->active = g_cfg.static_layers && static_layer_current(asset);
+    if (!l->active) {
+        if (l->px) l->stale = 1;
+        return;
+    }
+    fill_dsc->opa = LV_OPA_TRANSP;
+    lv_area_t cc;
+    lv_obj_get_coords(asset->container_obj, &cc);
+    lv_draw_image_dsc_t img_dsc;
+    lv_draw_image_dsc_init(&img_dsc);
+    img_dsc.src = &l->dsc;
+    lv_draw_image(base->layer, &img_dsc, &cc);
+}
+
+// The baked label is already in the blitted background
+static void static_label_draw_event_cb(lv_event_t *e)
+{
+    asset_t *asset = (asset_t *)lv_event_get_user_data(e);
+    lv_draw_task_t *task = (lv_draw_task_t *)lv_event_get_param(e);
+    if (!asset || !task || !asset->static_layer) return;
+    if (!asset->static_layer->active || !asset->static_layer->has_label) return;
+    lv_draw_label_dsc_t *label_dsc = lv_draw_task_get_label_dsc(task);
+    if (label_dsc) label_dsc->opa = LV_OPA_TRANSP;
+}
+
+static void static_layer_attach(asset_t *asset)
+{
+    if (!g_cfg.static_layers || !asset->container_obj) return;
+    lv_obj_add_flag(asset->container_obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+    lv_obj_add_event_cb(asset->container_obj, static_layer_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, asset);
+}
+
+/*
+ * LVGL v9 draw task hook for the bar indicator. Bars keep the LVGL value at
+ * 100 so the indicator task always spans the track and the level comes from
+ * last_pct: continuous bars trim the fill task to the current extent, and
+ * segmented bars (asset->cfg.segments > 1) replace it with blits of the
+ * cached lit sprite. lv_bar_set_value would invalidate the whole object on
+ * every change; this way the update paths choose the area themselves.
+ */
+static void bar_draw_event_cb(lv_event_t *e)
+{
+    asset_t *asset = (asset_t *)lv_event_get_user_data(e);
+    if (!asset) return;
+
+    lv_draw_task_t *task = (lv_draw_task_t *)lv_event_get_param(e);
+    if (!task) return;
+
+    lv_draw_dsc_base_t *base = (lv_draw_dsc_base_t *)task->draw_dsc;
+    if (!base) return;
+    lv_draw_border_dsc_t *border_dsc = lv_draw_task_get_border_dsc(task);
+    if (base->part == LV_PART_MAIN) {
+        // the outline is part of the static layer while that is blitted
+        const static_layer_t *l = asset->static_layer;
+        if (border_dsc && l && l->active && l->has_border) border_dsc->opa = LV_OPA_TRANSP;
+        return;
+    }
+    if (base->part != LV_PART_INDICATOR) return;
+
+    lv_draw_fill_dsc_t *fill_dsc = lv_draw_task_get_fill_dsc(task);
+    if (asset->cfg.segments <= 1) {
+        int rtl = lv_obj_get_style_base_dir(base->obj, LV_PART_INDICATOR) == LV_BASE_DIR_RTL;
+        lv_area_t track = task->area;
+        if (bar_fill_extent(&track, rtl, g_hot.last_pct[asset_slot(asset)], &task->area.x1, &task->area.x2) <= 0) {
+            if (fill_dsc) fill_dsc->opa = LV_OPA_TRANSP;
+            if (border_dsc) border_dsc->opa = LV_OPA_TRANSP;
+        }
+        return;
+    }
+
+    if (fill_dsc) fill_dsc->opa = LV_OPA_TRANSP;
+    if (border_dsc) border_dsc->opa = LV_OPA_TRANSP;
+
+    lv_area_t track_area;
+    lv_obj_get_content_coords(base->obj, &track_area);
+    int total_h = lv_area_get_height(&task->area);
+    seg_geom_t geom;
+    if (total_h <= 0 || seg_geom_init(&geom, asset->cfg.segments, lv_area_get_width(&track_area)) != 0) return;
+
+    int filled = seg_filled_count(&geom, g_hot.last_pct[asset_slot(asset)]);
+    int rtl = lv_obj_get_style_base_dir(base->obj, LV_PART_INDICATOR) == LV_BASE_DIR_RTL;
+
+    lv_draw_image_dsc_t img_dsc;
+    lv_draw_image_dsc_init(&img_dsc);
+    for (int i = 0; i < filled; i++) {
+        int offset = 0;
+        int draw_w = 0;
+        seg_span(&geom, i, &offset, &draw_w);
+        const lv_image_dsc_t *sprite = seg_sprite_get(asset, draw_w, total_h);
+        if (!sprite) continue;
+        lv_area_t seg_area = task->area;
+        seg_columns(&geom, &track_area, rtl, i, i + 1, &seg_area.x1, &seg_area.x2);
+        img_dsc.src = sprite;
+        lv_draw_image(base->layer, &img_dsc, &seg_area);
+    }
+}
+
+// Pushes a new fill level into a segmented bar, invalidating only the
+// segments whose lit state flipped
+static void bar_segments_update(asset_t *asset, int old_pct, int pct)
+{
+    lv_obj_t *bar = asset->obj;
+    if (old_pct < 0) {
+        lv_bar_set_value(bar, 100, LV_ANIM_OFF);
+        lv_obj_invalidate(bar);
+        return;
+    }
+    lv_area_t track;
+    lv_obj_get_content_coords(bar, &track);
+    seg_geom_t geom;
+    if (seg_geom_init(&geom, asset->cfg.segments, lv_area_get_width(&track)) != 0) return;
+    int was = seg_filled_count(&geom, old_pct);
+    int now = seg_filled_count(&geom, pct);
+    if (was == now) return;
+
+    int first = was < now ? was : now;
+    int last = was < now ? now : was;
+    int rtl = lv_obj_get_style_base_dir(bar, LV_PART_INDICATOR) == LV_BASE_DIR_RTL;
+    lv_area_t a = track;
+    seg_columns(&geom, &track, rtl, first, last, &a.x1, &a.x2);
+    lv_obj_invalidate_area(bar, &a);
+}
+
+// Pushes a new level into a continuous bar, invalidating only the strip
+// between the old and new fill edge plus the rounded end cap behind it
+static void bar_fill_update(asset_t *asset, int old_pct, int pct)
+{
+    lv_obj_t *bar = asset->obj;
+    if (old_pct < 0) {
+        lv_bar_set_value(bar, 100, LV_ANIM_OFF);
+        lv_obj_invalidate(bar);
+        return;
+    }
+    lv_area_t track;
+    bar_track_area(bar, &track);
+    int rtl = lv_obj_get_style_base_dir(bar, LV_PART_INDICATOR) == LV_BASE_DIR_RTL;
+    int ox1 = 0;
+    int ox2 = 0;
+    int nx1 = 0;
+    int nx2 = 0;
+    int old_w = bar_fill_extent(&track, rtl, old_pct, &ox1, &ox2);
+    int new_w = bar_fill_extent(&track, rtl, pct, &nx1, &nx2);
+    if (old_w == new_w) return;
+
+    int cap = lv_obj_get_style_radius(bar, LV_PART_INDICATOR);
+    int half_h = lv_area_get_height(&track) / 2;
+    if (cap > half_h) cap = half_h;
+    int inner = old_w < new_w ? old_w : new_w;
+    int outer = old_w < new_w ? new_w : old_w;
+    lv_area_t a;
+    lv_obj_get_coords(bar, &a);
+    if (rtl) {
+        a.x1 = track.x2 - outer + 1;
+        a.x2 = track.x2 - inner + cap;
+    } else {
+        a.x1 = track.x1 + inner - cap;
+        a.x2 = track.x1 + outer - 1;
+    }
+    if (a.x1 < track.x1) a.x1 = track.x1;
+    if (a.x2 > track.x2) a.x2 = track.x2;
+    lv_obj_invalidate_area(bar, &a);
+}
+
+// Inner size of a bar, graph or gauge; canvas buffers are allocated to match
+static void bar_asset_size(const asset_cfg_t *cfg, int *w, int *h)
+{
+    if (cfg->type == ASSET_GAUGE) {
+        *w = cfg->width > 0 ? cfg->width : 96;
+        *h = cfg->height > 0 ? cfg->height : 96;
+        return;
+    }
+    *w = cfg->width > 0 ? cfg->width : (cfg->rounded_outline ? 200 : 320);
+    *h = cfg->height > 0 ? cfg->height : (cfg->rounded_outline ? 20 : 32);
+}
+
+static void layout_bar_asset(asset_t *asset)
+{
+    if (!asset || !asset->container_obj || !asset->obj) return;
+    const asset_cfg_t *cfg = &asset->cfg;
+    int pad_x = 8;
+    int pad_y = 6;
+    int bar_width = 0;
+    int bar_height = 0;
+    bar_asset_size(cfg, &bar_width, &bar_height);
+    if (asset->image) {
+        bar_width = asset->image->w;  // images are shown at their native size
+        bar_height = asset->image->h;
+    }
+    int label_width = 0;
+    int label_height = 0;
+
+    if (asset->label_obj) {
+        // Avoid a full layout pass when we already have cached label dimensions, but
+        // fall back to calculating them if they haven't been resolved yet. This keeps
+        // orientation changes from degenerating into repeated layouts while still
+        // giving left/right placement accurate sizing data.
+        label_width = lv_obj_get_width(asset->label_obj);
+        label_height = lv_obj_get_height(asset->label_obj);
+        if (label_width == 0 || label_height == 0) {
+            lv_obj_update_layout(asset->label_obj);
+            label_width = lv_obj_get_width(asset->label_obj);
+            label_height = lv_obj_get_height(asset->label_obj);
+        }
+    }
+
+    int extra_height = cfg->rounded_outline ? 4 : 0;
+    int container_height = bar_height;
+    if (label_height > container_height) container_height = label_height;
+    container_height += pad_y * 2 + extra_height;
+    int gap = (label_width > 0) ? pad_x : 0;
+    int tail_pad = pad_x + (label_width > 0 ? 4 : 0);
+    int container_width = pad_x + bar_width + gap + label_width + tail_pad;
+
+    lv_obj_set_size(asset->container_obj, container_width, container_height);
+    int container_x = to_canvas_x(cfg->x);
+    if (cfg->orientation == ORIENTATION_LEFT) {
+        container_x -= container_width;
+    }
+    lv_obj_set_pos(asset->container_obj, container_x, to_canvas_y(cfg->y));
+    int grow_x = !asset->label_obj ? 0 : cfg->orientation == ORIENTATION_LEFT ? -1 : 1;
+    asset_set_box(asset, container_x, to_canvas_y(cfg->y), container_width, container_height, grow_x,
+                  asset->label_obj != NULL);
+    int base_radius_height = bar_height + pad_y * 2 + extra_height;
+    int container_radius = base_radius_height / 2;
+    if (container_radius < 6) container_radius = 6;
+    if (container_radius > container_height / 2) container_radius = container_height / 2;
+    lv_obj_set_style_radius(asset->container_obj, container_radius, 0);
+
+    lv_obj_set_size(asset->obj, bar_width, bar_height);
+    lv_obj_set_style_radius(asset->obj, bar_height / 2, LV_PART_MAIN);
+    lv_obj_set_style_radius(asset->obj, bar_height / 2, LV_PART_INDICATOR);
+    lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_LTR, LV_PART_MAIN);
+    lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_LTR, LV_PART_INDICATOR);
+
+    if (cfg->orientation == ORIENTATION_LEFT) {
+        lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_RTL, LV_PART_MAIN);
+        lv_obj_set_style_base_dir(asset->obj, LV_BASE_DIR_RTL, LV_PART_INDICATOR);
+        int bar_x = pad_x + label_width + gap;
+        if (asset->label_obj) {
+            lv_obj_align(asset->label_obj, LV_ALIGN_LEFT_MID, pad_x, 0);
+        }
+        lv_obj_align(asset->obj, LV_ALIGN_LEFT_MID, bar_x, 0);
+    } else {
+        int label_x = pad_x + bar_width + gap;
+        lv_obj_align(asset->obj, LV_ALIGN_LEFT_MID, pad_x, 0);
+        if (asset->label_obj) {
+            lv_obj_align(asset->label_obj, LV_ALIGN_LEFT_MID, label_x, 0);
+        }
+    }
+}
+
+static void layout_text_asset(asset_t *asset)
+{
+    if (!asset || !asset->obj) return;
+    const asset_cfg_t *cfg = &asset->cfg;
+    int width = cfg->width > 0 ? cfg->width : LV_SIZE_CONTENT;
+    int height = cfg->height > 0 ? cfg->height : LV_SIZE_CONTENT;
+    lv_obj_set_size(asset->obj, width, height);
+    int grow_x = width != LV_SIZE_CONTENT ? 0 : 1;
+    int grow_y = height == LV_SIZE_CONTENT;
+
+    // Resolve content-driven size before anchoring so we can offset correctly
+    if (width == LV_SIZE_CONTENT || height == LV_SIZE_CONTENT) {
+        lv_obj_update_layout(asset->obj);
+        width = lv_obj_get_width(asset->obj);
+        height = lv_obj_get_height(asset->obj);
+    }
+
+    lv_text_align_t align = LV_TEXT_ALIGN_LEFT;
+    int pos_x = to_canvas_x(cfg->x);
+    int pos_y = to_canvas_y(cfg->y);
+    switch (cfg->orientation) {
+        case ORIENTATION_CENTER:
+            align = LV_TEXT_ALIGN_CENTER;
+            pos_x -= width / 2;
+            if (grow_x) grow_x = 2;
+            break;
+        case ORIENTATION_LEFT:
+            align = LV_TEXT_ALIGN_RIGHT;
+            pos_x -= width;
+            if (grow_x) grow_x = -1;
+            break;
+        case ORIENTATION_RIGHT:
+        default:
+            align = LV_TEXT_ALIGN_LEFT;
+            break;
+    }
+    lv_obj_set_style_text_align(asset->obj, align, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_pos(asset->obj, pos_x, pos_y);
+    asset_set_box(asset, pos_x, pos_y, width, height, grow_x, grow_y);
+}
+
+static void layout_asset(asset_t *asset)
+{
+    if (asset->cfg.type == ASSET_TEXT) {
+        layout_text_asset(asset);
+    } else {
+        layout_bar_asset(asset);
+    }
+}
+
+static int json_get_string_range(const char *start, const char *end, const char *key, char *buf, size_t buf_sz)
+{
+    const char *p = find_key_range(start, end, key);
+    if (!p) return -1;
+    p = strchr(p, ':');
+    if (!p || p >= end) return -1;
+    p++;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    if (p >= end || *p != '\"') return -1;
+    p++; // skip opening quote
+    const char *q = p;
+    while (q < end && *q && *q != '\"') q++;
+    size_t len = (size_t)(q - p);
+    if (q >= end || len + 1 > buf_sz) return -1;
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+    return 0;
+}
+
+// -------------------------
+// Config cache
+// -------------------------
+/*
+ * After a JSON load the parsed result (g_cfg, the asset configs, filters and
+ * compiled computed slots) is written next to the config as CONFIG_PATH.cache,
+ * together with the pool sizes asset_pool_init reads. The next boot checks the
+ * JSON's size and mtime and a stamp of this build's struct sizes and build
+ * time, and copies the cache back instead of parsing when all match. Any edit
+ * of the config, or a new binary, falls back to the JSON and rewrites the
+ * cache. The file is replaced through a rename, so a crash mid-write leaves the
+ * old cache or none. `config_cache: false` removes it and stops writing.
+ */
+#define CONFIG_CACHE_MAGIC 0x43434F57u  // "WOCC"
+#define CONFIG_CACHE_VERSION 1
+
+// Startup-only sizing read by asset_pool_init, kept for the cache
+typedef struct {
+    int32_t max_assets;
+    int32_t udp_channels;
+    int32_t text_slot_len;
+    int32_t text_slot_lens_count;
+    int32_t text_slot_lens[UDP_CHANNEL_MAX];
+} pool_params_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t build;         // config_cache_build() of the writer
+    uint32_t src_size;
+    int64_t src_mtime_ns;
+    pool_params_t pool;
+    int32_t asset_count;
+    int32_t filter_count;
+    int32_t computed_count;
+    uint32_t reserved;
+    uint64_t filter_inputs;
+} config_cache_header_t;
+
+static pool_params_t g_pool_params;
+static int g_config_cache_hit = 0;  // the last load_config came from the cache
+
+static const char *config_cache_path(void)
+{
+    static char path[256];
+    snprintf(path, sizeof(path), "%s.cache", CONFIG_PATH);
+    return path;
+}
+
+static uint32_t config_cache_build(void)
+{
+    static const char stamp[] = __DATE__ " " __TIME__;
+    uint32_t sizes[] = {sizeof(app_config_t), sizeof(asset_cfg_t), sizeof(channel_filter_t),
+                        sizeof(computed_slot_t), sizeof(config_cache_header_t)};
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(sizes); i++) h = (h ^ ((const uint8_t *)sizes)[i]) * 16777619u;
+    for (size_t i = 0; stamp[i]; i++) h = (h ^ (uint8_t)stamp[i]) * 16777619u;
+    return h;
+}
+
+static int config_source_stat(uint32_t *size, int64_t *mtime_ns)
+{
+    struct stat st;
+    if (stat(CONFIG_PATH, &st) != 0) return -1;
+    *size = (uint32_t)st.st_size;
+    *mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+static size_t config_cache_body_size(const config_cache_header_t *h)
+{
+    return sizeof(app_config_t) + (size_t)h->asset_count * sizeof(asset_cfg_t) +
+           (size_t)h->filter_count * sizeof(channel_filter_t) + (size_t)h->computed_count * sizeof(computed_slot_t);
+}
+
+// Reads the cache when it still matches the config file; the caller frees *out
+static int config_cache_read(char **out, config_cache_header_t *hdr)
+{
+    uint32_t size = 0;
+    int64_t mtime = 0;
+    if (config_source_stat(&size, &mtime) != 0) return -1;
+    char *buf = NULL;
+    size_t len = 0;
+    if (read_file(config_cache_path(), &buf, &len) != 0) return -1;
+    if (len < sizeof(*hdr)) {
+        free(buf);
+        return -1;
+    }
+    memcpy(hdr, buf, sizeof(*hdr));
+    int valid = hdr->magic == CONFIG_CACHE_MAGIC && hdr->version == CONFIG_CACHE_VERSION &&
+                hdr->build == config_cache_build() && hdr->src_size == size && hdr->src_mtime_ns == mtime &&
+                hdr->asset_count >= 1 && hdr->asset_count <= ASSET_POOL_MAX &&
+                hdr->filter_count >= 0 && hdr->computed_count >= 0 &&
+                hdr->filter_count + hdr->computed_count <= DERIVED_SLOT_MAX &&
+                hdr->pool.text_slot_lens_count >= 0 && hdr->pool.text_slot_lens_count <= UDP_CHANNEL_MAX &&
+                len == sizeof(*hdr) + config_cache_body_size(hdr);
+    if (!valid) {
+        free(buf);
+        return -1;
+    }
+    *out = buf;
+    return 0;
+}
+
+// Pool parameters for asset_pool_init; returns 0 when the cache is usable
+static int config_cache_pool(pool_params_t *pool)
+{
+    char *buf = NULL;
+    config_cache_header_t hdr;
+    if (config_cache_read(&buf, &hdr) != 0) return -1;
+    free(buf);
+    *pool = hdr.pool;
+    return 0;
+}
+
+static int config_cache_load(asset_t *out, int *out_count)
+{
+    char *buf = NULL;
+    config_cache_header_t hdr;
+    if (config_cache_read(&buf, &hdr) != 0) return -1;
+    if (hdr.pool.max_assets != g_asset_capacity || hdr.pool.udp_channels != g_udp_channels ||
+        hdr.asset_count > g_asset_capacity) {
+        free(buf);
+        return -1;
+    }
+    const char *p = buf + sizeof(hdr);
+    memcpy(&g_cfg, p, sizeof(g_cfg));
+    p += sizeof(g_cfg);
+    for (int i = 0; i < hdr.asset_count; i++) {
+        init_asset_defaults(&out[i], i);
+        memcpy(&out[i].cfg, p, sizeof(out[i].cfg));
+        p += sizeof(out[i].cfg);
+    }
+    *out_count = hdr.asset_count;
+    memset(g_filters, 0, sizeof(g_filters));
+    memcpy(g_filters, p, (size_t)hdr.filter_count * sizeof(*g_filters));
+    p += (size_t)hdr.filter_count * sizeof(*g_filters);
+    g_filter_count = hdr.filter_count;
+    g_filter_inputs = hdr.filter_inputs;
+    memcpy(g_computed, p, (size_t)hdr.computed_count * sizeof(*g_computed));
+    g_computed_count = hdr.computed_count;
+    free(buf);
+    return 0;
+}
+
+static void config_cache_store(const asset_t *assets_in, int count)
+{
+    const char *path = config_cache_path();
+    if (!g_cfg.config_cache) {
+        unlink(path);
+        return;
+    }
+    config_cache_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = CONFIG_CACHE_MAGIC;
+    hdr.version = CONFIG_CACHE_VERSION;
+    hdr.build = config_cache_build();
+    if (config_source_stat(&hdr.src_size, &hdr.src_mtime_ns) != 0) return;
+    hdr.pool = g_pool_params;
+    hdr.asset_count = count;
+    hdr.filter_count = g_filter_count;
+    hdr.computed_count = g_computed_count;
+    hdr.filter_inputs = g_filter_inputs;
+
+    char tmp[272];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;  // read-only config directory: boot keeps parsing the JSON
+    int ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(&g_cfg, sizeof(g_cfg), 1, f) == 1;
+    for (int i = 0; ok && i < count; i++) ok = fwrite(&assets_in[i].cfg, sizeof(assets_in[i].cfg), 1, f) == 1;
+    if (ok && g_filter_count) ok = fwrite(g_filters, sizeof(*g_filters), (size_t)g_filter_count, f) == (size_t)g_filter_count;
+    if (ok && g_computed_count) {
+        ok = fwrite(g_computed, sizeof(*g_computed), (size_t)g_computed_count, f) == (size_t)g_computed_count;
+    }
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) unlink(tmp);
+}
+
+/*
+ * Asset and channel pool: max_assets (1-64) and udp_channels (8-48) are read
+ * once before the first load_config and size every per-asset and per-slot
+ * array. SIGHUP reloads keep the startup capacity.
+ */
+static int asset_pool_init(void)
+{
+    int capacity = DEFAULT_MAX_ASSETS;
+    int channels = UDP_VALUE_COUNT;
+    int text_len = TEXT_SLOT_MAX_CHARS;
+    int text_lens[UDP_CHANNEL_MAX];
+    int text_lens_count = 0;
+    char *json = NULL;
+    pool_params_t cached;
+    if (config_cache_pool(&cached) == 0) {
+        capacity = cached.max_assets;
+        channels = cached.udp_channels;
+        text_len = cached.text_slot_len;
+        text_lens_count = cached.text_slot_lens_count;
+        for (int i = 0; i < text_lens_count; i++) text_lens[i] = cached.text_slot_lens[i];
+    } else if (read_file(CONFIG_PATH, &json, NULL) == 0) {
+        int v = 0;
+        if (json_get_int(json, "max_assets", &v) == 0) capacity = clamp_int(v, 1, ASSET_POOL_MAX);
+        if (json_get_int(json, "udp_channels", &v) == 0) channels = clamp_int(v, UDP_VALUE_COUNT, UDP_CHANNEL_MAX);
+        if (json_get_int(json, "text_slot_len", &v) == 0) text_len = clamp_int(v, 0, TEXT_SLOT_CAP_MAX);
+        json_get_int_array_range(json, json + strlen(json), "text_slot_lens", text_lens, UDP_CHANNEL_MAX,
+                                 &text_lens_count, -1);
+        free(json);
+    }
+    g_pool_params.max_assets = capacity;
+    g_pool_params.udp_channels = channels;
+    g_pool_params.text_slot_len = text_len;
+    g_pool_params.text_slot_lens_count = text_lens_count;
+    for (int i = 0; i < text_lens_count; i++) g_pool_params.text_slot_lens[i] = text_lens[i];
+    g_asset_capacity = capacity;
+    g_udp_channels = channels;
+
+    assets = calloc((size_t)capacity, sizeof(*assets));
+    g_hot.flags = calloc((size_t)capacity, sizeof(*g_hot.flags));
+    g_hot.value_index = calloc((size_t)capacity, sizeof(*g_hot.value_index));
+    g_hot.last_pct = calloc((size_t)capacity, sizeof(*g_hot.last_pct));
+    g_hot.target_pct = calloc((size_t)capacity, sizeof(*g_hot.target_pct));
+    g_hot.pos_q8 = calloc((size_t)capacity, sizeof(*g_hot.pos_q8));
+    g_hot.smooth_ms = calloc((size_t)capacity, sizeof(*g_hot.smooth_ms));
+    g_hot.min_gap_ms = calloc((size_t)capacity, sizeof(*g_hot.min_gap_ms));
+    g_hot.refreshed_ms = calloc((size_t)capacity, sizeof(*g_hot.refreshed_ms));
+    g_hot.min = calloc((size_t)capacity, sizeof(*g_hot.min));
+    g_hot.range = calloc((size_t)capacity, sizeof(*g_hot.range));
+    g_label_cache = calloc((size_t)capacity, sizeof(*g_label_cache));
+    udp_values = calloc((size_t)channels, sizeof(*udp_values));
+    udp_texts = calloc((size_t)channels, sizeof(*udp_texts));
+    size_t arena = 0;
+    g_text_cap_max = 0;
+    for (int i = 0; udp_texts && i < channels; i++) {
+        int cap = i < text_lens_count && text_lens[i] >= 0 ? clamp_int(text_lens[i], 0, TEXT_SLOT_CAP_MAX) : text_len;
+        udp_texts[i].cap = (uint16_t)cap;
+        arena += (size_t)cap + 1;
+        if ((size_t)cap > g_text_cap_max) g_text_cap_max = (size_t)cap;
+    }
+    g_text_arena = calloc(arena ? arena : 1, 1);
+    g_text_scratch = malloc(g_text_cap_max + 1);
+    for (size_t i = 0, off = 0; g_text_arena && udp_texts && i < (size_t)channels; i++) {
+        udp_texts[i].text = g_text_arena + off;
+        off += (size_t)udp_texts[i].cap + 1;
+    }
+    g_value_users = calloc((size_t)VALUE_SLOT_COUNT, sizeof(*g_value_users));
+    g_text_users = calloc((size_t)TOTAL_TEXT_COUNT, sizeof(*g_text_users));
+    if (!assets || !g_hot.flags || !g_hot.value_index || !g_hot.last_pct || !g_hot.target_pct || !g_hot.pos_q8 ||
+        !g_hot.smooth_ms || !g_hot.min_gap_ms || !g_hot.refreshed_ms || !g_hot.min || !g_hot.range || !g_label_cache ||
+        !udp_values || !udp_texts || !g_text_arena || !g_text_scratch || !g_value_users || !g_text_users) {
+        return -1;
+    }
+    for (int i = 0; i < capacity; i++) g_hot.last_pct[i] = -1;
+    return 0;
+}
+
+static void asset_pool_free(void)
+{
+    free(assets);
+    free(g_hot.flags);
+    free(g_hot.value_index);
+    free(g_hot.last_pct);
+    free(g_hot.target_pct);
+    free(g_hot.pos_q8);
+    free(g_hot.smooth_ms);
+    free(g_hot.min_gap_ms);
+    free(g_hot.refreshed_ms);
+    free(g_hot.min);
+    free(g_hot.range);
+    free(g_label_cache);
+    free(udp_values);
+    free(udp_texts);
+    free(g_text_arena);
+    free(g_text_scratch);
+    free(g_value_users);
+    free(g_text_users);
+    assets = NULL;
+    memset(&g_hot, 0, sizeof(g_hot));
+    g_label_cache = NULL;
+    udp_values = NULL;
+    udp_texts = NULL;
+    g_text_arena = NULL;
+    g_text_scratch = NULL;
+    g_value_users = NULL;
+    g_text_users = NULL;
+}
+
+static void set_defaults(void)
+{
+    g_cfg.width = DEFAULT_SCREEN_WIDTH;
+    g_cfg.height = DEFAULT_SCREEN_HEIGHT;
+    g_cfg.osd_x = 0;
+    g_cfg.osd_y = 0;
+    g_cfg.osd_port[0] = 0;
+    g_cfg.osd_port_count = 1;
+    g_cfg.osd_port_xy_count = 0;
+    g_cfg.show_stats = 1;
     g_cfg.idle_ms = 100;
     g_cfg.system_refresh_ms = 1000;
+    memset(g_cfg.system_period_ms, 0, sizeof(g_cfg.system_period_ms));
     g_cfg.udp_stats = 1;
+    g_cfg.render_rows = DEFAULT_RENDER_ROWS;
+    g_cfg.render_buffers = 1;
+    g_cfg.render_pass_cost_px = DEFAULT_RENDER_PASS_COST_PX;
+    g_cfg.render_mode = RENDER_MODE_PARTIAL;
+    g_cfg.pixel_format = PIXEL_FORMAT_ARGB4444;
+    g_cfg.region_mode = REGION_MODE_SINGLE;
+    g_cfg.region_max = OSD_REGION_MAX;
+    g_cfg.gfx_accel = 0;
+    g_cfg.shm_transport = 0;
+    g_cfg.frame_sync = 0;
+    g_cfg.frame_rate = 0;
+    g_cfg.deep_idle = 0;
+    g_cfg.latency_stats = 0;
+    g_cfg.profile_stats = 0;
+    g_cfg.rx_thread = 0;
+    g_cfg.udp_rcvbuf = 0;
+    g_cfg.udp_reuseport = 0;
+    g_cfg.udp_multicast[0] = '\0';
+    g_cfg.udp_multicast_iface[0] = '\0';
+    for (int i = 0; i < UDP_CHANNEL_MAX; i++) {
+        g_cfg.value_owner[i] = -1;
+        g_cfg.text_owner[i] = -1;
+    }
+    g_cfg.render_cpus = 0;
+    g_cfg.cpu_affinity = 0;
+    g_cfg.sched_policy = SCHED_OTHER;
+    g_cfg.sched_priority = 10;
+    g_cfg.mlock = 0;
+    g_cfg.governor = 0;
+    g_cfg.governor_cpu_high = 85;
+    g_cfg.governor_cpu_low = 70;
+    g_cfg.governor_fps_min = 0;
+    g_cfg.governor_push_ms = 100;
+    g_cfg.governor_stats_ms = 1000;
+    g_cfg.governor_hold_ms = 5000;
+    g_cfg.static_layers = 0;
+    g_cfg.flush_compare = 0;
+    g_cfg.metrics_port = 0;
+    g_cfg.lvgl_heap_kb = 0;
+    g_cfg.lvgl_heap_auto = 0;
+    g_cfg.heap_alarm_pct = 90;
+    g_cfg.config_cache = 1;
+    system_slots_default(g_cfg.system_slots);
+    g_cfg.snapshot_ms = 1000;
+    snprintf(g_cfg.snapshot_path, sizeof(g_cfg.snapshot_path), "/tmp/waybeam_osd.state");
+    g_cfg.hitch_ms = 0;
+    g_cfg.hitch_file[0] = '\0';
+}
+
+// Live channel contents are not configuration: cleared once at startup and
+// kept across SIGHUP reloads
+static void reset_channels(void)
+{
+    memset(udp_values, 0, sizeof(*udp_values) * (size_t)g_udp_channels);
+    for (int i = 0; i < g_udp_channels; i++) {
+        udp_texts[i].text[0] = '\0';
+        udp_texts[i].len = 0;
+        udp_texts[i].hash = 2166136261u;
+    }
+    g_value_dirty = ~0ull;
+    g_text_dirty = ~0ull;
+    init_system_channels();
+    g_sample_seen = 0;
+    last_channel_push_ms = 0;
+    pending_channel_flush = false;
+}
+
+static filter_type_t parse_filter_type_string(const char *s, filter_type_t fallback)
+{
+    if (!s) return fallback;
+    if (strcasecmp(s, "ema") == 0) return FILTER_EMA;
+    if (strcasecmp(s, "median") == 0) return FILTER_MEDIAN;
+    if (strcasecmp(s, "rate") == 0) return FILTER_RATE;
+    return fallback;
+}
+
+static void parse_filters_array(const char *json)
+{
+    memset(g_filters, 0, sizeof(g_filters));
+    g_filter_count = 0;
+    g_filter_inputs = 0;
+    const char *p = strstr(json, "\"filters\"");
+    if (!p) return;
+    const char *arr = strchr(p, '[');
+    if (!arr) return;
+    p = arr + 1;
+
+    while (*p && g_filter_count < DERIVED_SLOT_MAX) {
+        while (*p && *p != '{' && *p != ']') p++;
+        if (*p != '{') break;
+        const char *obj_start = p;
+        while (*p && *p != '}') p++;
+        const char *obj_end = p;
+
+        channel_filter_t f;
+        memset(&f, 0, sizeof(f));
+        f.type = FILTER_EMA;
+        f.input = -1;
+        f.alpha = 0.25f;
+        f.window = 5;
+        f.scale = 1.0f;
+        int v = 0;
+        float fv = 0.0f;
+        char type_buf[16];
+        if (json_get_string_range(obj_start, obj_end, "type", type_buf, sizeof(type_buf)) == 0) {
+            f.type = parse_filter_type_string(type_buf, FILTER_EMA);
+        }
+        if (json_get_int_range(obj_start, obj_end, "input", &v) == 0) f.input = v;
+        if (json_get_float_range(obj_start, obj_end, "alpha", &fv) == 0) f.alpha = clamp_float(fv, 0.001f, 1.0f);
+        if (json_get_int_range(obj_start, obj_end, "window", &v) == 0) f.window = clamp_int(v, 1, FILTER_MEDIAN_MAX);
+        if (json_get_float_range(obj_start, obj_end, "scale", &fv) == 0) f.scale = fv;
+        if (*p) p++;
+
+        // real slots, or a filter listed before this one
+        int k = g_filter_count;
+        int valid = f.input >= 0 && (f.input < TOTAL_VALUE_COUNT ||
+                                     (f.input >= DERIVED_SLOT_BASE && f.input < DERIVED_SLOT_BASE + k));
+        if (!valid) {
+            fprintf(stderr, "filters[%d]: input %d is not a value slot or an earlier filter, skipped\n", k, f.input);
+            continue;
+        }
+        g_filters[k] = f;
+        g_filter_inputs |= 1ull << f.input;
+        g_filter_count++;
+    }
+}
+
+// Finds the [...] span of key's array inside [start, end); nested arrays are not expected
+static int json_find_array_range(const char *start, const char *end, const char *key,
+                                 const char **arr_start, const char **arr_end)
+{
+    const char *p = find_key_range(start, end, key);
+    if (!p) return -1;
+    p = memchr(p, '[', (size_t)(end - p));
+    if (!p) return -1;
+    const char *q = memchr(p, ']', (size_t)(end - p));
+    if (!q) return -1;
+    *arr_start = p;
+    *arr_end = q + 1;
+    return 0;
+}
+
+static void parse_asset_rules(const char *start, const char *end, asset_cfg_t *cfg)
+{
+    const char *p = start + 1;
+    cfg->rule_count = 0;
+    while (p < end && cfg->rule_count < ASSET_RULE_MAX) {
+        while (p < end && *p != '{') p++;
+        if (p >= end) break;
+        const char *obj_start = p;
+        while (p < end && *p != '}') p++;
+        const char *obj_end = p;
+
+        asset_rule_t r;
+        memset(&r, 0, sizeof(r));
+        r.above = -RULE_OPEN_BOUND;
+        r.below = RULE_OPEN_BOUND;
+        int v = 0;
+        float fv = 0.0f;
+        if (json_get_float_range(obj_start, obj_end, "above", &fv) == 0) r.above = fv;
+        if (json_get_float_range(obj_start, obj_end, "below", &fv) == 0) r.below = fv;
+        if (json_get_int_range(obj_start, obj_end, "bar_color", &v) == 0) {
+            r.bar_color = (uint32_t)v;
+            r.sets |= RULE_SET_BAR_COLOR;
+        }
+        if (json_get_int_range(obj_start, obj_end, "text_color", &v) == 0) {
+            r.text_color = (uint32_t)v;
+            r.sets |= RULE_SET_TEXT_COLOR;
+        }
+        if (json_get_int_range(obj_start, obj_end, "background", &v) == 0) {
+            r.background = clamp_int(v, -1, (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0])) - 1);
+            r.sets |= RULE_SET_BACKGROUND;
+        }
+        if (json_get_bool_range(obj_start, obj_end, "enabled", &v) == 0 && !v) r.sets |= RULE_SET_HIDE;
+        cfg->rules[cfg->rule_count++] = r;
+        if (p < end) p++;
+    }
+}
+
+// Runs after parse_filters_array: computed entries take the derived slots left over
+static void parse_computed_array(const char *json)
+{
+    g_computed_count = 0;
+    const char *p = strstr(json, "\"computed\"");
+    if (!p) return;
+    const char *arr = strchr(p, '[');
+    if (!arr) return;
+    p = arr + 1;
+
+    while (*p && g_filter_count + g_computed_count < DERIVED_SLOT_MAX) {
+        while (*p && *p != '{' && *p != ']') p++;
+        if (*p != '{') break;
+        const char *obj_start = p;
+        while (*p && *p != '}') p++;
+        const char *obj_end = p;
+        if (*p) p++;
+
+        int slot = DERIVED_SLOT_BASE + g_filter_count + g_computed_count;
+        char text[EXPR_TEXT_MAX];
+        if (json_get_string_range(obj_start, obj_end, "expr", text, sizeof(text)) != 0) {
+            fprintf(stderr, "computed slot %d: missing or overlong \"expr\", skipped\n", slot);
+            continue;
+        }
+        const char *err = expr_compile(text, slot, &g_computed[g_computed_count]);
+        if (err) {
+            fprintf(stderr, "computed slot %d: %s in \"%s\", skipped\n", slot, err, text);
+            continue;
+        }
+        g_computed_count++;
+    }
+}
+
+static void parse_assets_array(const char *json, asset_t *out, int *out_count)
+{
+    const char *p = strstr(json, "\"assets\"");
+    if (!p) return;
+    const char *arr = strchr(p, '[');
+    if (!arr) return;
+    p = arr + 1;
+    int count = 0;
+
+    while (*p && count < MAX_ASSETS) {
+        while (*p && *p != '{' && *p != ']') p++;
+        if (*p == ']') break;
+        const char *obj_start = p;
+        int depth = 1;
+        p++;
+        while (*p && depth > 0) {
+            if (*p == '{') depth++;
+            else if (*p == '}') depth--;
+            p++;
+        }
+        const char *obj_end = p;
+        if (depth != 0) break;
+
+        asset_t a;
+        init_asset_defaults(&a, count);
+
+        // Rules reuse asset key names, so the asset's own keys are read from a
+        // copy with the rules array blanked out
+        char *masked = NULL;
+        const char *rules_start = NULL;
+        const char *rules_end = NULL;
+        if (json_find_array_range(obj_start, obj_end, "rules", &rules_start, &rules_end) == 0) {
+            parse_asset_rules(rules_start, rules_end, &a.cfg);
+            size_t n = (size_t)(obj_end - obj_start);
+            masked = malloc(n + 1);
+            if (masked) {
+                memcpy(masked, obj_start, n);
+                masked[n] = '\0';
+                memset(masked + (rules_start - obj_start), ' ', (size_t)(rules_end - rules_start));
+                obj_start = masked;
+                obj_end = masked + n;
+            }
+        }
+
+        char type_buf[32];
+        if (json_get_string_range(obj_start, obj_end, "type", type_buf, sizeof(type_buf)) == 0) {
+            a.cfg.type = parse_asset_type_string(type_buf, ASSET_BAR);
+        }
+
+        int v = 0;
+        float fv = 0.0f;
+        int value_index_set = 0;
+        if (json_get_bool_range(obj_start, obj_end, "enabled", &v) == 0) a.cfg.enabled = v;
+        if (json_get_int_range(obj_start, obj_end, "value_index", &v) == 0) {
+            a.cfg.value_index = clamp_value_slot(v);
+            value_index_set = 1;
+        }
+        if (json_get_int_range(obj_start, obj_end, "id", &v) == 0) a.cfg.id = clamp_int(v, 0, 63);
+        if (json_get_int_range(obj_start, obj_end, "x", &v) == 0) a.cfg.x = v;
+        if (json_get_int_range(obj_start, obj_end, "y", &v) == 0) a.cfg.y = v;
+        if (json_get_int_range(obj_start, obj_end, "width", &v) == 0) a.cfg.width = v;
+        if (json_get_int_range(obj_start, obj_end, "height", &v) == 0) a.cfg.height = v;
+        if (json_get_float_range(obj_start, obj_end, "min", &fv) == 0) a.cfg.min = fv;
+        if (json_get_float_range(obj_start, obj_end, "max", &fv) == 0) a.cfg.max = fv;
+        if (json_get_int_range(obj_start, obj_end, "bar_color", &v) == 0) a.cfg.color = (uint32_t)v;
+        if (json_get_int_range(obj_start, obj_end, "text_color", &v) == 0) a.cfg.text_color = (uint32_t)v;
+        if (json_get_int_range(obj_start, obj_end, "background", &v) == 0) a.cfg.bg_style = clamp_int(v, -1, (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0])) - 1);
+        if (json_get_int_range(obj_start, obj_end, "background_opacity", &v) == 0) a.cfg.bg_opacity_pct = clamp_int(v, 0, 100);
+        if (json_get_int_range(obj_start, obj_end, "segments", &v) == 0) a.cfg.segments = clamp_int(v, 0, 64);
+        if (json_get_int_range(obj_start, obj_end, "text_index", &v) == 0) a.cfg.text_index = clamp_int(v, -1, TOTAL_TEXT_COUNT - 1);
+        json_get_int_array_range(obj_start, obj_end, "text_indices", a.cfg.text_indices, ASSET_INDEX_MAX, &a.cfg.text_indices_count, -1);
+        for (int i = 0; i < a.cfg.text_indices_count; i++) {
+            if (a.cfg.text_indices[i] >= 0) {
+                a.cfg.text_indices[i] = clamp_int(a.cfg.text_indices[i], 0, TOTAL_TEXT_COUNT - 1);
+            }
+        }
+        json_get_int_array_range(obj_start, obj_end, "value_indices", a.cfg.value_indices, ASSET_INDEX_MAX, &a.cfg.value_indices_count, -1);
+        for (int i = 0; i < a.cfg.value_indices_count; i++) {
+            if (a.cfg.value_indices[i] >= 0) {
+                a.cfg.value_indices[i] = clamp_value_slot(a.cfg.value_indices[i]);
+            }
+        }
+        if (json_get_bool_range(obj_start, obj_end, "text_inline", &v) == 0) a.cfg.text_inline = v;
+        json_get_string_range(obj_start, obj_end, "inline_separator", a.cfg.inline_separator, sizeof(a.cfg.inline_separator));
+        if (json_get_bool_range(obj_start, obj_end, "rounded_outline", &v) == 0) a.cfg.rounded_outline = v;
+        if (json_get_bool_range(obj_start, obj_end, "tabular_digits", &v) == 0) a.cfg.tabular_digits = v;
+        if (json_get_int_range(obj_start, obj_end, "font_size", &v) == 0) {
+            a.cfg.font_size = v <= 0 ? 0 : v < 13 ? 12 : v < 15 ? 14 : 16;
+        }
+        if (json_get_int_range(obj_start, obj_end, "font_bpp", &v) == 0) a.cfg.font_bpp = v <= 1 ? 1 : v == 2 ? 2 : 4;
+        if (json_get_bool_range(obj_start, obj_end, "noncritical", &v) == 0) a.cfg.noncritical = v;
+        if (json_get_int_range(obj_start, obj_end, "smooth_ms", &v) == 0) a.cfg.smooth_ms = clamp_int(v, 0, 10000);
+        json_get_string_range(obj_start, obj_end, "label", a.cfg.label, sizeof(a.cfg.label));
+        json_get_string_range(obj_start, obj_end, "image", a.cfg.image, sizeof(a.cfg.image));
+        char orient_buf[16];
+        if (json_get_string_range(obj_start, obj_end, "orientation", orient_buf, sizeof(orient_buf)) == 0) {
+            a.cfg.orientation = parse_orientation_string(orient_buf, ORIENTATION_RIGHT);
+        }
+        if (json_get_int_range(obj_start, obj_end, "history", &v) == 0) a.cfg.history = clamp_int(v, 8, 1024);
+        if (json_get_int_range(obj_start, obj_end, "interval_ms", &v) == 0) a.cfg.interval_ms = clamp_int(v, 10, 60000);
+        char mode_buf[16];
+        if (json_get_string_range(obj_start, obj_end, "graph_mode", mode_buf, sizeof(mode_buf)) == 0) {
+            a.cfg.graph_mode = parse_graph_mode_string(mode_buf, GRAPH_MODE_SWEEP);
+        }
+        char prio_buf[16];
+        if (json_get_string_range(obj_start, obj_end, "priority", prio_buf, sizeof(prio_buf)) == 0) {
+            a.cfg.priority = parse_priority_string(prio_buf, PRIORITY_NORMAL);
+        }
+        if (json_get_int_range(obj_start, obj_end, "max_rate_hz", &v) == 0) a.cfg.max_rate_hz = clamp_int(v, 0, 1000);
+
+        if (a.cfg.type == ASSET_TEXT && !value_index_set) {
+            a.cfg.value_index = -1;
+        }
+        free(masked);
+
+        out[count++] = a;
+        if (count >= MAX_ASSETS) break;
+    }
+
+    if (count == 0) {
+        memset(out, 0, sizeof(*out) * (size_t)g_asset_capacity);
+        count = 1;
+        init_asset_defaults(&out[0], 0);
+    }
+    *out_count = count;
+}
+
+// Reads CONFIG_PATH into g_cfg and the asset list `out` (g_asset_capacity entries)
+// Positional source names for slots 8-15; missing or unknown entries keep the default source
+static void parse_system_slots(const char *start, const char *end)
+{
+    const char *p = start;
+    for (int slot = 0; slot < SYSTEM_VALUE_COUNT; slot++) {
+        while (p < end && *p != '"' && *p != ']') p++;
+        if (p >= end || *p != '"') return;
+        const char *name = ++p;
+        while (p < end && *p != '"') p++;
+        if (p >= end) return;
+        char buf[40];
+        size_t len = (size_t)(p - name);
+        p++;
+        if (len >= sizeof(buf)) continue;
+        memcpy(buf, name, len);
+        buf[len] = '\0';
+        sys_slot_map_t m;
+        if (parse_sys_source(buf, &m) != 0) {
+            fprintf(stderr, "system_slots: unknown source \"%s\" for slot %d\n", buf, UDP_VALUE_COUNT + slot);
+            continue;
+        }
+        g_cfg.system_slots[slot] = m;
+    }
+}
+
+static void load_config(asset_t *out, int *out_count)
+{
+    set_defaults();
+    memset(out, 0, sizeof(*out) * (size_t)g_asset_capacity);
+    *out_count = 1;
+    init_asset_defaults(&out[0], 0);
+
+    g_config_cache_hit = config_cache_load(out, out_count) == 0;
+    if (g_config_cache_hit) return;
+    char *json = NULL;
+    if (read_file(CONFIG_PATH, &json, NULL) != 0) {
+        return;
+    }
+
+    int v = 0;
+    float fv = 0.0f;
+    if (json_get_int(json, "width", &v) == 0) g_cfg.width = v;
+    if (json_get_int(json, "height", &v) == 0) g_cfg.height = v;
+    if (json_get_int(json, "osd_x", &v) == 0) g_cfg.osd_x = v;
+    if (json_get_int(json, "osd_y", &v) == 0) g_cfg.osd_y = v;
+    int ports[OSD_PORT_MAX];
+    int port_count = 0;
+    json_get_int_array_range(json, json + strlen(json), "osd_ports", ports, OSD_PORT_MAX, &port_count, 0);
+    if (port_count > 0) {
+        g_cfg.osd_port_count = port_count;
+        for (int i = 0; i < port_count; i++) g_cfg.osd_port[i] = clamp_int(ports[i], 0, 3);
+    }
+    int port_xy[OSD_PORT_MAX * 2];
+    int port_xy_count = 0;
+    json_get_int_array_range(json, json + strlen(json), "osd_port_xy", port_xy, OSD_PORT_MAX * 2, &port_xy_count, 0);
+    if (port_xy_count > 0) {
+        g_cfg.osd_port_xy_count = port_xy_count / 2;
+        for (int i = 0; i < g_cfg.osd_port_xy_count; i++) {
+            g_cfg.osd_port_x[i] = port_xy[i * 2] < 0 ? 0 : port_xy[i * 2];
+            g_cfg.osd_port_y[i] = port_xy[i * 2 + 1] < 0 ? 0 : port_xy[i * 2 + 1];
+        }
+    }
+    if (json_get_bool(json, "show_stats", &v) == 0) g_cfg.show_stats = v;
+    if (json_get_bool(json, "udp_stats", &v) == 0) g_cfg.udp_stats = v;
+    if (json_get_int(json, "idle_ms", &v) == 0) {
+        g_cfg.idle_ms = clamp_int(v, 10, 1000);
+    } else if (json_get_int(json, "refresh_ms", &v) == 0) {
+        // Backward compatibility with older configs
+        g_cfg.idle_ms = clamp_int(v, 10, 1000);
+    }
+    if (json_get_int(json, "system_refresh_ms", &v) == 0) {
+        g_cfg.system_refresh_ms = clamp_int(v, 100, 60000);
+    }
+    const char *periods = strstr(json, "\"system_periods\"");
+    if (periods) periods = strchr(periods, '{');
+    const char *periods_end = periods ? strchr(periods, '}') : NULL;
+    if (periods_end) {
+        for (int g = 0; g < SYS_GROUP_COUNT; g++) {
+            if (json_get_int_range(periods, periods_end + 1, g_sys_group_names[g], &v) == 0) {
+                g_cfg.system_period_ms[g] = v <= 0 ? 0 : clamp_int(v, 100, 60000);
+            }
+        }
+    }
+    const char *slots_start = NULL;
+    const char *slots_end = NULL;
+    if (json_find_array_range(json, json + strlen(json), "system_slots", &slots_start, &slots_end) == 0) {
+        parse_system_slots(slots_start, slots_end);
+    }
+    if (json_get_int(json, "render_rows", &v) == 0) g_cfg.render_rows = clamp_int(v, 8, 4096);
+    if (json_get_int(json, "render_buffers", &v) == 0) g_cfg.render_buffers = clamp_int(v, 1, 2);
+    if (json_get_int(json, "render_pass_cost_px", &v) == 0) g_cfg.render_pass_cost_px = clamp_int(v, 0, 1 << 20);
+    char mode_buf[16];
+    if (json_get_string_range(json, json + strlen(json), "render_mode", mode_buf, sizeof(mode_buf)) == 0) {
+        g_cfg.render_mode = parse_render_mode_string(mode_buf, RENDER_MODE_PARTIAL);
+    }
+    if (json_get_string_range(json, json + strlen(json), "pixel_format", mode_buf, sizeof(mode_buf)) == 0) {
+        g_cfg.pixel_format = parse_pixel_format_string(mode_buf, PIXEL_FORMAT_ARGB4444);
+    }
+    if (json_get_string_range(json, json + strlen(json), "region_mode", mode_buf, sizeof(mode_buf)) == 0) {
+        g_cfg.region_mode = parse_region_mode_string(mode_buf, REGION_MODE_SINGLE);
+    }
+    if (json_get_string_range(json, json + strlen(json), "sched_policy", mode_buf, sizeof(mode_buf)) == 0) {
+        g_cfg.sched_policy = parse_sched_policy_string(mode_buf, SCHED_OTHER);
+    }
+    if (json_get_int(json, "sched_priority", &v) == 0) g_cfg.sched_priority = clamp_int(v, 1, 99);
+    if (json_get_int(json, "cpu_affinity", &v) == 0) g_cfg.cpu_affinity = clamp_int(v, 0, 0xFFFF);
+    if (json_get_bool(json, "mlock", &v) == 0) g_cfg.mlock = v;
+    if (json_get_bool(json, "governor", &v) == 0) g_cfg.governor = v;
+    if (json_get_bool(json, "static_layers", &v) == 0) g_cfg.static_layers = v;
+    if (json_get_bool(json, "flush_compare", &v) == 0) g_cfg.flush_compare = v;
+    if (json_get_int(json, "governor_cpu_high", &v) == 0) g_cfg.governor_cpu_high = clamp_int(v, 1, 100);
+    if (json_get_int(json, "governor_cpu_low", &v) == 0) g_cfg.governor_cpu_low = clamp_int(v, 0, 100);
+    if (g_cfg.governor_cpu_low > g_cfg.governor_cpu_high) g_cfg.governor_cpu_low = g_cfg.governor_cpu_high;
+    if (json_get_int(json, "governor_fps_min", &v) == 0) g_cfg.governor_fps_min = clamp_int(v, 0, 240);
+    if (json_get_int(json, "governor_push_ms", &v) == 0) g_cfg.governor_push_ms = clamp_int(v, 32, 5000);
+    if (json_get_int(json, "governor_stats_ms", &v) == 0) g_cfg.governor_stats_ms = clamp_int(v, 250, 60000);
+    if (json_get_int(json, "governor_hold_ms", &v) == 0) g_cfg.governor_hold_ms = clamp_int(v, 0, 600000);
+    if (json_get_int(json, "region_max", &v) == 0) g_cfg.region_max = clamp_int(v, 1, OSD_REGION_MAX);
+    if (json_get_bool(json, "gfx_accel", &v) == 0) g_cfg.gfx_accel = v;
+    if (json_get_bool(json, "shm_transport", &v) == 0) g_cfg.shm_transport = v;
+    if (json_get_bool(json, "frame_sync", &v) == 0) g_cfg.frame_sync = v;
+    if (json_get_int(json, "frame_rate", &v) == 0) g_cfg.frame_rate = v <= 0 ? 0 : clamp_int(v, 10, 240);
+    if (json_get_bool(json, "deep_idle", &v) == 0) g_cfg.deep_idle = v;
+    if (json_get_bool(json, "latency_stats", &v) == 0) g_cfg.latency_stats = v;
+    if (json_get_bool(json, "profile_stats", &v) == 0) g_cfg.profile_stats = v;
+    if (json_get_bool(json, "rx_thread", &v) == 0) g_cfg.rx_thread = v;
+    if (json_get_int(json, "render_cpus", &v) == 0) g_cfg.render_cpus = clamp_int(v, 0, 0xFFFF);
+    if (json_get_int(json, "udp_rcvbuf", &v) == 0) g_cfg.udp_rcvbuf = v <= 0 ? 0 : clamp_int(v, 4096, 8 << 20);
+    if (json_get_bool(json, "udp_reuseport", &v) == 0) g_cfg.udp_reuseport = v;
+    json_get_string_range(json, json + strlen(json), "udp_multicast", g_cfg.udp_multicast,
+                          sizeof(g_cfg.udp_multicast));
+    json_get_string_range(json, json + strlen(json), "udp_multicast_iface", g_cfg.udp_multicast_iface,
+                          sizeof(g_cfg.udp_multicast_iface));
+    int owners[UDP_CHANNEL_MAX];
+    int owner_count = 0;
+    json_get_int_array_range(json, json + strlen(json), "value_owners", owners, UDP_CHANNEL_MAX, &owner_count, -1);
+    for (int i = 0; i < owner_count; i++) g_cfg.value_owner[i] = (int16_t)clamp_int(owners[i], -1, UDP_SRC_MAX - 1);
+    owner_count = 0;
+    json_get_int_array_range(json, json + strlen(json), "text_owners", owners, UDP_CHANNEL_MAX, &owner_count, -1);
+    for (int i = 0; i < owner_count; i++) g_cfg.text_owner[i] = (int16_t)clamp_int(owners[i], -1, UDP_SRC_MAX - 1);
+    if (json_get_int(json, "metrics_port", &v) == 0) g_cfg.metrics_port = v <= 0 ? 0 : clamp_int(v, 1, 65535);
+    if (json_get_string_range(json, json + strlen(json), "lvgl_heap", mode_buf, sizeof(mode_buf)) == 0) {
+        g_cfg.lvgl_heap_auto = strcmp(mode_buf, "auto") == 0;
+        g_cfg.lvgl_heap_kb = 0;
+    } else if (json_get_int(json, "lvgl_heap", &v) == 0) {
+        g_cfg.lvgl_heap_auto = 0;
+        g_cfg.lvgl_heap_kb = v <= 0 ? 0 : clamp_int(v, 8, 16384);
+    }
+    if (json_get_int(json, "heap_alarm_pct", &v) == 0) g_cfg.heap_alarm_pct = clamp_int(v, 0, 100);
+    if (json_get_bool(json, "config_cache", &v) == 0) g_cfg.config_cache = v;
+    if (json_get_int(json, "snapshot_ms", &v) == 0) g_cfg.snapshot_ms = v <= 0 ? 0 : clamp_int(v, 100, 60000);
+    json_get_string_range(json, json + strlen(json), "snapshot_path", g_cfg.snapshot_path, sizeof(g_cfg.snapshot_path));
+    if (json_get_int(json, "hitch_ms", &v) == 0) g_cfg.hitch_ms = v <= 0 ? 0 : clamp_int(v, 10, 10000);
+    json_get_string_range(json, json + strlen(json), "hitch_file", g_cfg.hitch_file, sizeof(g_cfg.hitch_file));
+
+    // Backwards-compatible single bar fields (used only if no assets array)
+    if (json_get_int(json, "bar_x", &v) == 0) out[0].cfg.x = v;
+    if (json_get_int(json, "bar_y", &v) == 0) out[0].cfg.y = v;
+    if (json_get_int(json, "bar_width", &v) == 0) out[0].cfg.width = v;
+    if (json_get_int(json, "bar_height", &v) == 0) out[0].cfg.height = v;
+    if (json_get_float(json, "bar_min", &fv) == 0) out[0].cfg.min = fv;
+    if (json_get_float(json, "bar_max", &fv) == 0) out[0].cfg.max = fv;
+    if (json_get_int(json, "bar_color", &v) == 0) out[0].cfg.color = (uint32_t)v;
+
+    // Preferred structured assets list
+    parse_assets_array(json, out, out_count);
+    parse_filters_array(json);
+    parse_computed_array(json);
+
+    free(json);
+    config_cache_store(out, *out_count);
+}
+
+// Joins udp_multicast on udp_multicast_iface (a name such as "eth0" or a local
+// IPv4 address); failures are logged and the socket stays unicast
+static void udp_join_multicast(int fd)
+{
+    struct ip_mreqn mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    if (inet_pton(AF_INET, g_cfg.udp_multicast, &mreq.imr_multiaddr) != 1 ||
+        !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr))) {
+        fprintf(stderr, "UDP: udp_multicast \"%s\" is not an IPv4 multicast group\n", g_cfg.udp_multicast);
+        return;
+    }
+    const char *iface = g_cfg.udp_multicast_iface;
+    if (iface[0] && inet_pton(AF_INET, iface, &mreq.imr_address) != 1) {
+        mreq.imr_ifindex = (int)if_nametoindex(iface);
+        if (mreq.imr_ifindex == 0) {
+            fprintf(stderr, "UDP: multicast interface %s not found, using the kernel's choice\n", iface);
+        }
+    }
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        fprintf(stderr, "UDP: joining %s failed: %s\n", g_cfg.udp_multicast, strerror(errno));
+        return;
+    }
+    // Only groups joined on this socket, not every group another process joined
+#ifdef IP_MULTICAST_ALL
+    int off = 0;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off));
+#endif
+    printf("UDP: joined multicast group %s%s%s\n", g_cfg.udp_multicast, iface[0] ? " on " : "", iface);
+}
+
+static int setup_udp_socket(void)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+
+    // Several consumers (main/sub overlays, a recorder) can share port 7777;
+    // each gets its own copy of multicast datagrams, unicast goes to one of them
+    if (g_cfg.udp_reuseport) {
+        int on = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+            setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+            fprintf(stderr, "UDP: SO_REUSEPORT unavailable: %s\n", strerror(errno));
+        }
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+    if (g_cfg.udp_multicast[0]) udp_join_multicast(fd);
+
+    // Ask the kernel to attach its running drop count to every datagram
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+        fprintf(stderr, "UDP: SO_RXQ_OVFL unavailable, kernel drops not counted\n");
+    }
+    if (g_cfg.udp_rcvbuf > 0) {
+        int want = g_cfg.udp_rcvbuf;
+        int got = 0;
+        socklen_t got_len = sizeof(got);
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &want, sizeof(want));
+        // The kernel doubles the request; below half of it rmem_max capped us, so
+        // retry past the cap (needs CAP_NET_ADMIN)
+        if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &got, &got_len) == 0 && got < want) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &want, sizeof(want));
+            got_len = sizeof(got);
+            getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &got, &got_len);
+        }
+        printf("UDP receive buffer: requested %d, kernel reports %d bytes\n", want, got);
+    }
+    return fd;
+}
+
+// -------------------------
+// UDP payload scanner
+// -------------------------
+/*
+ * Datagrams are walked once: top-level keys are dispatched as they are met and
+ * each asset_updates object is decoded into an asset_update_t with a field mask
+ * before it is applied. Values are never searched for by key name, so a string
+ * that happens to contain "values" or another key cannot be mistaken for it.
+ */
+typedef struct {
+    const char *p;
+    const char *end;
+} json_cursor_t;
+
+static void json_skip_ws(json_cursor_t *c)
+{
+    while (c->p < c->end && isspace((unsigned char)*c->p)) c->p++;
+}
+
+static int json_peek(json_cursor_t *c)
+{
+    json_skip_ws(c);
+    return c->p < c->end ? (unsigned char)*c->p : -1;
+}
+
+static int json_expect(json_cursor_t *c, char ch)
+{
+    if (json_peek(c) != (unsigned char)ch) return -1;
+    c->p++;
+    return 0;
+}
+
+// Raw string body between the quotes (escapes left in place)
+static int json_scan_string(json_cursor_t *c, const char **out, size_t *out_len)
+{
+    if (json_expect(c, '"') != 0) return -1;
+    const char *start = c->p;
+    while (c->p < c->end && *c->p != '"') {
+        if (*c->p == '\\' && c->p + 1 < c->end) c->p++;
+        c->p++;
+    }
+    if (c->p >= c->end) return -1;
+    *out = start;
+    *out_len = (size_t)(c->p - start);
+    c->p++;
+    return 0;
+}
+
+// Unescapes a raw string body into buf; returns the unescaped length, or -1 if it does not fit
+static int json_unescape(const char *s, size_t len, char *buf, size_t buf_sz, int truncate)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        char ch = s[i];
+        if (ch == '\\' && i + 1 < len) {
+            ch = s[++i];
+            switch (ch) {
+                case 'n': ch = '\n'; break;
+                case 't': ch = '\t'; break;
+                case 'r': ch = '\r'; break;
+                case 'b': ch = '\b'; break;
+                case 'f': ch = '\f'; break;
+                case 'u': {
+                    unsigned cp = 0;
+                    if (i + 4 < len && sscanf(s + i + 1, "%4x", &cp) == 1) i += 4;
+                    ch = cp > 0 && cp < 0x80 ? (char)cp : '?';
+                    break;
+                }
+                default: break;  // \" \\ \/ map to themselves
+            }
+        }
+        if (o + 1 >= buf_sz) {
+            if (!truncate) return -1;
+            break;
+        }
+        buf[o++] = ch;
+    }
+    if (buf_sz) buf[o] = '\0';
+    return (int)o;
+}
+
+static int json_skip_value(json_cursor_t *c)
+{
+    int ch = json_peek(c);
+    if (ch == '"') {
+        const char *s;
+        size_t len;
+        return json_scan_string(c, &s, &len);
+    }
+    if (ch == '{' || ch == '[') {
+        int depth = 0;
+        while (c->p < c->end) {
+            char cur = *c->p;
+            if (cur == '"') {
+                const char *s;
+                size_t len;
+                if (json_scan_string(c, &s, &len) != 0) return -1;
+                continue;
+            }
+            if (cur == '{' || cur == '[') depth++;
+            else if (cur == '}' || cur == ']') depth--;
+            c->p++;
+            if (depth == 0) return 0;
+        }
+        return -1;
+    }
+    while (c->p < c->end && *c->p != ',' && *c->p != '}' && *c->p != ']' && !isspace((unsigned char)*c->p)) c->p++;
+    return 0;
+}
+
+// After a member or element: consumes ',' (returns 1) or the closing bracket (returns 0)
+static int json_next(json_cursor_t *c, char close)
+{
+    int ch = json_peek(c);
+    if (ch == ',') {
+        c->p++;
+        return 1;
+    }
+    if (ch == (unsigned char)close) {
+        c->p++;
+        return 0;
+    }
+    return -1;
+}
+
+static int json_key_is(const char *key, size_t len, const char *name)
+{
+    return strlen(name) == len && memcmp(key, name, len) == 0;
+}
+
+static int json_scan_number(json_cursor_t *c, double *out)
+{
+    json_skip_ws(c);
+    char *endptr = NULL;
+    double v = strtod(c->p, &endptr);
+    if (!endptr || endptr == c->p || endptr > c->end) return -1;
+    c->p = endptr;
+    *out = v;
+    return 0;
+}
+
+// Integers keep strtol base-0 parsing so hex colors such as 0xFF8800 still work
+static int json_scan_int(json_cursor_t *c, int *out)
+{
+    json_skip_ws(c);
+    int ch = c->p < c->end ? (unsigned char)*c->p : 0;
+    if (!(isdigit(ch) || ch == '-' || ch == '+')) return -1;
+    char *endptr = NULL;
+    long v = strtol(c->p, &endptr, 0);
+    if (!endptr || endptr == c->p || endptr > c->end) return -1;
+    // Tolerate fractional numbers where an int is expected
+    if (endptr < c->end && (*endptr == '.' || *endptr == 'e' || *endptr == 'E')) {
+        double d = strtod(c->p, &endptr);
+        v = (long)d;
+    }
+    c->p = endptr;
+    *out = (int)v;
+    return 0;
+}
+
+static int json_scan_bool(json_cursor_t *c, int *out)
+{
+    json_skip_ws(c);
+    size_t left = (size_t)(c->end - c->p);
+    if (left >= 4 && strncmp(c->p, "true", 4) == 0) {
+        c->p += 4;
+        *out = 1;
+        return 0;
+    }
+    if (left >= 5 && strncmp(c->p, "false", 5) == 0) {
+        c->p += 5;
+        *out = 0;
+        return 0;
+    }
+    return -1;
+}
+
+static int json_scan_null(json_cursor_t *c)
+{
+    json_skip_ws(c);
+    if ((size_t)(c->end - c->p) >= 4 && strncmp(c->p, "null", 4) == 0) {
+        c->p += 4;
+        return 0;
+    }
+    return -1;
+}
+
+static int json_scan_string_into(json_cursor_t *c, char *buf, size_t buf_sz, int truncate)
+{
+    const char *s;
+    size_t len;
+    if (json_peek(c) != '"') return json_skip_value(c) == 0 ? 1 : -1;
+    if (json_scan_string(c, &s, &len) != 0) return -1;
+    return json_unescape(s, len, buf, buf_sz, truncate) < 0 ? 1 : 0;
+}
+
+// Int array with null -> null_marker; stops filling at the first non-number
+static int json_scan_int_array(json_cursor_t *c, int *out, int max_count, int *out_count, int null_marker)
+{
+    int count = 0;
+    int filling = 1;
+    if (json_peek(c) != '[') {
+        *out_count = 0;
+        return json_skip_value(c);
+    }
+    c->p++;
+    if (json_peek(c) == ']') {
+        c->p++;
+        *out_count = 0;
+        return 0;
+    }
+    for (;;) {
+        int v = 0;
+        if (filling && count < max_count && json_scan_null(c) == 0) {
+            out[count++] = null_marker;
+        } else if (filling && count < max_count && json_scan_int(c, &v) == 0) {
+            out[count++] = v;
+        } else {
+            filling = 0;
+            if (json_skip_value(c) != 0) return -1;
+        }
+        int more = json_next(c, ']');
+        if (more < 0) return -1;
+        if (!more) break;
+    }
+    *out_count = count;
+    return 0;
+}
+
+// -------------------------
+// Sender sequencing
+// -------------------------
+/*
+ * A datagram may carry "src" (sender id 0-255) and "seq" (u32 counter). Both
+ * are found by a byte scan of the top-level object before anything is parsed,
+ * so a duplicate or reordered datagram costs one pass over its bytes and
+ * nothing else. A sequence counts as new when it is ahead of the last one
+ * (wrap-around safe); a sender that jumped far back or was silent for
+ * SEQ_RESTART_MS is taken to have restarted. "src" alone still selects the
+ * slots value_owners/text_owners reserve for that sender.
+ */
+#define SEQ_RESTART_WINDOW 1024
+#define SEQ_RESTART_MS 2000
+
+typedef struct {
+    uint32_t seq;
+    uint64_t last_ms;
+    int seen;
+} udp_source_t;
+
+static udp_source_t g_sources[UDP_SRC_MAX];
+static int g_rx_src = -1;  // "src" of the datagram being parsed, -1 = none
+
+static int udp_value_writable(int idx)
+{
+    int owner = idx < UDP_CHANNEL_MAX ? g_cfg.value_owner[idx] : -1;
+    return owner < 0 || owner == g_rx_src;
+}
+
+static int udp_text_writable(int idx)
+{
+    int owner = idx < UDP_CHANNEL_MAX ? g_cfg.text_owner[idx] : -1;
+    return owner < 0 || owner == g_rx_src;
+}
+
+// Unsigned integer right after `"key":` at buf[i]; -1 when no ':' or no number follows
+static long long udp_header_number(const char *buf, size_t len, size_t i)
+{
+    while (i < len && isspace((unsigned char)buf[i])) i++;
+    if (i >= len || buf[i] != ':') return -1;
+    i++;
+    while (i < len && isspace((unsigned char)buf[i])) i++;
+    if (i >= len || !isdigit((unsigned char)buf[i])) return -1;
+    long long v = 0;
+    for (; i < len && isdigit((unsigned char)buf[i]) && v <= 0xFFFFFFFFLL; i++) v = v * 10 + (buf[i] - '0');
+    return v <= 0xFFFFFFFFLL ? v : -1;
+}
+
+// Finds top-level "src" and "seq" without parsing the rest of the payload
+static void udp_header_scan(const char *buf, size_t len, long long *src, long long *seq)
+{
+    int depth = 0;
+    *src = -1;
+    *seq = -1;
+    for (size_t i = 0; i < len && (*src < 0 || *seq < 0); i++) {
+        char ch = buf[i];
+        if (ch == '{' || ch == '[') {
+            depth++;
+        } else if (ch == '}' || ch == ']') {
+            depth--;
+        } else if (ch == '"') {
+            size_t start = ++i;
+            while (i < len && buf[i] != '"') i += buf[i] == '\\' ? 2 : 1;
+            if (i >= len) return;
+            if (depth != 1 || i - start != 3) continue;
+            // A string is only a key when ':' follows it; values such as "name":"src" are skipped
+            long long v = udp_header_number(buf, len, i + 1);
+            if (v < 0) continue;
+            if (*src < 0 && memcmp(buf + start, "src", 3) == 0) {
+                *src = v;
+            } else if (*seq < 0 && memcmp(buf + start, "seq", 3) == 0) {
+                *seq = v;
+            }
+        }
+    }
+}
+
+// Returns 0 for a duplicate or out-of-order datagram from a known sender
+static int udp_source_accept(int src, uint32_t seq)
+{
+    udp_source_t *s = &g_sources[src];
+    uint64_t now = monotonic_us64() / 1000;
+    int32_t ahead = (int32_t)(seq - s->seq);
+    if (s->seen && ahead <= 0 && ahead > -SEQ_RESTART_WINDOW && now - s->last_ms < SEQ_RESTART_MS) return 0;
+    s->seq = seq;
+    s->last_ms = now;
+    s->seen = 1;
+    return 1;
+}
+
+static int parse_udp_values(json_cursor_t *c)
+{
+    if (json_peek(c) != '[') return json_skip_value(c);
+    c->p++;
+    if (json_peek(c) == ']') {
+        c->p++;
+        return 0;
+    }
+    for (int i = 0;; i++) {
+        double val = 0.0;
+        if (json_peek(c) == '"') {
+            /* Treat empty string as a clear-to-zero; other strings are ignored */
+            const char *str;
+            size_t len;
+            if (json_scan_string(c, &str, &len) != 0) return -1;
+            if (len == 0 && udp_value_writable(i)) set_udp_value(i, 0.0);
+        } else if (json_scan_null(c) == 0) {
+            // keep the previous value
+        } else if (json_scan_number(c, &val) == 0) {
+            if (udp_value_writable(i)) set_udp_value(i, val);
+        } else if (json_skip_value(c) != 0) {
+            return -1;
+        }
+        int more = json_next(c, ']');
+        if (more <= 0) return more;
+    }
+}
+
+static int parse_udp_texts(json_cursor_t *c)
+{
+    if (json_peek(c) != '[') return json_skip_value(c);
+    c->p++;
+    if (json_peek(c) == ']') {
+        c->p++;
+        return 0;
+    }
+    for (int i = 0;; i++) {
+        if (json_peek(c) == '"' && i < g_udp_channels && udp_text_writable(i)) {
+            if (json_scan_string_into(c, g_text_scratch, udp_texts[i].cap + 1, 1) < 0) return -1;
+            set_udp_text(i, g_text_scratch, strlen(g_text_scratch));
+        } else if (json_skip_value(c) != 0) {
+            return -1;
+        }
+        int more = json_next(c, ']');
+        if (more <= 0) return more;
+    }
+}
+
+typedef enum {
+    ASSET_UPD_ENABLED = 1u << 0,
+    ASSET_UPD_TYPE = 1u << 1,
+    ASSET_UPD_VALUE_INDEX = 1u << 2,
+    ASSET_UPD_TEXT_INDEX = 1u << 3,
+    ASSET_UPD_TEXT_INDICES = 1u << 4,
+    ASSET_UPD_VALUE_INDICES = 1u << 5,
+    ASSET_UPD_TEXT_INLINE = 1u << 6,
+    ASSET_UPD_INLINE_SEPARATOR = 1u << 7,
+    ASSET_UPD_ROUNDED_OUTLINE = 1u << 8,
+    ASSET_UPD_LABEL = 1u << 9,
+    ASSET_UPD_ORIENTATION = 1u << 10,
+    ASSET_UPD_BAR_COLOR = 1u << 11,
+    ASSET_UPD_TEXT_COLOR = 1u << 12,
+    ASSET_UPD_BACKGROUND = 1u << 13,
+    ASSET_UPD_BACKGROUND_OPACITY = 1u << 14,
+    ASSET_UPD_SEGMENTS = 1u << 15,
+    ASSET_UPD_X = 1u << 16,
+    ASSET_UPD_Y = 1u << 17,
+    ASSET_UPD_WIDTH = 1u << 18,
+    ASSET_UPD_HEIGHT = 1u << 19,
+    ASSET_UPD_MIN = 1u << 20,
+    ASSET_UPD_MAX = 1u << 21,
+} asset_update_field_t;
+
+// One decoded asset_updates entry; only fields flagged in `fields` are meaningful
+typedef struct {
+    uint32_t fields;
+    int id;
+    int enabled;
+    asset_type_t type;
+    int value_index;
+    int text_index;
+    int text_indices[ASSET_INDEX_MAX];
+    int text_indices_count;
+    int value_indices[ASSET_INDEX_MAX];
+    int value_indices_count;
+    int text_inline;
+    char inline_separator[16];
+    int rounded_outline;
+    char label[64];
+    asset_orientation_t orientation;
+    uint32_t bar_color;
+    uint32_t text_color;
+    int background;
+    int background_opacity;
+    int segments;
+    int x;
+    int y;
+    int width;
+    int height;
+    float min;
+    float max;
+} asset_update_t;
+
+static const struct {
+    const char *key;
+    uint32_t field;
+} g_asset_update_keys[] = {
+    {"enabled", ASSET_UPD_ENABLED},
+    {"type", ASSET_UPD_TYPE},
+    {"value_index", ASSET_UPD_VALUE_INDEX},
+    {"text_index", ASSET_UPD_TEXT_INDEX},
+    {"text_indices", ASSET_UPD_TEXT_INDICES},
+    {"value_indices", ASSET_UPD_VALUE_INDICES},
+    {"text_inline", ASSET_UPD_TEXT_INLINE},
+    {"inline_separator", ASSET_UPD_INLINE_SEPARATOR},
+    {"rounded_outline", ASSET_UPD_ROUNDED_OUTLINE},
+    {"label", ASSET_UPD_LABEL},
+    {"orientation", ASSET_UPD_ORIENTATION},
+    {"bar_color", ASSET_UPD_BAR_COLOR},
+    {"text_color", ASSET_UPD_TEXT_COLOR},
+    {"background", ASSET_UPD_BACKGROUND},
+    {"background_opacity", ASSET_UPD_BACKGROUND_OPACITY},
+    {"segments", ASSET_UPD_SEGMENTS},
+    {"x", ASSET_UPD_X},
+    {"y", ASSET_UPD_Y},
+    {"width", ASSET_UPD_WIDTH},
+    {"height", ASSET_UPD_HEIGHT},
+    {"min", ASSET_UPD_MIN},
+    {"max", ASSET_UPD_MAX},
+};
+
+// Decodes one member value into the record; values of the wrong type are skipped
+static int parse_asset_update_member(json_cursor_t *c, uint32_t field, asset_update_t *u)
+{
+    int v = 0;
+    double d = 0.0;
+    int ok = 0;
+    char str_buf[32];
+
+    switch (field) {
+        case ASSET_UPD_ENABLED:
+            ok = json_scan_bool(c, &u->enabled) == 0;
+            break;
+        case ASSET_UPD_TEXT_INLINE:
+            ok = json_scan_bool(c, &u->text_inline) == 0;
+            break;
+        case ASSET_UPD_ROUNDED_OUTLINE:
+            ok = json_scan_bool(c, &u->rounded_outline) == 0;
+            break;
+        case ASSET_UPD_TYPE:
+            if (json_peek(c) != '"') break;
+            v = json_scan_string_into(c, str_buf, sizeof(str_buf), 0);
+            if (v < 0) return -1;
+            u->type = parse_asset_type_string(str_buf, ASSET_BAR);
+            ok = v == 0;
+            break;
+        case ASSET_UPD_ORIENTATION:
+            if (json_peek(c) != '"') break;
+            v = json_scan_string_into(c, str_buf, sizeof(str_buf), 0);
+            if (v < 0) return -1;
+            u->orientation = parse_orientation_string(str_buf, ORIENTATION_RIGHT);
+            ok = v == 0 && (strcmp(str_buf, "left") == 0 || strcmp(str_buf, "center") == 0 || strcmp(str_buf, "right") == 0);
+            break;
+        case ASSET_UPD_LABEL:
+        case ASSET_UPD_INLINE_SEPARATOR: {
+            char *dst = field == ASSET_UPD_LABEL ? u->label : u->inline_separator;
+            size_t dst_sz = field == ASSET_UPD_LABEL ? sizeof(u->label) : sizeof(u->inline_separator);
+            if (json_peek(c) != '"') break;
+            v = json_scan_string_into(c, dst, dst_sz, 0);
+            if (v < 0) return -1;
+            ok = v == 0;  // over-long strings are ignored, as before
+            break;
+        }
+        case ASSET_UPD_TEXT_INDICES:
+            if (json_peek(c) != '[') break;
+            if (json_scan_int_array(c, u->text_indices, ASSET_INDEX_MAX, &u->text_indices_count, -1) != 0) return -1;
+            ok = 1;
+            break;
+        case ASSET_UPD_VALUE_INDICES:
+            if (json_peek(c) != '[') break;
+            if (json_scan_int_array(c, u->value_indices, ASSET_INDEX_MAX, &u->value_indices_count, -1) != 0) return -1;
+            ok = 1;
+            break;
+        case ASSET_UPD_MIN:
+        case ASSET_UPD_MAX:
+            if (json_scan_number(c, &d) != 0) break;
+            if (field == ASSET_UPD_MIN) u->min = (float)d;
+            else u->max = (float)d;
+            ok = 1;
+            break;
+        default:
+            if (json_scan_int(c, &v) != 0) break;
+            ok = 1;
+            switch (field) {
+                case ASSET_UPD_VALUE_INDEX: u->value_index = v; break;
+                case ASSET_UPD_TEXT_INDEX: u->text_index = v; break;
+                case ASSET_UPD_BAR_COLOR: u->bar_color = (uint32_t)v; break;
+                case ASSET_UPD_TEXT_COLOR: u->text_color = (uint32_t)v; break;
+                case ASSET_UPD_BACKGROUND: u->background = v; break;
+                case ASSET_UPD_BACKGROUND_OPACITY: u->background_opacity = v; break;
+                case ASSET_UPD_SEGMENTS: u->segments = v; break;
+                case ASSET_UPD_X: u->x = v; break;
+                case ASSET_UPD_Y: u->y = v; break;
+                case ASSET_UPD_WIDTH: u->width = v; break;
+                case ASSET_UPD_HEIGHT: u->height = v; break;
+                default: ok = 0; break;
+            }
+            break;
+    }
+
+    if (ok) {
+        u->fields |= field;
+        return 0;
+    }
+    // Unusable value: step over whatever is there
+    if (c->p < c->end && (*c->p == ',' || *c->p == '}')) return 0;
+    return json_skip_value(c);
+}
+
+static int parse_asset_update_object(json_cursor_t *c, asset_update_t *u)
+{
+    memset(u, 0, sizeof(*u));
+    u->id = -1;
+    if (json_expect(c, '{') != 0) return -1;
+    if (json_peek(c) == '}') {
+        c->p++;
+        return 0;
+    }
+    for (;;) {
+        const char *key;
+        size_t key_len;
+        if (json_scan_string(c, &key, &key_len) != 0 || json_expect(c, ':') != 0) return -1;
+
+        uint32_t field = 0;
+        for (size_t k = 0; k < sizeof(g_asset_update_keys) / sizeof(g_asset_update_keys[0]); k++) {
+            if (json_key_is(key, key_len, g_asset_update_keys[k].key)) {
+                field = g_asset_update_keys[k].field;
+                break;
+            }
+        }
+        int rc = 0;
+        if (field) {
+            rc = parse_asset_update_member(c, field, u);
+        } else if (json_key_is(key, key_len, "id")) {
+            if (json_scan_int(c, &u->id) != 0) rc = json_skip_value(c);
+        } else {
+            rc = json_skip_value(c);
+        }
+        if (rc != 0) return -1;
+
+        int more = json_next(c, '}');
+        if (more < 0) return -1;
+        if (!more) return 0;
+    }
+}
+
+static void apply_asset_update(const asset_update_t *u)
+{
+    if (u->id < 0) return;
+    int id = u->id;
+    asset_t *asset = find_asset_by_id(id);
+    int new_asset = 0;
+    if (!asset) {
+        if (asset_count >= MAX_ASSETS) return;
+        asset = &assets[asset_count++];
+        init_asset_defaults(asset, id);
+        asset->cfg.enabled = 0;
+        new_asset = 1;
+    }
+
+    int restyle = 0;
+    int relayout = 0;
+    int rerange = 0;
+    int recreate = 0;
+    int text_change = 0;
+    int type_changed = 0;
+
+    int enabled_flag = asset->cfg.enabled;
+    if (u->fields & ASSET_UPD_ENABLED) {
+        enabled_flag = u->enabled ? 1 : 0;
+    }
+
+    if (u->fields & ASSET_UPD_TYPE) {
+        if (u->type != asset->cfg.type) {
+            asset->cfg.type = u->type;
+            type_changed = 1;
+        }
+    }
+
+    int value_index_seen = 0;
+    if (u->fields & ASSET_UPD_VALUE_INDEX) {
+        int idx = clamp_value_slot(u->value_index);
+        if (idx != asset->cfg.value_index) {
+            asset->cfg.value_index = idx;
+        }
+        value_index_seen = 1;
+    }
+
+    if (u->fields & ASSET_UPD_TEXT_INDEX) {
+        int idx = clamp_int(u->text_index, -1, TOTAL_TEXT_COUNT - 1);
+        if (idx != asset->cfg.text_index) {
+            asset->cfg.text_index = idx;
+            text_change = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_TEXT_INDICES) {
+        int indices_tmp[ASSET_INDEX_MAX] = {0};
+        int idx_count = u->text_indices_count;
+        for (int i = 0; i < idx_count; i++) {
+            indices_tmp[i] = u->text_indices[i];
+            if (indices_tmp[i] >= 0) {
+                indices_tmp[i] = clamp_int(indices_tmp[i], 0, TOTAL_TEXT_COUNT - 1);
+            }
+        }
+        if (idx_count != asset->cfg.text_indices_count || memcmp(indices_tmp, asset->cfg.text_indices, sizeof(int) * (size_t)idx_count) != 0) {
+            memcpy(asset->cfg.text_indices, indices_tmp, sizeof(int) * (size_t)idx_count);
+            asset->cfg.text_indices_count = idx_count;
+            text_change = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_VALUE_INDICES) {
+        int value_indices_tmp[ASSET_INDEX_MAX] = {0};
+        int value_idx_count = u->value_indices_count;
+        for (int i = 0; i < value_idx_count; i++) {
+            value_indices_tmp[i] = u->value_indices[i];
+            if (value_indices_tmp[i] >= 0) {
+                value_indices_tmp[i] = clamp_value_slot(value_indices_tmp[i]);
+            }
+        }
+        if (value_idx_count != asset->cfg.value_indices_count ||
+            memcmp(value_indices_tmp, asset->cfg.value_indices, sizeof(int) * (size_t)value_idx_count) != 0) {
+            memcpy(asset->cfg.value_indices, value_indices_tmp, sizeof(int) * (size_t)value_idx_count);
+            asset->cfg.value_indices_count = value_idx_count;
+            text_change = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_TEXT_INLINE) {
+        int inline_flag = u->text_inline ? 1 : 0;
+        if (inline_flag != asset->cfg.text_inline) {
+            asset->cfg.text_inline = inline_flag;
+            text_change = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_INLINE_SEPARATOR) {
+        if (strcmp(u->inline_separator, asset->cfg.inline_separator) != 0) {
+            memcpy(asset->cfg.inline_separator, u->inline_separator, sizeof(asset->cfg.inline_separator));
+            text_change = 1;
+        }
+    }
+
+    if ((type_changed || new_asset) && asset->cfg.type == ASSET_TEXT && !value_index_seen && asset->cfg.value_indices_count == 0) {
+        asset->cfg.value_index = -1;
+    }
+
+    if (u->fields & ASSET_UPD_ROUNDED_OUTLINE) {
+        int outline_flag = u->rounded_outline ? 1 : 0;
+        if (outline_flag != asset->cfg.rounded_outline) {
+            asset->cfg.rounded_outline = outline_flag;
+            recreate = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_LABEL) {
+        memcpy(asset->cfg.label, u->label, sizeof(asset->cfg.label));
+        text_change = 1;
+    }
+
+    if (u->fields & ASSET_UPD_ORIENTATION) {
+        if (u->orientation != asset->cfg.orientation) {
+            asset->cfg.orientation = u->orientation;
+            relayout = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_BAR_COLOR) {
+        if (asset->cfg.type != ASSET_TEXT && asset->cfg.color != u->bar_color) {
+            asset->cfg.color = u->bar_color;
+            restyle = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_TEXT_COLOR) {
+        if (asset->cfg.text_color != u->text_color) {
+            asset->cfg.text_color = u->text_color;
+            restyle = 1;
+            text_change = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_BACKGROUND) {
+        int bg = clamp_int(u->background, -1, (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0])) - 1);
+        if (asset->cfg.bg_style != bg) {
+            asset->cfg.bg_style = bg;
+            restyle = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_BACKGROUND_OPACITY) {
+        int opa = clamp_int(u->background_opacity, 0, 100);
+        if (asset->cfg.bg_opacity_pct != opa) {
+            asset->cfg.bg_opacity_pct = opa;
+            restyle = 1;
+        }
+    }
+
+    if (u->fields & ASSET_UPD_SEGMENTS) {
+        int segs = clamp_int(u->segments, 0, 64);
+        if (asset->cfg.segments != segs) {
+            asset->cfg.segments = segs;
+            if (asset->cfg.type == ASSET_BAR) g_hot.last_pct[asset_slot(asset)] = -1;
+            if (asset->obj) lv_obj_invalidate(asset->obj);
+        }
+    }
+
+    if (u->fields & ASSET_UPD_X) {
+        if (asset->cfg.x != u->x) {
+            asset->cfg.x = u->x;
+            relayout = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_Y) {
+        if (asset->cfg.y != u->y) {
+            asset->cfg.y = u->y;
+            relayout = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_WIDTH) {
+        if (asset->cfg.width != u->width) {
+            asset->cfg.width = u->width;
+            relayout = 1;
+            recreate = asset->cfg.type != ASSET_BAR ? 1 : recreate;
+        }
+    }
+    if (u->fields & ASSET_UPD_HEIGHT) {
+        if (asset->cfg.height != u->height) {
+            asset->cfg.height = u->height;
+            relayout = 1;
+            recreate = asset->cfg.type != ASSET_BAR ? 1 : recreate;
+        }
+    }
+    if (u->fields & ASSET_UPD_MIN) {
+        if (asset->cfg.min != u->min) {
+            asset->cfg.min = u->min;
+            rerange = 1;
+        }
+    }
+    if (u->fields & ASSET_UPD_MAX) {
+        if (asset->cfg.max != u->max) {
+            asset->cfg.max = u->max;
+            rerange = 1;
+        }
+    }
+
+    int enabled_change = (enabled_flag != asset->cfg.enabled);
+    asset->cfg.enabled = enabled_flag;
+    if (relayout || recreate || enabled_change || type_changed) g_region_replan = 1;
+    mark_asset_refresh(asset);
+    // structural changes invalidate every hidden copy, not just the live one
+    if (recreate) asset_visual_drop_parked(asset);
+
+    if (!asset->cfg.enabled) {
+        asset_visual_park(asset);
+        return;
+    }
+
+    if (!recreate && (!asset->obj || type_changed) && asset_visual_unpark(asset)) {
+        // the pooled objects may predate position, range or label changes
+        layout_asset(asset);
+        if (asset->cfg.type == ASSET_BAR) g_hot.last_pct[asset_slot(asset)] = -1;
+        restyle = 1;
+        text_change = 1;
+    } else if (!asset->obj || recreate || enabled_change || type_changed) {
+        if (type_changed && !recreate) asset_visual_park(asset);
+        create_asset_visual(asset);
+        restyle = 1;
+        relayout = 0;
+        rerange = 1;
+        text_change = 1;
+    } else {
+        if (relayout) layout_asset(asset);
+
+        if (rerange && asset->cfg.type == ASSET_BAR) {
+            lv_bar_set_range(asset->obj, 0, 100);
+            g_hot.last_pct[asset_slot(asset)] = -1;
+        } else if (rerange && asset->cfg.type == ASSET_GRAPH && !restyle) {
+            graph_redraw(asset);
+        } else if (rerange && asset->cfg.type == ASSET_GAUGE && !restyle) {
+            gauge_redraw(asset);
+        }
+    }
+
+    if (restyle) {
+        apply_asset_styles(asset);
+    }
+
+    if (text_change) {
+        int wants_label = (asset->cfg.label[0] != '\0') || (asset->cfg.text_index >= 0);
+        int label_created = 0;
+        if (asset->cfg.type != ASSET_TEXT) {
+            if (wants_label && !asset->label_obj) {
+                maybe_attach_asset_label(asset);
+                label_created = asset->label_obj != NULL;
+            } else if (!wants_label && asset->label_obj) {
+                lv_obj_del(asset->label_obj);
+                asset->label_obj = NULL;
+                layout_bar_asset(asset);
+            }
+        }
+        label_cache_reset(asset);
+        asset->label_extent_w = -1;
+        if (label_created) {
+            apply_asset_styles(asset);
+        }
+    }
+}
+
+/*
+ * asset_updates are staged, not applied while a datagram is parsed: each id
+ * keeps one pending record whose field mask is the union of everything
+ * received since the last channel push, later values winning field by field.
+ * asset_updates_commit() then runs apply_asset_update once per asset, so a
+ * burst that retints or moves the same asset ten times costs one restyle,
+ * relayout or visual swap, and a toggle that ends where it started costs
+ * nothing. Records commit in first-arrival order, which keeps the slot order
+ * of assets created on the fly.
+ */
+static asset_update_t g_update_pending[ASSET_POOL_MAX];
+static int g_update_pending_count = 0;
+
+static void asset_updates_commit(void)
+{
+    int n = g_update_pending_count;
+    g_update_pending_count = 0;
+    for (int i = 0; i < n; i++) apply_asset_update(&g_update_pending[i]);
+    if (n > 0) g_snapshot_dirty = 1;
+}
+
+static void asset_update_merge(asset_update_t *dst, const asset_update_t *src)
+{
+    uint32_t f = src->fields;
+    dst->fields |= f;
+    if (f & ASSET_UPD_ENABLED) dst->enabled = src->enabled;
+    if (f & ASSET_UPD_TYPE) dst->type = src->type;
+    if (f & ASSET_UPD_VALUE_INDEX) dst->value_index = src->value_index;
+    if (f & ASSET_UPD_TEXT_INDEX) dst->text_index = src->text_index;
+    if (f & ASSET_UPD_TEXT_INDICES) {
+        memcpy(dst->text_indices, src->text_indices, sizeof(dst->text_indices));
+        dst->text_indices_count = src->text_indices_count;
+    }
+    if (f & ASSET_UPD_VALUE_INDICES) {
+        memcpy(dst->value_indices, src->value_indices, sizeof(dst->value_indices));
+        dst->value_indices_count = src->value_indices_count;
+    }
+    if (f & ASSET_UPD_TEXT_INLINE) dst->text_inline = src->text_inline;
+    if (f & ASSET_UPD_INLINE_SEPARATOR) memcpy(dst->inline_separator, src->inline_separator, sizeof(dst->inline_separator));
+    if (f & ASSET_UPD_ROUNDED_OUTLINE) dst->rounded_outline = src->rounded_outline;
+    if (f & ASSET_UPD_LABEL) memcpy(dst->label, src->label, sizeof(dst->label));
+    if (f & ASSET_UPD_ORIENTATION) dst->orientation = src->orientation;
+    if (f & ASSET_UPD_BAR_COLOR) dst->bar_color = src->bar_color;
+    if (f & ASSET_UPD_TEXT_COLOR) dst->text_color = src->text_color;
+    if (f & ASSET_UPD_BACKGROUND) dst->background = src->background;
+    if (f & ASSET_UPD_BACKGROUND_OPACITY) dst->background_opacity = src->background_opacity;
+    if (f & ASSET_UPD_SEGMENTS) dst->segments = src->segments;
+    if (f & ASSET_UPD_X) dst->x = src->x;
+    if (f & ASSET_UPD_Y) dst->y = src->y;
+    if (f & ASSET_UPD_WIDTH) dst->width = src->width;
+    if (f & ASSET_UPD_HEIGHT) dst->height = src->height;
+    if (f & ASSET_UPD_MIN) dst->min = src->min;
+    if (f & ASSET_UPD_MAX) dst->max = src->max;
+}
+
+static void asset_update_stage(const asset_update_t *u)
+{
+    if (u->id < 0) return;
+    for (int i = 0; i < g_update_pending_count; i++) {
+        if (g_update_pending[i].id == u->id) {
+            asset_update_merge(&g_update_pending[i], u);
+            return;
+        }
+    }
+    // more distinct ids than records: apply what is staged to make room
+    if (g_update_pending_count >= ASSET_POOL_MAX) asset_updates_commit();
+    g_update_pending[g_update_pending_count++] = *u;
+}
+
+static int parse_udp_asset_updates(json_cursor_t *c)
+{
+    if (json_peek(c) != '[') return json_skip_value(c);
+    c->p++;
+    if (json_peek(c) == ']') {
+        c->p++;
+        return 0;
+    }
+    for (;;) {
+        if (json_peek(c) == '{') {
+            asset_update_t update;
+            if (parse_asset_update_object(c, &update) != 0) return -1;
+            asset_update_stage(&update);
+        } else if (json_skip_value(c) != 0) {
+            return -1;
+        }
+        int more = json_next(c, ']');
+        if (more <= 0) return more;
+    }
+}
+
+// One pass over a datagram; a syntax error stops at that point, keeping what was applied
+// -------------------------
+// Packet-to-pixel latency
+// -------------------------
+/*
+ * With latency_stats every value/text slot that a datagram (or the shm
+ * transport) turns dirty is stamped with the monotonic receive time, or with
+ * the sender's "ts" when the packet carries one. A push moves the stamps of
+ * the slots it consumes into a pending batch, but only when it actually
+ * requested a redraw; the first flush and the MI_RGN_UpdateCanvas return then
+ * close the batch. Samples land in log-bucketed histograms (microseconds, four
+ * buckets per power of two) that the stats widget shows and a {"latency":...}
+ * query returns to its sender.
+ */
+#define LAT_HIST_SUB 4
+#define LAT_HIST_BUCKETS (32 * LAT_HIST_SUB)
+#define LAT_PENDING_MAX 64
+
+typedef enum {
+    LAT_STAGE_APPLY = 0,  // receive -> assets updated
+    LAT_STAGE_FLUSH,      // receive -> first pixels converted into the canvas
+    LAT_STAGE_COMMIT,     // receive -> MI_RGN_UpdateCanvas returned
+    LAT_STAGE_COUNT
+} lat_stage_t;
+
+typedef struct {
+    uint32_t buckets[LAT_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} lat_hist_t;
+
+static const char *const g_lat_stage_names[LAT_STAGE_COUNT] = {"apply", "flush", "commit"};
+static lat_hist_t g_lat_hist[LAT_STAGE_COUNT];
+static uint64_t g_lat_value_stamp[64];  // per slot, valid while its dirty bit is set
+static uint64_t g_lat_text_stamp[64];
+static uint64_t g_lat_pending[LAT_PENDING_MAX];
+static int g_lat_pending_count = 0;
+static int g_lat_batch_start = 0;      // first pending entry of the push in progress
+static uint64_t g_lat_flush_us = 0;    // first flush after the pending batch, 0 = none yet
+static uint64_t g_lat_rx_us = 0;       // receive time of the datagram being parsed
+static uint64_t g_lat_sender_us = 0;   // "ts" of the datagram being parsed, 0 = absent
+static int g_lat_query = 0;            // 1 = report, 2 = report and reset
+static int g_udp_stats_query = 0;      // {"rx_stats":...} seen in the datagram being parsed
+static uint32_t g_refr_requests = 0;   // LVGL refresh requests, bumped by the display event hook
+
+static uint64_t monotonic_us64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000ULL) + (uint64_t)(ts.tv_nsec / 1000ULL);
+}
+
+static int lat_bucket(uint32_t us)
+{
+    if (us < LAT_HIST_SUB) return (int)us;
+    int msb = 31 - __builtin_clz(us);
+    return LAT_HIST_SUB + (msb - 2) * LAT_HIST_SUB + (int)((us >> (msb - 2)) & (LAT_HIST_SUB - 1));
+}
+
+static uint32_t lat_bucket_upper(int b)
+{
+    if (b < LAT_HIST_SUB) return (uint32_t)b;
+    int msb = (b - LAT_HIST_SUB) / LAT_HIST_SUB + 2;
+    uint64_t lower = (uint64_t)(LAT_HIST_SUB + (b - LAT_HIST_SUB) % LAT_HIST_SUB) << (msb - 2);
+    uint64_t upper = lower + (1ull << (msb - 2)) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+static void lat_record(lat_stage_t stage, uint64_t now_us, uint64_t stamp_us)
+{
+    if (stamp_us == 0) return;
+    uint64_t d = now_us > stamp_us ? now_us - stamp_us : 0;
+    uint32_t us = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+    lat_hist_t *h = &g_lat_hist[stage];
+    h->buckets[lat_bucket(us)]++;
+    h->count++;
+    if (us > h->max_us) h->max_us = us;
+}
+
+// Upper bound of the bucket holding the given percentile, capped at the max
+static uint32_t lat_percentile(const lat_hist_t *h, int pct)
+{
+    if (h->count == 0) return 0;
+    uint64_t rank = ((uint64_t)h->count * (uint64_t)pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < LAT_HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = lat_bucket_upper(b);
+            return upper < h->max_us ? upper : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+static void latency_reset(void)
+{
+    memset(g_lat_hist, 0, sizeof(g_lat_hist));
+    g_lat_pending_count = 0;
+    g_lat_flush_us = 0;
+}
+
+// Stamps the slots that turned dirty since the masks were sampled
+static void latency_stamp_slots(uint64_t value_before, uint64_t text_before, uint64_t stamp_us)
+{
+    if (!g_cfg.latency_stats) return;
+    for (uint64_t m = g_value_dirty & ~value_before; m; m &= m - 1) g_lat_value_stamp[__builtin_ctzll(m)] = stamp_us;
+    for (uint64_t m = g_text_dirty & ~text_before; m; m &= m - 1) g_lat_text_stamp[__builtin_ctzll(m)] = stamp_us;
+}
+
+static void lat_pending_add(uint64_t stamp_us)
+{
+    if (g_lat_pending_count < LAT_PENDING_MAX) g_lat_pending[g_lat_pending_count++] = stamp_us;
+}
+
+// Call right before update_assets_from_channels consumes the dirty slots
+static void latency_push_begin(void)
+{
+    if (!g_cfg.latency_stats) return;
+    g_lat_batch_start = g_lat_pending_count;
+    for (uint64_t m = g_value_dirty; m; m &= m - 1) lat_pending_add(g_lat_value_stamp[__builtin_ctzll(m)]);
+    for (uint64_t m = g_text_dirty; m; m &= m - 1) lat_pending_add(g_lat_text_stamp[__builtin_ctzll(m)]);
+}
+
+// Keeps the push's stamps only if it invalidated something; refr_before is
+// g_refr_requests sampled before the push
+static void latency_push_end(uint32_t refr_before)
+{
+    if (!g_cfg.latency_stats) return;
+    if (g_refr_requests == refr_before) {
+        g_lat_pending_count = g_lat_batch_start;
+        return;
+    }
+    uint64_t now = monotonic_us64();
+    for (int i = g_lat_batch_start; i < g_lat_pending_count; i++) lat_record(LAT_STAGE_APPLY, now, g_lat_pending[i]);
+}
+
+static void latency_flush(void)
+{
+    if (g_lat_pending_count > 0 && g_lat_flush_us == 0) g_lat_flush_us = monotonic_us64();
+}
+
+// Call once the canvas commit returned
+static void latency_commit(void)
+{
+    if (g_lat_pending_count == 0) return;
+    uint64_t now = monotonic_us64();
+    uint64_t flushed = g_lat_flush_us ? g_lat_flush_us : now;
+    for (int i = 0; i < g_lat_pending_count; i++) {
+        lat_record(LAT_STAGE_FLUSH, flushed, g_lat_pending[i]);
+        lat_record(LAT_STAGE_COMMIT, now, g_lat_pending[i]);
+    }
+    g_lat_pending_count = 0;
+    g_lat_flush_us = 0;
+}
+
+static int latency_format(char *buf, size_t buf_sz, int json)
+{
+    int off = 0;
+    for (int i = 0; i < LAT_STAGE_COUNT && off < (int)buf_sz; i++) {
+        const lat_hist_t *h = &g_lat_hist[i];
+        uint32_t p50 = lat_percentile(h, 50);
+        uint32_t p99 = lat_percentile(h, 99);
+        if (json) {
+            off += snprintf(buf + off, buf_sz - (size_t)off, "%s\"%s\":{\"n\":%u,\"p50\":%u,\"p99\":%u,\"max\":%u}",
+                            i ? "," : "", g_lat_stage_names[i], h->count, p50, p99, h->max_us);
+        } else {
+            off += snprintf(buf + off, buf_sz - (size_t)off, "%s%s %u/%u/%u",
+                            i ? " | " : "", g_lat_stage_names[i], p50, p99, h->max_us);
+        }
+    }
+    return off;
+}
+
+// Answers a {"latency":...} query with the histogram summary in microseconds
+static void latency_reply(const struct sockaddr *from, socklen_t from_len)
+{
+    int query = g_lat_query;
+    g_lat_query = 0;
+    if (!g_cfg.latency_stats || !from || from_len == 0 || udp_sock < 0) return;
+    char buf[512];
+    int off = snprintf(buf, sizeof(buf), "{\"latency\":{");
+    off += latency_format(buf + off, sizeof(buf) - (size_t)off, 1);
+    if (off < (int)sizeof(buf) - 3) off += snprintf(buf + off, sizeof(buf) - (size_t)off, "}}");
+    if (off > (int)sizeof(buf) - 1) off = (int)sizeof(buf) - 1;
+    if (sendto(udp_sock, buf, (size_t)off, MSG_DONTWAIT, from, from_len) < 0) {
+        fprintf(stderr, "latency: reply failed: %s\n", strerror(errno));
+    }
+    if (query == 2) latency_reset();
+}
+
+// Returns -1 for a malformed payload; keys before the error are still applied
+static int parse_udp_packet(const char *buf, size_t len)
+{
+    json_cursor_t c = {buf, buf + len};
+    if (json_expect(&c, '{') != 0) return -1;
+    if (json_peek(&c) == '}') return 0;
+    for (;;) {
+        const char *key;
+        size_t key_len;
+        if (json_scan_string(&c, &key, &key_len) != 0 || json_expect(&c, ':') != 0) return -1;
+        int rc;
+        if (json_key_is(key, key_len, "values")) {
+            rc = parse_udp_values(&c);
+        } else if (json_key_is(key, key_len, "texts")) {
+            rc = parse_udp_texts(&c);
+        } else if (json_key_is(key, key_len, "asset_updates")) {
+            rc = parse_udp_asset_updates(&c);
+        } else if (json_key_is(key, key_len, "ts")) {
+            double ts = 0.0;
+            rc = json_scan_number(&c, &ts) == 0 ? 0 : json_skip_value(&c);
+            if (rc == 0 && ts > 0.0) g_lat_sender_us = (uint64_t)ts;
+        } else if (json_key_is(key, key_len, "latency")) {
+            const char *str;
+            size_t str_len;
+            g_lat_query = 1;
+            if (json_peek(&c) == '"') {
+                rc = json_scan_string(&c, &str, &str_len);
+                if (rc == 0 && json_key_is(str, str_len, "reset")) g_lat_query = 2;
+            } else {
+                rc = json_skip_value(&c);
+            }
+        } else if (json_key_is(key, key_len, "rx_stats")) {
+            g_udp_stats_query = 1;
+            rc = json_skip_value(&c);
+        } else {
+            rc = json_skip_value(&c);
+        }
+        if (rc != 0) return -1;
+        int next = json_next(&c, '}');
+        if (next != 1) return next == 0 ? 0 : -1;
+    }
+}
+
+// -------------------------
+// Binary UDP frames
+// -------------------------
+/*
+ * Compact alternative to the JSON payload (see CONTRACT.md). All integers are
+ * little-endian:
+ *   'W' 'B' version flags value_mask text_mask
+ *   float32 per set value_mask bit, then u8 length + bytes per set text_mask bit
+ *   if flags & OSD_BIN_FLAG_ASSETS: u8 count, then per update
+ *     u8 id, u32 field mask (ASSET_UPD_* bits), fields in ascending bit order
+ * Frames are parsed in place without allocation; a short or unknown-version
+ * frame is dropped before anything is applied.
+ */
+#define OSD_BIN_MAGIC0 'W'
+#define OSD_BIN_MAGIC1 'B'
+#define OSD_BIN_VERSION 1
+#define OSD_BIN_FLAG_ASSETS 0x01
+#define OSD_BIN_FLAG_SEQ 0x02     // u8 src + u32 seq follow the masks
+#define OSD_BIN_MAX_UPDATES 8
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    int err;
+} bin_reader_t;
+
+static uint32_t bin_u8(bin_reader_t *r)
+{
+    if (r->err || r->p + 1 > r->end) {
+        r->err = 1;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint32_t bin_u16(bin_reader_t *r)
+{
+    uint32_t lo = bin_u8(r);
+    return lo | (bin_u8(r) << 8);
+}
+
+static uint32_t bin_u32(bin_reader_t *r)
+{
+    uint32_t lo = bin_u16(r);
+    return lo | (bin_u16(r) << 16);
+}
+
+static float bin_f32(bin_reader_t *r)
+{
+    uint32_t bits = bin_u32(r);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// u8 length + bytes; returns the byte span, truncation is up to the caller
+static const char *bin_str(bin_reader_t *r, size_t *len)
+{
+    size_t n = bin_u8(r);
+    if (r->err || r->p + n > r->end) {
+        r->err = 1;
+        *len = 0;
+        return NULL;
+    }
+    const char *s = (const char *)r->p;
+    r->p += n;
+    *len = n;
+    return s;
+}
+
+static void bin_str_into(bin_reader_t *r, char *buf, size_t buf_sz)
+{
+    size_t len = 0;
+    const char *s = bin_str(r, &len);
+    if (!s) return;
+    if (len > buf_sz - 1) len = buf_sz - 1;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+}
+
+static void bin_index_list(bin_reader_t *r, int *out, int *out_count)
+{
+    int n = (int)bin_u8(r);
+    int kept = 0;
+    for (int i = 0; i < n && !r->err; i++) {
+        int v = (int8_t)bin_u8(r);
+        if (kept < ASSET_INDEX_MAX) out[kept++] = v;
+    }
+    *out_count = kept;
+}
+
+static void bin_read_asset_update(bin_reader_t *r, asset_update_t *u)
+{
+    memset(u, 0, sizeof(*u));
+    u->id = (int)bin_u8(r);
+    u->fields = bin_u32(r);
+    uint32_t f = u->fields;
+    if (f & ASSET_UPD_ENABLED) u->enabled = bin_u8(r) != 0;
+    if (f & ASSET_UPD_TYPE) {
+        uint8_t t = bin_u8(r);
+        u->type = t == 4 ? ASSET_IMAGE : t == 3 ? ASSET_GAUGE : (t == 2 ? ASSET_GRAPH : (t ? ASSET_TEXT : ASSET_BAR));
+    }
+    if (f & ASSET_UPD_VALUE_INDEX) u->value_index = (int8_t)bin_u8(r);
+    if (f & ASSET_UPD_TEXT_INDEX) u->text_index = (int8_t)bin_u8(r);
+    if (f & ASSET_UPD_TEXT_INDICES) bin_index_list(r, u->text_indices, &u->text_indices_count);
+    if (f & ASSET_UPD_VALUE_INDICES) bin_index_list(r, u->value_indices, &u->value_indices_count);
+    if (f & ASSET_UPD_TEXT_INLINE) u->text_inline = bin_u8(r) != 0;
+    if (f & ASSET_UPD_INLINE_SEPARATOR) bin_str_into(r, u->inline_separator, sizeof(u->inline_separator));
+    if (f & ASSET_UPD_ROUNDED_OUTLINE) u->rounded_outline = bin_u8(r) != 0;
+    if (f & ASSET_UPD_LABEL) bin_str_into(r, u->label, sizeof(u->label));
+    if (f & ASSET_UPD_ORIENTATION) {
+        uint32_t o = bin_u8(r);
+        u->orientation = o == 1 ? ORIENTATION_LEFT : (o == 2 ? ORIENTATION_CENTER : ORIENTATION_RIGHT);
+    }
+    if (f & ASSET_UPD_BAR_COLOR) u->bar_color = bin_u32(r) & 0xFFFFFF;
+    if (f & ASSET_UPD_TEXT_COLOR) u->text_color = bin_u32(r) & 0xFFFFFF;
+    if (f & ASSET_UPD_BACKGROUND) u->background = (int8_t)bin_u8(r);
+    if (f & ASSET_UPD_BACKGROUND_OPACITY) u->background_opacity = (int)bin_u8(r);
+    if (f & ASSET_UPD_SEGMENTS) u->segments = (int)bin_u8(r);
+    if (f & ASSET_UPD_X) u->x = (int16_t)bin_u16(r);
+    if (f & ASSET_UPD_Y) u->y = (int16_t)bin_u16(r);
+    if (f & ASSET_UPD_WIDTH) u->width = (int16_t)bin_u16(r);
+    if (f & ASSET_UPD_HEIGHT) u->height = (int16_t)bin_u16(r);
+    if (f & ASSET_UPD_MIN) u->min = bin_f32(r);
+    if (f & ASSET_UPD_MAX) u->max = bin_f32(r);
+}
+
+static int parse_udp_binary(const uint8_t *buf, size_t len)
+{
+    bin_reader_t r = {buf + 2, buf + len, 0};
+    if (bin_u8(&r) != OSD_BIN_VERSION) return -1;
+    uint32_t flags = bin_u8(&r);
+    uint32_t value_mask = bin_u8(&r);
+    uint32_t text_mask = bin_u8(&r);
+    if (flags & OSD_BIN_FLAG_SEQ) {
+        bin_u8(&r);   // src and seq were checked by parse_udp_datagram
+        bin_u32(&r);
+    }
+
+    // Decode everything first so a truncated frame changes nothing
+    float values[UDP_VALUE_COUNT];
+    const char *texts[UDP_TEXT_COUNT];
+    size_t text_lens[UDP_TEXT_COUNT];
+    asset_update_t updates[OSD_BIN_MAX_UPDATES];
+    int update_count = 0;
+
+    for (int i = 0; i < UDP_VALUE_COUNT; i++) {
+        if (value_mask & (1u << i)) values[i] = bin_f32(&r);
+    }
+    for (int i = 0; i < UDP_TEXT_COUNT; i++) {
+        if (text_mask & (1u << i)) texts[i] = bin_str(&r, &text_lens[i]);
+    }
+    if (flags & OSD_BIN_FLAG_ASSETS) {
+        int n = (int)bin_u8(&r);
+        if (n > OSD_BIN_MAX_UPDATES) r.err = 1;
+        for (int i = 0; i < n && !r.err; i++) bin_read_asset_update(&r, &updates[update_count++]);
+    }
+    if (r.err) return -1;
+
+    for (int i = 0; i < UDP_VALUE_COUNT; i++) {
+        if ((value_mask & (1u << i)) && udp_value_writable(i)) set_udp_value(i, values[i]);
+    }
+    for (int i = 0; i < UDP_TEXT_COUNT; i++) {
+        if (!(text_mask & (1u << i)) || !udp_text_writable(i)) continue;
+        set_udp_text(i, texts[i], text_lens[i]);
+    }
+    for (int i = 0; i < update_count; i++) asset_update_stage(&updates[i]);
+    return 0;
+}
+
+static const char *get_asset_text(const asset_t *asset)
+{
+    if (asset->cfg.text_index >= 0 && asset->cfg.text_index < TOTAL_TEXT_COUNT) {
+        const char *t = get_text_channel(asset->cfg.text_index);
+        if (t[0] != '\0') return t;
+    }
+    if (asset->cfg.label[0] != '\0') return asset->cfg.label;
+    return "";
+}
+
+static void format_value_text(double v, char *buf, size_t buf_sz)
+{
+    if (!buf || buf_sz == 0) return;
+    double rounded = (v >= 0.0) ? (v + 0.5) : (v - 0.5);
+    double diff = v - rounded;
+    if (diff < 0.0) diff = -diff;
+    if (diff < 0.005) {
+        snprintf(buf, buf_sz, "%.0f", v);
+        return;
+    }
+    double abs_v = v < 0.0 ? -v : v;
+    if (abs_v < 10.0) {
+        snprintf(buf, buf_sz, "%.2f", v);
+    } else if (abs_v < 100.0) {
+        snprintf(buf, buf_sz, "%.1f", v);
+    } else {
+        snprintf(buf, buf_sz, "%.0f", v);
+    }
+}
+
+static void append_entry_separator(const asset_cfg_t *cfg, char *buf, size_t buf_sz, size_t *written)
+{
+    if (!cfg || !buf || !written) return;
+    if (*written >= buf_sz - 1) return;
+    if (cfg->text_inline) {
+        const char *sep = cfg->inline_separator;
+        size_t sep_len = strlen(sep);
+        if (sep_len == 0) {
+            buf[(*written)++] = ' ';
+            return;
+        }
+        buf[(*written)++] = ' ';
+        size_t to_copy = sep_len < buf_sz - 1 - *written ? sep_len : buf_sz - 1 - *written;
+        memcpy(buf + *written, sep, to_copy);
+        *written += to_copy;
+        if (*written < buf_sz - 1) {
+            buf[(*written)++] = ' ';
+        }
+    } else {
+        buf[(*written)++] = '\n';
+    }
+}
+
+static void append_text_value_entry(const asset_t *asset, const char *text, int value_idx, char *buf, size_t buf_sz, size_t *written)
+{
+    if (!asset || !buf || !written) return;
+    const asset_cfg_t *cfg = &asset->cfg;
+    int clamped_value_idx = (value_idx >= 0 && value_idx == clamp_value_slot(value_idx)) ? value_idx : -1;
+    const char *t = text ? text : "";
+    bool has_text = t[0] != '\0';
+    bool has_value = clamped_value_idx >= 0;
+    if (!has_text && !has_value) return;
+
+    if (*written > 0) {
+        append_entry_separator(cfg, buf, buf_sz, written);
+    }
+
+    if (has_text) {
+        size_t len = strnlen(t, TEXT_SLOT_CAP_MAX);
+        size_t to_copy = len < buf_sz - 1 - *written ? len : buf_sz - 1 - *written;
+        memcpy(buf + *written, t, to_copy);
+        *written += to_copy;
+        if (*written < buf_sz - 1) {
+            buf[(*written)++] = ':';
+            if (has_value && *written < buf_sz - 1) {
+                buf[(*written)++] = ' ';
+            }
+        }
+    }
+
+    if (has_value && *written < buf_sz - 1) {
+        char val_buf[64];
+        format_value_text(get_value_channel(clamped_value_idx), val_buf, sizeof(val_buf));
+        size_t len = strnlen(val_buf, sizeof(val_buf) - 1);
+        size_t to_copy = len < buf_sz - 1 - *written ? len : buf_sz - 1 - *written;
+        memcpy(buf + *written, val_buf, to_copy);
+        *written += to_copy;
+    }
+}
+
+static void compose_asset_text(const asset_t *asset, char *buf, size_t buf_sz)
+{
+    if (!buf || buf_sz == 0) return;
+    buf[0] = '\0';
+    if (!asset) return;
+
+    if (asset->cfg.type == ASSET_TEXT) {
+        size_t written = 0;
+        if (asset->cfg.text_indices_count > 0) {
+            for (int i = 0; i < asset->cfg.text_indices_count; i++) {
+                int idx = asset->cfg.text_indices[i];
+                const char *t = "";
+                if (idx >= 0 && idx < TOTAL_TEXT_COUNT) {
+                    t = get_text_channel(idx);
+                }
+                int value_idx = (i < asset->cfg.value_indices_count) ? asset->cfg.value_indices[i] : -1;
+                append_text_value_entry(asset, t, value_idx, buf, buf_sz, &written);
+                if (written >= buf_sz - 1) break;
+            }
+        }
+
+        if (written == 0 && asset->cfg.text_index >= 0 && asset->cfg.text_index < TOTAL_TEXT_COUNT) {
+            const char *t = get_text_channel(asset->cfg.text_index);
+            int value_idx = (asset->cfg.value_indices_count > 0) ? asset->cfg.value_indices[0] : asset->cfg.value_index;
+            append_text_value_entry(asset, t, value_idx, buf, buf_sz, &written);
+        }
+
+        if (written == 0 && asset->cfg.label[0] != '\0') {
+            int value_idx = (asset->cfg.value_indices_count > 0) ? asset->cfg.value_indices[0] : asset->cfg.value_index;
+            append_text_value_entry(asset, asset->cfg.label, value_idx, buf, buf_sz, &written);
+        }
+
+        if (written == 0) {
+            buf[0] = '\0';
+        } else {
+            buf[written] = '\0';
+        }
+        return;
+    }
+
+    const char *t = get_asset_text(asset);
+    strncpy(buf, t, buf_sz - 1);
+    buf[buf_sz - 1] = '\0';
+}
+
+// -------------------------
+// Frame profiler
+// -------------------------
+/*
+ * Built with PROFILE=1 (OSD_PROFILE) the loop times each stage in
+ * microseconds: datagram parsing, the channel push, LVGL rendering (the timer
+ * handler minus the flush conversion it drove), the flush conversion with its
+ * pixel count, and the canvas commit. Samples fold into one-second windows;
+ * the last complete window is dumped to stderr on SIGUSR1 and, with
+ * profile_stats, shown in the stats widget. Without the flag the PROF_* macros
+ * compile to nothing.
+ */
+typedef enum {
+    PROF_PARSE = 0,
+    PROF_UPDATE,
+    PROF_RENDER,
+    PROF_FLUSH,
+    PROF_COMMIT,
+    PROF_STAGE_COUNT
+} prof_stage_t;
+
+#if OSD_PROFILE_ENABLED
+#define PROF_WINDOW_MS 1000
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint64_t pixels;
+    uint64_t flushes;   // PROF_FLUSH: my_flush_cb calls, one per render pass
+} prof_acc_t;
+
+static const char *const g_prof_names[PROF_STAGE_COUNT] = {"parse", "update", "render", "flush", "commit"};
+static prof_acc_t g_prof_cur[PROF_STAGE_COUNT];
+static prof_acc_t g_prof_last[PROF_STAGE_COUNT];
+static uint64_t g_prof_window_us = 0;
+static uint64_t g_prof_frame_flush_us = 0;  // conversion time inside the running timer handler
+static uint64_t g_prof_frame_pixels = 0;
+static volatile sig_atomic_t g_prof_dump_requested = 0;
+
+static void prof_add(prof_stage_t stage, uint64_t us, uint64_t pixels)
+{
+    prof_acc_t *a = &g_prof_cur[stage];
+    uint32_t v = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    if (a->count == 0 || v < a->min_us) a->min_us = v;
+    if (v > a->max_us) a->max_us = v;
+    a->count++;
+    a->sum_us += v;
+    a->pixels += pixels;
+}
+
+// Rolls the window over once PROF_WINDOW_MS has passed
+static void prof_tick(uint64_t now_us)
+{
+    if (g_prof_window_us == 0) g_prof_window_us = now_us;
+    if (now_us - g_prof_window_us < (uint64_t)PROF_WINDOW_MS * 1000ULL) return;
+    memcpy(g_prof_last, g_prof_cur, sizeof(g_prof_last));
+    memset(g_prof_cur, 0, sizeof(g_prof_cur));
+    g_prof_window_us = now_us;
+}
+
+static int prof_format(char *buf, size_t buf_sz, const char *sep)
+{
+    int off = 0;
+    for (int i = 0; i < PROF_STAGE_COUNT && off < (int)buf_sz; i++) {
+        const prof_acc_t *a = &g_prof_last[i];
+        uint32_t avg = a->count ? (uint32_t)(a->sum_us / a->count) : 0;
+        off += snprintf(buf + off, buf_sz - (size_t)off, "%s%s %u/%u/%u x%u", i ? sep : "", g_prof_names[i],
+                        a->min_us, avg, a->max_us, a->count);
+        if (i == PROF_FLUSH && a->count && off < (int)buf_sz) {
+            uint64_t tenths = a->flushes * 10 / a->count;
+            off += snprintf(buf + off, buf_sz - (size_t)off, " %llupx %llu.%llu passes", (unsigned long long)(a->pixels / a->count),
+                            (unsigned long long)(tenths / 10), (unsigned long long)(tenths % 10));
+        }
+    }
+    return off;
+}
+
+static void prof_dump(void)
+{
+    char buf[512];
+    prof_format(buf, sizeof(buf), "\n  ");
+    fprintf(stderr, "profile (last %d ms, us min/avg/max xcount):\n  %s\n", PROF_WINDOW_MS, buf);
+}
+
+static void handle_sigusr1(int sig)
+{
+    (void)sig;
+    g_prof_dump_requested = 1;
+}
+
+#define PROF_BEGIN(var) uint64_t var = monotonic_us64()
+#define PROF_END(stage, var) prof_add((stage), monotonic_us64() - (var), 0)
+#else
+#define PROF_BEGIN(var) (void)0
+#define PROF_END(stage, var) (void)0
+#endif
+
+// Datagrams pulled per recvmmsg call; each slot holds one packet plus a terminator
+#define UDP_BATCH 8
+#define UDP_CTRL_LEN CMSG_SPACE(sizeof(uint32_t))
+static char udp_batch_bufs[UDP_BATCH][UDP_MAX_PACKET + 1];
+static char udp_batch_ctrl[UDP_BATCH][UDP_CTRL_LEN];
+static int udp_use_mmsg = 1;
+
+/*
+ * Receive-side accounting. oversized and kernel_drops are also written by the
+ * receive thread, so every field is touched with relaxed atomics. kernel_drops
+ * mirrors the socket's cumulative SO_RXQ_OVFL count, which the kernel attaches
+ * to a datagram only once something has been dropped.
+ */
+typedef struct {
+    uint32_t rx;            // datagrams handed to the parser
+    uint32_t kernel_drops;  // lost to a full socket buffer before we read them
+    uint32_t oversized;     // longer than UDP_MAX_PACKET, discarded unread
+    uint32_t parse_errors;  // malformed JSON or short/unknown binary frames
+    uint32_t ring_drops;    // rx_thread ring was full
+    uint32_t seq_drops;     // duplicate or out-of-order "seq" from a known "src"
+} udp_counters_t;
+
+static udp_counters_t g_udp_counters;
+
+static void udp_count(uint32_t *counter)
+{
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+static void udp_msg_init(struct msghdr *mh, struct iovec *iov, char *buf, struct sockaddr_storage *from, char *ctrl)
+{
+    memset(mh, 0, sizeof(*mh));
+    iov->iov_base = buf;
+    iov->iov_len = UDP_MAX_PACKET;
+    mh->msg_iov = iov;
+    mh->msg_iovlen = 1;
+    mh->msg_name = from;
+    mh->msg_namelen = sizeof(*from);
+    mh->msg_control = ctrl;
+    mh->msg_controllen = UDP_CTRL_LEN;
+}
+
+// Picks up the SO_RXQ_OVFL count and flags oversized datagrams; false = drop it
+static bool udp_msg_accept(struct msghdr *mh)
+{
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(mh); cm; cm = CMSG_NXTHDR(mh, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SO_RXQ_OVFL) continue;
+        uint32_t drops;
+        memcpy(&drops, CMSG_DATA(cm), sizeof(drops));
+        __atomic_store_n(&g_udp_counters.kernel_drops, drops, __ATOMIC_RELAXED);
+    }
+    if (mh->msg_flags & MSG_TRUNC) {
+        udp_count(&g_udp_counters.oversized);
+        return false;
+    }
+    return true;
+}
+
+static int udp_stats_format(char *buf, size_t buf_sz, int json)
+{
+    uint32_t rx = __atomic_load_n(&g_udp_counters.rx, __ATOMIC_RELAXED);
+    uint32_t kernel = __atomic_load_n(&g_udp_counters.kernel_drops, __ATOMIC_RELAXED);
+    uint32_t big = __atomic_load_n(&g_udp_counters.oversized, __ATOMIC_RELAXED);
+    uint32_t bad = __atomic_load_n(&g_udp_counters.parse_errors, __ATOMIC_RELAXED);
+    uint32_t ring = __atomic_load_n(&g_udp_counters.ring_drops, __ATOMIC_RELAXED);
+    uint32_t seq = __atomic_load_n(&g_udp_counters.seq_drops, __ATOMIC_RELAXED);
+    if (json) {
+        return snprintf(buf, buf_sz,
+                        "\"rx\":%u,\"kernel_drops\":%u,\"oversized\":%u,\"parse_errors\":%u,\"ring_drops\":%u,"
+                        "\"seq_drops\":%u",
+                        rx, kernel, big, bad, ring, seq);
+    }
+    return snprintf(buf, buf_sz, "rx %u | drop kern %u big %u bad %u ring %u seq %u", rx, kernel, big, bad, ring, seq);
+}
+
+// Answers a {"rx_stats":true} query with the receive counters
+static void udp_stats_reply(const struct sockaddr *from, socklen_t from_len)
+{
+    g_udp_stats_query = 0;
+    if (!from || from_len == 0 || udp_sock < 0) return;
+    char buf[256];
+    int off = snprintf(buf, sizeof(buf), "{\"rx_stats\":{");
+    off += udp_stats_format(buf + off, sizeof(buf) - (size_t)off, 1);
+    if (off < (int)sizeof(buf) - 3) off += snprintf(buf + off, sizeof(buf) - (size_t)off, "}}");
+    if (off > (int)sizeof(buf) - 1) off = (int)sizeof(buf) - 1;
+    if (sendto(udp_sock, buf, (size_t)off, MSG_DONTWAIT, from, from_len) < 0) {
+        fprintf(stderr, "rx_stats: reply failed: %s\n", strerror(errno));
+    }
+}
+
+// Binary frames are told apart from JSON by their first bytes
+static void parse_udp_datagram(const char *buf, size_t len, const struct sockaddr *from, socklen_t from_len)
+{
+    PROF_BEGIN(prof_t0);
+    uint64_t value_before = g_value_dirty;
+    uint64_t text_before = g_text_dirty;
+    g_lat_sender_us = 0;
+    g_value_stamp_us = g_lat_rx_us;
+    int binary = len >= 2 && (uint8_t)buf[0] == OSD_BIN_MAGIC0 && (uint8_t)buf[1] == OSD_BIN_MAGIC1;
+    long long src = -1;
+    long long seq = -1;
+    if (!binary) {
+        udp_header_scan(buf, len, &src, &seq);
+    } else if (len >= 11 && ((uint8_t)buf[3] & OSD_BIN_FLAG_SEQ)) {
+        const uint8_t *h = (const uint8_t *)buf + 6;
+        src = h[0];
+        seq = (long long)((uint32_t)h[1] | ((uint32_t)h[2] << 8) | ((uint32_t)h[3] << 16) | ((uint32_t)h[4] << 24));
+    }
+    g_rx_src = src >= 0 && src < UDP_SRC_MAX ? (int)src : -1;
+    if (g_rx_src >= 0 && seq >= 0 && !udp_source_accept(g_rx_src, (uint32_t)seq)) {
+        udp_count(&g_udp_counters.rx);
+        udp_count(&g_udp_counters.seq_drops);
+        g_rx_src = -1;
+        g_value_stamp_us = 0;
+        PROF_END(PROF_PARSE, prof_t0);
+        return;
+    }
+    int rc;
+    if (binary) {
+        rc = parse_udp_binary((const uint8_t *)buf, len);
+    } else {
+        rc = parse_udp_packet(buf, len);
+    }
+    g_rx_src = -1;
+    udp_count(&g_udp_counters.rx);
+    if (rc != 0) udp_count(&g_udp_counters.parse_errors);
+    latency_stamp_slots(value_before, text_before, g_lat_sender_us ? g_lat_sender_us : g_lat_rx_us);
+    PROF_END(PROF_PARSE, prof_t0);
+    if (g_lat_query) latency_reply(from, from_len);
+    if (g_udp_stats_query) udp_stats_reply(from, from_len);
+    g_value_stamp_us = 0;
+}
+
+static bool poll_udp_single(void)
+{
+    char *buf = udp_batch_bufs[0];
+    bool updated = false;
+    struct sockaddr_storage from;
+    struct msghdr mh;
+    struct iovec iov;
+
+    for (;;) {
+        udp_msg_init(&mh, &iov, buf, &from, udp_batch_ctrl[0]);
+        ssize_t r = recvmsg(udp_sock, &mh, MSG_DONTWAIT);
+        if (r < 0) break;
+        if (g_cfg.latency_stats || g_filter_count > 0) g_lat_rx_us = monotonic_us64();
+        // msg_flags carries MSG_TRUNC for datagrams longer than the buffer
+        if (!udp_msg_accept(&mh)) continue;
+        buf[r] = '\0';
+        parse_udp_datagram(buf, (size_t)r, (const struct sockaddr *)&from, mh.msg_namelen);
+        updated = true;
+    }
+    return updated;
+}
+
+static bool poll_udp(void)
+{
+    if (udp_sock < 0) return false;
+    if (!udp_use_mmsg) return poll_udp_single();
+
+    struct mmsghdr msgs[UDP_BATCH];
+    struct iovec iovs[UDP_BATCH];
+    struct sockaddr_storage froms[UDP_BATCH];
+    bool updated = false;
+
+    for (;;) {
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < UDP_BATCH; i++) {
+            udp_msg_init(&msgs[i].msg_hdr, &iovs[i], udp_batch_bufs[i], &froms[i], udp_batch_ctrl[i]);
+        }
+        int n = recvmmsg(udp_sock, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == ENOSYS) {
+                // Kernel without recvmmsg: drain one datagram per syscall instead
+                udp_use_mmsg = 0;
+                return poll_udp_single() || updated;
+            }
+            break;
+        }
+        if (n == 0) break;
+        if (g_cfg.latency_stats || g_filter_count > 0) g_lat_rx_us = monotonic_us64();
+
+        // Parse the whole batch in arrival order before reporting it
+        for (int i = 0; i < n; i++) {
+            if (!udp_msg_accept(&msgs[i].msg_hdr)) continue;  // oversized datagram
+            size_t len = msgs[i].msg_len;
+            udp_batch_bufs[i][len] = '\0';
+            parse_udp_datagram(udp_batch_bufs[i], len, (const struct sockaddr *)&froms[i], msgs[i].msg_hdr.msg_namelen);
+            updated = true;
+        }
+        if (n < UDP_BATCH) break;
+    }
+
+    return updated;
+}
+
+// -------------------------
+// UDP receive thread
+// -------------------------
+/*
+ * With rx_thread a dedicated thread blocks on udp_sock and copies each
+ * datagram into a single-producer/single-consumer ring, so the kernel buffer
+ * keeps draining while the main loop rasterizes a large invalidation. Parsing
+ * stays on the main thread, which owns the channel arrays and LVGL. Head is
+ * written only by the receiver and tail only by the main loop; a wake byte is
+ * posted only when no wakeup is pending, so a burst costs one pipe write.
+ */
+#define RX_RING_SLOTS 32  // power of two
+
+typedef struct {
+    uint32_t len;
+    socklen_t from_len;
+    uint64_t rx_us;
+    struct sockaddr_storage from;
+    char data[UDP_MAX_PACKET + 1];
+} rx_slot_t;
+
+static rx_slot_t g_rx_ring[RX_RING_SLOTS];
+static rx_slot_t g_rx_spill;           // receive target while the ring is full
+static uint32_t g_rx_head = 0;         // next slot the receiver fills
+static uint32_t g_rx_tail = 0;         // next slot the main loop parses
+static int g_rx_wake_pending = 0;
+static pthread_t g_rx_thread;
+static int g_rx_running = 0;
+static int g_rx_stop = 0;
+static int g_rx_wake[2] = {-1, -1};
+
+static void *rx_thread_main(void *arg)
+{
+    (void)arg;
+    struct pollfd pfd = {.fd = udp_sock, .events = POLLIN, .revents = 0};
+    struct msghdr mh;
+    struct iovec iov;
+    char ctrl[UDP_CTRL_LEN];
+
+    while (!__atomic_load_n(&g_rx_stop, __ATOMIC_RELAXED)) {
+        // Short timeout so a stop request is noticed without signalling the thread
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        int got = 0;
+        for (int burst = 0; burst < RX_RING_SLOTS; burst++) {
+            uint32_t head = g_rx_head;
+            int full = head - __atomic_load_n(&g_rx_tail, __ATOMIC_ACQUIRE) >= RX_RING_SLOTS;
+            rx_slot_t *s = full ? &g_rx_spill : &g_rx_ring[head & (RX_RING_SLOTS - 1)];
+            udp_msg_init(&mh, &iov, s->data, &s->from, ctrl);
+            ssize_t r = recvmsg(udp_sock, &mh, MSG_DONTWAIT);
+            if (r < 0) break;
+            if (!udp_msg_accept(&mh)) continue;
+            if (full) {
+                udp_count(&g_udp_counters.ring_drops);
+                continue;
+            }
+            s->len = (uint32_t)r;
+            s->data[r] = '\0';
+            s->from_len = mh.msg_namelen;
+            s->rx_us = monotonic_us64();
+            __atomic_store_n(&g_rx_head, head + 1, __ATOMIC_RELEASE);
+            got = 1;
+        }
+
+        if (got && !__atomic_exchange_n(&g_rx_wake_pending, 1, __ATOMIC_SEQ_CST) && g_rx_wake[1] >= 0) {
+            char b = 1;
+            if (write(g_rx_wake[1], &b, 1) < 0) {
+                // pipe full: a wakeup is already pending
+            }
+        }
+    }
+    return NULL;
+}
+
+static void rx_thread_start(void)
+{
+    if (udp_sock < 0) return;
+    if (pipe(g_rx_wake) != 0) {
+        g_rx_wake[0] = g_rx_wake[1] = -1;
+        fprintf(stderr, "UDP receive thread: pipe failed, receiving inline\n");
+        return;
+    }
+    for (int i = 0; i < 2; i++) fcntl(g_rx_wake[i], F_SETFL, fcntl(g_rx_wake[i], F_GETFL, 0) | O_NONBLOCK);
+
+    g_rx_head = g_rx_tail = 0;
+    g_rx_wake_pending = 0;
+    g_rx_stop = 0;
+    if (pthread_create(&g_rx_thread, NULL, rx_thread_main, NULL) != 0) {
+        fprintf(stderr, "UDP receive thread failed to start, receiving inline\n");
+        for (int i = 0; i < 2; i++) {
+            close(g_rx_wake[i]);
+            g_rx_wake[i] = -1;
+        }
+        return;
+    }
+    g_rx_running = 1;
+}
+
+static void rx_thread_stop(void)
+{
+    if (g_rx_running) {
+        __atomic_store_n(&g_rx_stop, 1, __ATOMIC_RELAXED);
+        pthread_join(g_rx_thread, NULL);
+        g_rx_running = 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (g_rx_wake[i] >= 0) close(g_rx_wake[i]);
+        g_rx_wake[i] = -1;
+    }
+}
+
+// Parses everything the receiver has queued, in arrival order
+static bool rx_ring_drain(void)
+{
+    if (!g_rx_running) return false;
+
+    // Re-arm the wakeup before looking at head so a datagram published after
+    // the load below always posts a fresh byte
+    __atomic_store_n(&g_rx_wake_pending, 0, __ATOMIC_SEQ_CST);
+    char tmp[16];
+    while (read(g_rx_wake[0], tmp, sizeof(tmp)) > 0) {
+    }
+
+    bool updated = false;
+    uint32_t tail = g_rx_tail;
+    uint32_t head = __atomic_load_n(&g_rx_head, __ATOMIC_SEQ_CST);
+    while (tail != head) {
+        rx_slot_t *s = &g_rx_ring[tail & (RX_RING_SLOTS - 1)];
+        g_lat_rx_us = s->rx_us;
+        parse_udp_datagram(s->data, s->len, (const struct sockaddr *)&s->from, s->from_len);
+        tail++;
+        __atomic_store_n(&g_rx_tail, tail, __ATOMIC_RELEASE);
+        updated = true;
+    }
+    return updated;
+}
+
+// -------------------------
+// Shared-memory channel transport
+// -------------------------
+/*
+ * Co-located producers can skip the UDP socket: they update seqlocked slots in
+ * OSD_SHM_PATH and poke the wake FIFO. Only slots whose sequence moved since
+ * the last pass are copied into the UDP banks, so a torn or stale slot is never
+ * applied and idle slots cost one load each.
+ */
+static osd_shm_t *g_shm = NULL;
+static int g_shm_wake_fd = -1;
+static int g_shm_wake_keep_fd = -1;  // own writer keeps the FIFO from reporting POLLHUP
+static uint32_t g_shm_value_seen[OSD_SHM_VALUE_SLOTS];
+static uint32_t g_shm_text_seen[OSD_SHM_TEXT_SLOTS];
+
+static int shm_transport_init(void)
+{
+    int fd = open(OSD_SHM_PATH, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        fprintf(stderr, "shm: open %s failed: %s\n", OSD_SHM_PATH, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    int fresh = fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(osd_shm_t);
+    if (fresh && ftruncate(fd, sizeof(osd_shm_t)) != 0) {
+        fprintf(stderr, "shm: ftruncate failed: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(osd_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "shm: mmap failed: %s\n", strerror(errno));
+        return -1;
+    }
+    g_shm = (osd_shm_t *)map;
+    if (fresh || g_shm->magic != OSD_SHM_MAGIC || g_shm->version != OSD_SHM_VERSION) {
+        memset(g_shm, 0, sizeof(*g_shm));
+        g_shm->version = OSD_SHM_VERSION;
+        g_shm->value_slots = OSD_SHM_VALUE_SLOTS;
+        g_shm->text_slots = OSD_SHM_TEXT_SLOTS;
+        __atomic_store_n(&g_shm->magic, OSD_SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+    memset(g_shm_value_seen, 0, sizeof(g_shm_value_seen));
+    memset(g_shm_text_seen, 0, sizeof(g_shm_text_seen));
+
+    if (mkfifo(OSD_SHM_WAKE_PATH, 0666) != 0 && errno != EEXIST) {
+        fprintf(stderr, "shm: mkfifo %s failed: %s\n", OSD_SHM_WAKE_PATH, strerror(errno));
+    }
+    g_shm_wake_fd = open(OSD_SHM_WAKE_PATH, O_RDONLY | O_NONBLOCK);
+    if (g_shm_wake_fd >= 0) g_shm_wake_keep_fd = open(OSD_SHM_WAKE_PATH, O_WRONLY | O_NONBLOCK);
+    if (g_shm_wake_fd < 0) {
+        fprintf(stderr, "shm: wake FIFO unavailable, slots are read every loop\n");
+    }
+    printf("Shared-memory transport at %s\n", OSD_SHM_PATH);
+    return 0;
+}
+
+static void shm_transport_close(void)
+{
+    if (g_shm) munmap(g_shm, sizeof(osd_shm_t));
+    g_shm = NULL;
+    if (g_shm_wake_fd >= 0) close(g_shm_wake_fd);
+    if (g_shm_wake_keep_fd >= 0) close(g_shm_wake_keep_fd);
+    g_shm_wake_fd = -1;
+    g_shm_wake_keep_fd = -1;
+}
+
+static void shm_drain_wake(void)
+{
+    char buf[64];
+    if (g_shm_wake_fd < 0) return;
+    while (read(g_shm_wake_fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+static bool shm_poll(void)
+{
+    if (!g_shm) return false;
+    bool updated = false;
+    uint64_t value_before = g_value_dirty;
+    uint64_t text_before = g_text_dirty;
+
+    for (int i = 0; i < OSD_SHM_VALUE_SLOTS && i < UDP_VALUE_COUNT; i++) {
+        osd_shm_value_t *slot = &g_shm->values[i];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        if (seq == g_shm_value_seen[i]) continue;
+        uint32_t begin = osd_shm_read_begin(&slot->seq);
+        if (begin == 0) continue;  // writer active: pick it up on its wake byte
+        double v = slot->value;
+        if (osd_shm_read_retry(&slot->seq, begin)) continue;
+        g_shm_value_seen[i] = begin;
+        set_udp_value(i, v);
+        updated = true;
+    }
+    for (int i = 0; i < OSD_SHM_TEXT_SLOTS && i < UDP_TEXT_COUNT; i++) {
+        osd_shm_text_t *slot = &g_shm->texts[i];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        if (seq == g_shm_text_seen[i]) continue;
+        uint32_t begin = osd_shm_read_begin(&slot->seq);
+        if (begin == 0) continue;
+        char tmp[OSD_SHM_TEXT_MAX];
+        size_t n = slot->len;
+        if (n > OSD_SHM_TEXT_MAX) n = OSD_SHM_TEXT_MAX;
+        memcpy(tmp, slot->text, n);
+        if (osd_shm_read_retry(&slot->seq, begin)) continue;
+        g_shm_text_seen[i] = begin;
+        if (set_udp_text(i, tmp, n)) updated = true;
+    }
+    if (updated && g_cfg.latency_stats) latency_stamp_slots(value_before, text_before, monotonic_us64());
+    return updated;
+}
+
+// -------------------------
+// LVGL tick function
+// -------------------------
+uint32_t my_get_milliseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000ULL) + (uint64_t)(ts.tv_nsec / 1000000ULL));
+}
+
+static uint64_t monotonic_ms64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000ULL) + (uint64_t)(ts.tv_nsec / 1000000ULL);
+}
+
+static bool set_system_value(int idx, double v)
+{
+    if (idx < 0 || idx >= SYSTEM_VALUE_COUNT) return false;
+    filters_feed(UDP_VALUE_COUNT + idx, v);
+    double prev = system_values[idx];
+    double diff = prev - v;
+    if (diff < 0) diff = -diff;
+    if (diff < 0.001) return false;
+    system_values[idx] = v;
+    g_value_dirty |= 1ull << (UDP_VALUE_COUNT + idx);
+    return true;
+}
+
+// -------------------------
+// procfs/sysfs readers
+// -------------------------
+/*
+ * Telemetry files stay open for the life of the process and are re-read from
+ * offset 0 with pread into fixed buffers; procfs and sysfs regenerate their
+ * content on every read at offset 0. A failed read closes the descriptor so
+ * the next sample reopens it (e.g. after mi_venc is reloaded).
+ */
+typedef struct {
+    const char *path;
+    int fd;
+} proc_file_t;
+
+static char g_temp_path[64];
+static proc_file_t g_proc_temp = {g_temp_path, -1};
+static proc_file_t g_proc_stat = {"/proc/stat", -1};
+static proc_file_t g_proc_venc = {"/proc/mi_modules/mi_venc/mi_venc0", -1};
+static proc_file_t g_proc_meminfo = {"/proc/meminfo", -1};
+static proc_file_t g_proc_net_dev = {"/proc/net/dev", -1};
+static char g_proc_venc_buf[16384];
+static char g_proc_stat_buf[2048];
+static char g_proc_net_buf[4096];
+
+static ssize_t proc_file_read(proc_file_t *pf, char *buf, size_t cap)
+{
+    if (cap == 0) return -1;
+    if (pf->fd < 0) {
+        pf->fd = open(pf->path, O_RDONLY | O_CLOEXEC);
+        if (pf->fd < 0) return -1;
+    }
+    ssize_t n = pread(pf->fd, buf, cap - 1, 0);
+    if (n < 0) {
+        close(pf->fd);
+        pf->fd = -1;
+        return -1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+static void proc_file_close(proc_file_t *pf)
+{
+    if (pf->fd >= 0) close(pf->fd);
+    pf->fd = -1;
+}
+
+static void proc_files_close(void)
+{
+    proc_file_close(&g_proc_temp);
+    proc_file_close(&g_proc_stat);
+    proc_file_close(&g_proc_venc);
+    proc_file_close(&g_proc_meminfo);
+    proc_file_close(&g_proc_net_dev);
+}
+
+// Minimal scanners for the fixed-format telemetry lines; no locale, no stdio
+static void scan_blanks(const char **p)
+{
+    while (**p == ' ' || **p == '\t') (*p)++;
+}
+
+static int scan_u64(const char **p, unsigned long long *out)
+{
+    scan_blanks(p);
+    if (!isdigit((unsigned char)**p)) return 0;
+    unsigned long long v = 0;
+    while (isdigit((unsigned char)**p)) v = v * 10u + (unsigned)(*(*p)++ - '0');
+    *out = v;
+    return 1;
+}
+
+static int scan_i32(const char **p, int *out)
+{
+    scan_blanks(p);
+    int neg = (**p == '-');
+    if (neg) (*p)++;
+    unsigned long long v = 0;
+    if (!scan_u64(p, &v)) return 0;
+    *out = neg ? -(int)v : (int)v;
+    return 1;
+}
+
+static int scan_decimal(const char **p, double *out)
+{
+    scan_blanks(p);
+    int neg = (**p == '-');
+    if (neg) (*p)++;
+    if (!isdigit((unsigned char)**p)) return 0;
+    double v = 0.0;
+    while (isdigit((unsigned char)**p)) v = v * 10.0 + (*(*p)++ - '0');
+    if (**p == '.') {
+        (*p)++;
+        double scale = 0.1;
+        while (isdigit((unsigned char)**p)) {
+            v += (*(*p)++ - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    *out = neg ? -v : v;
+    return 1;
+}
+
+static double parse_temperature_line(const char *line)
+{
+    if (!line) return -1.0;
+    const char *p = line;
+    while (*p && !isdigit((unsigned char)*p) && *p != '-') p++;
+    if (*p == '\0') return -1.0;
+    double v = -1.0;
+    if (scan_decimal(&p, &v)) return v;
+    return -1.0;
+}
+
+/*
+ * The temperature source is discovered once: the Sigmastar cpufreq temp_out
+ * node first, then the first thermal zone or hwmon sensor that reads back a
+ * plausible value. thermal/hwmon report millidegrees. With no source at all
+ * the slot is left alone instead of forking a helper on every sample.
+ */
+typedef enum {
+    TEMP_SOURCE_UNKNOWN = 0,
+    TEMP_SOURCE_FOUND,
+    TEMP_SOURCE_NONE,
+} temp_source_state_t;
+
+static temp_source_state_t g_temp_state = TEMP_SOURCE_UNKNOWN;
+static double g_temp_scale = 1.0;
+
+static double read_temp_file(void)
+{
+    char line[64];
+    if (proc_file_read(&g_proc_temp, line, sizeof(line)) <= 0) return -1.0;
+    double v = parse_temperature_line(line);
+    if (v < 0.0) return -1.0;
+    return v * g_temp_scale;
+}
+
+static int probe_temp_source(const char *path, double scale)
+{
+    proc_file_close(&g_proc_temp);
+    snprintf(g_temp_path, sizeof(g_temp_path), "%s", path);
+    g_temp_scale = scale;
+    double v = read_temp_file();
+    if (v > 0.0 && v < 200.0) return 1;
+    proc_file_close(&g_proc_temp);
+    return 0;
+}
+
+static int find_temp_source(void)
+{
+    char path[64];
+    if (probe_temp_source("/sys/devices/system/cpu/cpufreq/temp_out", 1.0)) return 1;
+    for (int i = 0; i < 16; i++) {
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp", i);
+        if (probe_temp_source(path, 0.001)) return 1;
+    }
+    for (int i = 0; i < 16; i++) {
+        snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/temp1_input", i);
+        if (probe_temp_source(path, 0.001)) return 1;
+    }
+    return 0;
+}
+
+static void discover_temp_source(void)
+{
+    if (!find_temp_source()) {
+        g_temp_state = TEMP_SOURCE_NONE;
+        fprintf(stderr, "No SoC temperature source found, temperature slot disabled\n");
+        return;
+    }
+    g_temp_state = TEMP_SOURCE_FOUND;
+    printf("SoC temperature from %s\n", g_temp_path);
+}
+
+static double read_soc_temperature(void)
+{
+    if (g_temp_state == TEMP_SOURCE_UNKNOWN) discover_temp_source();
+    if (g_temp_state != TEMP_SOURCE_FOUND) return -1.0;
+    return read_temp_file();
+}
+
+// Busy and total jiffies of one "cpu" / "cpuN" line of /proc/stat
+static int cpu_line_times(const char *line, unsigned long long *busy, unsigned long long *total)
+{
+    unsigned long long f[8] = {0};
+    const char *p = line;
+    while (*p && *p != ' ') p++;
+    int parsed = 0;
+    while (parsed < 8 && scan_u64(&p, &f[parsed])) parsed++;
+    if (parsed < 4) return -1;
+    unsigned long long idle_all = f[3] + f[4];
+    *busy = f[0] + f[1] + f[2] + f[5] + f[6] + f[7];
+    *total = *busy + idle_all;
+    return 0;
+}
+
+// Load since the previous call with the same state; -1 on the first call or no progress
+static double cpu_delta_pct(unsigned long long busy, unsigned long long total, unsigned long long *prev_busy,
+                            unsigned long long *prev_total)
+{
+    unsigned long long pb = *prev_busy;
+    unsigned long long pt = *prev_total;
+    *prev_busy = busy;
+    *prev_total = total;
+    if (pt == 0 || total <= pt || busy < pb) return -1.0;
+    unsigned long long busyd = busy - pb;
+    unsigned long long totald = total - pt;
+    if (busyd > totald) busyd = totald;
+    return (double)busyd * 100.0 / (double)totald;
+}
+
+// Reads /proc/stat: the aggregate "cpu" line always, the per-core lines only when a slot shows one
+static int read_proc_stat(int want_cores)
+{
+    size_t cap = want_cores ? sizeof(g_proc_stat_buf) : 256;
+    if (proc_file_read(&g_proc_stat, g_proc_stat_buf, cap) <= 0) return -1;
+    return strncmp(g_proc_stat_buf, "cpu ", 4) == 0 ? 0 : -1;
+}
+
+static double read_cpu_load_pct(void)
+{
+    static unsigned long long prev_busy = 0;
+    static unsigned long long prev_total = 0;
+    unsigned long long busy, total;
+    if (cpu_line_times(g_proc_stat_buf, &busy, &total) != 0) return -1.0;
+    return cpu_delta_pct(busy, total, &prev_busy, &prev_total);
+}
+
+// Line of core n in the buffer read_proc_stat filled, NULL when missing
+static const char *proc_stat_core_line(int core)
+{
+    char tag[8];
+    int n = snprintf(tag, sizeof(tag), "\ncpu%d ", core);
+    return n > 0 ? strstr(g_proc_stat_buf, tag) : NULL;
+}
+
+// MemTotal/MemFree/MemAvailable in kB; MemAvailable falls back to MemFree on pre-3.14 kernels
+static int read_meminfo(unsigned long long *total, unsigned long long *free_kb, unsigned long long *avail)
+{
+    char buf[512];
+    if (proc_file_read(&g_proc_meminfo, buf, sizeof(buf)) <= 0) return -1;
+    static const char *const keys[3] = {"MemTotal:", "MemFree:", "MemAvailable:"};
+    unsigned long long *out[3] = {total, free_kb, avail};
+    *avail = 0;
+    for (int i = 0; i < 3; i++) {
+        const char *p = strstr(buf, keys[i]);
+        if (p) {
+            p += strlen(keys[i]);
+            scan_u64(&p, out[i]);
+        } else if (i < 2) {
+            return -1;
+        }
+    }
+    if (*avail == 0) *avail = *free_kb;
+    return 0;
+}
+
+/*
+ * /proc/net/dev rows are
+ *   iface: rx_bytes rx_packets errs drop fifo frame compressed multicast tx_bytes tx_packets ...
+ * counters[] receives rx_bytes, tx_bytes, rx_packets, tx_packets.
+ */
+static int net_dev_counters(const char *buf, const char *iface, unsigned long long counters[4])
+{
+    size_t len = strlen(iface);
+    for (const char *line = buf; line; line = strchr(line, '\n')) {
+        const char *p = line;
+        while (*p == '\n' || *p == ' ') p++;
+        line = p;
+        if (strncmp(p, iface, len) != 0 || p[len] != ':') continue;
+        p += len + 1;
+        unsigned long long f[10];
+        int n = 0;
+        while (n < 10 && scan_u64(&p, &f[n])) n++;
+        if (n < 10) return -1;
+        counters[0] = f[0];
+        counters[1] = f[8];
+        counters[2] = f[1];
+        counters[3] = f[9];
+        return 0;
+    }
+    return -1;
+}
+
+/*
+ * Channel rows under "VENC 0 CHN info" are
+ *   ChnId State EnPred Base Enhance MaxStream FrameIdx Gradient Fps_1s kbps Fps_10s kbps_10s
+ * Channels 0 (main stream) and 1 (sub stream) are kept; the scan stops once
+ * both rows are in or at the blank line ending the table.
+ */
+#define VENC_STATS_CHANNELS 2
+
+typedef struct {
+    double fps_1s;
+    double kbps;
+    double fps_10s;
+    double kbps_10s;
+} venc_chn_stats_t;
+
+// Returns a bitmask of the channels found in out[]
+static unsigned read_encoder_stats_proc(venc_chn_stats_t out[VENC_STATS_CHANNELS])
+{
+    if (proc_file_read(&g_proc_venc, g_proc_venc_buf, sizeof(g_proc_venc_buf)) <= 0) return 0;
+
+    const char *line = strstr(g_proc_venc_buf, "VENC 0 CHN info");
+    if (!line) return 0;
+    line = strchr(line, '\n');
+
+    const unsigned all = (1u << VENC_STATS_CHANNELS) - 1u;
+    unsigned found = 0;
+    while (line && *++line && found != all) {
+        const char *next = strchr(line, '\n');
+        if (*line == '\n' || *line == '\r') break;  // end of the table
+        if (strncmp(line, "ChnId", 5) == 0 || *line == '-') {
+            line = next;
+            continue;
+        }
+
+        const char *p = line;
+        int ints[8];
+        int n = 0;
+        while (n < 8 && scan_i32(&p, &ints[n])) n++;
+        int chn = n == 8 ? ints[0] : -1;
+        venc_chn_stats_t st;
+        if (chn >= 0 && chn < VENC_STATS_CHANNELS &&
+            scan_decimal(&p, &st.fps_1s) && scan_decimal(&p, &st.kbps) &&
+            scan_decimal(&p, &st.fps_10s) && scan_decimal(&p, &st.kbps_10s)) {
+            out[chn] = st;
+            found |= 1u << chn;
+        }
+        line = next;
+    }
+    return found;
+}
+
+// -------------------------
+// System telemetry sampler
+// -------------------------
+/*
+ * procfs/sysfs reads run on a niced sampler thread so a slow mi_venc proc
+ * file never stalls a frame. Each source group is read on its own period
+ * (system_periods) and only while something consumes it: a mapped slot, or
+ * the governor and frame_sync for CPU load and encoder FPS. Groups sit in a
+ * min-heap by due time and the thread sleeps until the top one is due, so
+ * idle groups cost nothing. Readings are merged into a pending sample under
+ * a mutex; the main loop takes it when the sequence moved and diffs it into
+ * the system slots. The inline path remains for a failed thread start.
+ */
+typedef struct {
+    double values[SYSTEM_VALUE_COUNT];
+    uint32_t valid;  // bit per slot that produced a reading
+    double cpu_load;        // governor and frame_sync inputs whatever the slot mapping, -1 = no reading
+    double enc_fps;
+} system_sample_t;
+
+typedef struct {
+    uint64_t due_us;
+    uint32_t period_ms;     // 0 = no consumer, never read
+    uint32_t reads;
+    uint64_t cost_us;       // total time spent reading and parsing
+    uint32_t max_us;
+} sys_group_sched_t;
+
+typedef struct {
+    sys_group_sched_t group[SYS_GROUP_COUNT];
+    uint8_t heap[SYS_GROUP_COUNT];  // scheduled groups, earliest due_us first
+    int len;
+} sys_sched_t;
+
+static system_sample_t g_sample_pending;  // readings not yet taken by the main loop
+static uint32_t g_sample_seq = 0;
+static pthread_mutex_t g_sample_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sample_cond;
+static pthread_t g_sample_thread;
+static int g_sample_running = 0;
+static int g_sample_stop = 0;
+static int g_sample_replan = 1;  // periods or mapping changed: reschedule and read everything now
+static uint32_t g_sample_periods[SYS_GROUP_COUNT];  // per group, under g_sample_lock
+static int g_sample_wake[2] = {-1, -1};
+static sys_slot_map_t g_sample_map[SYSTEM_VALUE_COUNT];  // under g_sample_lock, copied per sample
+static sys_group_sched_t g_sample_stats[SYS_GROUP_COUNT];  // cost snapshot for metrics, under g_sample_lock
+static sys_sched_t g_sched;  // the sampler thread's, or the inline path's
+
+static int sys_source_group(int source)
+{
+    switch (source) {
+        case SYS_SRC_TEMP:
+            return SYS_GROUP_TEMP;
+        case SYS_SRC_CPU_LOAD:
+        case SYS_SRC_CPU_CORE:
+            return SYS_GROUP_CPU;
+        case SYS_SRC_MEM_FREE:
+        case SYS_SRC_MEM_AVAIL:
+        case SYS_SRC_MEM_USED_PCT:
+            return SYS_GROUP_MEM;
+        default:
+            break;
+    }
+    if (source >= SYS_SRC_ENC_FPS && source <= SYS_SRC_ENC1_KBPS) return SYS_GROUP_VENC;
+    if (source >= SYS_SRC_NET_RX_KBPS && source < SYS_SRC_COUNT) return SYS_GROUP_NET;
+    return -1;
+}
+
+// Period per group from the config, 0 for groups nothing reads
+static void system_group_periods(uint32_t *out)
+{
+    uint32_t used = 0;
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        int g = sys_source_group(g_cfg.system_slots[i].source);
+        if (g >= 0) used |= 1u << g;
+    }
+    if (g_cfg.governor) used |= 1u << SYS_GROUP_CPU;
+    if ((g_cfg.governor && g_cfg.governor_fps_min > 0) || (g_cfg.frame_sync && g_cfg.frame_rate <= 0)) {
+        used |= 1u << SYS_GROUP_VENC;
+    }
+    for (int g = 0; g < SYS_GROUP_COUNT; g++) {
+        int ms = g_cfg.system_period_ms[g] > 0 ? g_cfg.system_period_ms[g] : g_cfg.system_refresh_ms;
+        out[g] = (used & (1u << g)) ? (uint32_t)clamp_int(ms, 100, 60000) : 0;
+    }
+}
+
+static int sys_sched_before(const sys_sched_t *s, int a, int b)
+{
+    return s->group[s->heap[a]].due_us < s->group[s->heap[b]].due_us;
+}
+
+static void sys_sched_swap(sys_sched_t *s, int a, int b)
+{
+    uint8_t t = s->heap[a];
+    s->heap[a] = s->heap[b];
+    s->heap[b] = t;
+}
+
+static void sys_sched_sift_down(sys_sched_t *s, int i)
+{
+    for (;;) {
+        int min = i;
+        int l = 2 * i + 1;
+        int r = l + 1;
+        if (l < s->len && sys_sched_before(s, l, min)) min = l;
+        if (r < s->len && sys_sched_before(s, r, min)) min = r;
+        if (min == i) return;
+        sys_sched_swap(s, i, min);
+        i = min;
+    }
+}
+
+static void sys_sched_push(sys_sched_t *s, int group)
+{
+    int i = s->len++;
+    s->heap[i] = (uint8_t)group;
+    while (i > 0 && sys_sched_before(s, i, (i - 1) / 2)) {
+        sys_sched_swap(s, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+// Reschedules every consumed group due now; cost counters carry over
+static void sys_sched_plan(sys_sched_t *s, const uint32_t *periods, uint64_t now_us)
+{
+    s->len = 0;
+    for (int g = 0; g < SYS_GROUP_COUNT; g++) {
+        s->group[g].period_ms = periods[g];
+        s->group[g].due_us = now_us;
+        if (periods[g] > 0) sys_sched_push(s, g);
+    }
+}
+
+// Bitmask of the groups due at now_us, each pushed back by its period
+static uint32_t sys_sched_take_due(sys_sched_t *s, uint64_t now_us)
+{
+    uint32_t due = 0;
+    while (s->len > 0 && s->group[s->heap[0]].due_us <= now_us) {
+        sys_group_sched_t *g = &s->group[s->heap[0]];
+        due |= 1u << s->heap[0];
+        g->due_us += (uint64_t)g->period_ms * 1000u;
+        // A group that fell a whole period behind (stalled read, suspend) does not catch up in a burst
+        if (g->due_us <= now_us) g->due_us = now_us + (uint64_t)g->period_ms * 1000u;
+        sys_sched_sift_down(s, 0);
+    }
+    return due;
+}
+
+// Monotonic microseconds of the earliest due group, 0 when none is scheduled
+static uint64_t sys_sched_next_due(const sys_sched_t *s)
+{
+    return s->len > 0 ? s->group[s->heap[0]].due_us : 0;
+}
+
+static void sys_sched_account(sys_sched_t *s, int group, uint64_t start_us)
+{
+    uint64_t took = monotonic_us64() - start_us;
+    sys_group_sched_t *g = &s->group[group];
+    g->reads++;
+    g->cost_us += took;
+    if (took > g->max_us) g->max_us = (uint32_t)took;
+}
+
+/*
+ * Rate sources keep the previous counters of their slot; a slot whose mapping
+ * changed starts over. Rates divide by the monotonic time between the two
+ * reads, so a late sample does not show up as a burst.
+ */
+typedef struct {
+    sys_slot_map_t map;
+    unsigned long long prev_a;
+    unsigned long long prev_b;
+    uint64_t prev_us;
+} sys_rate_state_t;
+
+static sys_rate_state_t g_sys_rate[SYSTEM_VALUE_COUNT];  // sampler thread, or the inline path
+
+// Reads the groups in due (bitmask of sys_group_t) and fills the slots mapped to them
+static void collect_system_sample(system_sample_t *out, const sys_slot_map_t *map, uint32_t due, sys_sched_t *sched)
+{
+    out->valid = 0;
+    out->cpu_load = -1.0;
+    out->enc_fps = -1.0;
+    uint32_t want = 0;
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) want |= 1u << map[i].source;
+
+    double fixed[SYS_SRC_CPU_CORE];
+    uint32_t fixed_valid = 0;
+    uint64_t t0;
+    if (due & (1u << SYS_GROUP_TEMP)) {
+        t0 = monotonic_us64();
+        fixed[SYS_SRC_TEMP] = read_soc_temperature();
+        if (fixed[SYS_SRC_TEMP] >= 0.0) fixed_valid |= 1u << SYS_SRC_TEMP;
+        sys_sched_account(sched, SYS_GROUP_TEMP, t0);
+    }
+
+    int have_stat = 0;
+    if (due & (1u << SYS_GROUP_CPU)) {
+        t0 = monotonic_us64();
+        have_stat = read_proc_stat((want & (1u << SYS_SRC_CPU_CORE)) != 0) == 0;
+        out->cpu_load = have_stat ? read_cpu_load_pct() : -1.0;
+        if (out->cpu_load >= 0.0) {
+            fixed[SYS_SRC_CPU_LOAD] = out->cpu_load;
+            fixed_valid |= 1u << SYS_SRC_CPU_LOAD;
+        }
+        sys_sched_account(sched, SYS_GROUP_CPU, t0);
+    }
+
+    venc_chn_stats_t venc[VENC_STATS_CHANNELS];
+    unsigned chn_mask = 0;
+    if (due & (1u << SYS_GROUP_VENC)) {
+        t0 = monotonic_us64();
+        chn_mask = read_encoder_stats_proc(venc);
+        sys_sched_account(sched, SYS_GROUP_VENC, t0);
+    }
+    if (chn_mask & 1u) out->enc_fps = venc[0].fps_1s;
+    if (chn_mask & 1u) {
+        fixed[SYS_SRC_ENC_FPS] = venc[0].fps_1s;
+        fixed[SYS_SRC_ENC_KBPS] = venc[0].kbps;
+        fixed[SYS_SRC_ENC_FPS_10S] = venc[0].fps_10s;
+        fixed[SYS_SRC_ENC_KBPS_10S] = venc[0].kbps_10s;
+        fixed_valid |= (1u << SYS_SRC_ENC_FPS) | (1u << SYS_SRC_ENC_KBPS) | (1u << SYS_SRC_ENC_FPS_10S) |
+                       (1u << SYS_SRC_ENC_KBPS_10S);
+    }
+    if (chn_mask & 2u) {
+        fixed[SYS_SRC_ENC1_FPS] = venc[1].fps_1s;
+        fixed[SYS_SRC_ENC1_KBPS] = venc[1].kbps;
+        fixed_valid |= (1u << SYS_SRC_ENC1_FPS) | (1u << SYS_SRC_ENC1_KBPS);
+    }
+
+    unsigned long long mem_total, mem_free, mem_avail;
+    if (due & (1u << SYS_GROUP_MEM)) {
+        t0 = monotonic_us64();
+        if (read_meminfo(&mem_total, &mem_free, &mem_avail) == 0 && mem_total > 0) {
+            fixed[SYS_SRC_MEM_FREE] = (double)mem_free / 1024.0;
+            fixed[SYS_SRC_MEM_AVAIL] = (double)mem_avail / 1024.0;
+            fixed[SYS_SRC_MEM_USED_PCT] = (double)(mem_total - mem_avail) * 100.0 / (double)mem_total;
+            fixed_valid |= (1u << SYS_SRC_MEM_FREE) | (1u << SYS_SRC_MEM_AVAIL) | (1u << SYS_SRC_MEM_USED_PCT);
+        }
+        sys_sched_account(sched, SYS_GROUP_MEM, t0);
+    }
+
+    int have_net = 0;
+    if (due & (1u << SYS_GROUP_NET)) {
+        t0 = monotonic_us64();
+        have_net = proc_file_read(&g_proc_net_dev, g_proc_net_buf, sizeof(g_proc_net_buf)) > 0;
+        sys_sched_account(sched, SYS_GROUP_NET, t0);
+    }
+    uint64_t now_us = monotonic_us64();
+
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        const sys_slot_map_t *m = &map[i];
+        sys_rate_state_t *st = &g_sys_rate[i];
+        if (memcmp(&st->map, m, sizeof(*m)) != 0) {
+            memset(st, 0, sizeof(*st));
+            st->map = *m;
+        }
+        double v = -1.0;
+        if (m->source < SYS_SRC_CPU_CORE) {
+            if (!(fixed_valid & (1u << m->source))) continue;
+            v = fixed[m->source];
+        } else if (m->source == SYS_SRC_CPU_CORE) {
+            if (!have_stat) continue;
+            const char *line = have_stat ? proc_stat_core_line(m->arg) : NULL;
+            unsigned long long busy, total;
+            if (!line || cpu_line_times(line + 1, &busy, &total) != 0) continue;
+            v = cpu_delta_pct(busy, total, &st->prev_a, &st->prev_b);
+        } else {
+            if (!have_net) continue;
+            unsigned long long counters[4];
+            if (net_dev_counters(g_proc_net_buf, m->iface, counters) != 0) continue;
+            int kbps = m->source == SYS_SRC_NET_RX_KBPS || m->source == SYS_SRC_NET_TX_KBPS;
+            int tx = m->source == SYS_SRC_NET_TX_KBPS || m->source == SYS_SRC_NET_TX_PPS;
+            unsigned long long cur = counters[(kbps ? 0 : 2) + tx];
+            // A counter that went backwards (interface reset, 32-bit wrap) restarts the rate
+            if (st->prev_us != 0 && cur >= st->prev_a && now_us > st->prev_us) {
+                double dt = (double)(now_us - st->prev_us) / 1e6;
+                double d = (double)(cur - st->prev_a);
+                v = kbps ? d * 8.0 / 1000.0 / dt : d / dt;
+            }
+            st->prev_a = cur;
+            st->prev_us = now_us;
+        }
+        if (v < 0.0) continue;
+        out->values[i] = v;
+        out->valid |= 1u << i;
+    }
+}
+
+/*
+ * Each system slot keeps its last SYSTEM_HISTORY_LEN samples (one per read of
+ * its source group, recorded whether or not the value moved) so graphs and min/max or
+ * jitter readouts need no history from the sender. Rings survive SIGHUP.
+ */
+#define SYSTEM_HISTORY_LEN 64
+
+typedef struct {
+    float samples[SYSTEM_HISTORY_LEN];
+    int head;   // next write position
+    int count;
+} metric_history_t;
+
+static metric_history_t g_system_history[SYSTEM_VALUE_COUNT];
+
+static void history_push(metric_history_t *h, float v)
+{
+    h->samples[h->head] = v;
+    h->head = (h->head + 1) % SYSTEM_HISTORY_LEN;
+    if (h->count < SYSTEM_HISTORY_LEN) h->count++;
+}
+
+// age 0 is the newest sample; callers keep age below h->count
+static float history_at(const metric_history_t *h, int age)
+{
+    int idx = h->head - 1 - age;
+    while (idx < 0) idx += SYSTEM_HISTORY_LEN;
+    return h->samples[idx];
+}
+
+// Jitter is the mean absolute step between consecutive samples
+static bool history_stats(const metric_history_t *h, float *min_out, float *max_out, float *jitter_out)
+{
+    if (h->count == 0) return false;
+    float mn = history_at(h, 0);
+    float mx = mn;
+    float steps = 0.0f;
+    for (int age = 1; age < h->count; age++) {
+        float v = history_at(h, age);
+        float d = v - history_at(h, age - 1);
+        steps += d < 0.0f ? -d : d;
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+    }
+    *min_out = mn;
+    *max_out = mx;
+    *jitter_out = h->count > 1 ? steps / (float)(h->count - 1) : 0.0f;
+    return true;
+}
+
+static bool apply_system_sample(const system_sample_t *sample)
+{
+    if (sample->cpu_load >= 0.0) g_sys_cpu_load = sample->cpu_load;
+    if (sample->enc_fps >= 0.0) g_sys_enc_fps = sample->enc_fps;
+    bool changed = false;
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        if (!(sample->valid & (1u << i))) continue;
+        history_push(&g_system_history[i], (float)sample->values[i]);
+        changed |= set_system_value(i, sample->values[i]);
+    }
+    return changed;
+}
+
+// Folds a partial sample into dst: slots without a reading keep dst's
+static void system_sample_merge(system_sample_t *dst, const system_sample_t *src)
+{
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        if (src->valid & (1u << i)) dst->values[i] = src->values[i];
+    }
+    dst->valid |= src->valid;
+    if (src->cpu_load >= 0.0) dst->cpu_load = src->cpu_load;
+    if (src->enc_fps >= 0.0) dst->enc_fps = src->enc_fps;
+}
+
+static void system_sample_clear(system_sample_t *s)
+{
+    s->valid = 0;
+    s->cpu_load = -1.0;
+    s->enc_fps = -1.0;
+}
+
+static void *system_sampler_main(void *arg)
+{
+    (void)arg;
+    // Only /proc and sysfs reads happen here: keep it out of a real-time class
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &sp);
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+
+    pthread_mutex_lock(&g_sample_lock);
+    while (!g_sample_stop) {
+        uint64_t now_us = monotonic_us64();
+        if (g_sample_replan) {
+            sys_sched_plan(&g_sched, g_sample_periods, now_us);
+            g_sample_replan = 0;
+        }
+        uint32_t due = sys_sched_take_due(&g_sched, now_us);
+        sys_slot_map_t map[SYSTEM_VALUE_COUNT];
+        memcpy(map, g_sample_map, sizeof(map));
+        pthread_mutex_unlock(&g_sample_lock);
+
+        system_sample_t sample;
+        if (due) collect_system_sample(&sample, map, due, &g_sched);
+
+        pthread_mutex_lock(&g_sample_lock);
+        if (due) {
+            system_sample_merge(&g_sample_pending, &sample);
+            memcpy(g_sample_stats, g_sched.group, sizeof(g_sample_stats));
+            g_sample_seq++;
+            if (g_sample_wake[1] >= 0) {
+                char b = 1;
+                if (write(g_sample_wake[1], &b, 1) < 0) {
+                    // pipe full: a wakeup is already pending
+                }
+            }
+        }
+
+        // With nothing consumed the thread only wakes for a reload or stop
+        uint64_t next_us = sys_sched_next_due(&g_sched);
+        if (next_us == 0) next_us = monotonic_us64() + 60000000ull;
+        struct timespec until;
+        until.tv_sec = (time_t)(next_us / 1000000u);
+        until.tv_nsec = (long)(next_us % 1000000u) * 1000L;
+        while (!g_sample_stop && !g_sample_replan) {
+            if (pthread_cond_timedwait(&g_sample_cond, &g_sample_lock, &until) == ETIMEDOUT) break;
+        }
+    }
+    pthread_mutex_unlock(&g_sample_lock);
+    return NULL;
+}
+
+static void system_sampler_start(void)
+{
+    system_group_periods(g_sample_periods);
+    memcpy(g_sample_map, g_cfg.system_slots, sizeof(g_sample_map));
+    system_sample_clear(&g_sample_pending);
+    g_sample_replan = 1;
+    if (pipe(g_sample_wake) == 0) {
+        for (int i = 0; i < 2; i++) fcntl(g_sample_wake[i], F_SETFL, fcntl(g_sample_wake[i], F_GETFL, 0) | O_NONBLOCK);
+    } else {
+        g_sample_wake[0] = g_sample_wake[1] = -1;
+    }
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_sample_cond, &ca);
+    pthread_condattr_destroy(&ca);
+
+    g_sample_stop = 0;
+    if (pthread_create(&g_sample_thread, NULL, system_sampler_main, NULL) != 0) {
+        fprintf(stderr, "System sampler thread failed to start, sampling inline\n");
+        return;
+    }
+    g_sample_running = 1;
+}
+
+static void system_sampler_stop(void)
+{
+    if (g_sample_running) {
+        pthread_mutex_lock(&g_sample_lock);
+        g_sample_stop = 1;
+        pthread_cond_signal(&g_sample_cond);
+        pthread_mutex_unlock(&g_sample_lock);
+        pthread_join(g_sample_thread, NULL);
+        g_sample_running = 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (g_sample_wake[i] >= 0) close(g_sample_wake[i]);
+        g_sample_wake[i] = -1;
+    }
+    proc_files_close();
+}
+
+// Picks up new periods and slot mapping after a SIGHUP reload and samples right away
+static void system_sampler_reconfigure(void)
+{
+    pthread_mutex_lock(&g_sample_lock);
+    system_group_periods(g_sample_periods);
+    memcpy(g_sample_map, g_cfg.system_slots, sizeof(g_sample_map));
+    g_sample_replan = 1;
+    pthread_cond_signal(&g_sample_cond);
+    pthread_mutex_unlock(&g_sample_lock);
+}
+
+static void system_sampler_drain_wake(void)
+{
+    char buf[16];
+    if (g_sample_wake[0] < 0) return;
+    while (read(g_sample_wake[0], buf, sizeof(buf)) > 0) {
+    }
+}
 
-    memset(udp_values, 0, sizeof(udp_values));
-    memset(udp_texts, 0, sizeof(udp_texts));
-    init_system_channels();
-    last_system_refresh_ms = 0;
-    last_channel_push_ms = 0;
-    pending_channel_flush = false;
+static bool refresh_system_values(void)
+{
+    system_sample_t sample;
+    if (g_sample_running) {
+        if (__atomic_load_n(&g_sample_seq, __ATOMIC_RELAXED) == g_sample_seen) return false;
+        pthread_mutex_lock(&g_sample_lock);
+        sample = g_sample_pending;
+        system_sample_clear(&g_sample_pending);
+        g_sample_seen = g_sample_seq;
+        pthread_mutex_unlock(&g_sample_lock);
+        return apply_system_sample(&sample);
+    }
+
+    uint64_t now_us = monotonic_us64();
+    if (g_sample_replan) {
+        system_group_periods(g_sample_periods);
+        sys_sched_plan(&g_sched, g_sample_periods, now_us);
+        g_sample_replan = 0;
+    }
+    uint32_t due = sys_sched_take_due(&g_sched, now_us);
+    if (!due) return false;
+    collect_system_sample(&sample, g_cfg.system_slots, due, &g_sched);
+    memcpy(g_sample_stats, g_sched.group, sizeof(g_sample_stats));
+    return apply_system_sample(&sample);
+}
+
+// Next inline collection time in ms, 0 while the sampler thread owns collection
+static uint64_t system_refresh_deadline(void)
+{
+    if (g_sample_running) return 0;
+    uint64_t next_us = sys_sched_next_due(&g_sched);
+    return next_us ? (next_us + 999u) / 1000u : 0;
+}
+
+static const MI_RGN_CanvasInfo_t *get_cached_canvas(osd_region_t *r)
+{
+    if (!r->canvas_valid || !r->canvas.virtAddr) {
+        if (MI_RGN_GetCanvasInfo(r->handle, &r->canvas) != MI_RGN_OK) {
+            r->canvas_valid = 0;
+            return NULL;
+        }
+        r->canvas_valid = 1;
+    }
+    return &r->canvas;
+}
+
+// -------------------------
+// Pixel conversion
+// -------------------------
+/*
+ * ARGB8888 -> ARGB4444 by keeping the upper nibble of each channel. LVGL stores
+ * ARGB8888 as B,G,R,A bytes; the little-endian 16-bit result is AAAA RRRR GGGG BBBB,
+ * i.e. byte 0 = G4B4 and byte 1 = A4R4. The NEON path deinterleaves 16 pixels per
+ * iteration (vld4q), merges channel pairs with a shift-right-insert and stores the
+ * two result bytes interleaved (vst2q); an 8-pixel step and the scalar loop handle
+ * the tail.
+ */
+static void convert_row_argb8888_to_argb4444(uint16_t *dst, const uint32_t *src, int count)
+{
+    int x = 0;
+#if OSD_NEON_ENABLED
+    for (; x + 16 <= count; x += 16) {
+        uint8x16x4_t px = vld4q_u8((const uint8_t *)(src + x));  // val[0]=B [1]=G [2]=R [3]=A
+        uint8x16x2_t out;
+        out.val[0] = vsriq_n_u8(px.val[1], px.val[0], 4);  // G4B4
+        out.val[1] = vsriq_n_u8(px.val[3], px.val[2], 4);  // A4R4
+        vst2q_u8((uint8_t *)(dst + x), out);
+    }
+    for (; x + 8 <= count; x += 8) {
+        uint8x8x4_t px = vld4_u8((const uint8_t *)(src + x));
+        uint8x8x2_t out;
+        out.val[0] = vsri_n_u8(px.val[1], px.val[0], 4);
+        out.val[1] = vsri_n_u8(px.val[3], px.val[2], 4);
+        vst2_u8((uint8_t *)(dst + x), out);
+    }
+#endif
+    for (; x < count; x++) {
+        uint32_t argb8888 = src[x];
+        dst[x] = (uint16_t)(((argb8888 >> 16) & 0xF000) |  // A
+                            ((argb8888 >> 12) & 0x0F00) |  // R
+                            ((argb8888 >> 8) & 0x00F0) |   // G
+                            ((argb8888 >> 4) & 0x000F));   // B
+    }
+}
+
+/*
+ * ARGB8888 -> ARGB1555: the top bit of alpha and the upper five bits of each
+ * color, little-endian A RRRRR GGGGG BBBBB (byte 0 = G3B5, byte 1 = A1R5G2).
+ * The NEON path builds both bytes with shift-right-inserts like the ARGB4444
+ * one.
+ */
+static void convert_row_argb8888_to_argb1555(uint16_t *dst, const uint32_t *src, int count)
+{
+    int x = 0;
+#if OSD_NEON_ENABLED
+    for (; x + 16 <= count; x += 16) {
+        uint8x16x4_t px = vld4q_u8((const uint8_t *)(src + x));  // val[0]=B [1]=G [2]=R [3]=A
+        uint8x16x2_t out;
+        out.val[0] = vsriq_n_u8(vshlq_n_u8(px.val[1], 2), px.val[0], 3);                // G3B5
+        out.val[1] = vsriq_n_u8(vsriq_n_u8(px.val[3], px.val[2], 1), px.val[1], 6);     // A1R5G2
+        vst2q_u8((uint8_t *)(dst + x), out);
+    }
+#endif
+    for (; x < count; x++) {
+        uint32_t argb8888 = src[x];
+        dst[x] = (uint16_t)(((argb8888 >> 16) & 0x8000) |  // A
+                            ((argb8888 >> 9) & 0x7C00) |   // R
+                            ((argb8888 >> 6) & 0x03E0) |   // G
+                            ((argb8888 >> 3) & 0x001F));   // B
+    }
+}
+
+// Image blobs carry ARGB4444; widen each channel to match the ARGB8888 path
+static uint16_t argb4444_to_argb1555(uint16_t p)
+{
+    uint16_t r = (uint16_t)((p >> 8) & 0xF);
+    uint16_t g = (uint16_t)((p >> 4) & 0xF);
+    uint16_t b = (uint16_t)(p & 0xF);
+    return (uint16_t)((p & 0x8000) | ((r << 1 | r >> 3) << 10) | ((g << 1 | g >> 3) << 5) | (b << 1 | b >> 3));
+}
+
+// -------------------------
+// Palette (I8/I4 canvas)
+// -------------------------
+// I4 packs two pixels per byte; set to 0 if the left pixel lives in the high nibble.
+#ifndef OSD_I4_LOW_NIBBLE_FIRST
+#define OSD_I4_LOW_NIBBLE_FIRST 1
+#endif
+
+static uint32_t g_palette_argb[MI_RGN_MAX_PALETTE_TABLE_NUM];
+static int g_palette_count = 0;
+static int g_palette_capacity = 0;
+static int g_palette_dropped = 0;
+// Nearest-palette index per ARGB4444 value, filled lazily on first use
+static uint8_t *g_palette_lut = NULL;
+static uint32_t *g_palette_lut_valid = NULL;
+static uint16_t *g_palette_keys = NULL;  // one row of ARGB4444 keys
+
+static void palette_add(uint32_t argb)
+{
+    if ((argb >> 24) == 0) argb = 0;  // every transparent color is index 0
+    for (int i = 0; i < g_palette_count; i++) {
+        if (g_palette_argb[i] == argb) return;
+    }
+    if (g_palette_count >= g_palette_capacity) {
+        g_palette_dropped++;
+        return;
+    }
+    g_palette_argb[g_palette_count++] = argb;
+}
+
+static uint32_t with_opa(uint32_t rgb, lv_opa_t opa)
+{
+    return ((uint32_t)opa << 24) | (rgb & 0xFFFFFF);
+}
+
+// Most important colors first so an I4 palette keeps what the layout needs:
+// transparent, text, bar fills, the asset backgrounds, then built-in styles and
+// anti-aliasing ramps for text edges.
+static void palette_build(int capacity)
+{
+    const int bg_count = (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0]));
+
+    g_palette_capacity = capacity;
+    g_palette_count = 0;
+    g_palette_dropped = 0;
+    palette_add(0);
+
+    for (int i = 0; i < asset_count; i++) {
+        palette_add(with_opa(assets[i].cfg.text_color, LV_OPA_COVER));
+    }
+    for (int i = 0; i < asset_count; i++) {
+        if (assets[i].cfg.type != ASSET_TEXT) palette_add(with_opa(assets[i].cfg.color, LV_OPA_COVER));
+        if (assets[i].cfg.type == ASSET_GRAPH) palette_add(with_opa(assets[i].cfg.color, GRAPH_FILL_OPA));
+        if (assets[i].cfg.type == ASSET_GAUGE) palette_add(with_opa(assets[i].cfg.color, GAUGE_TRACK_OPA));
+    }
+    for (int i = 0; i < asset_count; i++) {
+        int bg = assets[i].cfg.bg_style;
+        if (bg >= 0 && bg < bg_count) {
+            palette_add(with_opa(g_bg_styles[bg].color, g_bg_styles[bg].opa));
+        } else if (assets[i].cfg.type != ASSET_TEXT) {
+            palette_add(with_opa(0x222222, LV_OPA_40));  // style_bar_container fallback
+        }
+    }
+    palette_add(with_opa(0xFFFFFF, LV_OPA_COVER));  // stats overlay
+    palette_add(with_opa(0x000000, LV_OPA_70));
+    for (int i = 0; i < bg_count; i++) {
+        palette_add(with_opa(g_bg_styles[i].color, g_bg_styles[i].opa));
+    }
+    for (int i = 0; i < asset_count; i++) {
+        palette_add(with_opa(assets[i].cfg.text_color, LV_OPA_50));
+    }
+    for (int i = 0; i < asset_count; i++) {
+        palette_add(with_opa(assets[i].cfg.text_color, LV_OPA_80));
+        palette_add(with_opa(assets[i].cfg.text_color, LV_OPA_20));
+    }
+    for (int i = 0; i < asset_count; i++) {
+        if (assets[i].cfg.type == ASSET_IMAGE) image_palette_add(assets[i].cfg.image);
+    }
+
+    memset(&g_stPaletteTable, 0, sizeof(g_stPaletteTable));
+    for (int i = 0; i < g_palette_count; i++) {
+        uint32_t c = g_palette_argb[i];
+        g_stPaletteTable.astElement[i].u8Alpha = (MI_U8)(c >> 24);
+        g_stPaletteTable.astElement[i].u8Red = (MI_U8)(c >> 16);
+        g_stPaletteTable.astElement[i].u8Green = (MI_U8)(c >> 8);
+        g_stPaletteTable.astElement[i].u8Blue = (MI_U8)c;
+    }
+}
+
+static uint8_t palette_nearest(uint16_t key)
+{
+    int a = ((key >> 12) & 0xF) * 17;
+    int r = ((key >> 8) & 0xF) * 17;
+    int g = ((key >> 4) & 0xF) * 17;
+    int b = (key & 0xF) * 17;
+    if (a == 0) return 0;
+
+    int best = 0;
+    long best_d = -1;
+    for (int i = 0; i < g_palette_count; i++) {
+        uint32_t c = g_palette_argb[i];
+        int da = a - (int)(c >> 24);
+        int dr = r - (int)((c >> 16) & 0xFF);
+        int dg = g - (int)((c >> 8) & 0xFF);
+        int db = b - (int)(c & 0xFF);
+        // Color error matters less the more transparent the pixel is
+        long d = 2L * da * da + (((long)dr * dr + (long)dg * dg + (long)db * db) * a >> 8);
+        if (best_d < 0 || d < best_d) {
+            best_d = d;
+            best = i;
+        }
+    }
+    return (uint8_t)best;
+}
+
+static inline uint8_t palette_lookup(uint16_t key)
+{
+    uint32_t bit = 1u << (key & 31);
+    uint32_t *word = &g_palette_lut_valid[key >> 5];
+    if (!(*word & bit)) {
+        g_palette_lut[key] = palette_nearest(key);
+        *word |= bit;
+    }
+    return g_palette_lut[key];
+}
+
+static int palette_init(pixel_format_t fmt)
+{
+    g_palette_lut = (uint8_t *)malloc(65536);
+    g_palette_lut_valid = (uint32_t *)calloc(65536 / 32, sizeof(uint32_t));
+    g_palette_keys = (uint16_t *)malloc((size_t)osd_width * sizeof(uint16_t));
+    if (!g_palette_lut || !g_palette_lut_valid || !g_palette_keys) {
+        free(g_palette_lut);
+        free(g_palette_lut_valid);
+        free(g_palette_keys);
+        g_palette_lut = NULL;
+        g_palette_lut_valid = NULL;
+        g_palette_keys = NULL;
+        return -1;
+    }
+    palette_build(fmt == PIXEL_FORMAT_I4 ? 16 : MI_RGN_MAX_PALETTE_TABLE_NUM);
+    printf("Palette: %d colors%s\n", g_palette_count,
+           g_palette_dropped ? " (palette full, extra colors map to nearest)" : "");
+    return 0;
+}
+
+static void convert_row_argb8888_to_i8(uint8_t *dst, const uint32_t *src, int count)
+{
+    uint16_t *keys = g_palette_keys;
+    convert_row_argb8888_to_argb4444(keys, src, count);
+
+    // Runs of one color (mostly transparent) skip the table lookup
+    uint16_t last_key = keys[0];
+    uint8_t last_idx = palette_lookup(last_key);
+    for (int x = 0; x < count; x++) {
+        if (keys[x] != last_key) {
+            last_key = keys[x];
+            last_idx = palette_lookup(last_key);
+        }
+        dst[x] = last_idx;
+    }
+}
+
+static inline void i4_put(uint8_t *line, int px, uint8_t idx)
+{
+    uint8_t *b = &line[px >> 1];
+    if ((px & 1) == OSD_I4_LOW_NIBBLE_FIRST) {
+        *b = (uint8_t)((*b & 0x0F) | (idx << 4));
+    } else {
+        *b = (uint8_t)((*b & 0xF0) | (idx & 0x0F));
+    }
+}
+
+// Writes count pixels starting at column x0; only partial edge bytes are read back.
+static void convert_row_argb8888_to_i4(uint8_t *line, int x0, const uint32_t *src, int count)
+{
+    uint16_t *keys = g_palette_keys;
+    convert_row_argb8888_to_argb4444(keys, src, count);
+
+    int x = 0;
+    if (x0 & 1) {
+        i4_put(line, x0, palette_lookup(keys[0]));
+        x = 1;
+    }
+    for (; x + 2 <= count; x += 2) {
+        uint8_t first = palette_lookup(keys[x]);
+        uint8_t second = palette_lookup(keys[x + 1]);
+        line[(x0 + x) >> 1] = OSD_I4_LOW_NIBBLE_FIRST ? (uint8_t)(first | (second << 4))
+                                                      : (uint8_t)((first << 4) | second);
+    }
+    if (x < count) {
+        i4_put(line, x0 + x, palette_lookup(keys[x]));
+    }
+}
+
+// -------------------------
+// Canvas row stores
+// -------------------------
+/*
+ * The canvas is uncached memory shared with the VPE, so every byte stored costs
+ * bus bandwidth. Rows are split into runs of fully transparent source pixels,
+ * which become plain zero stores (ARGB4444 0x0000, palette index 0) without any
+ * conversion, and the converted pixels in between. With flush_compare each run
+ * is compared with the canvas in 16-byte chunks first and only chunks that
+ * differ are written; that trades an uncached read for every skipped write and
+ * pays off when most of a flushed area is unchanged. I4 rows, whose edge bytes
+ * are shared with neighbouring pixels, are always written.
+ */
+#define FLUSH_SPAN_MIN 16   // shorter transparent runs are converted with their neighbours
+#define FLUSH_CHUNK 16
+
+typedef struct {
+    uint64_t converted;     // pixels run through a format converter
+    uint64_t zeroed;        // pixels stored as transparent spans
+    uint64_t skipped;       // pixels whose chunk already matched (flush_compare)
+    uint64_t merged;        // invalidated areas folded into a larger pass (render_pass_cost_px)
+} flush_counters_t;
+
+static flush_counters_t g_flush_counters;
+static uint8_t *g_flush_row = NULL;  // one converted row for flush_compare
+
+static inline int transparent_run(const uint32_t *src, int x, int count)
+{
+    int n = x;
+    for (; n + 4 <= count; n += 4) {
+        if ((src[n] | src[n + 1] | src[n + 2] | src[n + 3]) & 0xFF000000u) break;
+    }
+    while (n < count && (src[n] >> 24) == 0) n++;
+    return n - x;
+}
+
+// Stores bytes from src (NULL = zeros) where the canvas differs; returns bytes skipped
+static size_t canvas_store_changed(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    static const uint8_t zeros[FLUSH_CHUNK];
+    size_t skipped = 0;
+    for (size_t off = 0; off < bytes; off += FLUSH_CHUNK) {
+        size_t n = bytes - off < FLUSH_CHUNK ? bytes - off : FLUSH_CHUNK;
+        const uint8_t *want = src ? src + off : zeros;
+        if (memcmp(dst + off, want, n) == 0) {
+            skipped += n;
+            continue;
+        }
+        memcpy(dst + off, want, n);
+    }
+    return skipped;
+}
+
+// Zero and converted spans of a byte-addressed format, "bytes" wide per pixel
+#define CANVAS_BYTE_SPANS(name, bytes, convert_row)                                                   \
+    static void canvas_zero_span_##name(uint8_t *line, int x0, int count)                             \
+    {                                                                                                 \
+        g_flush_counters.zeroed += (uint64_t)count;                                                   \
+        uint8_t *dst = line + (size_t)x0 * (bytes);                                                   \
+        if (!g_cfg.flush_compare) {                                                                   \
+            memset(dst, 0, (size_t)count * (bytes));                                                  \
+            return;                                                                                   \
+        }                                                                                             \
+        g_flush_counters.skipped += canvas_store_changed(dst, NULL, (size_t)count * (bytes)) / (bytes); \
+    }                                                                                                 \
+    static void canvas_convert_span_##name(uint8_t *line, int x0, const uint32_t *src, int count)     \
+    {                                                                                                 \
+        g_flush_counters.converted += (uint64_t)count;                                                \
+        uint8_t *dst = line + (size_t)x0 * (bytes);                                                   \
+        uint8_t *out = g_cfg.flush_compare && g_flush_row ? g_flush_row : dst;                        \
+        convert_row((void *)out, src, count);                                                         \
+        if (out == dst) return;                                                                       \
+        g_flush_counters.skipped += canvas_store_changed(dst, out, (size_t)count * (bytes)) / (bytes); \
+    }
+
+CANVAS_BYTE_SPANS(argb4444, 2, convert_row_argb8888_to_argb4444)
+CANVAS_BYTE_SPANS(argb1555, 2, convert_row_argb8888_to_argb1555)
+CANVAS_BYTE_SPANS(i8, 1, convert_row_argb8888_to_i8)
+
+// I4 shares edge bytes with the neighbouring pixels, so it is always written
+static void canvas_zero_span_i4(uint8_t *line, int x0, int count)
+{
+    g_flush_counters.zeroed += (uint64_t)count;
+    if (x0 & 1) {
+        i4_put(line, x0, 0);
+        x0++;
+        count--;
+    }
+    if (count & 1) i4_put(line, x0 + count - 1, 0);
+    memset(line + (x0 >> 1), 0, (size_t)(count >> 1));
+}
+
+static void canvas_convert_span_i4(uint8_t *line, int x0, const uint32_t *src, int count)
+{
+    g_flush_counters.converted += (uint64_t)count;
+    convert_row_argb8888_to_i4(line, x0, src, count);
+}
+
+// One clipped row: transparent runs of FLUSH_SPAN_MIN+ pixels (or a trailing one) become zero spans
+#define CANVAS_ROW_KERNEL(name)                                                                        \
+    static void canvas_store_row_##name(uint8_t *line, int x0, const uint32_t *src, int count)        \
+    {                                                                                                 \
+        int x = 0;                                                                                    \
+        while (x < count) {                                                                           \
+            int end = x;                                                                              \
+            int run = 0;                                                                              \
+            while (end < count) {                                                                     \
+                run = transparent_run(src, end, count);                                               \
+                if (run >= FLUSH_SPAN_MIN || end + run == count) break;                               \
+                end += run + 1;                                                                       \
+                run = 0;                                                                              \
+            }                                                                                         \
+            if (end > x) canvas_convert_span_##name(line, x0 + x, src + x, end - x);                  \
+            if (run > 0) canvas_zero_span_##name(line, x0 + end, run);                                \
+            x = end + run;                                                                            \
+        }                                                                                             \
+    }
+
+CANVAS_ROW_KERNEL(argb4444)
+CANVAS_ROW_KERNEL(argb1555)
+CANVAS_ROW_KERNEL(i8)
+CANVAS_ROW_KERNEL(i4)
+
+/*
+ * Per-format canvas pipeline. Each format gets its own row store stamped out
+ * from its span kernels, and mi_region_init points g_canvas_store_row at the
+ * one for pixel_format, so the flush never asks which format it writes.
+ */
+typedef void (*canvas_store_row_fn)(uint8_t *line, int x0, const uint32_t *src, int count);
+
+typedef struct {
+    MI_RGN_PixelFormat_e rgn;
+    int bpp;                    // bits per canvas pixel
+    int indexed;                // needs the palette
+    canvas_store_row_fn store_row;
+} canvas_kernel_t;
+
+static const canvas_kernel_t g_canvas_kernels[PIXEL_FORMAT_COUNT] = {
+    [PIXEL_FORMAT_ARGB4444] = {E_MI_RGN_PIXEL_FORMAT_ARGB4444, 16, 0, canvas_store_row_argb4444},
+    [PIXEL_FORMAT_I8] = {E_MI_RGN_PIXEL_FORMAT_I8, 8, 1, canvas_store_row_i8},
+    [PIXEL_FORMAT_I4] = {E_MI_RGN_PIXEL_FORMAT_I4, 4, 1, canvas_store_row_i4},
+    [PIXEL_FORMAT_ARGB1555] = {E_MI_RGN_PIXEL_FORMAT_ARGB1555, 16, 0, canvas_store_row_argb1555},
+};
+
+static canvas_store_row_fn g_canvas_store_row = canvas_store_row_argb4444;
+
+// -------------------------
+// MI_GFX back end
+// -------------------------
+/*
+ * With gfx_accel (and a GFX=1 build) the LVGL buffers come from MMA so the 2D
+ * engine can read them, and large flushed areas are converted ARGB8888 ->
+ * ARGB4444 by a GE blit straight into the canvas; the same engine handles the
+ * ping-pong copy-forward. Small areas stay on the CPU where the GE setup cost
+ * outweighs the copy. Any GE failure drops back to the CPU path for good.
+ */
+#define GFX_MIN_PIXELS 4096
+
+static MI_PHY g_render_phy[2];  // physical address of buf1/buf2 when MMA-backed, else 0
+
+#if OSD_GFX_ENABLED
+static int g_gfx_active = 0;
+
+static void gfx_init(void)
+{
+    if (!g_cfg.gfx_accel || g_canvas_format != PIXEL_FORMAT_ARGB4444) return;
+    if (MI_GFX_Open() != MI_SUCCESS) {
+        fprintf(stderr, "MI_GFX_Open failed, using CPU conversion\n");
+        return;
+    }
+    g_gfx_active = 1;
+    printf("MI_GFX: conversion and copy-forward offloaded\n");
+}
+
+static void gfx_disable(const char *what, MI_S32 ret)
+{
+    fprintf(stderr, "MI_GFX %s failed (0x%x), using CPU paths\n", what, (unsigned)ret);
+    g_gfx_active = 0;
+}
+
+static int gfx_blit(MI_GFX_Surface_t *src, MI_GFX_Rect_t *src_rect, MI_GFX_Surface_t *dst, MI_GFX_Rect_t *dst_rect)
+{
+    MI_GFX_Opt_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.stClipRect = *dst_rect;
+    opt.eSrcDfbBldOp = E_MI_GFX_DFB_BLD_ONE;
+    opt.eDstDfbBldOp = E_MI_GFX_DFB_BLD_ZERO;
+    opt.eMirror = E_MI_GFX_MIRROR_NONE;
+    opt.eRotate = E_MI_GFX_ROTATE_0;
+    opt.eDFBBlendFlag = E_MI_GFX_DFB_BLEND_NOFX;
+
+    MI_U16 fence = 0;
+    MI_S32 ret = MI_GFX_BitBlit(src, src_rect, dst, dst_rect, &opt, &fence);
+    if (ret != MI_SUCCESS) {
+        gfx_disable("BitBlit", ret);
+        return -1;
+    }
+    MI_GFX_WaitAllDone(FALSE, fence);
+    return 0;
+}
+#endif
+
+static uint8_t *render_buffer_alloc(size_t size, int slot)
+{
+    g_render_phy[slot] = 0;
+#if OSD_GFX_ENABLED
+    if (g_gfx_active) {
+        MI_PHY phy = 0;
+        void *virt = NULL;
+        if (MI_SYS_MMA_Alloc(NULL, (MI_U32)size, &phy) == MI_SUCCESS) {
+            if (MI_SYS_Mmap(phy, (MI_U32)size, &virt, TRUE) == MI_SUCCESS) {
+                g_render_phy[slot] = phy;
+                return (uint8_t *)virt;
+            }
+            MI_SYS_MMA_Free(phy);
+        }
+        fprintf(stderr, "MMA render buffer allocation failed, buffer %d uses CPU conversion\n", slot + 1);
+    }
+#endif
+    return (uint8_t *)malloc(size);
+}
+
+static void render_buffer_free(uint8_t *buf, size_t size, int slot)
+{
+    if (!buf) return;
+#if OSD_GFX_ENABLED
+    if (g_render_phy[slot]) {
+        MI_SYS_Munmap(buf, (MI_U32)size);
+        MI_SYS_MMA_Free(g_render_phy[slot]);
+        g_render_phy[slot] = 0;
+        return;
+    }
+#else
+    (void)size;
+    (void)slot;
+#endif
+    free(buf);
+}
+
+// GE conversion of one clipped area; returns 0 when the blit was done
+static int gfx_convert_area(const uint8_t *px_map, int src_stride, int src_rows, int sx, int sy,
+                            const MI_RGN_CanvasInfo_t *info, const osd_region_t *r, int dx, int dy, int w, int h)
+{
+#if OSD_GFX_ENABLED
+    if (!g_gfx_active || w * h < GFX_MIN_PIXELS || !info->phyAddr) return -1;
+    MI_PHY phy = px_map == buf1 ? g_render_phy[0] : (px_map == buf2 ? g_render_phy[1] : 0);
+    if (!phy) return -1;
+
+    // Rendered by the CPU through a cached mapping: push it out before the GE reads it
+    size_t first = (size_t)sy * (size_t)src_stride * 4;
+    MI_SYS_FlushInvCache((void *)(px_map + first), (MI_U32)((size_t)h * (size_t)src_stride * 4));
+
+    MI_GFX_Surface_t src = {phy, E_MI_GFX_FMT_ARGB8888, (MI_U32)src_stride, (MI_U32)src_rows, (MI_U32)src_stride * 4};
+    MI_GFX_Rect_t src_rect = {sx, sy, (MI_U32)w, (MI_U32)h};
+    MI_GFX_Surface_t dst = {info->phyAddr, E_MI_GFX_FMT_ARGB4444, (MI_U32)lv_area_get_width(&r->area),
+                            (MI_U32)lv_area_get_height(&r->area), info->u32Stride};
+    MI_GFX_Rect_t dst_rect = {dx, dy, (MI_U32)w, (MI_U32)h};
+    return gfx_blit(&src, &src_rect, &dst, &dst_rect);
+#else
+    (void)px_map; (void)src_stride; (void)src_rows; (void)sx; (void)sy;
+    (void)info; (void)r; (void)dx; (void)dy; (void)w; (void)h;
+    return -1;
+#endif
+}
+
+// GE canvas-to-canvas copy for the ping-pong copy-forward; area is region-local
+static int gfx_copy_area(const MI_RGN_CanvasInfo_t *dst, const MI_RGN_CanvasInfo_t *src, const lv_area_t *a)
+{
+#if OSD_GFX_ENABLED
+    int w = lv_area_get_width(a);
+    int h = lv_area_get_height(a);
+    if (!g_gfx_active || w * h < GFX_MIN_PIXELS || !dst->phyAddr || !src->phyAddr) return -1;
+    MI_U32 surf_w = src->u32Stride / 2;
+    MI_U32 surf_h = (MI_U32)(a->y2 + 1);
+    MI_GFX_Surface_t s = {src->phyAddr, E_MI_GFX_FMT_ARGB4444, surf_w, surf_h, src->u32Stride};
+    MI_GFX_Surface_t d = {dst->phyAddr, E_MI_GFX_FMT_ARGB4444, surf_w, surf_h, dst->u32Stride};
+    MI_GFX_Rect_t rect = {a->x1, a->y1, (MI_U32)w, (MI_U32)h};
+    MI_GFX_Rect_t dst_rect = rect;
+    return gfx_blit(&s, &rect, &d, &dst_rect);
+#else
+    (void)dst; (void)src; (void)a;
+    return -1;
+#endif
+}
+
+// -------------------------
+// LVGL flush callback
+// -------------------------
+/*
+ * Always called on the refresh (main) thread once every draw unit has finished
+ * the area, so with multiple draw units (make MT=1) px_map is stable and the
+ * region, latency and profiler state below is single-threaded. That holds only
+ * because flush_ready is signalled before returning: an asynchronous flush would
+ * let LVGL start rendering into the other buffer while this one is converted.
+ */
+void my_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    PROF_BEGIN(prof_t0);
+    const uint32_t *src = (const uint32_t *)px_map;  // Source is ARGB8888 (32-bit)
+    int src_stride = area->x2 - area->x1 + 1;
+    int src_x = area->x1;
+    int src_y = area->y1;
+    if (g_render_direct) {
+        // Direct mode hands over the full-frame buffer; the area is in screen coordinates
+        src_stride = osd_width;
+        src_x = 0;
+        src_y = 0;
+    }
+
+    for (int i = 0; i < g_region_count; i++) {
+        osd_region_t *r = &g_regions[i];
+        lv_area_t clip;
+        if (!lv_area_intersect(&clip, area, &r->area)) continue;
+        const MI_RGN_CanvasInfo_t *info = get_cached_canvas(r);
+        if (!info || !info->virtAddr) continue;
+
+        int w = clip.x2 - clip.x1 + 1;
+        int cx = clip.x1 - r->area.x1;
+        r->dirty = 1;
+        latency_flush();
+        if (gfx_convert_area(px_map, src_stride, g_render_rows, clip.x1 - src_x, clip.y1 - src_y,
+                             info, r, cx, clip.y1 - r->area.y1, w, clip.y2 - clip.y1 + 1) != 0) {
+            for (int y = clip.y1; y <= clip.y2; y++) {
+                uint8_t *line = (uint8_t *)(info->virtAddr + (y - r->area.y1) * info->u32Stride);
+                const uint32_t *row = src + (size_t)(y - src_y) * (size_t)src_stride + (size_t)(clip.x1 - src_x);
+                g_canvas_store_row(line, cx, row, w);
+            }
+        }
+        if (g_image_live) images_overlay(r, info, &clip);
+    }
+
+    if (g_frame_flush_count < FRAME_AREA_MAX) {
+        g_frame_areas[g_frame_flush_count] = *area;
+    }
+    if (g_frame_flush_count == 0) {
+        g_frame_dirty_area = *area;
+    } else {
+        lv_area_join(&g_frame_dirty_area, &g_frame_dirty_area, area);
+    }
+    g_frame_flush_count++;
+    g_canvas_dirty = 1;
+    g_hitch_cur.pixels += (uint32_t)lv_area_get_width(area) * (uint32_t)lv_area_get_height(area);
+#if OSD_PROFILE_ENABLED
+    g_prof_frame_flush_us += monotonic_us64() - prof_t0;
+    g_prof_frame_pixels += (uint64_t)lv_area_get_width(area) * (uint64_t)lv_area_get_height(area);
+#endif
+    lv_display_flush_ready(disp);
+}
+
+// -------------------------
+// Canvas commit / swap tracking
+// -------------------------
+// Area is in region-local pixels.
+static void canvas_copy_area(const MI_RGN_CanvasInfo_t *dst, const MI_RGN_CanvasInfo_t *src, const lv_area_t *a)
+{
+    if (gfx_copy_area(dst, src, a) == 0) return;
+
+    // Whole bytes covering the area; for I4 that may include a neighbouring pixel,
+    // which is harmless because the source is the complete newer frame.
+    size_t x_off = (size_t)a->x1 * (size_t)g_canvas_bpp / 8;
+    size_t x_end = ((size_t)a->x2 * (size_t)g_canvas_bpp) / 8 + (g_canvas_bpp + 7) / 8;
+    size_t row_bytes = x_end - x_off;
+    for (int y = a->y1; y <= a->y2; y++) {
+        size_t off = (size_t)y * src->u32Stride + x_off;
+        memcpy((uint8_t *)dst->virtAddr + off, (const uint8_t *)src->virtAddr + off, row_bytes);
+    }
+}
+
+static void canvas_copy_region_area(const osd_region_t *r, const MI_RGN_CanvasInfo_t *back,
+                                    const MI_RGN_CanvasInfo_t *front, const lv_area_t *screen_area)
+{
+    lv_area_t clip;
+    if (!lv_area_intersect(&clip, screen_area, &r->area)) return;
+    clip.x1 -= r->area.x1;
+    clip.x2 -= r->area.x1;
+    clip.y1 -= r->area.y1;
+    clip.y2 -= r->area.y1;
+    canvas_copy_area(back, front, &clip);
+}
+
+// Bring the new back canvas up to date with the frame that was just committed so
+// the next frame only has to render its own dirty areas.
+static void canvas_copy_forward(const osd_region_t *r, const MI_RGN_CanvasInfo_t *back, const MI_RGN_CanvasInfo_t *front)
+{
+    if (!back->virtAddr || !front->virtAddr || back->virtAddr == front->virtAddr) return;
+    if (back->u32Stride != front->u32Stride || g_frame_flush_count == 0) return;
+    if (g_frame_flush_count > FRAME_AREA_MAX) {
+        canvas_copy_region_area(r, back, front, &g_frame_dirty_area);
+        return;
+    }
+    for (int i = 0; i < g_frame_flush_count; i++) {
+        canvas_copy_region_area(r, back, front, &g_frame_areas[i]);
+    }
+}
+
+static void canvas_probe_swap(osd_region_t *r, const MI_RGN_CanvasInfo_t *front, const MI_RGN_CanvasInfo_t *next)
+{
+    r->probe_commits++;
+    if (r->probe_commits == 1) {
+        if (next->virtAddr == front->virtAddr) {
+            r->swap_mode = CANVAS_SWAP_SINGLE;
+            printf("Canvas %u: single buffer\n", (unsigned)r->handle);
+            return;
+        }
+        r->slots[0] = *front;
+        r->slots[1] = *next;
+        r->back = 1;
+        return;
+    }
+    if (next->virtAddr == r->slots[0].virtAddr && front->virtAddr == r->slots[1].virtAddr) {
+        r->slots[0] = *next;
+        r->back = 0;
+        r->swap_mode = CANVAS_SWAP_PINGPONG;
+        printf("Canvas %u: ping-pong buffers\n", (unsigned)r->handle);
+    } else {
+        r->swap_mode = CANVAS_SWAP_QUERY;
+        printf("Canvas %u: unrecognised swap pattern, querying per frame\n", (unsigned)r->handle);
+    }
+}
+
+static void canvas_reset_swap_tracking(osd_region_t *r)
+{
+    r->swap_mode = CANVAS_SWAP_PROBING;
+    r->probe_commits = 0;
+    r->back = 0;
+    memset(r->slots, 0, sizeof(r->slots));
+}
+
+static void commit_region(osd_region_t *r)
+{
+    MI_RGN_CanvasInfo_t front = r->canvas;
+    MI_S32 ret = MI_RGN_UpdateCanvas(r->handle);
+    if (ret != MI_RGN_OK) {
+        // Includes MI_NOTICE_RGN_BUFFER_CHANGE: the driver remapped its buffers
+        canvas_reset_swap_tracking(r);
+        r->canvas_valid = 0;
+        memset(&r->canvas, 0, sizeof(r->canvas));
+        return;
+    }
+
+    switch (r->swap_mode) {
+        case CANVAS_SWAP_SINGLE:
+            return;
+        case CANVAS_SWAP_PINGPONG:
+            r->back ^= 1;
+            r->canvas = r->slots[r->back];
+            canvas_copy_forward(r, &r->canvas, &front);
+            return;
+        case CANVAS_SWAP_PROBING:
+        case CANVAS_SWAP_QUERY:
+        default:
+            break;
+    }
+
+    MI_RGN_CanvasInfo_t next;
+    if (MI_RGN_GetCanvasInfo(r->handle, &next) != MI_RGN_OK) {
+        r->canvas_valid = 0;
+        memset(&r->canvas, 0, sizeof(r->canvas));
+        return;
+    }
+    r->canvas = next;
+    r->canvas_valid = 1;
+    if (r->swap_mode == CANVAS_SWAP_PROBING && front.virtAddr) {
+        canvas_probe_swap(r, &front, &next);
+        if (r->swap_mode != CANVAS_SWAP_QUERY && r->swap_mode != CANVAS_SWAP_SINGLE) {
+            canvas_copy_forward(r, &next, &front);
+        }
+    }
+}
 
-    memset(assets, 0, sizeof(assets));
-    asset_count = 1;
-    init_asset_defaults(&assets[0], 0);
+static void commit_canvas(void)
+{
+    for (int i = 0; i < g_region_count; i++) {
+        if (!g_regions[i].dirty) continue;
+        commit_region(&g_regions[i]);
+        g_regions[i].dirty = 0;
+    }
 }
 
-static void parse_assets_array(const char *json)
+// -------------------------
+// Initialize RGN
+// -------------------------
+static int region_handle_in_use(MI_RGN_HANDLE h)
 {
-    const char *p = strstr(json, "\"assets\"");
-    if (!p) return;
-    const char *arr = strchr(p, '[');
-    if (!arr) return;
-    p = arr + 1;
-    asset_count = 0;
+    for (int i = 0; i < g_region_count; i++) {
+        if (g_regions[i].handle == h) return 1;
+    }
+    return 0;
+}
 
-    while (*p && asset_count < MAX_ASSETS) {
-        while (*p && *p != '{' && *p != ']') p++;
-        if (*p == ']') break;
-        const char *obj_start = p;
-        int depth = 1;
-        p++;
-        while (*p && depth > 0) {
-            if (*p == '{') depth++;
-            else if (*p == '}') depth--;
-            p++;
+static int region_create(osd_region_t *r, const lv_area_t *area)
+{
+    MI_RGN_HANDLE h = 0;
+    while (region_handle_in_use(h)) h++;
+
+    memset(r, 0, sizeof(*r));
+    r->handle = h;
+    r->area = *area;
+    canvas_reset_swap_tracking(r);
+
+    MI_RGN_Attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.eType = E_MI_RGN_TYPE_OSD;
+    attr.stOsdInitParam.ePixelFmt = g_rgn_pixel_fmt;
+    attr.stOsdInitParam.stSize.u32Width = (MI_U32)lv_area_get_width(area);
+    attr.stOsdInitParam.stSize.u32Height = (MI_U32)lv_area_get_height(area);
+    if (MI_RGN_Create(h, &attr) != MI_RGN_OK) {
+        fprintf(stderr, "MI_RGN_Create failed for region %u\n", (unsigned)h);
+        return -1;
+    }
+
+    // The driver composites the same canvas onto each port, so extra streams cost no rendering
+    for (int i = 0; i < g_port_count; i++) {
+        MI_RGN_ChnPortParam_t chn_attr;
+        memset(&chn_attr, 0, sizeof(chn_attr));
+        chn_attr.bShow = 1;
+        chn_attr.stPoint.u32X = (MI_U32)(g_ports[i].x + area->x1);
+        chn_attr.stPoint.u32Y = (MI_U32)(g_ports[i].y + area->y1);
+        chn_attr.unPara.stOsdChnPort.u32Layer = 0;
+        chn_attr.unPara.stOsdChnPort.stOsdAlphaAttr.eAlphaMode = E_MI_RGN_PIXEL_ALPHA;
+        if (g_rgn_pixel_fmt == E_MI_RGN_PIXEL_FORMAT_ARGB1555) {
+            // The alpha bit selects between these: clear or fully opaque
+            chn_attr.unPara.stOsdChnPort.stOsdAlphaAttr.stAlphaPara.stArgb1555Alpha.u8BgAlpha = 0;
+            chn_attr.unPara.stOsdChnPort.stOsdAlphaAttr.stAlphaPara.stArgb1555Alpha.u8FgAlpha = 0xFF;
         }
-        const char *obj_end = p;
-        if (depth != 0) break;
+        if (MI_RGN_AttachToChn(h, &g_ports[i].chn, &chn_attr) != MI_RGN_OK && i > 0) {
+            fprintf(stderr, "MI_RGN_AttachToChn failed for region %u on VPE port %d\n", (unsigned)h,
+                    (int)g_ports[i].chn.s32OutputPortId);
+        }
+    }
 
-        asset_t a;
-        init_asset_defaults(&a, asset_count);
+    if (MI_RGN_GetCanvasInfo(h, &r->canvas) == MI_RGN_OK) {
+        r->canvas_valid = 1;
+    }
+    return 0;
+}
 
-        char type_buf[32];
-        if (json_get_string_range(obj_start, obj_end, "type", type_buf, sizeof(type_buf)) == 0) {
-            if (strcmp(type_buf, "text") == 0) {
-                a.cfg.type = ASSET_TEXT;
-            } else {
-                a.cfg.type = ASSET_BAR;
+static void region_destroy(osd_region_t *r)
+{
+    for (int i = 0; i < g_port_count; i++) MI_RGN_DetachFromChn(r->handle, &g_ports[i].chn);
+    MI_RGN_Destroy(r->handle);
+}
+
+void mi_region_init(void)
+{
+    if (g_canvas_kernels[g_cfg.pixel_format].indexed && palette_init(g_cfg.pixel_format) != 0) {
+        fprintf(stderr, "Palette allocation failed, using ARGB4444\n");
+        g_cfg.pixel_format = PIXEL_FORMAT_ARGB4444;
+    }
+    const canvas_kernel_t *k = &g_canvas_kernels[g_cfg.pixel_format];
+    g_rgn_pixel_fmt = k->rgn;
+    g_canvas_bpp = k->bpp;
+    g_canvas_store_row = k->store_row;
+    g_canvas_format = g_cfg.pixel_format;
+
+    MI_RGN_Init(&g_stPaletteTable);
+
+    g_port_count = 0;
+    for (int i = 0; i < g_cfg.osd_port_count; i++) {
+        int dup = 0;
+        for (int j = 0; j < g_port_count; j++) dup |= g_ports[j].chn.s32OutputPortId == g_cfg.osd_port[i];
+        if (dup) continue;
+        osd_port_t *p = &g_ports[g_port_count++];
+        memset(p, 0, sizeof(*p));
+        p->chn.eModId = E_MI_RGN_MODID_VPE;
+        p->chn.s32DevId = 0;
+        p->chn.s32ChnId = 0;
+        p->chn.s32OutputPortId = g_cfg.osd_port[i];
+        p->x = i < g_cfg.osd_port_xy_count ? g_cfg.osd_port_x[i] : rgn_pos_x;
+        p->y = i < g_cfg.osd_port_xy_count ? g_cfg.osd_port_y[i] : rgn_pos_y;
+    }
+
+    g_region_count = 0;
+    g_region_auto = g_cfg.region_mode == REGION_MODE_AUTO;
+    if (g_region_auto) return;  // planned once the assets exist
+
+    lv_area_t full = {0, 0, osd_width - 1, osd_height - 1};
+    if (region_create(&g_regions[0], &full) == 0) g_region_count = 1;
+}
+
+// -------------------------
+// Region planner
+// -------------------------
+#define REGION_PAD 8            // px kept around each visual so small growth needs no replan
+#define REGION_MERGE_SLACK 4096 // px of transparent area worth trading for one handle less
+
+static void region_align(lv_area_t *a)
+{
+    // Keep regions on 8-px columns and even rows so every pixel format packs cleanly
+    a->x1 = (a->x1 - REGION_PAD) & ~7;
+    a->x2 = ((a->x2 + REGION_PAD) | 7);
+    a->y1 = (a->y1 - REGION_PAD) & ~1;
+    a->y2 = ((a->y2 + REGION_PAD) | 1);
+    if (a->x1 < 0) a->x1 = 0;
+    if (a->y1 < 0) a->y1 = 0;
+    if (a->x2 > osd_width - 1) a->x2 = osd_width - 1;
+    if (a->y2 > osd_height - 1) a->y2 = osd_height - 1;
+}
+
+static int region_visual_box(lv_obj_t *obj, lv_area_t *out)
+{
+    if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) return 0;
+    lv_area_t coords;
+    lv_area_t screen = {0, 0, osd_width - 1, osd_height - 1};
+    lv_obj_get_coords(obj, &coords);
+    return lv_area_intersect(out, &coords, &screen) ? 1 : 0;
+}
+
+// Screen areas of everything that can paint: enabled assets and the stats overlay
+static int region_collect_boxes(lv_area_t *boxes, int max)
+{
+    int n = 0;
+    for (int i = 0; i < asset_count && n < max; i++) {
+        asset_t *asset = &assets[i];
+        if (!asset->cfg.enabled) continue;
+        lv_obj_t *top = asset->container_obj ? asset->container_obj : asset->obj;
+        if (region_visual_box(top, &boxes[n])) n++;
+    }
+    if (n < max && region_visual_box(stats_label, &boxes[n])) n++;
+    return n;
+}
+
+static int32_t region_area_size(const lv_area_t *a)
+{
+    return lv_area_get_width(a) * lv_area_get_height(a);
+}
+
+static int region_plan(lv_area_t *boxes, int n, int max_regions)
+{
+    for (int i = 0; i < n; i++) region_align(&boxes[i]);
+
+    // Greedy bounding-box clustering: merge the cheapest pair until the count fits
+    // and no pair wastes less than REGION_MERGE_SLACK. Overlapping regions are always
+    // merged because the VPE would blend the shared pixels twice.
+    while (n > 1) {
+        int best_i = -1;
+        int best_j = -1;
+        long best_cost = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                lv_area_t u;
+                lv_area_t ov;
+                lv_area_join(&u, &boxes[i], &boxes[j]);
+                long cost = (long)region_area_size(&u) - region_area_size(&boxes[i]) - region_area_size(&boxes[j]);
+                if (lv_area_intersect(&ov, &boxes[i], &boxes[j])) cost = LONG_MIN;
+                if (best_i < 0 || cost < best_cost) {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
             }
         }
+        if (n <= max_regions && best_cost > REGION_MERGE_SLACK) break;
+        lv_area_join(&boxes[best_i], &boxes[best_i], &boxes[best_j]);
+        boxes[best_j] = boxes[--n];
+    }
+    return n;
+}
 
-        int v = 0;
-        float fv = 0.0f;
-        int value_index_set = 0;
-        if (json_get_bool_range(obj_start, obj_end, "enabled", &v) == 0) a.cfg.enabled = v;
-        if (json_get_int_range(obj_start, obj_end, "value_index", &v) == 0) {
-            a.cfg.value_index = clamp_int(v, 0, TOTAL_VALUE_COUNT - 1);
-            value_index_set = 1;
+static int region_find(const lv_area_t *a)
+{
+    for (int i = 0; i < g_region_count; i++) {
+        const lv_area_t *r = &g_regions[i].area;
+        if (r->x1 == a->x1 && r->y1 == a->y1 && r->x2 == a->x2 && r->y2 == a->y2) return i;
+    }
+    return -1;
+}
+
+// Keep regions whose rectangle did not change and recreate the rest
+static void region_replan(void)
+{
+    lv_area_t boxes[ASSET_POOL_MAX + 1];
+    lv_obj_update_layout(lv_screen_active());
+    int n = region_collect_boxes(boxes, ASSET_POOL_MAX + 1);
+    n = region_plan(boxes, n, clamp_int(g_cfg.region_max, 1, OSD_REGION_MAX));
+
+    int changed = 0;
+    for (int i = 0; i < g_region_count;) {
+        int keep = 0;
+        for (int j = 0; j < n; j++) {
+            const lv_area_t *b = &boxes[j];
+            const lv_area_t *r = &g_regions[i].area;
+            if (r->x1 == b->x1 && r->y1 == b->y1 && r->x2 == b->x2 && r->y2 == b->y2) keep = 1;
         }
-        if (json_get_int_range(obj_start, obj_end, "id", &v) == 0) a.cfg.id = clamp_int(v, 0, 63);
-        if (json_get_int_range(obj_start, obj_end, "x", &v) == 0) a.cfg.x = v;
-        if (json_get_int_range(obj_start, obj_end, "y", &v) == 0) a.cfg.y = v;
-        if (json_get_int_range(obj_start, obj_end, "width", &v) == 0) a.cfg.width = v;
-        if (json_get_int_range(obj_start, obj_end, "height", &v) == 0) a.cfg.height = v;
-        if (json_get_float_range(obj_start, obj_end, "min", &fv) == 0) a.cfg.min = fv;
-        if (json_get_float_range(obj_start, obj_end, "max", &fv) == 0) a.cfg.max = fv;
-        if (json_get_int_range(obj_start, obj_end, "bar_color", &v) == 0) a.cfg.color = (uint32_t)v;
-        if (json_get_int_range(obj_start, obj_end, "text_color", &v) == 0) a.cfg.text_color = (uint32_t)v;
-        if (json_get_int_range(obj_start, obj_end, "background", &v) == 0) a.cfg.bg_style = clamp_int(v, -1, (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0])) - 1);
-        if (json_get_int_range(obj_start, obj_end, "background_opacity", &v) == 0) a.cfg.bg_opacity_pct = clamp_int(v, 0, 100);
-        if (json_get_int_range(obj_start, obj_end, "segments", &v) == 0) a.cfg.segments = clamp_int(v, 0, 64);
-        if (json_get_int_range(obj_start, obj_end, "text_index", &v) == 0) a.cfg.text_index = clamp_int(v, -1, TOTAL_TEXT_COUNT - 1);
-        json_get_int_array_range(obj_start, obj_end, "text_indices", a.cfg.text_indices, 8, &a.cfg.text_indices_count, -1);
-        for (int i = 0; i < a.cfg.text_indices_count; i++) {
-            if (a.cfg.text_indices[i] >= 0) {
-                a.cfg.text_indices[i] = clamp_int(a.cfg.text_indices[i], 0, TOTAL_TEXT_COUNT - 1);
-            }
+        if (keep) {
+            i++;
+            continue;
         }
-        json_get_int_array_range(obj_start, obj_end, "value_indices", a.cfg.value_indices, 8, &a.cfg.value_indices_count, -1);
-        for (int i = 0; i < a.cfg.value_indices_count; i++) {
-            if (a.cfg.value_indices[i] >= 0) {
-                a.cfg.value_indices[i] = clamp_int(a.cfg.value_indices[i], 0, TOTAL_VALUE_COUNT - 1);
-            }
+        region_destroy(&g_regions[i]);
+        g_regions[i] = g_regions[--g_region_count];
+        changed = 1;
+    }
+    for (int j = 0; j < n; j++) {
+        if (region_find(&boxes[j]) >= 0 || g_region_count >= OSD_REGION_MAX) continue;
+        if (region_create(&g_regions[g_region_count], &boxes[j]) == 0) {
+            g_region_count++;
+            changed = 1;
+        }
+    }
+    if (!changed) return;
+
+    uint32_t pixels = 0;
+    for (int i = 0; i < g_region_count; i++) pixels += (uint32_t)region_area_size(&g_regions[i].area);
+    printf("Regions: %d covering %u of %u px\n", g_region_count, pixels, (unsigned)(osd_width * osd_height));
+    // New canvases start undefined; repaint everything into them
+    lv_obj_invalidate(lv_screen_active());
+}
+
+// Visual grew past its region (e.g. longer text): plan again
+static int region_plan_covers_visuals(void)
+{
+    lv_area_t boxes[ASSET_POOL_MAX + 1];
+    int n = region_collect_boxes(boxes, ASSET_POOL_MAX + 1);
+    for (int i = 0; i < n; i++) {
+        int covered = 0;
+        for (int j = 0; j < g_region_count && !covered; j++) {
+            const lv_area_t *r = &g_regions[j].area;
+            covered = boxes[i].x1 >= r->x1 && boxes[i].y1 >= r->y1 && boxes[i].x2 <= r->x2 && boxes[i].y2 <= r->y2;
+        }
+        if (!covered) return 0;
+    }
+    return 1;
+}
+
+// -------------------------
+// Initialize LVGL display
+// -------------------------
+// -------------------------
+// Scheduling, affinity and memory locking
+// -------------------------
+/*
+ * Everything here acts on the calling thread, and threads inherit their
+ * creator's mask and policy. process_tuning_apply runs in main() before any
+ * thread exists so it covers the whole process; render_cpus is applied just
+ * before lv_init, so it also narrows the LVGL draw unit threads and every
+ * helper thread started after them.
+ */
+static void cpu_mask_apply(const char *what, int mask)
+{
+    if (mask == 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < 16; i++) {
+        if (mask & (1 << i)) CPU_SET(i, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        fprintf(stderr, "%s 0x%x: %s\n", what, (unsigned)mask, strerror(errno));
+        return;
+    }
+    printf("%s: pinned to CPU mask 0x%x\n", what, (unsigned)mask);
+}
+
+static void process_tuning_apply(void)
+{
+    cpu_mask_apply("cpu_affinity", g_cfg.cpu_affinity);
+
+    // MCL_FUTURE also populates the LVGL pool, render buffers and later mappings up front
+    if (g_cfg.mlock && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        fprintf(stderr, "mlockall: %s\n", strerror(errno));
+    }
+
+    if (g_cfg.sched_policy == SCHED_OTHER) return;
+    int policy = g_cfg.sched_policy;
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = clamp_int(g_cfg.sched_priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+    if (sched_setscheduler(0, policy, &sp) != 0) {
+        fprintf(stderr, "sched_policy %s/%d: %s\n", policy == SCHED_FIFO ? "fifo" : "rr", sp.sched_priority,
+                strerror(errno));
+        return;
+    }
+    printf("Scheduling: %s priority %d\n", policy == SCHED_FIFO ? "fifo" : "rr", sp.sched_priority);
+}
+
+// Writes each page of the render buffers and reads each canvas page so the first
+// frames after startup do not take the faults; mlockall then keeps them resident
+static void prefault_range(uint8_t *p, size_t len, int write)
+{
+    if (!p || len == 0) return;
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+    for (size_t off = 0; off < len; off += (size_t)page) {
+        if (write) {
+            p[off] = 0;
+        } else {
+            (void)*(volatile uint8_t *)(p + off);
+        }
+    }
+}
+
+static void prefault_render_memory(void)
+{
+    if (!g_cfg.mlock) return;
+    prefault_range(buf1, g_render_buf_size, 1);
+    prefault_range(buf2, g_render_buf_size, 1);
+    for (int i = 0; i < g_region_count; i++) {
+        const MI_RGN_CanvasInfo_t *info = get_cached_canvas(&g_regions[i]);
+        if (!info || !info->virtAddr) continue;
+        prefault_range((uint8_t *)info->virtAddr, (size_t)info->u32Stride * info->stSize.u32Height, 0);
+    }
+}
+
+// -------------------------
+// LVGL heap
+// -------------------------
+/*
+ * The builtin allocator starts with the compile-time LV_MEM_SIZE pool.
+ * lvgl_heap tops it up once at startup, either to a fixed size or, with
+ * "auto", to an estimate for max_assets, so each board can be right-sized.
+ * heap_sample() polls lv_mem_monitor at most once a second for the peak use,
+ * the smallest largest-free-block seen and the worst fragmentation, and
+ * raises a one-shot alarm when use crosses heap_alarm_pct.
+ */
+#define HEAP_SAMPLE_MS 1000
+#define HEAP_AUTO_BASE (32 * 1024)        // display, screen, timers and the stats panel
+#define HEAP_AUTO_PER_ASSET (2 * 1024)    // container, widget, label and local styles
+#define HEAP_ALARM_HYST_PCT 5
+
+typedef struct {
+    uint32_t total;
+    uint32_t used;
+    uint32_t peak_used;
+    uint32_t biggest_free;
+    uint32_t min_biggest_free;  // worst largest-free-block since startup
+    uint32_t frag_pct;
+    uint32_t max_frag_pct;
+    uint32_t assert_fails;      // LVGL asserts, i.e. failed allocations
+    uint32_t alarms;            // heap_alarm_pct crossings
+    int alarmed;
+    uint64_t next_ms;
+} heap_stats_t;
+
+static heap_stats_t g_heap = {0};
+static void *g_heap_extra = NULL;   // pool added with lv_mem_add_pool, lives until exit
+
+/*
+ * lv_conf.h routes LV_ASSERT_HANDLER here instead of halting: LVGL checks
+ * the result right after each allocation assert, so a failed allocation
+ * just skips that object or text and shows up in the counters.
+ */
+void osd_lvgl_assert(void)
+{
+    g_heap.assert_fails++;
+    if (g_heap.assert_fails <= 8 || (g_heap.assert_fails & (g_heap.assert_fails - 1)) == 0) {
+        fprintf(stderr, "LVGL: assertion failed (out of heap?), %u so far\n", g_heap.assert_fails);
+    }
+}
+
+static void heap_extend(void)
+{
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    size_t want = 0;
+    if (g_cfg.lvgl_heap_auto) {
+        want = HEAP_AUTO_BASE + (size_t)HEAP_AUTO_PER_ASSET * (size_t)g_asset_capacity;
+    } else if (g_cfg.lvgl_heap_kb > 0) {
+        want = (size_t)g_cfg.lvgl_heap_kb * 1024;
+    }
+    if (want <= LV_MEM_SIZE) {
+        if (want > 0) printf("LVGL heap: %u bytes built in, no extra pool needed\n", (unsigned)LV_MEM_SIZE);
+        return;
+    }
+    size_t extra = want - LV_MEM_SIZE;
+    g_heap_extra = malloc(extra);
+    if (!g_heap_extra || !lv_mem_add_pool(g_heap_extra, extra)) {
+        fprintf(stderr, "LVGL heap: could not add a %u byte pool\n", (unsigned)extra);
+        free(g_heap_extra);
+        g_heap_extra = NULL;
+        return;
+    }
+    printf("LVGL heap: %u bytes built in + %u byte pool\n", (unsigned)LV_MEM_SIZE, (unsigned)extra);
+#endif
+}
+
+// Cheap when not due; force = 1 samples right away (after creating assets)
+static void heap_sample(uint64_t now, int force)
+{
+    if (!force && now < g_heap.next_ms) return;
+    g_heap.next_ms = now + HEAP_SAMPLE_MS;
+
+    lv_mem_monitor_t mon;
+    memset(&mon, 0, sizeof(mon));
+    lv_mem_monitor(&mon);
+    g_heap.total = mon.total_size;
+    g_heap.used = mon.total_size - mon.free_size;
+    if (mon.max_used > g_heap.peak_used) g_heap.peak_used = mon.max_used;
+    if (g_heap.used > g_heap.peak_used) g_heap.peak_used = g_heap.used;
+    g_heap.biggest_free = mon.free_biggest_size;
+    if (g_heap.min_biggest_free == 0 || mon.free_biggest_size < g_heap.min_biggest_free) {
+        g_heap.min_biggest_free = mon.free_biggest_size;
+    }
+    g_heap.frag_pct = mon.frag_pct;
+    if (mon.frag_pct > g_heap.max_frag_pct) g_heap.max_frag_pct = mon.frag_pct;
+
+    if (g_cfg.heap_alarm_pct <= 0 || g_heap.total == 0) return;
+    int used_pct = (int)((uint64_t)g_heap.used * 100 / g_heap.total);
+    if (!g_heap.alarmed && used_pct >= g_cfg.heap_alarm_pct) {
+        g_heap.alarmed = 1;
+        g_heap.alarms++;
+        fprintf(stderr, "LVGL heap: %d%% used (%u of %u bytes), largest free block %u, frag %u%%\n",
+                used_pct, g_heap.used, g_heap.total, g_heap.biggest_free, g_heap.frag_pct);
+    } else if (g_heap.alarmed && used_pct < g_cfg.heap_alarm_pct - HEAP_ALARM_HYST_PCT) {
+        g_heap.alarmed = 0;
+    }
+}
+
+// -------------------------
+// Dirty-area coalescing
+// -------------------------
+/*
+ * LVGL only joins invalidated areas that touch and whose union is smaller than
+ * the pair, so a frame with a few small scattered changes (two bars and the
+ * stats line) is rendered once per area, each pass paying the layer setup, an
+ * object tree walk and a my_flush_cb with its canvas lookups. The display's
+ * LV_EVENT_INVALIDATE_AREA may grow an area before LVGL stores it: the area is
+ * widened over every area of this frame that one larger pass renders more
+ * cheaply, and LVGL's own join then folds the absorbed areas into it. A pass is
+ * priced at render_pass_cost_px pixels. In partial mode an area w pixels wide
+ * is rendered in strips of render buffer / w rows starting at its top row, so
+ * the cost counts whole strips: rows added inside a strip that is paid for
+ * anyway only cost their pixels.
+ */
+#define INV_TRACK_MAX 32  // LV_INV_BUF_SIZE; past it LVGL redraws the whole screen anyway
+
+static lv_area_t g_inv_track[INV_TRACK_MAX];  // areas invalidated since the last refresh
+static int g_inv_track_count = 0;
+
+static uint32_t inv_area_passes(const lv_area_t *a)
+{
+    int32_t w = lv_area_get_width(a);
+    int32_t h = lv_area_get_height(a);
+    if (g_render_direct || w <= 0 || h <= 0) return 1;
+    size_t rows = g_render_buf_size / sizeof(uint32_t) / (size_t)w;
+    if (rows < 1) rows = 1;
+    return (uint32_t)(((size_t)h + rows - 1) / rows);
+}
+
+static uint64_t inv_area_cost(const lv_area_t *a)
+{
+    return (uint64_t)lv_area_get_size(a) + (uint64_t)inv_area_passes(a) * (uint64_t)g_cfg.render_pass_cost_px;
+}
+
+// Grows *area over the tracked areas it is cheaper to render together with
+static int inv_area_absorb(lv_area_t *area)
+{
+    int absorbed = 0;
+    for (int again = 1; again;) {
+        again = 0;
+        for (int i = 0; i < g_inv_track_count; i++) {
+            lv_area_t u;
+            lv_area_join(&u, area, &g_inv_track[i]);
+            if (inv_area_cost(&u) >= inv_area_cost(area) + inv_area_cost(&g_inv_track[i])) continue;
+            *area = u;
+            g_inv_track[i--] = g_inv_track[--g_inv_track_count];
+            absorbed++;
+            again = 1;
+        }
+    }
+    return absorbed;
+}
+
+static void inv_policy_event_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_REFR_READY) {
+        g_inv_track_count = 0;
+        return;
+    }
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    if (!area || g_cfg.render_pass_cost_px <= 0) return;
+    g_flush_counters.merged += (uint64_t)inv_area_absorb(area);
+    if (g_inv_track_count < INV_TRACK_MAX) g_inv_track[g_inv_track_count++] = *area;
+}
+
+void init_lvgl(void)
+{
+    cpu_mask_apply("render_cpus", g_cfg.render_cpus);
+    lv_init();
+    heap_extend();
+
+    // Set LVGL tick callback
+    lv_tick_set_cb(my_get_milliseconds);
+
+    // LVGL's software renderer cannot blend into ARGB4444, so it keeps rendering
+    // ARGB8888 strips that my_flush_cb converts straight into the canvas. Size the
+    // strip by the real pixel size (lv_color_t is only 24-bit in v9).
+    // Direct mode keeps one full-frame buffer so each dirty area is rendered in a
+    // single pass at its screen position and only that area is converted.
+    g_render_direct = g_cfg.render_mode == RENDER_MODE_DIRECT;
+    int rows = g_render_direct ? osd_height : clamp_int(g_cfg.render_rows, 1, osd_height);
+    size_t buf_size = (size_t)osd_width * rows * lv_color_format_get_size(LV_COLOR_FORMAT_ARGB8888);
+    g_render_rows = rows;
+    g_render_buf_size = buf_size;
+#if OSD_GFX_ENABLED
+    gfx_init();
+#endif
+    buf1 = render_buffer_alloc(buf_size, 0);
+    if (g_cfg.render_buffers > 1) buf2 = render_buffer_alloc(buf_size, 1);
+    if (!buf1 || (g_cfg.render_buffers > 1 && !buf2)) {
+        fprintf(stderr, "Failed to allocate LVGL buffers\n");
+        exit(1);
+    }
+    // Without it flush_compare simply writes every chunk
+    g_flush_row = (uint8_t *)malloc((size_t)osd_width * sizeof(uint16_t));
+
+    lv_display_t * disp = lv_display_create(osd_width, osd_height);
+    g_display = disp;
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_ARGB8888);
+    lv_display_set_buffers(disp, buf1, buf2, buf_size,
+                           g_render_direct ? LV_DISPLAY_RENDER_MODE_DIRECT : LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, my_flush_cb);
+    lv_display_add_event_cb(disp, inv_policy_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, inv_policy_event_cb, LV_EVENT_REFR_READY, NULL);
+}
+
+
+static lv_obj_t *create_bar(asset_t *asset)
+{
+    if (!asset) return NULL;
+    const asset_cfg_t *cfg = &asset->cfg;
+    asset->container_obj = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(asset->container_obj);
+    lv_obj_clear_flag(asset->container_obj, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *bar = lv_bar_create(asset->container_obj);
+    lv_obj_remove_style_all(bar);
+    if (cfg->rounded_outline) {
+        lv_obj_set_style_border_width(bar, 2, 0);
+        lv_obj_set_style_border_color(bar, lv_color_hex(cfg->color), 0);
+        lv_obj_set_style_pad_all(bar, 6, 0);
+        lv_obj_set_style_radius(bar, 6, 0);
+        lv_obj_set_style_anim_duration(bar, 1000, 0);
+    } else {
+        lv_obj_set_style_bg_opa(bar, LV_OPA_TRANSP, LV_PART_MAIN);
+        lv_obj_set_style_radius(bar, cfg->height > 0 ? cfg->height / 2 : 16, LV_PART_MAIN);
+    }
+    lv_obj_set_style_radius(bar, 3, LV_PART_INDICATOR);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(cfg->color), LV_PART_INDICATOR);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, LV_PART_INDICATOR);
+    lv_obj_add_flag(bar, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+    lv_obj_add_event_cb(bar, bar_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, asset);
+    lv_bar_set_range(bar, 0, 100);
+    static_layer_attach(asset);
+    return bar;
+}
+
+// -------------------------
+// Graph assets
+// -------------------------
+// A graph keeps its samples in a ring and paints straight into an ARGB8888
+// canvas buffer. Each ring slot owns a fixed run of columns, so a new sample
+// only rewrites its own columns: sweep mode invalidates just those plus the
+// cleared cursor ahead of them, scroll mode repaints the whole canvas.
+
+static float graph_norm(const asset_cfg_t *cfg, double v)
+{
+    float range = (cfg->max <= cfg->min + 0.0001f) ? 1.0f : cfg->max - cfg->min;
+    return clamp_float(((float)v - cfg->min) / range, 0.0f, 1.0f);
+}
+
+static int graph_slot_x(const graph_state_t *g, int slot)
+{
+    return (int)(((int64_t)slot * g->w) / g->len);
+}
+
+static int graph_row(const graph_state_t *g, float norm)
+{
+    return g->h - 1 - (int)(norm * (float)(g->h - 1) + 0.5f);
+}
+
+static void graph_clear_columns(graph_state_t *g, int x0, int x1)
+{
+    for (int y = 0; y < g->h; y++) {
+        uint32_t *row = g->buf + (size_t)y * (size_t)g->w;
+        memset(row + x0, 0, sizeof(*row) * (size_t)(x1 - x0));
+    }
+}
+
+// Paints one slot: a vertical line joining the previous sample on its first
+// column, the sample level across the rest, and a translucent fill below.
+static void graph_paint_slot(graph_state_t *g, int x0, int x1, int y, int prev_y, uint32_t line, uint32_t fill)
+{
+    for (int x = x0; x < x1; x++) {
+        int top = y;
+        int bottom = y;
+        if (x == x0 && prev_y >= 0) {
+            if (prev_y < top) top = prev_y;
+            if (prev_y > bottom) bottom = prev_y;
         }
-        if (json_get_bool_range(obj_start, obj_end, "text_inline", &v) == 0) a.cfg.text_inline = v;
-        json_get_string_range(obj_start, obj_end, "inline_separator", a.cfg.inline_separator, sizeof(a.cfg.inline_separator));
-        if (json_get_bool_range(obj_start, obj_end, "rounded_outline", &v) == 0) a.cfg.rounded_outline = v;
-        json_get_string_range(obj_start, obj_end, "label", a.cfg.label, sizeof(a.cfg.label));
-        char orient_buf[16];
-        if (json_get_string_range(obj_start, obj_end, "orientation", orient_buf, sizeof(orient_buf)) == 0) {
-            a.cfg.orientation = parse_orientation_string(orient_buf, ORIENTATION_RIGHT);
+        for (int r = 0; r < g->h; r++) {
+            uint32_t px = 0;
+            if (r >= top && r <= bottom) px = line;
+            else if (r > bottom) px = fill;
+            g->buf[(size_t)r * (size_t)g->w + (size_t)x] = px;
         }
+    }
+}
+
+static void graph_colors(const asset_cfg_t *cfg, uint32_t *line, uint32_t *fill)
+{
+    uint32_t rgb = cfg->color & 0xFFFFFFu;
+    *line = 0xFF000000u | rgb;
+    *fill = ((uint32_t)GRAPH_FILL_OPA << 24) | rgb;
+}
 
-        a.last_pct = -1;
-        a.last_label_text[0] = '\0';
+static void graph_invalidate_columns(asset_t *asset, int x0, int x1)
+{
+    if (x1 <= x0) return;
+    lv_area_t c;
+    lv_obj_get_coords(asset->obj, &c);
+    lv_area_t a = {c.x1 + x0, c.y1, c.x1 + x1 - 1, c.y1 + asset->graph->h - 1};
+    lv_obj_invalidate_area(asset->obj, &a);
+}
 
-        if (a.cfg.type == ASSET_TEXT && !value_index_set) {
-            a.cfg.value_index = -1;
+// Rebuilds every column from the ring (create, restyle, min/max change)
+static void graph_redraw(asset_t *asset)
+{
+    if (!asset || !asset->obj || !asset->graph) return;
+    graph_state_t *g = asset->graph;
+    uint32_t line = 0;
+    uint32_t fill = 0;
+    graph_colors(&asset->cfg, &line, &fill);
+    memset(g->buf, 0, sizeof(*g->buf) * (size_t)g->w * (size_t)g->h);
+
+    if (asset->cfg.graph_mode == GRAPH_MODE_SCROLL) {
+        int prev_y = -1;
+        for (int i = 0; i < g->count; i++) {
+            int slot = g->len - g->count + i;
+            int y = graph_row(g, g->ring[(g->head - g->count + i + g->len) % g->len]);
+            graph_paint_slot(g, graph_slot_x(g, slot), graph_slot_x(g, slot + 1), y, prev_y, line, fill);
+            prev_y = y;
+        }
+    } else {
+        // ring index == slot; the slot at head is the sweep cursor and stays clear
+        for (int slot = 0; slot < g->count; slot++) {
+            if (g->count == g->len && slot == g->head) continue;
+            int prev_y = slot > 0 ? graph_row(g, g->ring[slot - 1]) : -1;
+            graph_paint_slot(g, graph_slot_x(g, slot), graph_slot_x(g, slot + 1), graph_row(g, g->ring[slot]), prev_y, line, fill);
         }
+    }
+    lv_obj_invalidate(asset->obj);
+}
 
-        assets[asset_count++] = a;
-        if (asset_count >= MAX_ASSETS) break;
+static void graph_push(asset_t *asset, double value)
+{
+    graph_state_t *g = asset->graph;
+    int slot = g->head;
+    g->ring[slot] = graph_norm(&asset->cfg, value);
+    g->head = (g->head + 1) % g->len;
+    if (g->count < g->len) g->count++;
+
+    if (asset->cfg.graph_mode == GRAPH_MODE_SCROLL) {
+        graph_redraw(asset);
+        return;
     }
 
-    if (asset_count == 0) {
-        memset(assets, 0, sizeof(assets));
-        asset_count = 1;
-        init_asset_defaults(&assets[0], 0);
+    uint32_t line = 0;
+    uint32_t fill = 0;
+    graph_colors(&asset->cfg, &line, &fill);
+    int x0 = graph_slot_x(g, slot);
+    int x1 = graph_slot_x(g, slot + 1);
+    int prev_y = slot > 0 ? graph_row(g, g->ring[slot - 1]) : -1;
+    graph_paint_slot(g, x0, x1, graph_row(g, g->ring[slot]), prev_y, line, fill);
+    graph_invalidate_columns(asset, x0, x1);
+    if (g->count == g->len) {
+        // wipe the oldest slot so the sweep position stays readable
+        int cx0 = graph_slot_x(g, g->head);
+        int cx1 = graph_slot_x(g, g->head + 1);
+        graph_clear_columns(g, cx0, cx1);
+        graph_invalidate_columns(asset, cx0, cx1);
     }
 }
 
-static void load_config(void)
+static void graph_free(asset_t *asset)
 {
-    set_defaults();
+    if (!asset->graph) return;
+    free(asset->graph->ring);
+    free(asset->graph->buf);
+    free(asset->graph);
+    asset->graph = NULL;
+}
 
-    char *json = NULL;
-    if (read_file(CONFIG_PATH, &json, NULL) != 0) {
-        return;
+static lv_obj_t *create_graph(asset_t *asset)
+{
+    if (!asset) return NULL;
+    const asset_cfg_t *cfg = &asset->cfg;
+    int w = 0;
+    int h = 0;
+    bar_asset_size(cfg, &w, &h);
+    w = clamp_int(w, 8, 1920);
+    h = clamp_int(h, 4, 1080);
+
+    graph_state_t *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
+    g->w = w;
+    g->h = h;
+    g->len = cfg->history > 0 ? cfg->history : w;
+    if (g->len > w) g->len = w;  // at least one column per slot
+    g->ring = calloc((size_t)g->len, sizeof(*g->ring));
+    g->buf = calloc((size_t)w * (size_t)h, sizeof(*g->buf));
+    if (!g->ring || !g->buf) {
+        free(g->ring);
+        free(g->buf);
+        free(g);
+        fprintf(stderr, "Graph asset %d: out of memory for %dx%d canvas\n", cfg->id, w, h);
+        return NULL;
     }
+    asset->graph = g;
 
-    int v = 0;
-    float fv = 0.0f;
-    if (json_get_int(json, "width", &v) == 0) g_cfg.width = v;
-    if (json_get_int(json, "height", &v) == 0) g_cfg.height = v;
-    if (json_get_int(json, "osd_x", &v) == 0) g_cfg.osd_x = v;
-    if (json_get_int(json, "osd_y", &v) == 0) g_cfg.osd_y = v;
-    if (json_get_bool(json, "show_stats", &v) == 0) g_cfg.show_stats = v;
-    if (json_get_bool(json, "udp_stats", &v) == 0) g_cfg.udp_stats = v;
-    if (json_get_int(json, "idle_ms", &v) == 0) {
-        g_cfg.idle_ms = clamp_int(v, 10, 1000);
-    } else if (json_get_int(json, "refresh_ms", &v) == 0) {
-        // Backward compatibility with older configs
-        g_cfg.idle_ms = clamp_int(v, 10, 1000);
-    }
-    if (json_get_int(json, "system_refresh_ms", &v) == 0) {
-        g_cfg.system_refresh_ms = clamp_int(v, 100, 60000);
+    asset->container_obj = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(asset->container_obj);
+    lv_obj_clear_flag(asset->container_obj, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *canvas = lv_canvas_create(asset->container_obj);
+    lv_canvas_set_buffer(canvas, g->buf, w, h, LV_COLOR_FORMAT_ARGB8888);
+    static_layer_attach(asset);
+    return canvas;
+}
+
+// Samples every graph whose period elapsed; returns the earliest upcoming
+// deadline so the main loop can cap its poll, or 0 when no graph is live.
+static uint64_t graphs_tick(uint64_t now)
+{
+    uint64_t next = 0;
+    for (int i = 0; i < asset_count; i++) {
+        asset_t *a = &assets[i];
+        if (a->cfg.type != ASSET_GRAPH || !a->cfg.enabled || !a->graph || !a->obj) continue;
+        if (((g_gov.shed | g_asset_offscreen) >> i) & 1u) continue;
+        graph_state_t *g = a->graph;
+        if (now >= g->next_ms) {
+            int idx = clamp_value_slot(a->cfg.value_index);
+            graph_push(a, get_value_channel(idx));
+            uint64_t period = (uint64_t)clamp_int(a->cfg.interval_ms, 10, 60000);
+            g->next_ms = (g->next_ms != 0 && now - g->next_ms < period) ? g->next_ms + period : now + period;
+        }
+        if (next == 0 || g->next_ms < next) next = g->next_ms;
     }
+    return next;
+}
 
-    // Backwards-compatible single bar fields (used only if no assets array)
-    if (json_get_int(json, "bar_x", &v) == 0) assets[0].cfg.x = v;
-    if (json_get_int(json, "bar_y", &v) == 0) assets[0].cfg.y = v;
-    if (json_get_int(json, "bar_width", &v) == 0) assets[0].cfg.width = v;
-    if (json_get_int(json, "bar_height", &v) == 0) assets[0].cfg.height = v;
-    if (json_get_float(json, "bar_min", &fv) == 0) assets[0].cfg.min = fv;
-    if (json_get_float(json, "bar_max", &fv) == 0) assets[0].cfg.max = fv;
-    if (json_get_int(json, "bar_color", &v) == 0) assets[0].cfg.color = (uint32_t)v;
+// -------------------------
+// Gauge assets
+// -------------------------
+/*
+ * A gauge is a 270 degree ring open at the bottom, filled clockwise from the
+ * lower left. Its anti-aliased coverage is rasterised once when the visual is
+ * created (a resize rebuilds it) into an A8 mask, and every ring pixel is
+ * bucketed by the percent step its angle falls in. A value change then only
+ * recolours the buckets between the old and new percentage, tinting the
+ * cached coverage with either the fill or the track colour, and invalidates
+ * the bounding box of those buckets. No arc is rasterised after create.
+ */
+#define GAUGE_SWEEP 4.71238898f     // 270 degrees
+#define GAUGE_START 2.35619449f     // 135 degrees, clockwise from +x in screen space
+#define GAUGE_TWO_PI 6.28318531f
 
-    // Preferred structured assets list
-    parse_assets_array(json);
+// atan2 without libm, max error about 2e-4 rad
+static float gauge_atan2(float y, float x)
+{
+    float ax = x < 0.0f ? -x : x;
+    float ay = y < 0.0f ? -y : y;
+    if (ax == 0.0f && ay == 0.0f) return 0.0f;
+    float a = ax < ay ? ax / ay : ay / ax;
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    if (ay > ax) r = 1.57079637f - r;
+    if (x < 0.0f) r = 3.14159274f - r;
+    return y < 0.0f ? -r : r;
+}
 
-    free(json);
+static float gauge_sqrt(float v)
+{
+    if (v <= 0.0f) return 0.0f;
+    float r = v > 1.0f ? v * 0.5f : 1.0f;
+    for (int i = 0; i < 12; i++) r = 0.5f * (r + v / r);
+    return r;
 }
 
-static int setup_udp_socket(void)
+static void gauge_colors(const asset_cfg_t *cfg, uint32_t *fill, uint32_t *track)
 {
-    int fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (fd < 0) return -1;
+    uint32_t rgb = cfg->color & 0xFFFFFFu;
+    *fill = 0xFF000000u | rgb;
+    *track = ((uint32_t)GAUGE_TRACK_OPA << 24) | rgb;
+}
 
-    struct sockaddr_in addr = {
-        .sin_family = AF_INET,
-        .sin_port = htons(UDP_PORT),
-        .sin_addr.s_addr = htonl(INADDR_ANY),
-    };
-    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(fd);
-        return -1;
+// Recolours buckets [k0, k1): below `filled` with the fill, the rest with the track
+static void gauge_paint_steps(gauge_state_t *g, int k0, int k1, int filled, uint32_t fill, uint32_t track)
+{
+    for (int k = k0; k < k1; k++) {
+        uint32_t c = k < filled ? fill : track;
+        uint32_t a = c >> 24;
+        uint32_t rgb = c & 0xFFFFFFu;
+        for (uint32_t j = g->start[k]; j < g->start[k + 1]; j++) {
+            uint32_t idx = g->order[j];
+            g->buf[idx] = (((a * g->mask[idx] + 127u) / 255u) << 24) | rgb;
+        }
     }
+}
 
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags >= 0) {
-        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+static void gauge_invalidate_steps(asset_t *asset, int k0, int k1)
+{
+    const gauge_state_t *g = asset->gauge;
+    lv_area_t box = {g->w, g->h, -1, -1};
+    for (int k = k0; k < k1; k++) {
+        const lv_area_t *b = &g->step_box[k];
+        if (b->x2 < b->x1) continue;
+        if (b->x1 < box.x1) box.x1 = b->x1;
+        if (b->y1 < box.y1) box.y1 = b->y1;
+        if (b->x2 > box.x2) box.x2 = b->x2;
+        if (b->y2 > box.y2) box.y2 = b->y2;
     }
-    return fd;
+    if (box.x2 < box.x1) return;
+    lv_area_t c;
+    lv_obj_get_coords(asset->obj, &c);
+    lv_area_t a = {c.x1 + box.x1, c.y1 + box.y1, c.x1 + box.x2, c.y1 + box.y2};
+    lv_obj_invalidate_area(asset->obj, &a);
 }
 
-static void parse_udp_values(const char *buf)
+// Repaints the whole ring at the drawn level (create, restyle, min/max change)
+static void gauge_redraw(asset_t *asset)
 {
-    const char *p = strstr(buf, "\"values\"");
-    if (!p) return;
-    p = strchr(p, '[');
-    if (!p) return;
-    p++;
-    for (int i = 0; i < UDP_VALUE_COUNT; i++) {
-        while (*p && isspace((unsigned char)*p)) p++;
-        if (!*p) break;
-
-        if (strncmp(p, "null", 4) == 0) {
-            p += 4;
-        } else {
-            if (*p == '\"') {
-                /* Treat empty string as a clear-to-zero */
-                p++;
-                if (*p == '\"') {
-                    udp_values[i] = 0.0;
-                    p++; /* skip closing quote */
-                } else {
-                    // Skip until closing quote for malformed entries
-                    while (*p && *p != '\"') p++;
-                    if (*p == '\"') p++;
-                }
-            } else {
-            char *endptr = NULL;
-            double val = strtod(p, &endptr);
-            if (p == endptr) break;
-            udp_values[i] = val;
-            p = endptr;
-            }
-        }
+    if (!asset || !asset->obj || !asset->gauge) return;
+    gauge_state_t *g = asset->gauge;
+    uint32_t fill = 0;
+    uint32_t track = 0;
+    gauge_colors(&asset->cfg, &fill, &track);
+    gauge_paint_steps(g, 0, GAUGE_STEPS, g->drawn, fill, track);
+    lv_obj_invalidate(asset->obj);
+}
 
-        const char *comma = strchr(p, ',');
-        if (!comma) break;
-        p = comma + 1;
-    }
+static void gauge_set_pct(asset_t *asset, int pct)
+{
+    gauge_state_t *g = asset->gauge;
+    if (!g || pct == g->drawn) return;
+    int lo = pct < g->drawn ? pct : g->drawn;
+    int hi = pct < g->drawn ? g->drawn : pct;
+    uint32_t fill = 0;
+    uint32_t track = 0;
+    gauge_colors(&asset->cfg, &fill, &track);
+    gauge_paint_steps(g, lo, hi, pct, fill, track);
+    g->drawn = pct;
+    gauge_invalidate_steps(asset, lo, hi);
 }
 
-static void parse_udp_texts(const char *buf)
+static float gauge_clamp01(float v)
 {
-    const char *p = strstr(buf, "\"texts\"");
-    if (!p) return;
-    p = strchr(p, '[');
-    if (!p) return;
-    p++;
-    for (int i = 0; i < UDP_TEXT_COUNT; i++) {
-        while (*p && isspace((unsigned char)*p)) p++;
-        if (!*p) break;
+    return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
 
-        if (strncmp(p, "null", 4) == 0) {
-            p += 4;
-        } else if (*p == '\"') {
-            p++; // skip quote
-            const char *start = p;
-            while (*p && *p != '\"') p++;
-            size_t len = (size_t)(p - start);
-            if (len > TEXT_SLOT_LEN - 1) len = TEXT_SLOT_LEN - 1;
-            memcpy(udp_texts[i], start, len);
-            udp_texts[i][len] = '\0';
-            if (*p != '\"') break;
-            p++; // skip closing quote
-        } else {
-            break;
+// Rasterises the ring coverage and buckets its pixels by percent step
+static int gauge_build(gauge_state_t *g)
+{
+    int w = g->w;
+    int h = g->h;
+    size_t n = (size_t)w * (size_t)h;
+    uint8_t *step = malloc(n);
+    if (!step) return -1;
+
+    float cx = (float)w * 0.5f;
+    float cy = (float)h * 0.5f;
+    float r_out = (float)(w < h ? w : h) * 0.5f - 0.5f;
+    float thick = r_out / 4.0f;
+    if (thick < 3.0f) thick = 3.0f;
+    float r_in = r_out - thick;
+    float r_mid = r_out - thick * 0.5f;
+    uint32_t counts[GAUGE_STEPS] = {0};
+
+    for (int k = 0; k < GAUGE_STEPS; k++) {
+        lv_area_t empty = {w, h, -1, -1};
+        g->step_box[k] = empty;
+    }
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            size_t idx = (size_t)y * (size_t)w + (size_t)x;
+            float dx = (float)x + 0.5f - cx;
+            float dy = (float)y + 0.5f - cy;
+            float d = gauge_sqrt(dx * dx + dy * dy);
+            float cov = gauge_clamp01(r_out - d + 0.5f) * gauge_clamp01(d - r_in + 0.5f);
+            g->mask[idx] = 0;
+            if (cov <= 0.0f) continue;
+
+            float t = gauge_atan2(dy, dx) - GAUGE_START;
+            while (t < 0.0f) t += GAUGE_TWO_PI;
+            int k;
+            if (t <= GAUGE_SWEEP) {
+                float edge = (t < GAUGE_SWEEP - t ? t : GAUGE_SWEEP - t) * r_mid;
+                cov *= gauge_clamp01(edge + 0.5f);
+                k = (int)(t * (float)GAUGE_STEPS / GAUGE_SWEEP);
+                if (k >= GAUGE_STEPS) k = GAUGE_STEPS - 1;
+            } else {
+                // the antialiased fringe of the end caps inside the gap
+                float past_end = t - GAUGE_SWEEP;
+                float before_start = GAUGE_TWO_PI - t;
+                float over = (past_end < before_start ? past_end : before_start) * r_mid;
+                cov *= gauge_clamp01(0.5f - over);
+                k = past_end < before_start ? GAUGE_STEPS - 1 : 0;
+            }
+            uint8_t m = (uint8_t)(cov * 255.0f + 0.5f);
+            if (m == 0) continue;
+            g->mask[idx] = m;
+            step[idx] = (uint8_t)k;
+            counts[k]++;
+            lv_area_t *b = &g->step_box[k];
+            if (x < b->x1) b->x1 = x;
+            if (y < b->y1) b->y1 = y;
+            if (x > b->x2) b->x2 = x;
+            if (y > b->y2) b->y2 = y;
         }
+    }
 
-        const char *comma = strchr(p, ',');
-        if (!comma) break;
-        p = comma + 1;
+    uint32_t total = 0;
+    for (int k = 0; k < GAUGE_STEPS; k++) {
+        g->start[k] = total;
+        total += counts[k];
     }
+    g->start[GAUGE_STEPS] = total;
+    g->order = malloc(sizeof(*g->order) * (total ? total : 1));
+    if (!g->order) {
+        free(step);
+        return -1;
+    }
+    uint32_t fill_at[GAUGE_STEPS];
+    memcpy(fill_at, g->start, sizeof(fill_at));
+    for (size_t idx = 0; idx < n; idx++) {
+        if (g->mask[idx]) g->order[fill_at[step[idx]]++] = (uint32_t)idx;
+    }
+    free(step);
+    return 0;
 }
 
-static void parse_udp_asset_updates(const char *buf)
+static void gauge_state_free(gauge_state_t *g)
 {
-    const char *p = strstr(buf, "\"asset_updates\"");
-    if (!p) return;
-    const char *arr = strchr(p, '[');
-    if (!arr) return;
-    p = arr + 1;
+    if (!g) return;
+    free(g->buf);
+    free(g->mask);
+    free(g->order);
+    free(g);
+}
 
-    while (*p) {
-        while (*p && *p != '{' && *p != ']') p++;
-        if (*p == ']') break;
-        const char *obj_start = p;
-        int depth = 1;
-        p++;
-        while (*p && depth > 0) {
-            if (*p == '{') depth++;
-            else if (*p == '}') depth--;
-            p++;
-        }
-        const char *obj_end = p;
-        if (depth != 0) break;
+static void gauge_free(asset_t *asset)
+{
+    gauge_state_free(asset->gauge);
+    asset->gauge = NULL;
+}
 
-        int id = -1;
-        if (json_get_int_range(obj_start, obj_end, "id", &id) != 0 || id < 0) {
-            continue;
-        }
+static lv_obj_t *create_gauge(asset_t *asset)
+{
+    if (!asset) return NULL;
+    const asset_cfg_t *cfg = &asset->cfg;
+    int w = 0;
+    int h = 0;
+    bar_asset_size(cfg, &w, &h);
+    w = clamp_int(w, 8, 1080);
+    h = clamp_int(h, 8, 1080);
+
+    gauge_state_t *g = calloc(1, sizeof(*g));
+    if (!g) return NULL;
+    g->w = w;
+    g->h = h;
+    g->buf = calloc((size_t)w * (size_t)h, sizeof(*g->buf));
+    g->mask = calloc((size_t)w * (size_t)h, 1);
+    if (!g->buf || !g->mask || gauge_build(g) != 0) {
+        gauge_state_free(g);
+        fprintf(stderr, "Gauge asset %d: out of memory for %dx%d canvas\n", cfg->id, w, h);
+        return NULL;
+    }
+    asset->gauge = g;
 
-        asset_t *asset = find_asset_by_id(id);
-        int new_asset = 0;
-        if (!asset) {
-            if (asset_count >= MAX_ASSETS) continue;
-            asset = &assets[asset_count++];
-            init_asset_defaults(asset, id);
-            asset->cfg.enabled = 0;
-            new_asset = 1;
-        }
+    asset->container_obj = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(asset->container_obj);
+    lv_obj_clear_flag(asset->container_obj, LV_OBJ_FLAG_SCROLLABLE);
 
-        int v = 0;
-        float fv = 0.0f;
-        int restyle = 0;
-        int relayout = 0;
-        int rerange = 0;
-        int recreate = 0;
-        int text_change = 0;
-        int type_changed = 0;
+    lv_obj_t *canvas = lv_canvas_create(asset->container_obj);
+    lv_canvas_set_buffer(canvas, g->buf, w, h, LV_COLOR_FORMAT_ARGB8888);
+    return canvas;
+}
 
-        int enabled_flag = asset->cfg.enabled;
-        if (json_get_bool_range(obj_start, obj_end, "enabled", &v) == 0) {
-            enabled_flag = v ? 1 : 0;
-        }
+// -------------------------
+// Image assets
+// -------------------------
+/*
+ * An image asset maps a pre-converted osd_image.h blob read-only and never
+ * hands its pixels to LVGL. Its LVGL object is an empty placeholder of the
+ * image size, so layout, regions, pooling and invalidation work as for any
+ * other asset; when LVGL flushes an area the placeholder covers,
+ * images_overlay copies the matching rows of the current frame over what was
+ * just stored. On an ARGB4444 canvas that is a memcpy straight out of the
+ * mapping; I8/I4 canvases copy from palette indices converted once at create.
+ * The image replaces every pixel of its box, so its container has no
+ * background. A value change that selects another frame only invalidates the
+ * placeholder.
+ */
+// Maps and validates a blob; returns 0 with im->map/px/w/h/frames filled
+static int image_map(const char *path, image_state_t *im)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(osd_image_header_t)) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const osd_image_header_t *hdr = (const osd_image_header_t *)map;
+    int valid = hdr->magic == OSD_IMAGE_MAGIC && hdr->version == OSD_IMAGE_VERSION &&
+                hdr->format == OSD_IMAGE_ARGB4444 && hdr->width > 0 && hdr->height > 0 &&
+                hdr->width <= OSD_IMAGE_DIM_MAX && hdr->height <= OSD_IMAGE_DIM_MAX &&
+                hdr->frames > 0 && hdr->frames <= OSD_IMAGE_FRAMES_MAX &&
+                (size_t)st.st_size >= sizeof(*hdr) + osd_image_data_size(hdr);
+    if (!valid) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+    im->map = map;
+    im->map_len = (size_t)st.st_size;
+    im->px = (const uint16_t *)((const uint8_t *)map + sizeof(*hdr));
+    im->w = hdr->width;
+    im->h = hdr->height;
+    im->frames = hdr->frames;
+    return 0;
+}
 
-        char type_buf[32];
-        if (json_get_string_range(obj_start, obj_end, "type", type_buf, sizeof(type_buf)) == 0) {
-            asset_type_t new_type = asset->cfg.type;
-            if (strcmp(type_buf, "text") == 0) {
-                new_type = ASSET_TEXT;
-            } else {
-                new_type = ASSET_BAR;
-            }
-            if (new_type != asset->cfg.type) {
-                asset->cfg.type = new_type;
-                recreate = 1;
-                type_changed = 1;
-            }
-        }
+static void image_state_free(image_state_t *im)
+{
+    if (!im) return;
+    if (im->map) munmap(im->map, im->map_len);
+    free(im->idx);
+    free(im->argb1555);
+    free(im);
+    g_image_live--;
+}
 
-        int value_index_seen = 0;
-        if (json_get_int_range(obj_start, obj_end, "value_index", &v) == 0) {
-            int idx = clamp_int(v, 0, TOTAL_VALUE_COUNT - 1);
-            if (idx != asset->cfg.value_index) {
-                asset->cfg.value_index = idx;
-            }
-            value_index_seen = 1;
-        }
+static void image_free(asset_t *asset)
+{
+    image_state_free(asset->image);
+    asset->image = NULL;
+}
 
-        if (json_get_int_range(obj_start, obj_end, "text_index", &v) == 0) {
-            int idx = clamp_int(v, -1, TOTAL_TEXT_COUNT - 1);
-            if (idx != asset->cfg.text_index) {
-                asset->cfg.text_index = idx;
-                text_change = 1;
-            }
-        }
+// Adds the distinct colours of an image to the indexed-canvas palette
+static void image_palette_add(const char *path)
+{
+    image_state_t im;
+    memset(&im, 0, sizeof(im));
+    if (image_map(path, &im) != 0) return;
+    static uint32_t seen[65536 / 32];
+    memset(seen, 0, sizeof(seen));
+    size_t n = (size_t)im.w * (size_t)im.h * (size_t)im.frames;
+    for (size_t i = 0; i < n; i++) {
+        uint16_t k = im.px[i];
+        if (!(k >> 12) || (seen[k >> 5] & (1u << (k & 31)))) continue;
+        seen[k >> 5] |= 1u << (k & 31);
+        uint32_t argb = ((uint32_t)(k >> 12) * 17u << 24) | ((uint32_t)((k >> 8) & 0xF) * 17u << 16) |
+                        ((uint32_t)((k >> 4) & 0xF) * 17u << 8) | (uint32_t)(k & 0xF) * 17u;
+        palette_add(argb);
+    }
+    munmap(im.map, im.map_len);
+}
 
-        int indices_tmp[8] = {0};
-        int idx_count = 0;
-        if (find_key_range(obj_start, obj_end, "text_indices")) {
-            json_get_int_array_range(obj_start, obj_end, "text_indices", indices_tmp, 8, &idx_count, -1);
-            for (int i = 0; i < idx_count; i++) {
-                if (indices_tmp[i] >= 0) {
-                    indices_tmp[i] = clamp_int(indices_tmp[i], 0, TOTAL_TEXT_COUNT - 1);
-                }
-            }
-            if (idx_count != asset->cfg.text_indices_count || memcmp(indices_tmp, asset->cfg.text_indices, sizeof(int) * (size_t)idx_count) != 0) {
-                memcpy(asset->cfg.text_indices, indices_tmp, sizeof(int) * (size_t)idx_count);
-                asset->cfg.text_indices_count = idx_count;
-                text_change = 1;
-            }
+static lv_obj_t *create_image(asset_t *asset)
+{
+    if (!asset) return NULL;
+    const asset_cfg_t *cfg = &asset->cfg;
+    image_state_t *im = calloc(1, sizeof(*im));
+    if (!im) return NULL;
+    if (cfg->image[0] == '\0' || image_map(cfg->image, im) != 0) {
+        fprintf(stderr, "Image asset %d: cannot load '%s'\n", cfg->id, cfg->image);
+        free(im);
+        return NULL;
+    }
+    g_image_live++;
+    if (g_canvas_format == PIXEL_FORMAT_ARGB1555) {
+        size_t n = (size_t)im->w * (size_t)im->h * (size_t)im->frames;
+        im->argb1555 = malloc(n * sizeof(uint16_t));
+        if (!im->argb1555) {
+            fprintf(stderr, "Image asset %d: out of memory for %zu ARGB1555 pixels\n", cfg->id, n);
+            image_state_free(im);
+            return NULL;
         }
-
-        int value_indices_tmp[8] = {0};
-        int value_idx_count = 0;
-        if (find_key_range(obj_start, obj_end, "value_indices")) {
-            json_get_int_array_range(obj_start, obj_end, "value_indices", value_indices_tmp, 8, &value_idx_count, -1);
-            for (int i = 0; i < value_idx_count; i++) {
-                if (value_indices_tmp[i] >= 0) {
-                    value_indices_tmp[i] = clamp_int(value_indices_tmp[i], 0, TOTAL_VALUE_COUNT - 1);
-                }
-            }
-            if (value_idx_count != asset->cfg.value_indices_count ||
-                memcmp(value_indices_tmp, asset->cfg.value_indices, sizeof(int) * (size_t)value_idx_count) != 0) {
-                memcpy(asset->cfg.value_indices, value_indices_tmp, sizeof(int) * (size_t)value_idx_count);
-                asset->cfg.value_indices_count = value_idx_count;
-                text_change = 1;
-            }
+        for (size_t i = 0; i < n; i++) im->argb1555[i] = argb4444_to_argb1555(im->px[i]);
+    } else if (g_canvas_kernels[g_canvas_format].indexed) {
+        size_t n = (size_t)im->w * (size_t)im->h * (size_t)im->frames;
+        im->idx = malloc(n);
+        if (!im->idx) {
+            fprintf(stderr, "Image asset %d: out of memory for %zu palette indices\n", cfg->id, n);
+            image_state_free(im);
+            return NULL;
         }
+        for (size_t i = 0; i < n; i++) im->idx[i] = palette_lookup(im->px[i]);
+    }
+    asset->image = im;
 
-        if (json_get_bool_range(obj_start, obj_end, "text_inline", &v) == 0) {
-            int inline_flag = v ? 1 : 0;
-            if (inline_flag != asset->cfg.text_inline) {
-                asset->cfg.text_inline = inline_flag;
-                text_change = 1;
-            }
-        }
+    asset->container_obj = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(asset->container_obj);
+    lv_obj_clear_flag(asset->container_obj, LV_OBJ_FLAG_SCROLLABLE);
 
-        char inline_sep_buf[sizeof(asset->cfg.inline_separator)];
-        if (json_get_string_range(obj_start, obj_end, "inline_separator", inline_sep_buf, sizeof(inline_sep_buf)) == 0) {
-            if (strcmp(inline_sep_buf, asset->cfg.inline_separator) != 0) {
-                strncpy(asset->cfg.inline_separator, inline_sep_buf, sizeof(asset->cfg.inline_separator) - 1);
-                asset->cfg.inline_separator[sizeof(asset->cfg.inline_separator) - 1] = '\0';
-                text_change = 1;
-            }
-        }
+    lv_obj_t *placeholder = lv_obj_create(asset->container_obj);
+    lv_obj_remove_style_all(placeholder);
+    lv_obj_clear_flag(placeholder, LV_OBJ_FLAG_SCROLLABLE);
+    return placeholder;
+}
 
-        if ((type_changed || new_asset) && asset->cfg.type == ASSET_TEXT && !value_index_seen && asset->cfg.value_indices_count == 0) {
-            asset->cfg.value_index = -1;
-        }
+// Frame k of n covers [min + k*range/n, min + (k+1)*range/n)
+static void image_set_pct(asset_t *asset, int pct)
+{
+    image_state_t *im = asset->image;
+    if (!im) return;
+    int frame = clamp_int(pct * im->frames / 100, 0, im->frames - 1);
+    if (frame == im->frame) return;
+    im->frame = frame;
+    lv_obj_invalidate(asset->obj);
+}
 
-        if (json_get_bool_range(obj_start, obj_end, "rounded_outline", &v) == 0) {
-            int outline_flag = v ? 1 : 0;
-            if (outline_flag != asset->cfg.rounded_outline) {
-                asset->cfg.rounded_outline = outline_flag;
-                recreate = 1;
+// Copies the current frame of every visible image over a freshly stored clip
+static void images_overlay(osd_region_t *r, const MI_RGN_CanvasInfo_t *info, const lv_area_t *clip)
+{
+    for (int i = 0; i < asset_count; i++) {
+        asset_t *a = &assets[i];
+        const image_state_t *im = a->image;
+        if (!im || !a->obj) continue;
+        if (lv_obj_has_flag(a->obj, LV_OBJ_FLAG_HIDDEN)) continue;
+        if (a->container_obj && lv_obj_has_flag(a->container_obj, LV_OBJ_FLAG_HIDDEN)) continue;
+        lv_area_t box;
+        lv_obj_get_coords(a->obj, &box);
+        box.x2 = box.x1 + im->w - 1;
+        box.y2 = box.y1 + im->h - 1;
+        lv_area_t area;
+        if (!lv_area_intersect(&area, clip, &box)) continue;
+
+        int w = area.x2 - area.x1 + 1;
+        int cx = area.x1 - r->area.x1;
+        for (int y = area.y1; y <= area.y2; y++) {
+            uint8_t *line = (uint8_t *)(info->virtAddr + (y - r->area.y1) * info->u32Stride);
+            size_t src = ((size_t)im->frame * (size_t)im->h + (size_t)(y - box.y1)) * (size_t)im->w +
+                         (size_t)(area.x1 - box.x1);
+            if (g_canvas_format == PIXEL_FORMAT_ARGB4444) {
+                memcpy(line + (size_t)cx * 2, im->px + src, (size_t)w * 2);
+            } else if (g_canvas_format == PIXEL_FORMAT_ARGB1555) {
+                memcpy(line + (size_t)cx * 2, im->argb1555 + src, (size_t)w * 2);
+            } else if (g_canvas_format == PIXEL_FORMAT_I8) {
+                memcpy(line + cx, im->idx + src, (size_t)w);
+            } else {
+                for (int x = 0; x < w; x++) i4_put(line, cx + x, im->idx[src + (size_t)x]);
             }
         }
+    }
+}
 
-        if (json_get_string_range(obj_start, obj_end, "label", asset->cfg.label, sizeof(asset->cfg.label)) == 0) {
-            text_change = 1;
-        }
-
-        char orient_buf[16];
-        if (json_get_string_range(obj_start, obj_end, "orientation", orient_buf, sizeof(orient_buf)) == 0) {
-            asset_orientation_t orientation = parse_orientation_string(orient_buf, asset->cfg.orientation);
-            if (orientation != asset->cfg.orientation) {
-                asset->cfg.orientation = orientation;
-                relayout = 1;
-            }
-        }
+static void destroy_asset_visual(asset_t *asset)
+{
+    if (!asset) return;
+    if (asset->container_obj) {
+        lv_obj_del(asset->container_obj);
+    } else {
+        if (asset->label_obj) lv_obj_del(asset->label_obj);
+        if (asset->obj) lv_obj_del(asset->obj);
+    }
+    asset->container_obj = NULL;
+    asset->label_obj = NULL;
+    asset->obj = NULL;
+    graph_free(asset);
+    gauge_free(asset);
+    image_free(asset);
+    seg_sprites_free(asset);
+    static_layer_free(asset);
+    g_hot.last_pct[asset_slot(asset)] = -1;
+    label_cache_reset(asset);
+    asset->label_extent_w = -1;
+}
 
-        if (json_get_int_range(obj_start, obj_end, "bar_color", &v) == 0) {
-            uint32_t color = (uint32_t)v;
-            if (asset->cfg.type != ASSET_TEXT && asset->cfg.color != color) {
-                asset->cfg.color = color;
-                restyle = 1;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "text_color", &v) == 0) {
-            uint32_t color = (uint32_t)v;
-            if (asset->cfg.text_color != color) {
-                asset->cfg.text_color = color;
-                restyle = 1;
-                text_change = 1;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "background", &v) == 0) {
-            int bg = clamp_int(v, -1, (int)(sizeof(g_bg_styles) / sizeof(g_bg_styles[0])) - 1);
-            if (asset->cfg.bg_style != bg) {
-                asset->cfg.bg_style = bg;
-                restyle = 1;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "background_opacity", &v) == 0) {
-            int opa = clamp_int(v, 0, 100);
-            if (asset->cfg.bg_opacity_pct != opa) {
-                asset->cfg.bg_opacity_pct = opa;
-                restyle = 1;
-            }
-        }
+// -------------------------
+// Visual pool
+// -------------------------
+static lv_obj_t *parked_root(const asset_parked_t *v)
+{
+    return v->container_obj ? v->container_obj : v->obj;
+}
 
-        if (json_get_int_range(obj_start, obj_end, "segments", &v) == 0) {
-            int segs = clamp_int(v, 0, 64);
-            if (asset->cfg.segments != segs) {
-                asset->cfg.segments = segs;
-                if (asset->obj) lv_obj_invalidate(asset->obj);
-            }
-        }
+static void parked_destroy(asset_parked_t *v)
+{
+    lv_obj_t *root = parked_root(v);
+    if (root) lv_obj_del(root);
+    if (!v->container_obj && v->label_obj) lv_obj_del(v->label_obj);
+    if (v->graph) {
+        free(v->graph->ring);
+        free(v->graph->buf);
+        free(v->graph);
+    }
+    gauge_state_free(v->gauge);
+    image_state_free(v->image);
+    memset(v, 0, sizeof(*v));
+}
 
-        if (json_get_int_range(obj_start, obj_end, "x", &v) == 0) {
-            if (asset->cfg.x != v) {
-                asset->cfg.x = v;
-                relayout = 1;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "y", &v) == 0) {
-            if (asset->cfg.y != v) {
-                asset->cfg.y = v;
-                relayout = 1;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "width", &v) == 0) {
-            if (asset->cfg.width != v) {
-                asset->cfg.width = v;
-                relayout = 1;
-                recreate = asset->cfg.type == ASSET_TEXT ? 1 : recreate;
-            }
-        }
-        if (json_get_int_range(obj_start, obj_end, "height", &v) == 0) {
-            if (asset->cfg.height != v) {
-                asset->cfg.height = v;
-                relayout = 1;
-                recreate = asset->cfg.type == ASSET_TEXT ? 1 : recreate;
-            }
-        }
-        if (json_get_float_range(obj_start, obj_end, "min", &fv) == 0) {
-            if (asset->cfg.min != fv) {
-                asset->cfg.min = fv;
-                rerange = 1;
-            }
-        }
-        if (json_get_float_range(obj_start, obj_end, "max", &fv) == 0) {
-            if (asset->cfg.max != fv) {
-                asset->cfg.max = fv;
-                rerange = 1;
-            }
-        }
+static void asset_visual_drop_parked(asset_t *asset)
+{
+    for (int t = 0; t < ASSET_TYPE_COUNT; t++) {
+        if (parked_root(&asset->parked[t])) parked_destroy(&asset->parked[t]);
+    }
+}
 
-        int enabled_change = (enabled_flag != asset->cfg.enabled);
-        asset->cfg.enabled = enabled_flag;
+// Hides the live visual and keeps it for the next enable of the same type
+static void asset_visual_park(asset_t *asset)
+{
+    if (!asset->obj) {
+        destroy_asset_visual(asset);
+        return;
+    }
+    asset_parked_t *slot = &asset->parked[asset->visual_type];
+    if (parked_root(slot)) parked_destroy(slot);
+    slot->container_obj = asset->container_obj;
+    slot->obj = asset->obj;
+    slot->label_obj = asset->label_obj;
+    slot->graph = asset->graph;
+    slot->gauge = asset->gauge;
+    slot->image = asset->image;
+    lv_obj_add_flag(parked_root(slot), LV_OBJ_FLAG_HIDDEN);
+    if (!slot->container_obj && slot->label_obj) lv_obj_add_flag(slot->label_obj, LV_OBJ_FLAG_HIDDEN);
 
-        if (!asset->cfg.enabled) {
-            destroy_asset_visual(asset);
-            continue;
-        }
+    asset->container_obj = NULL;
+    asset->obj = NULL;
+    asset->label_obj = NULL;
+    asset->graph = NULL;
+    asset->gauge = NULL;
+    asset->image = NULL;
+    if (asset->static_layer) asset->static_layer->stale = 1;
+    g_hot.last_pct[asset_slot(asset)] = -1;
+    label_cache_reset(asset);
+    asset->label_extent_w = -1;
+}
 
-        if (!asset->obj || recreate || enabled_change) {
-            create_asset_visual(asset);
-            restyle = 1;
-            relayout = 0;
-            rerange = 1;
-            text_change = 1;
-        } else {
-            if (relayout) {
-                if (asset->cfg.type == ASSET_TEXT) {
-                    layout_text_asset(asset);
-                } else {
-                    layout_bar_asset(asset);
-                }
-            }
+// Brings back a hidden visual of the configured type; returns 0 when none is
+// pooled and the caller has to create one
+static int asset_visual_unpark(asset_t *asset)
+{
+    asset_parked_t *slot = &asset->parked[asset->cfg.type];
+    if (!parked_root(slot)) return 0;
+    asset_visual_park(asset);  // a swapped-out type goes back to its own slot
+
+    asset->container_obj = slot->container_obj;
+    asset->obj = slot->obj;
+    asset->label_obj = slot->label_obj;
+    asset->graph = slot->graph;
+    asset->gauge = slot->gauge;
+    asset->image = slot->image;
+    asset->visual_type = asset->cfg.type;
+    memset(slot, 0, sizeof(*slot));
+    lv_obj_clear_flag(asset->container_obj ? asset->container_obj : asset->obj, LV_OBJ_FLAG_HIDDEN);
+    if (!asset->container_obj && asset->label_obj) lv_obj_clear_flag(asset->label_obj, LV_OBJ_FLAG_HIDDEN);
+    return 1;
+}
 
-            if (rerange && asset->cfg.type == ASSET_BAR) {
-                lv_bar_set_range(asset->obj, 0, 100);
-                asset->last_pct = -1;
-            }
-        }
+static lv_obj_t *create_text_asset(asset_t *asset)
+{
+    lv_obj_t *label = lv_label_create(lv_scr_act());
+    apply_label_font(asset, label);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    apply_background_style(label, asset->cfg.bg_style, asset->cfg.bg_opacity_pct, 0);
+    lv_obj_set_style_text_color(label, lv_color_hex(asset->cfg.text_color), 0);
+    lv_obj_set_style_text_opa(label, LV_OPA_COVER, 0);
 
-        if (restyle) {
-            apply_asset_styles(asset);
-        }
+    char text_buf[1024];
+    compose_asset_text(asset, text_buf, sizeof(text_buf));
+    lv_label_set_text(label, text_buf);
+    label_cache_reset(asset);
+    label_cache_update(asset, text_buf);
+    asset->obj = label;
+    layout_text_asset(asset);
+    return label;
+}
 
-        if (text_change) {
-            int wants_label = (asset->cfg.label[0] != '\0') || (asset->cfg.text_index >= 0);
-            int label_created = 0;
-            if (asset->cfg.type != ASSET_TEXT) {
-                if (wants_label && !asset->label_obj) {
-                    maybe_attach_asset_label(asset);
-                    label_created = asset->label_obj != NULL;
-                } else if (!wants_label && asset->label_obj) {
-                    lv_obj_del(asset->label_obj);
-                    asset->label_obj = NULL;
-                    layout_bar_asset(asset);
-                }
-            }
-            asset->last_label_text[0] = '\0';
-            if (label_created) {
-                apply_asset_styles(asset);
-            }
-        }
+static void create_asset_visual(asset_t *asset)
+{
+    if (!asset || !asset->cfg.enabled) return;
+    destroy_asset_visual(asset);
+    mark_asset_refresh(asset);
+    asset->visual_type = asset->cfg.type;
+    if (parked_root(&asset->parked[asset->cfg.type])) parked_destroy(&asset->parked[asset->cfg.type]);
+    switch (asset->cfg.type) {
+        case ASSET_BAR:
+            asset->obj = create_bar(asset);
+            maybe_attach_asset_label(asset);
+            break;
+        case ASSET_TEXT:
+            asset->obj = create_text_asset(asset);
+            break;
+        case ASSET_GRAPH:
+            asset->obj = create_graph(asset);
+            maybe_attach_asset_label(asset);
+            break;
+        case ASSET_GAUGE:
+            asset->obj = create_gauge(asset);
+            maybe_attach_asset_label(asset);
+            break;
+        case ASSET_IMAGE:
+            asset->obj = create_image(asset);
+            maybe_attach_asset_label(asset);
+            break;
+        default:
+            asset->obj = create_bar(asset);
+            maybe_attach_asset_label(asset);
+            break;
+    }
+
+    if (asset->container_obj && asset->cfg.type != ASSET_TEXT) {
+        layout_bar_asset(asset);
     }
+
+    apply_asset_styles(asset);
 }
 
-static const char *get_asset_text(const asset_t *asset)
+static void maybe_attach_asset_label(asset_t *asset)
 {
-    if (asset->cfg.text_index >= 0 && asset->cfg.text_index < TOTAL_TEXT_COUNT) {
-        const char *t = get_text_channel(asset->cfg.text_index);
-        if (t[0] != '\0') return t;
+    if (!asset->obj) return;
+    if (asset->cfg.type == ASSET_TEXT) return;
+    if (asset->cfg.label[0] == '\0' && asset->cfg.text_index < 0) return;
+    lv_obj_t *parent = asset->container_obj ? asset->container_obj : lv_scr_act();
+    asset->label_obj = lv_label_create(parent);
+    apply_label_font(asset, asset->label_obj);
+    lv_obj_set_style_text_color(asset->label_obj, lv_color_hex(asset->cfg.text_color), 0);
+    lv_obj_set_style_text_opa(asset->label_obj, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_opa(asset->label_obj, LV_OPA_TRANSP, 0);
+    if (g_cfg.static_layers && asset->container_obj) {
+        lv_obj_add_flag(asset->label_obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+        lv_obj_add_event_cb(asset->label_obj, static_label_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, asset);
+    }
+
+    char text_buf[1024];
+    compose_asset_text(asset, text_buf, sizeof(text_buf));
+    lv_label_set_text(asset->label_obj, text_buf);
+    label_cache_reset(asset);
+    label_cache_update(asset, text_buf);
+    if (asset->container_obj) {
+        layout_bar_asset(asset);
+    } else {
+        lv_obj_align_to(asset->label_obj, asset->obj, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
     }
-    if (asset->cfg.label[0] != '\0') return asset->cfg.label;
-    return "";
 }
 
-static void format_value_text(double v, char *buf, size_t buf_sz)
+static void create_assets(void)
 {
-    if (!buf || buf_sz == 0) return;
-    double rounded = (v >= 0.0) ? (v + 0.5) : (v - 0.5);
-    double diff = v - rounded;
-    if (diff < 0.0) diff = -diff;
-    if (diff < 0.005) {
-        snprintf(buf, buf_sz, "%.0f", v);
-        return;
+    for (int i = 0; i < asset_count; i++) {
+        create_asset_visual(&assets[i]);
     }
-    double abs_v = v < 0.0 ? -v : v;
-    if (abs_v < 10.0) {
-        snprintf(buf, buf_sz, "%.2f", v);
-    } else if (abs_v < 100.0) {
-        snprintf(buf, buf_sz, "%.1f", v);
-    } else {
-        snprintf(buf, buf_sz, "%.0f", v);
+}
+
+static void destroy_assets(void)
+{
+    for (int i = 0; i < asset_count; i++) {
+        destroy_asset_visual(&assets[i]);
+        asset_visual_drop_parked(&assets[i]);
     }
+
+    asset_count = 0;
+    memset(assets, 0, sizeof(*assets) * (size_t)g_asset_capacity);
+    g_asset_force = 0;
+    g_asset_offscreen = 0;
+    g_asset_deferred = 0;
+    g_channel_deps_stale = 1;
 }
 
-static void append_entry_separator(const asset_cfg_t *cfg, char *buf, size_t buf_sz, size_t *written)
+// Bars still easing toward target_pct, bit per asset slot
+static uint64_t g_bar_easing = 0;
+
+// Redraws a bar at pct, invalidating only what the integer step changed
+static void bar_set_pct(asset_t *asset, int pct)
 {
-    if (!cfg || !buf || !written) return;
-    if (*written >= buf_sz - 1) return;
-    if (cfg->text_inline) {
-        const char *sep = cfg->inline_separator;
-        size_t sep_len = strlen(sep);
-        if (sep_len == 0) {
-            buf[(*written)++] = ' ';
-            return;
-        }
-        buf[(*written)++] = ' ';
-        size_t to_copy = sep_len < buf_sz - 1 - *written ? sep_len : buf_sz - 1 - *written;
-        memcpy(buf + *written, sep, to_copy);
-        *written += to_copy;
-        if (*written < buf_sz - 1) {
-            buf[(*written)++] = ' ';
-        }
+    int i = asset_slot(asset);
+    int old_pct = g_hot.last_pct[i];
+    if (old_pct == pct) return;
+    g_hot.last_pct[i] = (int16_t)pct;
+    if (asset->cfg.segments > 1) {
+        bar_segments_update(asset, old_pct, pct);
     } else {
-        buf[(*written)++] = '\n';
+        bar_fill_update(asset, old_pct, pct);
     }
 }
 
-static void append_text_value_entry(const asset_t *asset, const char *text, int value_idx, char *buf, size_t buf_sz, size_t *written)
+// -------------------------
+// Value rules
+// -------------------------
+/*
+ * An asset's rules map ranges of its value (value_index, or the first
+ * value_indices entry for text assets) to bar_color, text_color, background
+ * and visibility, so the sender no longer has to push asset_updates when a
+ * reading crosses a threshold. Each channel push re-evaluates the ranges, but
+ * styles go through apply_asset_update only when the matching rule changes;
+ * the base styles are remembered when a rule first takes over and restored
+ * when none matches. A hidden asset stays live and keeps being evaluated.
+ */
+static int asset_rule_slot(const asset_cfg_t *cfg)
 {
-    if (!asset || !buf || !written) return;
-    const asset_cfg_t *cfg = &asset->cfg;
-    int clamped_value_idx = (value_idx >= 0 && value_idx < TOTAL_VALUE_COUNT) ? value_idx : -1;
-    const char *t = text ? text : "";
-    bool has_text = t[0] != '\0';
-    bool has_value = clamped_value_idx >= 0;
-    if (!has_text && !has_value) return;
+    if (cfg->value_index >= 0) return cfg->value_index;
+    return cfg->value_indices_count > 0 ? cfg->value_indices[0] : -1;
+}
 
-    if (*written > 0) {
-        append_entry_separator(cfg, buf, buf_sz, written);
+static void asset_rule_apply(asset_t *asset, int match)
+{
+    const asset_cfg_t *cfg = &asset->cfg;
+    if (asset->rule_active == 0) {
+        asset->rule_base_color = cfg->color;
+        asset->rule_base_text_color = cfg->text_color;
+        asset->rule_base_bg_style = cfg->bg_style;
     }
+    const asset_rule_t *r = match > 0 ? &cfg->rules[match - 1] : NULL;
+    uint32_t sets = r ? r->sets : 0;
+    asset_update_t u;
+    memset(&u, 0, sizeof(u));
+    u.id = cfg->id;
+    u.fields = ASSET_UPD_BAR_COLOR | ASSET_UPD_TEXT_COLOR | ASSET_UPD_BACKGROUND;
+    u.bar_color = (sets & RULE_SET_BAR_COLOR) ? r->bar_color : asset->rule_base_color;
+    u.text_color = (sets & RULE_SET_TEXT_COLOR) ? r->text_color : asset->rule_base_text_color;
+    u.background = (sets & RULE_SET_BACKGROUND) ? r->background : asset->rule_base_bg_style;
+    asset->rule_active = match;
+    apply_asset_update(&u);
+}
 
-    if (has_text) {
-        size_t len = strnlen(t, TEXT_SLOT_LEN - 1);
-        size_t to_copy = len < buf_sz - 1 - *written ? len : buf_sz - 1 - *written;
-        memcpy(buf + *written, t, to_copy);
-        *written += to_copy;
-        if (*written < buf_sz - 1) {
-            buf[(*written)++] = ':';
-            if (has_value && *written < buf_sz - 1) {
-                buf[(*written)++] = ' ';
-            }
+// Returns 1 while the matching rule hides the asset
+static int asset_rules_eval(asset_t *asset)
+{
+    const asset_cfg_t *cfg = &asset->cfg;
+    double v = get_value_channel(asset_rule_slot(cfg));
+    int match = 0;
+    for (int k = 0; k < cfg->rule_count; k++) {
+        if (v >= cfg->rules[k].above && v < cfg->rules[k].below) {
+            match = k + 1;
+            break;
         }
     }
+    if (match != asset->rule_active) asset_rule_apply(asset, match);
+    int hide = match > 0 && (cfg->rules[match - 1].sets & RULE_SET_HIDE);
+    if (hide != asset->rule_hidden) g_region_replan = 1;
+    asset->rule_hidden = hide;
+    asset_set_shed(asset, hide);  // also re-hides a visual rebuilt by asset_updates
+    return hide;
+}
 
-    if (has_value && *written < buf_sz - 1) {
-        char val_buf[64];
-        format_value_text(get_value_channel(clamped_value_idx), val_buf, sizeof(val_buf));
-        size_t len = strnlen(val_buf, sizeof(val_buf) - 1);
-        size_t to_copy = len < buf_sz - 1 - *written ? len : buf_sz - 1 - *written;
-        memcpy(buf + *written, val_buf, to_copy);
-        *written += to_copy;
+/*
+ * Per-asset pacing on top of the push throttle: an asset with a min_gap_ms
+ * (max_rate_hz, or priority low) that refreshed less than that long ago is
+ * held in g_asset_deferred and taken up by the push after its gap ends, so a
+ * fast input only costs its slow readers one refresh per gap. Config and
+ * visual changes (g_asset_force) are never held back. High-priority assets
+ * instead make the main loop push as soon as their inputs change.
+ */
+static uint64_t asset_rate_filter(uint64_t todo, uint64_t forced, uint64_t now)
+{
+    uint64_t next = 0;
+    for (uint64_t m = todo; m; m &= m - 1) {
+        int i = __builtin_ctzll(m);
+        uint64_t gap = g_hot.min_gap_ms[i];
+        if (gap == 0) continue;
+        uint64_t bit = 1ull << i;
+        uint64_t due = g_hot.refreshed_ms[i] + gap;
+        if (!(forced & bit) && g_hot.refreshed_ms[i] != 0 && now < due) {
+            todo &= ~bit;
+            g_asset_deferred |= bit;
+            if (next == 0 || due < next) next = due;
+            continue;
+        }
+        g_hot.refreshed_ms[i] = now;
     }
+    g_asset_deferred &= ~todo;
+    g_asset_deferred_ms = next;
+    return todo;
 }
 
-static void compose_asset_text(const asset_t *asset, char *buf, size_t buf_sz)
+// A high-priority asset has changed inputs and should not wait out the push interval
+static int channel_push_urgent(void)
 {
-    if (!buf || buf_sz == 0) return;
-    buf[0] = '\0';
-    if (!asset) return;
+    if (!g_asset_high && !g_channel_deps_stale) return 0;
+    return (dirty_asset_users() & g_asset_high & ~(g_gov.shed | g_asset_offscreen)) != 0;
+}
 
-    if (asset->cfg.type == ASSET_TEXT) {
-        size_t written = 0;
-        if (asset->cfg.text_indices_count > 0) {
-            for (int i = 0; i < asset->cfg.text_indices_count; i++) {
-                int idx = asset->cfg.text_indices[i];
-                const char *t = "";
-                if (idx >= 0 && idx < TOTAL_TEXT_COUNT) {
-                    t = get_text_channel(idx);
+static void update_assets_from_channels(void)
+{
+    // Shed and offscreen assets are skipped; both force a refresh when they return
+    computed_update();
+    uint64_t forced = g_asset_force;
+    uint64_t skip = g_gov.shed | g_asset_offscreen;
+    g_asset_deferred &= ~skip;
+    uint64_t todo = (take_dirty_assets() | g_asset_deferred) & ~skip;
+    todo = asset_rate_filter(todo, forced, monotonic_ms64());
+    g_hitch_cur.assets += (uint16_t)__builtin_popcountll(todo);
+    for (int i = 0; todo; i++, todo >>= 1) {
+        if (!(todo & 1u)) continue;
+        if (!(g_hot.flags[i] & ASSET_HOT_ENABLED)) continue;
+        if (assets[i].cfg.rule_count > 0 && asset_rules_eval(&assets[i])) continue;
+        float min = g_hot.min[i];
+        float range = g_hot.range[i];
+        float v = (float)get_value_channel(g_hot.value_index[i]);
+        v = clamp_float(v, min, min + range);
+        float pct_f = (v - min) / range;
+        int pct = clamp_int((int)(pct_f * 100.0f), 0, 100);
+
+        switch (assets[i].cfg.type) {
+            case ASSET_BAR:
+                if (!assets[i].obj) break;
+                g_hot.target_pct[i] = (int16_t)pct;
+                // a freshly built bar draws its first value directly
+                if (g_hot.smooth_ms[i] > 0 && g_hot.last_pct[i] >= 0 && !g_gov.active) {
+                    if (g_hot.pos_q8[i] != pct << 8) g_bar_easing |= 1ull << i;
+                    break;
                 }
-                int value_idx = (i < asset->cfg.value_indices_count) ? asset->cfg.value_indices[i] : -1;
-                append_text_value_entry(asset, t, value_idx, buf, buf_sz, &written);
-                if (written >= buf_sz - 1) break;
+                g_bar_easing &= ~(1ull << i);
+                g_hot.pos_q8[i] = pct << 8;
+                bar_set_pct(&assets[i], pct);
+                break;
+            case ASSET_GAUGE:
+                if (assets[i].obj) gauge_set_pct(&assets[i], pct);
+                break;
+            case ASSET_IMAGE:
+                if (assets[i].obj) image_set_pct(&assets[i], pct);
+                break;
+            case ASSET_TEXT: {
+                if (assets[i].obj) {
+                    char text_buf[1024];
+                    compose_asset_text(&assets[i], text_buf, sizeof(text_buf));
+                    if (label_cache_update(&assets[i], text_buf)) {
+                        lv_label_set_text(assets[i].obj, text_buf);
+                        if (!label_extent_unchanged(&assets[i], assets[i].obj, text_buf)) {
+                            layout_text_asset(&assets[i]);
+                        }
+                    }
+                }
+                continue;
             }
+            default:
+                break;
         }
 
-        if (written == 0 && asset->cfg.text_index >= 0 && asset->cfg.text_index < TOTAL_TEXT_COUNT) {
-            const char *t = get_text_channel(asset->cfg.text_index);
-            int value_idx = (asset->cfg.value_indices_count > 0) ? asset->cfg.value_indices[0] : asset->cfg.value_index;
-            append_text_value_entry(asset, t, value_idx, buf, buf_sz, &written);
-        }
-
-        if (written == 0 && asset->cfg.label[0] != '\0') {
-            int value_idx = (asset->cfg.value_indices_count > 0) ? asset->cfg.value_indices[0] : asset->cfg.value_index;
-            append_text_value_entry(asset, asset->cfg.label, value_idx, buf, buf_sz, &written);
-        }
-
-        if (written == 0) {
-            buf[0] = '\0';
-        } else {
-            buf[written] = '\0';
+        if (assets[i].label_obj) {
+            char text_buf[1024];
+            compose_asset_text(&assets[i], text_buf, sizeof(text_buf));
+            if (label_cache_update(&assets[i], text_buf)) {
+                lv_label_set_text(assets[i].label_obj, text_buf);
+                if (!label_extent_unchanged(&assets[i], assets[i].label_obj, text_buf)) {
+                    lv_obj_update_layout(assets[i].label_obj);
+                    if (assets[i].container_obj) {
+                        layout_bar_asset(&assets[i]);
+                    }
+                }
+            }
         }
-        return;
     }
-
-    const char *t = get_asset_text(asset);
-    strncpy(buf, t, buf_sz - 1);
-    buf[buf_sz - 1] = '\0';
 }
 
-static bool poll_udp(void)
-{
-    if (udp_sock < 0) return false;
-    char buf[UDP_MAX_PACKET];
-    ssize_t r = 0;
-    bool updated = false;
+// -------------------------
+// Bar interpolation
+// -------------------------
+/*
+ * Bars with smooth_ms ease their drawn level toward the latest channel value
+ * instead of jumping to it, so a 5-10 Hz sender still gives smooth motion. The
+ * position is a Q8 percentage that each rendered frame moves by dt / (smooth_ms
+ * + dt) of the remaining distance, an exponential approach with smooth_ms as
+ * time constant. Only whole-percent changes reach bar_set_pct, so frames that
+ * do not move the fill edge invalidate nothing, and a bar drops out of
+ * g_bar_easing once it lands. While the governor is engaged bars jump straight
+ * to their value.
+ */
+#define EASE_FRAME_MS 16
+#define EASE_LAND_Q8 64     // within a quarter percent the bar snaps onto its target
 
-    while ((r = recvfrom(udp_sock, buf, sizeof(buf) - 1, 0, NULL, NULL)) > 0) {
-        buf[r] = '\0';
-        parse_udp_values(buf);
-        parse_udp_texts(buf);
-        parse_udp_asset_updates(buf);
-        updated = true;
-    }
+static uint64_t g_ease_last_ms = 0;
 
-    return updated;
+// Advances every easing bar; returns the next frame deadline, 0 when all are at rest
+static uint64_t bars_ease_tick(uint64_t now)
+{
+    if (!g_bar_easing) {
+        g_ease_last_ms = 0;
+        return 0;
+    }
+    uint64_t dt = g_ease_last_ms ? now - g_ease_last_ms : EASE_FRAME_MS;
+    g_ease_last_ms = now;
+    if (dt == 0) return now + EASE_FRAME_MS;
+    if (dt > 1000) dt = 1000;
+
+    uint64_t todo = g_bar_easing & ~(g_gov.shed | g_asset_offscreen);
+    for (int i = 0; todo; i++, todo >>= 1) {
+        if (!(todo & 1u)) continue;
+        uint64_t bit = 1ull << i;
+        int last = g_hot.last_pct[i];
+        if (!assets[i].obj || last < 0 || !(g_hot.flags[i] & ASSET_HOT_ENABLED)) {
+            g_bar_easing &= ~bit;  // rebuilt or disabled; the next update draws directly
+            continue;
+        }
+        int32_t goal = (int32_t)g_hot.target_pct[i] << 8;
+        int32_t pos = g_hot.pos_q8[i];
+        int64_t tau = g_gov.active ? 0 : g_hot.smooth_ms[i];
+        int32_t step = (int32_t)((int64_t)(goal - pos) * (int64_t)dt / (tau + (int64_t)dt));
+        if (step == 0) step = goal > pos ? 1 : -1;
+        pos += step;
+        if (abs(goal - pos) <= EASE_LAND_Q8) pos = goal;
+        g_hot.pos_q8[i] = pos;
+        bar_set_pct(&assets[i], (pos + 128) >> 8);
+        if (pos == goal) g_bar_easing &= ~bit;
+    }
+    // shed bars keep their bit but wait for the governor to release them
+    return (g_bar_easing & ~(g_gov.shed | g_asset_offscreen)) ? now + EASE_FRAME_MS : 0;
 }
 
-// -------------------------
-// LVGL tick function
-// -------------------------
-uint32_t my_get_milliseconds(void)
+static void handle_sigint(int sig)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint32_t)(((uint64_t)ts.tv_sec * 1000ULL) + (uint64_t)(ts.tv_nsec / 1000000ULL));
+    (void)sig;
+    stop_requested = 1;
 }
 
-static uint64_t monotonic_ms64(void)
+static void handle_sighup(int sig)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ((uint64_t)ts.tv_sec * 1000ULL) + (uint64_t)(ts.tv_nsec / 1000000ULL);
+    (void)sig;
+    reload_requested = 1;
 }
 
-static bool set_system_value(int idx, double v)
+// -------------------------
+// Frame scheduler
+// -------------------------
+// With frame_sync the 32 ms push throttle is replaced by a periodic timerfd
+// ticking at the video frame rate: pending channel updates are applied, drawn
+// and committed right after each tick, so the OSD moves once per encoded
+// frame. The rate follows the main encoder's FPS from the system bank unless
+// frame_rate pins it, and the timer is re-armed when the rounded rate changes.
+#define FRAME_SYNC_DEFAULT_FPS 30
+
+static int g_frame_timer_fd = -1;
+static int g_frame_timer_fps = 0;
+
+static int frame_sync_target_fps(void)
 {
-    if (idx < 0 || idx >= SYSTEM_VALUE_COUNT) return false;
-    double prev = system_values[idx];
-    double diff = prev - v;
-    if (diff < 0) diff = -diff;
-    if (diff < 0.001) return false;
-    system_values[idx] = v;
-    return true;
+    if (g_cfg.frame_rate > 0) return g_cfg.frame_rate;
+    int fps = (int)(g_sys_enc_fps + 0.5);
+    if (fps < 10) return FRAME_SYNC_DEFAULT_FPS;  // encoder idle or not readable
+    return clamp_int(fps, 10, 240);
 }
 
-static double parse_temperature_line(const char *line)
+static void frame_timer_close(void)
 {
-    if (!line) return -1.0;
-    const char *p = line;
-    while (*p && !isdigit((unsigned char)*p) && *p != '-') p++;
-    if (*p == '\0') return -1.0;
-    double v = -1.0;
-    if (sscanf(p, "%lf", &v) == 1) return v;
-    return -1.0;
+    if (g_frame_timer_fd >= 0) close(g_frame_timer_fd);
+    g_frame_timer_fd = -1;
+    g_frame_timer_fps = 0;
 }
 
-static double read_soc_temperature_sysfs(void)
+// Opens, re-arms or closes the tick timer to match the config; cheap when
+// nothing changed, so the main loop calls it every iteration
+static void frame_timer_update(void)
 {
-    static const char *paths[] = {
-        "/sys/devices/system/cpu/cpufreq/temp_out",
+    if (!g_cfg.frame_sync) {
+        frame_timer_close();
+        return;
+    }
+    if (g_frame_timer_fd < 0) {
+        g_frame_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (g_frame_timer_fd < 0) {
+            fprintf(stderr, "frame_sync: timerfd_create failed (%s), using the push throttle\n", strerror(errno));
+            g_cfg.frame_sync = 0;
+            return;
+        }
+    }
+    int fps = frame_sync_target_fps();
+    if (fps == g_frame_timer_fps) return;
+
+    long period_ns = 1000000000L / fps;
+    struct itimerspec its = {
+        .it_interval = {.tv_sec = 0, .tv_nsec = period_ns},
+        .it_value = {.tv_sec = 0, .tv_nsec = period_ns},
     };
-    char line[64];
-    for (int i = 0; i < (int)(sizeof(paths) / sizeof(paths[0])); i++) {
-        FILE *f = fopen(paths[i], "r");
-        if (!f) continue;
-        double temp = -1.0;
-        if (fgets(line, sizeof(line), f)) temp = parse_temperature_line(line);
-        fclose(f);
-        if (temp >= 0.0) return temp;
+    if (timerfd_settime(g_frame_timer_fd, 0, &its, NULL) != 0) {
+        fprintf(stderr, "frame_sync: timerfd_settime failed (%s)\n", strerror(errno));
+        return;
     }
-    return -1.0;
+    g_frame_timer_fps = fps;
 }
 
-static double read_soc_temperature(void)
+// True when at least one tick elapsed since the last call
+static int frame_timer_consume(void)
 {
-    double temp = read_soc_temperature_sysfs();
-    if (temp >= 0.0) return temp;
-
-    FILE *fp = popen("ipctool --temp 2>/dev/null", "r");
-    if (!fp) return -1.0;
-    char line[64];
-    temp = -1.0;
-    if (fgets(line, sizeof(line), fp)) {
-        temp = parse_temperature_line(line);
-    }
-    pclose(fp);
-    return temp;
+    uint64_t expirations = 0;
+    return read(g_frame_timer_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations) && expirations > 0;
 }
 
-static double read_cpu_load_pct(void)
-{
-    FILE *f = fopen("/proc/stat", "r");
-    if (!f) return -1.0;
-    char line[256];
-    if (!fgets(line, sizeof(line), f)) {
-        fclose(f);
-        return -1.0;
-    }
-    fclose(f);
+// -------------------------
+// Idle scheduling
+// -------------------------
+// With deep_idle the loop no longer wakes every idle_ms. The display refresh
+// timer is paused after each refresh and resumed by LVGL's refresh request
+// (sent on any invalidation), lv_timer_handler() only runs when such a request
+// fired or an LVGL timer is due, and poll() sleeps until input or the earliest
+// of the push, graph, LVGL timer and inline system refresh deadlines.
 
-    unsigned long long user = 0, nice = 0, system_time = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
-    if (sscanf(line, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &system_time, &idle, &iowait, &irq, &softirq, &steal) < 4) {
-        return -1.0;
-    }
+static int g_lvgl_kick = 1;          // a refresh was requested since the last handler run
+static uint64_t g_lvgl_next_ms = 0;  // next LVGL timer deadline, 0 = none pending
 
-    unsigned long long idle_all = idle + iowait;
-    unsigned long long non_idle = user + nice + system_time + irq + softirq + steal;
-    unsigned long long total = idle_all + non_idle;
-    static unsigned long long prev_total = 0;
-    static unsigned long long prev_idle = 0;
-    if (prev_total == 0 && prev_idle == 0) {
-        prev_total = total;
-        prev_idle = idle_all;
-        return -1.0;
-    }
-
-    unsigned long long totald = total - prev_total;
-    unsigned long long idled = idle_all - prev_idle;
-    prev_total = total;
-    prev_idle = idle_all;
-    if (totald == 0) return -1.0;
-
-    double pct = (double)(totald - idled) * 100.0 / (double)totald;
-    if (pct < 0.0) pct = 0.0;
-    if (pct > 100.0) pct = 100.0;
-    return pct;
-}
-
-static bool read_encoder_stats_proc(double *fps_out, double *bitrate_out)
-{
-    if (!fps_out || !bitrate_out) return false;
-    FILE *f = fopen("/proc/mi_modules/mi_venc/mi_venc0", "r");
-    if (!f) return false;
-
-    char line[512];
-    int in_section = 0;
-    bool found = false;
-    while (fgets(line, sizeof(line), f)) {
-        if (!in_section) {
-            if (strstr(line, "VENC 0 CHN info")) {
-                in_section = 1;
-            }
-            continue;
-        }
+static void display_idle_event_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_REFR_REQUEST) g_refr_requests++;
+    lv_timer_t *refr = lv_display_get_refr_timer(g_display);
+    if (!g_cfg.deep_idle || !refr) return;
+    if (lv_event_get_code(e) == LV_EVENT_REFR_REQUEST) {
+        lv_timer_resume(refr);
+        g_lvgl_kick = 1;
+        return;
+    }
+    lv_timer_pause(refr);
+}
 
-        if (strncmp(line, "ChnId", 5) == 0 || line[0] == '-') continue;
-
-        int chn = -1;
-        int state = 0, enpred = 0, base = 0, enhance = 0, max_stream = 0, frame_idx = 0, gradient = 0;
-        double fps1s = 0.0, kbps = 0.0, fps10s = 0.0, kbps10s = 0.0;
-        int parsed = sscanf(line,
-                            " %d %d %d %d %d %d %d %d %lf %lf %lf %lf",
-                            &chn,
-                            &state,
-                            &enpred,
-                            &base,
-                            &enhance,
-                            &max_stream,
-                            &frame_idx,
-                            &gradient,
-                            &fps1s,
-                            &kbps,
-                            &fps10s,
-                            &kbps10s);
-        if (parsed == 12 && chn == 0) {
-            *fps_out = fps1s;
-            *bitrate_out = kbps;
-            found = true;
-            break;
-        }
+static void idle_init(void)
+{
+    if (!g_display) return;
+    lv_display_add_event_cb(g_display, display_idle_event_cb, LV_EVENT_REFR_REQUEST, NULL);
+    lv_display_add_event_cb(g_display, display_idle_event_cb, LV_EVENT_REFR_READY, NULL);
+}
 
-        if (parsed < 0 && in_section && line[0] == '\n') {
-            break;
+// Applies show_stats and deep_idle; the stats timer is paused while the label
+// is hidden so it is never formatted for nobody
+static void idle_apply_config(void)
+{
+    if (stats_timer) {
+        if (g_cfg.show_stats) {
+            lv_timer_resume(stats_timer);
+        } else {
+            lv_timer_pause(stats_timer);
         }
     }
-
-    fclose(f);
-    return found;
+    lv_timer_t *refr = g_display ? lv_display_get_refr_timer(g_display) : NULL;
+    if (refr) lv_timer_resume(refr);
+    g_lvgl_kick = 1;
 }
 
-static bool refresh_system_values(void)
+// Runs the LVGL timers unless deep_idle knows none of them has work
+static void lvgl_service(uint64_t now)
 {
-    uint64_t now = monotonic_ms64();
-    int refresh_ms = clamp_int(g_cfg.system_refresh_ms, 100, 60000);
-    if (last_system_refresh_ms != 0 && now - last_system_refresh_ms < (uint64_t)refresh_ms) return false;
-    last_system_refresh_ms = now;
+    if (g_cfg.deep_idle && !g_lvgl_kick && (g_lvgl_next_ms == 0 || now < g_lvgl_next_ms)) return;
+    g_lvgl_kick = 0;
+    uint32_t next = lv_timer_handler();
+    g_lvgl_next_ms = next == LV_NO_TIMER_READY ? 0 : monotonic_ms64() + next;
+}
 
-    bool changed = false;
+// Lowers a poll timeout (-1 = infinite) to the time left until deadline (0 = none)
+static int cap_wait(int wait_ms, uint64_t deadline, uint64_t now)
+{
+    if (deadline == 0) return wait_ms;
+    uint64_t left = deadline > now ? deadline - now : 0;
+    if (left > 60000) left = 60000;
+    if (wait_ms < 0 || left < (uint64_t)wait_ms) return (int)left;
+    return wait_ms;
+}
 
-    double temp = read_soc_temperature();
-    if (temp >= 0.0) changed |= set_system_value(SYS_VALUE_TEMP, temp);
+// Base poll timeout: idle_ms normally, unbounded with deep_idle unless the
+// shared-memory transport has no wake FIFO and must be polled
+static int idle_wait_base(void)
+{
+    if (!g_cfg.deep_idle || (g_shm && g_shm_wake_fd < 0)) return idle_cap_ms;
+    return -1;
+}
 
-    double cpu = read_cpu_load_pct();
-    if (cpu >= 0.0) changed |= set_system_value(SYS_VALUE_CPU_LOAD, cpu);
+// -------------------------
+// Incremental reload
+// -------------------------
+// A SIGHUP re-parses the config into a staging list and reconciles it with
+// the live assets by id: removed ids lose their visuals, new ids are created,
+// and changed ones go through apply_asset_update so only the affected
+// properties are restyled, relaid out or recreated. Unchanged assets keep
+// their LVGL objects and do not repaint.
 
-    double fps = 0.0;
-    double bitrate = 0.0;
-    if (read_encoder_stats_proc(&fps, &bitrate)) {
-        changed |= set_system_value(SYS_VALUE_ENCODER_FPS, fps);
-        changed |= set_system_value(SYS_VALUE_ENCODER_BITRATE, bitrate);
+static int asset_index_of(const asset_t *list, int count, int id)
+{
+    for (int i = 0; i < count; i++) {
+        if (list[i].cfg.id == id) return i;
     }
-
-    return changed;
+    return -1;
 }
 
-static const MI_RGN_CanvasInfo_t *get_cached_canvas(void)
+// Moves a live asset to a lower slot, carrying its per-index hot state and
+// the bar draw hook, which is registered with the asset's address
+static void asset_move(asset_t *dst, asset_t *src)
 {
-    if (!g_canvas_info_valid || !g_cached_canvas_info.virtAddr) {
-        if (MI_RGN_GetCanvasInfo(hRgnHandle, &g_cached_canvas_info) != MI_RGN_OK) {
-            g_canvas_info_valid = 0;
-            return NULL;
+    int from = asset_slot(src);
+    int to = asset_slot(dst);
+    *dst = *src;
+    g_hot.last_pct[to] = g_hot.last_pct[from];
+    g_hot.target_pct[to] = g_hot.target_pct[from];
+    g_hot.pos_q8[to] = g_hot.pos_q8[from];
+    g_hot.refreshed_ms[to] = g_hot.refreshed_ms[from];
+    g_label_cache[to] = g_label_cache[from];
+    g_label_cache[from].valid = 0;
+    uint64_t *masks[3] = {&g_bar_easing, &g_asset_offscreen, &g_asset_deferred};
+    for (int i = 0; i < 3; i++) {
+        if ((*masks[i] >> from) & 1u) {
+            *masks[i] |= 1ull << to;
+        } else {
+            *masks[i] &= ~(1ull << to);
+        }
+        *masks[i] &= ~(1ull << from);
+    }
+    lv_obj_t *bars[2] = {dst->visual_type == ASSET_BAR ? dst->obj : NULL, dst->parked[ASSET_BAR].obj};
+    for (int i = 0; i < 2; i++) {
+        if (!bars[i]) continue;
+        lv_obj_remove_event_cb_with_user_data(bars[i], bar_draw_event_cb, src);
+        lv_obj_add_event_cb(bars[i], bar_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, dst);
+    }
+    // static layer hooks live on the containers and labels of every visual
+    for (int t = -1; t < ASSET_TYPE_COUNT; t++) {
+        lv_obj_t *cont = t < 0 ? dst->container_obj : dst->parked[t].container_obj;
+        lv_obj_t *label = t < 0 ? dst->label_obj : dst->parked[t].label_obj;
+        if (cont && lv_obj_remove_event_cb_with_user_data(cont, static_layer_draw_event_cb, src)) {
+            lv_obj_add_event_cb(cont, static_layer_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, dst);
+        }
+        if (label && lv_obj_remove_event_cb_with_user_data(label, static_label_draw_event_cb, src)) {
+            lv_obj_add_event_cb(label, static_label_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, dst);
         }
-        g_canvas_info_valid = 1;
     }
-    return &g_cached_canvas_info;
+    memset(src, 0, sizeof(*src));
 }
 
-// -------------------------
-// LVGL flush callback
-// -------------------------
-void my_flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+static void asset_update_from_cfg(const asset_cfg_t *cfg, asset_update_t *u)
 {
-    const MI_RGN_CanvasInfo_t *info = get_cached_canvas();
-
-    if (!info || !info->virtAddr) {
-        lv_display_flush_ready(disp);
-        return;
-    }
+    memset(u, 0, sizeof(*u));
+    u->fields = (ASSET_UPD_MAX << 1) - 1u;
+    u->id = cfg->id;
+    u->enabled = cfg->enabled;
+    u->type = cfg->type;
+    u->value_index = cfg->value_index;
+    u->text_index = cfg->text_index;
+    memcpy(u->text_indices, cfg->text_indices, sizeof(u->text_indices));
+    u->text_indices_count = cfg->text_indices_count;
+    memcpy(u->value_indices, cfg->value_indices, sizeof(u->value_indices));
+    u->value_indices_count = cfg->value_indices_count;
+    u->text_inline = cfg->text_inline;
+    memcpy(u->inline_separator, cfg->inline_separator, sizeof(u->inline_separator));
+    u->rounded_outline = cfg->rounded_outline;
+    memcpy(u->label, cfg->label, sizeof(u->label));
+    u->orientation = cfg->orientation;
+    u->bar_color = cfg->color;
+    u->text_color = cfg->text_color;
+    u->background = cfg->bg_style;
+    u->background_opacity = cfg->bg_opacity_pct;
+    u->segments = cfg->segments;
+    u->x = cfg->x;
+    u->y = cfg->y;
+    u->width = cfg->width;
+    u->height = cfg->height;
+    u->min = cfg->min;
+    u->max = cfg->max;
+}
 
-    int w = area->x2 - area->x1 + 1;
-    int h = area->y2 - area->y1 + 1;
-    uint32_t *src = (uint32_t *)px_map;  // Source is ARGB8888 (32-bit)
+// Config keys asset_updates cannot carry; a change rebuilds the visual
+static int asset_cfg_needs_rebuild(const asset_cfg_t *a, const asset_cfg_t *b)
+{
+    return a->tabular_digits != b->tabular_digits || a->font_size != b->font_size || a->font_bpp != b->font_bpp ||
+           a->history != b->history ||
+           a->interval_ms != b->interval_ms || a->graph_mode != b->graph_mode || strcmp(a->image, b->image) != 0;
+}
 
-    for (int y = 0; y < h; y++) {
-        uint16_t *dest = (uint16_t *)(info->virtAddr +
-                                      (area->y1 + y) * info->u32Stride +
-                                      area->x1 * 2);  // Dest is ARGB4444 (16-bit)
+// Returns the number of assets that were added, removed or changed
+static int reconcile_assets(const asset_t *staged, int staged_count)
+{
+    int touched = 0;
+    int kept = 0;
+    for (int i = 0; i < asset_count; i++) {
+        if (asset_index_of(staged, staged_count, assets[i].cfg.id) < 0) {
+            destroy_asset_visual(&assets[i]);
+            asset_visual_drop_parked(&assets[i]);
+            memset(&assets[i], 0, sizeof(assets[i]));
+            touched++;
+            continue;
+        }
+        if (kept != i) asset_move(&assets[kept], &assets[i]);
+        kept++;
+    }
+    asset_count = kept;
+    if (touched) {
+        g_region_replan = 1;
+        g_channel_deps_stale = 1;
+    }
 
-        for (int x = 0; x < w; x++) {
-            uint32_t argb8888 = src[y * w + x];
-            
-            // Extract ARGB8888 components (8 bits each)
-            uint8_t a8 = (argb8888 >> 24) & 0xFF;  // Alpha
-            uint8_t r8 = (argb8888 >> 16) & 0xFF;  // Red
-            uint8_t g8 = (argb8888 >> 8) & 0xFF;   // Green
-            uint8_t b8 = argb8888 & 0xFF;          // Blue
-            
-            // Convert 8-bit to 4-bit by taking the upper 4 bits
-            // This is equivalent to: value >> 4
-            uint8_t a4 = (a8 >> 4) & 0x0F;  // 8-bit -> 4-bit alpha
-            uint8_t r4 = (r8 >> 4) & 0x0F;  // 8-bit -> 4-bit red
-            uint8_t g4 = (g8 >> 4) & 0x0F;  // 8-bit -> 4-bit green
-            uint8_t b4 = (b8 >> 4) & 0x0F;  // 8-bit -> 4-bit blue
-            
-            // Pack into ARGB4444 format: AAAA RRRR GGGG BBBB
-            uint16_t argb4444 = (a4 << 12) | (r4 << 8) | (g4 << 4) | b4;
-            
-            dest[x] = argb4444;
+    for (int i = 0; i < staged_count; i++) {
+        const asset_cfg_t *cfg = &staged[i].cfg;
+        asset_t *live = find_asset_by_id(cfg->id);
+        if (live && memcmp(&live->cfg, cfg, sizeof(*cfg)) == 0) continue;
+
+        asset_update_t u;
+        asset_update_from_cfg(cfg, &u);
+        apply_asset_update(&u);
+        live = find_asset_by_id(cfg->id);
+        if (!live) continue;
+        int rebuild = asset_cfg_needs_rebuild(&live->cfg, cfg);
+        // the update clamps a few fields differently from the config parser
+        live->cfg = *cfg;
+        live->rule_active = 0;  // re-evaluated against the new base styles
+        mark_asset_refresh(live);
+        if (rebuild) asset_visual_drop_parked(live);
+        if (rebuild && live->cfg.enabled) {
+            create_asset_visual(live);
+            g_region_replan = 1;
         }
+        touched++;
     }
+    return touched;
+}
 
-    g_canvas_dirty = 1;
-    lv_display_flush_ready(disp);
+// Staged ids must be unique to be matched; otherwise the live list is rebuilt
+static int staged_ids_unique(const asset_t *staged, int staged_count)
+{
+    for (int i = 1; i < staged_count; i++) {
+        if (asset_index_of(staged, i, staged[i].cfg.id) >= 0) return 0;
+    }
+    return 1;
 }
 
 // -------------------------
-// Initialize RGN
+// State snapshot
 // -------------------------
-void mi_region_init(void)
-{
-    MI_RGN_Init(&g_stPaletteTable);
-    hRgnHandle = 0;
-
-    g_canvas_info_valid = 0;
-    memset(&g_cached_canvas_info, 0, sizeof(g_cached_canvas_info));
-
-    memset(&stRgnAttr, 0, sizeof(MI_RGN_Attr_t));
-    stRgnAttr.eType = E_MI_RGN_TYPE_OSD;
-    stRgnAttr.stOsdInitParam.ePixelFmt = E_MI_RGN_PIXEL_FORMAT_ARGB4444;  // Changed to ARGB4444
-    stRgnAttr.stOsdInitParam.stSize.u32Width = osd_width;
-    stRgnAttr.stOsdInitParam.stSize.u32Height = osd_height;
+/*
+ * Every snapshot_ms, and only when something changed, the UDP value and text
+ * banks and the live asset configs (with every asset_update applied) are
+ * written to snapshot_path, normally on tmpfs, via a temporary file and a
+ * rename. A restarted process loads it right after the config, before the
+ * first frame, so the screen comes back as it was instead of blank until the
+ * senders repeat themselves. Asset configs are restored only when the binary
+ * and the config file are the ones that wrote the snapshot; the channel banks
+ * are restored whenever the snapshot is younger than SNAPSHOT_MAX_AGE_MS of
+ * CLOCK_BOOTTIME, which also rules out snapshots from before a reboot.
+ */
+#define SNAPSHOT_MAGIC 0x53534F57u  // "WOSS"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_MAX_AGE_MS 60000
 
-    MI_RGN_Create(hRgnHandle, &stRgnAttr);
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t build;         // config_cache_build() of the writer
+    uint32_t src_size;      // config file the assets belong to
+    int64_t src_mtime_ns;
+    uint64_t boot_ms;       // CLOCK_BOOTTIME at write
+    int32_t udp_channels;
+    int32_t asset_count;
+    uint32_t text_bytes;    // u16 length + bytes per channel
+    uint32_t reserved;
+} snapshot_header_t;
+
+static uint64_t g_snapshot_next_ms = 0;
+
+static uint64_t boottime_ms(void)
+{
+    struct timespec ts;
+#ifdef CLOCK_BOOTTIME
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) == 0) return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
 
-    stVpeChnPort.eModId = E_MI_RGN_MODID_VPE;
-    stVpeChnPort.s32DevId = 0;
-    stVpeChnPort.s32ChnId = 0;
-    stVpeChnPort.s32OutputPortId = 0;
+static void snapshot_write(void)
+{
+    snapshot_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = SNAPSHOT_MAGIC;
+    hdr.version = SNAPSHOT_VERSION;
+    hdr.build = config_cache_build();
+    config_source_stat(&hdr.src_size, &hdr.src_mtime_ns);
+    hdr.boot_ms = boottime_ms();
+    hdr.udp_channels = g_udp_channels;
+    hdr.asset_count = asset_count;
+    for (int i = 0; i < g_udp_channels; i++) hdr.text_bytes += 2u + udp_texts[i].len;
+
+    size_t size = sizeof(hdr) + sizeof(*udp_values) * (size_t)g_udp_channels + hdr.text_bytes +
+                  sizeof(asset_cfg_t) * (size_t)asset_count;
+    uint8_t *buf = malloc(size);
+    if (!buf) return;
+    uint8_t *p = buf;
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+    memcpy(p, udp_values, sizeof(*udp_values) * (size_t)g_udp_channels);
+    p += sizeof(*udp_values) * (size_t)g_udp_channels;
+    for (int i = 0; i < g_udp_channels; i++) {
+        uint16_t len = udp_texts[i].len;
+        memcpy(p, &len, sizeof(len));
+        memcpy(p + sizeof(len), udp_texts[i].text, len);
+        p += sizeof(len) + len;
+    }
+    for (int i = 0; i < asset_count; i++) {
+        memcpy(p, &assets[i].cfg, sizeof(assets[i].cfg));
+        p += sizeof(assets[i].cfg);
+    }
 
-    memset(&stRgnChnAttr, 0, sizeof(MI_RGN_ChnPortParam_t));
-    stRgnChnAttr.bShow = 1;
-    stRgnChnAttr.stPoint.u32X = (MI_U32)rgn_pos_x;
-    stRgnChnAttr.stPoint.u32Y = (MI_U32)rgn_pos_y;
-    stRgnChnAttr.unPara.stOsdChnPort.u32Layer = 0;
-    stRgnChnAttr.unPara.stOsdChnPort.stOsdAlphaAttr.eAlphaMode = E_MI_RGN_PIXEL_ALPHA;
+    char tmp[sizeof(g_cfg.snapshot_path) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", g_cfg.snapshot_path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        int ok = write(fd, buf, size) == (ssize_t)size;
+        ok = close(fd) == 0 && ok;
+        if (!ok || rename(tmp, g_cfg.snapshot_path) != 0) unlink(tmp);
+    }
+    free(buf);
+}
 
-    MI_RGN_AttachToChn(hRgnHandle, &stVpeChnPort, &stRgnChnAttr);
+// Writes the snapshot once it is due and something changed since the last one
+static void snapshot_tick(uint64_t now)
+{
+    if (g_cfg.snapshot_ms <= 0 || !g_snapshot_dirty || now < g_snapshot_next_ms) return;
+    g_snapshot_dirty = 0;
+    g_snapshot_next_ms = now + (uint64_t)g_cfg.snapshot_ms;
+    snapshot_write();
+}
 
-    if (MI_RGN_GetCanvasInfo(hRgnHandle, &g_cached_canvas_info) == MI_RGN_OK) {
-        g_canvas_info_valid = 1;
-    }
+// Next write time while a change is pending, 0 otherwise
+static uint64_t snapshot_deadline(void)
+{
+    if (g_cfg.snapshot_ms <= 0 || !g_snapshot_dirty) return 0;
+    return g_snapshot_next_ms;
 }
 
-// -------------------------
-// Initialize LVGL display
-// -------------------------
-void init_lvgl(void)
+// Final write on a clean exit so a restart starts from the latest state
+static void snapshot_flush(void)
 {
-    lv_init();
+    if (g_cfg.snapshot_ms <= 0 || !g_snapshot_dirty) return;
+    g_snapshot_dirty = 0;
+    snapshot_write();
+}
 
-    // Set LVGL tick callback
-    lv_tick_set_cb(my_get_milliseconds);
+// Runs after load_config and before the assets are created
+static void snapshot_restore(void)
+{
+    if (g_cfg.snapshot_ms <= 0) return;
+    char *buf = NULL;
+    size_t len = 0;
+    if (read_file(g_cfg.snapshot_path, &buf, &len) != 0) return;
+    snapshot_header_t hdr;
+    size_t value_bytes = sizeof(*udp_values) * (size_t)g_udp_channels;
+    int valid = len >= sizeof(hdr);
+    if (valid) {
+        memcpy(&hdr, buf, sizeof(hdr));
+        uint64_t now = boottime_ms();
+        // Each size is bounded by what is left before it is added, so the sums cannot wrap on 32-bit
+        size_t body = len - sizeof(hdr);
+        valid = hdr.magic == SNAPSHOT_MAGIC && hdr.version == SNAPSHOT_VERSION && hdr.udp_channels == g_udp_channels &&
+                hdr.boot_ms <= now && now - hdr.boot_ms <= SNAPSHOT_MAX_AGE_MS && hdr.asset_count >= 0 &&
+                g_udp_channels > 0 && g_udp_channels <= UDP_CHANNEL_MAX && value_bytes <= body &&
+                hdr.text_bytes <= body - value_bytes;
+    }
+    if (!valid) {
+        free(buf);
+        return;
+    }
 
-    size_t buf_size = (size_t)osd_width * BUF_ROWS * sizeof(lv_color_t);
-    buf1 = (lv_color_t *)malloc(buf_size);
-    buf2 = (lv_color_t *)malloc(buf_size);
-    if (!buf1 || !buf2) {
-        fprintf(stderr, "Failed to allocate LVGL buffers\n");
-        exit(1);
+    const uint8_t *p = (const uint8_t *)buf + sizeof(hdr);
+    const uint8_t *texts_end = p + value_bytes + hdr.text_bytes;
+    for (int i = 0; i < g_udp_channels; i++) {
+        double v;
+        memcpy(&v, p, sizeof(v));
+        set_udp_value(i, v);
+        p += sizeof(v);
+    }
+    for (int i = 0; i < g_udp_channels && p + sizeof(uint16_t) <= texts_end; i++) {
+        uint16_t n;
+        memcpy(&n, p, sizeof(n));
+        p += sizeof(n);
+        if (p + n > texts_end) break;
+        set_udp_text(i, (const char *)p, n);
+        p += n;
     }
 
-    lv_display_t * disp = lv_display_create(osd_width, osd_height);
-    lv_display_set_color_format(disp, LV_COLOR_FORMAT_ARGB8888);
-    lv_display_set_buffers(disp, buf1, buf2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
-    lv_display_set_flush_cb(disp, my_flush_cb);
+    // Asset configs only mean something to the binary and config that wrote them
+    uint32_t size = 0;
+    int64_t mtime = 0;
+    int assets_restored = 0;
+    if (hdr.build == config_cache_build() && config_source_stat(&size, &mtime) == 0 && hdr.src_size == size &&
+        hdr.src_mtime_ns == mtime && hdr.asset_count >= 1 && hdr.asset_count <= g_asset_capacity &&
+        len == (size_t)(texts_end - (const uint8_t *)buf) + sizeof(asset_cfg_t) * (size_t)hdr.asset_count) {
+        p = texts_end;
+        for (int i = 0; i < hdr.asset_count; i++) {
+            init_asset_defaults(&assets[i], i);
+            memcpy(&assets[i].cfg, p, sizeof(assets[i].cfg));
+            p += sizeof(assets[i].cfg);
+        }
+        asset_count = hdr.asset_count;
+        assets_restored = 1;
+    }
+    printf("Snapshot: restored %d channels%s from %llu ms ago\n", g_udp_channels,
+           assets_restored ? " and the asset set" : "", (unsigned long long)(boottime_ms() - hdr.boot_ms));
+    g_snapshot_dirty = 0;
+    free(buf);
 }
 
+// -------------------------
+// Startup
+// -------------------------
+/*
+ * main() brings up only what the first frame needs: pool, config (from the
+ * cache when it is current), sockets, regions, LVGL and the assets. It then
+ * renders and commits once, and only afterwards builds the stats panel, starts
+ * the system sampler and pre-faults the render memory. Each phase is timed from
+ * main() and the report ends with time-to-first-commit; the metrics endpoint
+ * repeats it.
+ */
+#define BOOT_PHASE_MAX 10
 
-static lv_obj_t *create_bar(asset_t *asset)
+typedef struct {
+    const char *name;
+    uint32_t us;
+} boot_phase_t;
+
+static struct {
+    uint64_t start_us;
+    uint64_t last_us;
+    boot_phase_t phase[BOOT_PHASE_MAX];
+    int count;
+    uint32_t first_commit_us;   // main() to the first MI_RGN_UpdateCanvas
+    uint32_t ready_us;          // deferred work done, entering the main loop
+} g_boot;
+
+static void boot_phase(const char *name)
 {
-    if (!asset) return NULL;
-    const asset_cfg_t *cfg = &asset->cfg;
-    asset->container_obj = lv_obj_create(lv_scr_act());
-    lv_obj_remove_style_all(asset->container_obj);
-    lv_obj_clear_flag(asset->container_obj, LV_OBJ_FLAG_SCROLLABLE);
-
-    lv_obj_t *bar = lv_bar_create(asset->container_obj);
-    lv_obj_remove_style_all(bar);
-    if (cfg->rounded_outline) {
-        lv_obj_set_style_border_width(bar, 2, 0);
-        lv_obj_set_style_border_color(bar, lv_color_hex(cfg->color), 0);
-        lv_obj_set_style_pad_all(bar, 6, 0);
-        lv_obj_set_style_radius(bar, 6, 0);
-        lv_obj_set_style_anim_duration(bar, 1000, 0);
-    } else {
-        lv_obj_set_style_bg_opa(bar, LV_OPA_TRANSP, LV_PART_MAIN);
-        lv_obj_set_style_radius(bar, cfg->height > 0 ? cfg->height / 2 : 16, LV_PART_MAIN);
+    uint64_t now = monotonic_us64();
+    if (g_boot.start_us == 0) {
+        g_boot.start_us = now;
+        g_boot.last_us = now;
+        return;
     }
-    lv_obj_set_style_radius(bar, 3, LV_PART_INDICATOR);
-    lv_obj_set_style_bg_color(bar, lv_color_hex(cfg->color), LV_PART_INDICATOR);
-    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, LV_PART_INDICATOR);
-    lv_obj_add_flag(bar, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
-    lv_obj_add_event_cb(bar, bar_draw_event_cb, LV_EVENT_DRAW_TASK_ADDED, asset);
-    lv_bar_set_range(bar, 0, 100);
-    return bar;
+    if (g_boot.count < BOOT_PHASE_MAX) {
+        g_boot.phase[g_boot.count].name = name;
+        g_boot.phase[g_boot.count].us = (uint32_t)(now - g_boot.last_us);
+        g_boot.count++;
+    }
+    g_boot.last_us = now;
 }
 
-static void destroy_asset_visual(asset_t *asset)
+static void boot_report(void)
 {
-    if (!asset) return;
-    if (asset->container_obj) {
-        lv_obj_del(asset->container_obj);
-    } else {
-        if (asset->label_obj) lv_obj_del(asset->label_obj);
-        if (asset->obj) lv_obj_del(asset->obj);
+    char line[256];
+    int off = 0;
+    for (int i = 0; i < g_boot.count && off < (int)sizeof(line); i++) {
+        off += snprintf(line + off, sizeof(line) - (size_t)off, "%s%s %.1f", i ? ", " : "", g_boot.phase[i].name,
+                        g_boot.phase[i].us / 1000.0);
     }
-    asset->container_obj = NULL;
-    asset->label_obj = NULL;
-    asset->obj = NULL;
-    asset->last_pct = -1;
-    asset->last_label_text[0] = '\0';
+    printf("Startup ms: %s\n", line);
+    printf("Startup: first commit after %.1f ms (config %s), ready after %.1f ms\n", g_boot.first_commit_us / 1000.0,
+           g_config_cache_hit ? "from cache" : "parsed", g_boot.ready_us / 1000.0);
 }
 
-static lv_obj_t *create_text_asset(asset_t *asset)
-{
-    lv_obj_t *label = lv_label_create(lv_scr_act());
-    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
-    apply_background_style(label, asset->cfg.bg_style, asset->cfg.bg_opacity_pct, 0);
-    lv_obj_set_style_text_color(label, lv_color_hex(asset->cfg.text_color), 0);
-    lv_obj_set_style_text_opa(label, LV_OPA_COVER, 0);
+// -------------------------
+// Hitch flight recorder
+// -------------------------
+/*
+ * Every main loop iteration leaves one hitch_rec_t in a fixed ring, so the
+ * cost in steady state is a few stores and clock reads. When an iteration
+ * is busy for at least hitch_ms (its time minus the poll() wait), the window around it (HITCH_BEFORE iterations
+ * before, HITCH_AFTER after, so the recovery is in it too) is frozen once the
+ * last of those iterations is recorded. {"hitch":true} on the metrics port
+ * returns the frozen window, and with hitch_file set it is also appended to
+ * that file. The file gets at most one window per HITCH_WRITE_GAP_MS, so a
+ * burst of stalls (or a slow filesystem) cannot cause more of them.
+ */
+#define HITCH_RING 64       // power of two
+#define HITCH_BEFORE 11
+#define HITCH_AFTER 4
+#define HITCH_WINDOW (HITCH_BEFORE + 1 + HITCH_AFTER)
+#define HITCH_WRITE_GAP_MS 10000
 
-    char text_buf[1024];
-    compose_asset_text(asset, text_buf, sizeof(text_buf));
-    lv_label_set_text(label, text_buf);
-    strncpy(asset->last_label_text, text_buf, sizeof(asset->last_label_text) - 1);
-    asset->last_label_text[sizeof(asset->last_label_text) - 1] = '\0';
-    asset->obj = label;
-    layout_text_asset(asset);
-    return label;
+typedef struct {
+    hitch_rec_t ring[HITCH_RING];
+    uint32_t seq;               // records written so far
+    uint32_t rx_seen;           // g_udp_counters.rx at the previous record
+    uint32_t trigger_seq;       // record that crossed the deadline, valid while armed
+    int armed;
+    uint32_t count;             // iterations over the deadline since startup
+    uint32_t worst_us;
+    hitch_rec_t window[HITCH_WINDOW];  // last frozen window, oldest first
+    int window_len;
+    int window_trigger;         // index of the slow iteration in window[]
+    uint64_t written_ms;        // last hitch_file write
+} hitch_state_t;
+
+static hitch_state_t g_hitch;
+
+static void hitch_write_file(uint64_t now_ms)
+{
+    if (!g_cfg.hitch_file[0] || (g_hitch.written_ms && now_ms - g_hitch.written_ms < HITCH_WRITE_GAP_MS)) return;
+    g_hitch.written_ms = now_ms;
+    FILE *f = fopen(g_cfg.hitch_file, "a");
+    if (!f) {
+        fprintf(stderr, "hitch: cannot open %s: %s\n", g_cfg.hitch_file, strerror(errno));
+        return;
+    }
+    const hitch_rec_t *t = &g_hitch.window[g_hitch.window_trigger];
+    fprintf(f, "hitch at %u ms: busy %u us over %d ms (#%u)\n", t->start_ms, t->loop_us - t->poll_us, g_cfg.hitch_ms,
+            g_hitch.count);
+    fprintf(f, "  %10s %8s %8s %7s %8s %7s %8s %4s %6s\n", "start_ms", "loop_us", "poll_us", "sys_us", "frame_us",
+            "commit", "pixels", "rx", "assets");
+    for (int i = 0; i < g_hitch.window_len; i++) {
+        const hitch_rec_t *r = &g_hitch.window[i];
+        fprintf(f, "%s %10u %8u %8u %7u %8u %7u %8u %4u %6u\n", i == g_hitch.window_trigger ? ">" : " ", r->start_ms,
+                r->loop_us, r->poll_us, r->sys_us, r->frame_us, r->commit_us, r->pixels, r->rx, r->assets);
+    }
+    fclose(f);
 }
 
-static void create_asset_visual(asset_t *asset)
+static void hitch_freeze(uint64_t now_ms)
 {
-    if (!asset || !asset->cfg.enabled) return;
-    destroy_asset_visual(asset);
-    switch (asset->cfg.type) {
-        case ASSET_BAR:
-            asset->obj = create_bar(asset);
-            maybe_attach_asset_label(asset);
-            break;
-        case ASSET_TEXT:
-            asset->obj = create_text_asset(asset);
-            break;
-        default:
-            asset->obj = create_bar(asset);
-            maybe_attach_asset_label(asset);
-            break;
-    }
+    uint32_t first = g_hitch.trigger_seq >= HITCH_BEFORE ? g_hitch.trigger_seq - HITCH_BEFORE : 0;
+    int n = (int)(g_hitch.seq - first);
+    for (int i = 0; i < n; i++) g_hitch.window[i] = g_hitch.ring[(first + (uint32_t)i) & (HITCH_RING - 1)];
+    g_hitch.window_len = n;
+    g_hitch.window_trigger = (int)(g_hitch.trigger_seq - first);
+    g_hitch.armed = 0;
+    hitch_write_file(now_ms);
+}
 
-    if (asset->container_obj && asset->cfg.type != ASSET_TEXT) {
-        layout_bar_asset(asset);
+// Closes the iteration that started at loop_start_us and resets g_hitch_cur for the next one
+static void hitch_record(uint64_t loop_start_us, uint64_t end_us)
+{
+    hitch_rec_t *r = &g_hitch.ring[g_hitch.seq & (HITCH_RING - 1)];
+    *r = g_hitch_cur;
+    r->start_ms = (uint32_t)(loop_start_us / 1000);
+    r->loop_us = (uint32_t)(end_us - loop_start_us);
+    uint32_t rx = __atomic_load_n(&g_udp_counters.rx, __ATOMIC_RELAXED);
+    r->rx = (uint16_t)(rx - g_hitch.rx_seen);
+    g_hitch.rx_seen = rx;
+    memset(&g_hitch_cur, 0, sizeof(g_hitch_cur));
+
+    // Only busy time counts; a long poll() is the loop idling, not stalling
+    uint32_t busy_us = r->loop_us - r->poll_us;
+    uint32_t seq = g_hitch.seq++;
+    if (g_cfg.hitch_ms > 0 && busy_us >= (uint32_t)g_cfg.hitch_ms * 1000u) {
+        g_hitch.count++;
+        if (busy_us > g_hitch.worst_us) g_hitch.worst_us = busy_us;
+        if (!g_hitch.armed) {
+            g_hitch.armed = 1;
+            g_hitch.trigger_seq = seq;
+        }
     }
+    if (g_hitch.armed && g_hitch.seq - g_hitch.trigger_seq > HITCH_AFTER) hitch_freeze(end_us / 1000);
+}
 
-    apply_asset_styles(asset);
+static int hitch_rec_format(char *buf, size_t buf_sz, const hitch_rec_t *r, int first)
+{
+    return snprintf(buf, buf_sz, "%s[%u,%u,%u,%u,%u,%u,%u,%u,%u]", first ? "" : ",", r->start_ms, r->loop_us, r->poll_us,
+                    r->sys_us, r->frame_us, r->commit_us, r->pixels, r->rx, r->assets);
 }
 
-static void maybe_attach_asset_label(asset_t *asset)
+static int hitch_format(char *buf, size_t buf_sz)
 {
-    if (!asset->obj) return;
-    if (asset->cfg.type == ASSET_TEXT) return;
-    if (asset->cfg.label[0] == '\0' && asset->cfg.text_index < 0) return;
-    lv_obj_t *parent = asset->container_obj ? asset->container_obj : lv_scr_act();
-    asset->label_obj = lv_label_create(parent);
-    lv_obj_set_style_text_color(asset->label_obj, lv_color_hex(asset->cfg.text_color), 0);
-    lv_obj_set_style_text_opa(asset->label_obj, LV_OPA_COVER, 0);
-    lv_obj_set_style_bg_opa(asset->label_obj, LV_OPA_TRANSP, 0);
+    static const char head[] = "{\"hitch\":{\"deadline_ms\":%d,\"count\":%u,\"worst_us\":%u,\"trigger\":%d,"
+                               "\"fields\":[\"start_ms\",\"loop_us\",\"poll_us\",\"sys_us\",\"frame_us\",\"commit_us\","
+                               "\"pixels\",\"rx\",\"assets\"],\"records\":[";
+    // Drop the oldest records (never the slow one) until the window fits in one reply
+    int first = 0;
+    size_t need = sizeof(head) + 40 + 3;
+    for (int i = 0; i < g_hitch.window_len; i++) need += (size_t)hitch_rec_format(NULL, 0, &g_hitch.window[i], 0);
+    while (first < g_hitch.window_trigger && need >= buf_sz) {
+        need -= (size_t)hitch_rec_format(NULL, 0, &g_hitch.window[first], 0);
+        first++;
+    }
 
-    char text_buf[1024];
-    compose_asset_text(asset, text_buf, sizeof(text_buf));
-    lv_label_set_text(asset->label_obj, text_buf);
-    strncpy(asset->last_label_text, text_buf, sizeof(asset->last_label_text) - 1);
-    asset->last_label_text[sizeof(asset->last_label_text) - 1] = '\0';
-    if (asset->container_obj) {
-        layout_bar_asset(asset);
-    } else {
-        lv_obj_align_to(asset->label_obj, asset->obj, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
+    int off = snprintf(buf, buf_sz, head, g_cfg.hitch_ms, g_hitch.count, g_hitch.worst_us,
+                       g_hitch.window_len ? g_hitch.window_trigger - first : -1);
+    for (int i = first; i < g_hitch.window_len && off < (int)buf_sz; i++) {
+        off += hitch_rec_format(buf + off, buf_sz - (size_t)off, &g_hitch.window[i], i == first);
     }
+    if (off < (int)buf_sz) off += snprintf(buf + off, buf_sz - (size_t)off, "]}}");
+    return off;
 }
 
-static void create_assets(void)
+// -------------------------
+// Metrics endpoint
+// -------------------------
+/*
+ * With metrics_port set, a second UDP socket answers every datagram it gets
+ * with one JSON snapshot of the renderer internals: frame timings, flushed
+ * pixel counts, receive counters, LVGL heap use and the value banks. The
+ * request payload is ignored, so `echo | nc -u host port` is enough to scrape
+ * it without turning on the on-screen stats.
+ */
+#define METRICS_REPLY_MAX 1472  // one unfragmented datagram on a 1500-byte MTU
+
+static int g_metrics_sock = -1;
+static int g_metrics_port_bound = 0;
+
+static void metrics_close(void)
 {
-    for (int i = 0; i < asset_count; i++) {
-        create_asset_visual(&assets[i]);
-    }
+    if (g_metrics_sock >= 0) close(g_metrics_sock);
+    g_metrics_sock = -1;
+    g_metrics_port_bound = 0;
 }
 
-static void destroy_assets(void)
+// Opens, rebinds or closes the metrics socket to match the config
+static void metrics_apply_config(void)
 {
-    for (int i = 0; i < asset_count; i++) {
-        destroy_asset_visual(&assets[i]);
+    if (g_cfg.metrics_port == g_metrics_port_bound && (g_metrics_sock >= 0) == (g_cfg.metrics_port > 0)) return;
+    metrics_close();
+    if (g_cfg.metrics_port <= 0) return;
+    if (g_cfg.metrics_port == UDP_PORT) {
+        fprintf(stderr, "metrics: port %d is the data port, endpoint disabled\n", UDP_PORT);
+        return;
     }
 
-    asset_count = 0;
-    memset(assets, 0, sizeof(assets));
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "metrics: socket failed: %s\n", strerror(errno));
+        return;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)g_cfg.metrics_port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "metrics: bind to port %d failed: %s\n", g_cfg.metrics_port, strerror(errno));
+        close(fd);
+        return;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    g_metrics_sock = fd;
+    g_metrics_port_bound = g_cfg.metrics_port;
+    printf("Metrics endpoint on UDP port %d\n", g_cfg.metrics_port);
 }
 
-static void update_assets_from_channels(void)
+// Appends to a fixed buffer; output past the end is dropped, never overrun
+static void metrics_appendf(char *buf, size_t buf_sz, int *off, const char *fmt, ...)
 {
+    if (*off >= (int)buf_sz - 1) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf + *off, buf_sz - (size_t)*off, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    *off += n;
+    if (*off > (int)buf_sz - 1) *off = (int)buf_sz - 1;
+}
+
+static int metrics_format(char *buf, size_t buf_sz)
+{
+    int active = 0;
+    int offscreen = 0;
     for (int i = 0; i < asset_count; i++) {
         if (!assets[i].cfg.enabled) continue;
-        const asset_cfg_t *cfg = &assets[i].cfg;
-        float min = cfg->min;
-        float max = cfg->max;
-        if (max <= min + 0.0001f) {
-            max = min + 1.0f;
-        }
-        float v = (float)get_value_channel(clamp_int(cfg->value_index, 0, TOTAL_VALUE_COUNT - 1));
-        v = clamp_float(v, min, max);
-        float pct_f = (v - min) / (max - min);
-        int pct = clamp_int((int)(pct_f * 100.0f), 0, 100);
-
-        switch (cfg->type) {
-            case ASSET_BAR:
-                if (assets[i].obj && assets[i].last_pct != pct) {
-                    lv_bar_set_value(assets[i].obj, pct, LV_ANIM_OFF);
-                    assets[i].last_pct = pct;
-                }
-                break;
-            case ASSET_TEXT: {
-                if (assets[i].obj) {
-                    char text_buf[1024];
-                    compose_asset_text(&assets[i], text_buf, sizeof(text_buf));
-                    if (strncmp(text_buf, assets[i].last_label_text, sizeof(assets[i].last_label_text) - 1) != 0) {
-                        lv_label_set_text(assets[i].obj, text_buf);
-                        strncpy(assets[i].last_label_text, text_buf, sizeof(assets[i].last_label_text) - 1);
-                        assets[i].last_label_text[sizeof(assets[i].last_label_text) - 1] = '\0';
-                        layout_text_asset(&assets[i]);
-                    }
-                }
-                continue;
-            }
-            default:
-                break;
-        }
+        active++;
+        offscreen += (int)((g_asset_offscreen >> i) & 1u);
+    }
+    heap_sample(monotonic_ms64(), 1);
 
-        if (assets[i].label_obj) {
-            char text_buf[1024];
-            compose_asset_text(&assets[i], text_buf, sizeof(text_buf));
-            if (strncmp(text_buf, assets[i].last_label_text, sizeof(assets[i].last_label_text) - 1) != 0) {
-                lv_label_set_text(assets[i].label_obj, text_buf);
-                lv_obj_update_layout(assets[i].label_obj);
-                strncpy(assets[i].last_label_text, text_buf, sizeof(assets[i].last_label_text) - 1);
-                assets[i].last_label_text[sizeof(assets[i].last_label_text) - 1] = '\0';
-                if (assets[i].container_obj) {
-                    layout_bar_asset(&assets[i]);
-                }
-            }
+    int off = 0;
+    metrics_appendf(buf, buf_sz, &off,
+                    "{\"metrics\":{\"fps\":%u,\"frame_ms\":%u,\"loop_ms\":%u,\"idle_ms\":%d,"
+                    "\"assets\":%d,\"assets_enabled\":%d,\"offscreen\":%d,\"governor\":%d,\"shed\":%d",
+                    fps_value, last_frame_ms, last_loop_ms, idle_ms_applied, asset_count, active,
+                    offscreen, g_gov.active, __builtin_popcountll(g_gov.shed));
+    metrics_appendf(buf, buf_sz, &off, ",\"flush\":{\"converted\":%llu,\"zeroed\":%llu,\"skipped\":%llu,\"merged\":%llu}",
+                    (unsigned long long)g_flush_counters.converted,
+                    (unsigned long long)g_flush_counters.zeroed,
+                    (unsigned long long)g_flush_counters.skipped,
+                    (unsigned long long)g_flush_counters.merged);
+    metrics_appendf(buf, buf_sz, &off, ",\"rx_stats\":{");
+    if (off < (int)buf_sz - 1) {
+        off += udp_stats_format(buf + off, buf_sz - (size_t)off, 1);
+        if (off > (int)buf_sz - 1) off = (int)buf_sz - 1;
+    }
+    metrics_appendf(buf, buf_sz, &off,
+                    "},\"heap\":{\"total\":%u,\"used\":%u,\"peak\":%u,\"biggest_free\":%u,"
+                    "\"min_biggest_free\":%u,\"frag_pct\":%u,\"max_frag_pct\":%u,\"alloc_fails\":%u,"
+                    "\"alarms\":%u}",
+                    g_heap.total, g_heap.used, g_heap.peak_used, g_heap.biggest_free, g_heap.min_biggest_free,
+                    g_heap.frag_pct, g_heap.max_frag_pct, g_heap.assert_fails, g_heap.alarms);
+    metrics_appendf(buf, buf_sz, &off, ",\"hitch\":{\"count\":%u,\"worst_us\":%u}", g_hitch.count, g_hitch.worst_us);
+    metrics_appendf(buf, buf_sz, &off, ",\"startup\":{\"first_commit_ms\":%.1f,\"ready_ms\":%.1f,\"config_cached\":%d}",
+                    g_boot.first_commit_us / 1000.0, g_boot.ready_us / 1000.0, g_config_cache_hit);
+    if (g_cfg.latency_stats) {
+        metrics_appendf(buf, buf_sz, &off, ",\"latency\":{");
+        if (off < (int)buf_sz - 1) {
+            off += latency_format(buf + off, buf_sz - (size_t)off, 1);
+            if (off > (int)buf_sz - 1) off = (int)buf_sz - 1;
         }
+        metrics_appendf(buf, buf_sz, &off, "}");
     }
+    sys_group_sched_t sampler[SYS_GROUP_COUNT];
+    pthread_mutex_lock(&g_sample_lock);
+    memcpy(sampler, g_sample_stats, sizeof(sampler));
+    pthread_mutex_unlock(&g_sample_lock);
+    metrics_appendf(buf, buf_sz, &off, ",\"sampler\":{");
+    for (int g = 0; g < SYS_GROUP_COUNT; g++) {
+        const sys_group_sched_t *s = &sampler[g];
+        metrics_appendf(buf, buf_sz, &off, "%s\"%s\":{\"period_ms\":%u,\"reads\":%u,\"avg_us\":%llu,\"max_us\":%u}",
+                        g ? "," : "", g_sys_group_names[g], s->period_ms, s->reads,
+                        s->reads ? (unsigned long long)(s->cost_us / s->reads) : 0ull, s->max_us);
+    }
+    metrics_appendf(buf, buf_sz, &off, "}");
+    metrics_appendf(buf, buf_sz, &off, ",\"values\":[");
+    for (int i = 0; i < g_udp_channels; i++) {
+        metrics_appendf(buf, buf_sz, &off, "%s%.4g", i ? "," : "", udp_values[i]);
+    }
+    metrics_appendf(buf, buf_sz, &off, "],\"system\":[");
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        metrics_appendf(buf, buf_sz, &off, "%s%.4g", i ? "," : "", system_values[i]);
+    }
+    metrics_appendf(buf, buf_sz, &off, "]}}");
+    return off;
 }
 
-static void handle_sigint(int sig)
-{
-    (void)sig;
-    stop_requested = 1;
-}
-
-static void handle_sighup(int sig)
+// Answers every queued request; a truncated snapshot is never sent
+static void metrics_poll(void)
 {
-    (void)sig;
-    reload_requested = 1;
+    if (g_metrics_sock < 0) return;
+    for (;;) {
+        char req[64];
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t r = recvfrom(g_metrics_sock, req, sizeof(req) - 1, MSG_DONTWAIT, (struct sockaddr *)&from, &from_len);
+        if (r < 0) return;
+        req[r] = '\0';
+        char buf[METRICS_REPLY_MAX];
+        int len = strstr(req, "\"hitch\"") ? hitch_format(buf, sizeof(buf)) : metrics_format(buf, sizeof(buf));
+        if (len >= (int)sizeof(buf) - 1) {
+            fprintf(stderr, "metrics: snapshot exceeds %d bytes, dropped\n", METRICS_REPLY_MAX);
+            continue;
+        }
+        if (sendto(g_metrics_sock, buf, (size_t)len, MSG_DONTWAIT, (struct sockaddr *)&from, from_len) < 0) {
+            fprintf(stderr, "metrics: reply failed: %s\n", strerror(errno));
+        }
+    }
 }
 
 static void reload_config_runtime(void)
 {
     printf("Reloading config...\n");
+    asset_updates_commit();  // the reloaded config has the last word
 
-    destroy_assets();
-    load_config();
+    asset_t *staged = calloc((size_t)g_asset_capacity, sizeof(*staged));
+    if (!staged) {
+        fprintf(stderr, "Config reload skipped: out of memory\n");
+        return;
+    }
+    int staged_count = 0;
+    sys_slot_map_t old_slots[SYSTEM_VALUE_COUNT];
+    memcpy(old_slots, g_cfg.system_slots, sizeof(old_slots));
+    load_config(staged, &staged_count);
 
     idle_cap_ms = clamp_int(g_cfg.idle_ms, 10, 1000);
     idle_ms_applied = idle_cap_ms;
+    for (int i = 0; i < SYSTEM_VALUE_COUNT; i++) {
+        if (memcmp(&old_slots[i], &g_cfg.system_slots[i], sizeof(old_slots[i])) == 0) continue;
+        // A remapped slot drops the old source's reading and history
+        memset(&g_system_history[i], 0, sizeof(g_system_history[i]));
+        system_values[i] = 0.0;
+        g_value_dirty |= 1ull << (UDP_VALUE_COUNT + i);
+    }
+    system_texts_label();
+    system_sampler_reconfigure();
+
+    if (staged_ids_unique(staged, staged_count)) {
+        int touched = reconcile_assets(staged, staged_count);
+        printf("Config reload: %d asset(s) changed\n", touched);
+    } else {
+        destroy_assets();
+        memcpy(assets, staged, sizeof(*assets) * (size_t)staged_count);
+        asset_count = staged_count;
+        create_assets();
+        g_region_replan = 1;
+    }
+    g_snapshot_dirty = 1;
+    free(staged);
 
-    create_assets();
     refresh_system_values();
     update_assets_from_channels();
     pending_channel_flush = false;
@@ -2042,6 +9658,9 @@ static void reload_config_runtime(void)
             lv_obj_add_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
         }
     }
+    idle_apply_config();
+    metrics_apply_config();
+    heap_sample(monotonic_ms64(), 1);
 
     fps_start_ms = monotonic_ms64();
     fps_frames = 0;
@@ -2049,6 +9668,7 @@ static void reload_config_runtime(void)
 
 static void cleanup_resources(void)
 {
+    system_sampler_stop();
     destroy_assets();
 
     if (stats_timer) {
@@ -2056,17 +9676,70 @@ static void cleanup_resources(void)
         stats_timer = NULL;
     }
 
-    // Tear down OSD region cleanly
-    MI_RGN_DetachFromChn(hRgnHandle, &stVpeChnPort);
-    MI_RGN_Destroy(hRgnHandle);
+    // Tear down OSD regions cleanly
+    for (int i = 0; i < g_region_count; i++) {
+        region_destroy(&g_regions[i]);
+    }
+    g_region_count = 0;
 
+    rx_thread_stop();
     if (udp_sock >= 0) {
         close(udp_sock);
         udp_sock = -1;
     }
+    shm_transport_close();
+    frame_timer_close();
+    metrics_close();
+
+    render_buffer_free(buf1, g_render_buf_size, 0);
+    render_buffer_free(buf2, g_render_buf_size, 1);
+#if OSD_GFX_ENABLED
+    if (g_gfx_active) MI_GFX_Close();
+#endif
+    free(g_palette_lut);
+    free(g_palette_lut_valid);
+    free(g_palette_keys);
+    free(g_flush_row);
+    asset_pool_free();
+}
+
+// Writes one stats line; untouched lines keep their label and cached pixels
+static void stats_line_set(int *n, const char *text)
+{
+    int i = *n;
+    if (i >= STATS_LINE_MAX || !stats_label) return;
+    if (!g_stats_lines[i]) {
+        g_stats_lines[i] = lv_label_create(stats_label);
+        if (!g_stats_lines[i]) return;
+        g_stats_text[i][0] = '\0';
+        lv_label_set_text(g_stats_lines[i], "");
+    }
+    if (i >= g_stats_shown) lv_obj_clear_flag(g_stats_lines[i], LV_OBJ_FLAG_HIDDEN);
+    if (strcmp(g_stats_text[i], text) != 0) {
+        snprintf(g_stats_text[i], sizeof(g_stats_text[i]), "%s", text);
+        lv_label_set_text(g_stats_lines[i], g_stats_text[i]);
+    }
+    *n = i + 1;
+}
+
+static void stats_lines_finish(int n)
+{
+    for (int i = n; i < g_stats_shown; i++) {
+        if (g_stats_lines[i]) lv_obj_add_flag(g_stats_lines[i], LV_OBJ_FLAG_HIDDEN);
+    }
+    g_stats_shown = n;
+}
 
-    free(buf1);
-    free(buf2);
+static void stats_format_value(char *out, size_t sz, int have, float v)
+{
+    if (!have) {
+        snprintf(out, sz, "-");
+        return;
+    }
+    int whole = (int)v;
+    int frac = (int)((v - whole) * 100.0);
+    if (frac < 0) frac = -frac;
+    lv_snprintf(out, sz, "%d.%02d", whole, frac);
 }
 
 static void stats_timer_cb(lv_timer_t *timer)
@@ -2082,6 +9755,13 @@ static void stats_timer_cb(lv_timer_t *timer)
         fps_start_ms = now;
     }
 
+    if (!stats_label) return;
+    if (!g_cfg.show_stats) {
+        lv_obj_add_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+    lv_obj_clear_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
+
     int primary_w = 0;
     int primary_h = 0;
     int active_assets = 0;
@@ -2093,115 +9773,348 @@ static void stats_timer_cb(lv_timer_t *timer)
             primary_h = lv_obj_get_height(assets[i].obj);
         }
     }
-    char buf[1024];
-    int disp_w = lv_disp_get_hor_res(NULL);
-    int disp_h = lv_disp_get_ver_res(NULL);
-    int off = 0;
-    off += lv_snprintf(buf + off, sizeof(buf) - off,
-                       "OSD %dx%d (disp %dx%d)\n"
-                       "Assets %d/%d | primary %d,%d\n"
-                       "FPS %u | work %ums | loop %ums | idle %dms",
-                       osd_width, osd_height,
-                       disp_w, disp_h,
-                       active_assets, asset_count, primary_w, primary_h,
-                       fps_value, last_frame_ms, last_loop_ms, idle_ms_applied);
-
-    if (g_cfg.udp_stats && off < (int)sizeof(buf) - 32) {
+    char line[STATS_LINE_LEN];
+    int n = 0;
+    lv_snprintf(line, sizeof(line), "OSD %dx%d (disp %dx%d)", osd_width, osd_height,
+                lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
+    stats_line_set(&n, line);
+    lv_snprintf(line, sizeof(line), "Assets %d/%d | primary %d,%d", active_assets, asset_count, primary_w, primary_h);
+    stats_line_set(&n, line);
+    lv_snprintf(line, sizeof(line), "FPS %u | work %ums | loop %ums | idle %dms",
+                fps_value, last_frame_ms, last_loop_ms, idle_ms_applied);
+    stats_line_set(&n, line);
+
+    if (g_gov.active) {
+        lv_snprintf(line, sizeof(line), "governor: push %dms, %d asset(s) shed",
+                    g_cfg.governor_push_ms, __builtin_popcountll(g_gov.shed));
+        stats_line_set(&n, line);
+    }
+
+    heap_sample(now, 0);
+    lv_snprintf(line, sizeof(line), "heap %u/%uK peak %uK | big %uK min %uK | frag %u%% | fail %u",
+                g_heap.used / 1024, g_heap.total / 1024, g_heap.peak_used / 1024, g_heap.biggest_free / 1024,
+                g_heap.min_biggest_free / 1024, g_heap.frag_pct, g_heap.assert_fails);
+    stats_line_set(&n, line);
+
+    float kb_min = 0.0f, kb_max = 0.0f, kb_jit = 0.0f;
+    int kb_slot = system_slot_of(SYS_SRC_ENC_KBPS);
+    const metric_history_t *kb_hist = kb_slot >= 0 ? &g_system_history[kb_slot] : NULL;
+    if (kb_hist && history_stats(kb_hist, &kb_min, &kb_max, &kb_jit)) {
+        lv_snprintf(line, sizeof(line), "kbps %d..%d jitter %d (%d samples)",
+                    (int)kb_min, (int)kb_max, (int)kb_jit, kb_hist->count);
+        stats_line_set(&n, line);
+    }
+
+    if (g_cfg.udp_stats) {
+        int off = lv_snprintf(line, sizeof(line), "udp ");
+        udp_stats_format(line + off, sizeof(line) - off, 0);
+        stats_line_set(&n, line);
+    }
+
+    if (g_cfg.flush_compare) {
+        snprintf(line, sizeof(line), "flush px conv %llu zero %llu skip %llu",
+                 (unsigned long long)g_flush_counters.converted,
+                 (unsigned long long)g_flush_counters.zeroed,
+                 (unsigned long long)g_flush_counters.skipped);
+        stats_line_set(&n, line);
+    }
+
+    if (g_cfg.latency_stats) {
+        int off = lv_snprintf(line, sizeof(line), "lat us p50/p99/max: ");
+        latency_format(line + off, sizeof(line) - off, 0);
+        stats_line_set(&n, line);
+    }
+
+#if OSD_PROFILE_ENABLED
+    if (g_cfg.profile_stats) {
+        // One line per stage so a single changed timing repaints one row
+        char stages[512];
+        prof_format(stages, sizeof(stages), "\n");
+        stats_line_set(&n, "us min/avg/max:");
+        for (char *p = stages; *p && n < STATS_LINE_MAX;) {
+            char *nl = strchr(p, '\n');
+            size_t len = nl ? (size_t)(nl - p) : strlen(p);
+            lv_snprintf(line, sizeof(line), " %.*s", (int)len, p);
+            stats_line_set(&n, line);
+            p += len + (nl ? 1 : 0);
+        }
+    }
+#endif
+
+    if (g_cfg.udp_stats) {
         int rows = UDP_VALUE_COUNT > SYSTEM_VALUE_COUNT ? UDP_VALUE_COUNT : SYSTEM_VALUE_COUNT;
-        off += lv_snprintf(buf + off, sizeof(buf) - off, "\nValues (v=UDP s=SYS):");
-        for (int i = 0; i < rows && off < (int)sizeof(buf) - 24; i++) {
+        stats_line_set(&n, "Values (v=UDP s=SYS):");
+        for (int i = 0; i < rows; i++) {
             char udp_val[24];
             char sys_val[24];
-            if (i < UDP_VALUE_COUNT) {
-                int whole = (int)udp_values[i];
-                int frac = (int)((udp_values[i] - whole) * 100.0);
-                if (frac < 0) frac = -frac;
-                lv_snprintf(udp_val, sizeof(udp_val), "%d.%02d", whole, frac);
-            } else {
-                lv_snprintf(udp_val, sizeof(udp_val), "-");
-            }
-
-            if (i < SYSTEM_VALUE_COUNT) {
-                int whole = (int)system_values[i];
-                int frac = (int)((system_values[i] - whole) * 100.0);
-                if (frac < 0) frac = -frac;
-                lv_snprintf(sys_val, sizeof(sys_val), "%d.%02d", whole, frac);
-            } else {
-                lv_snprintf(sys_val, sizeof(sys_val), "-");
-            }
-
-            off += lv_snprintf(buf + off, sizeof(buf) - off, "\n %d v=%s | s=%s", i, udp_val, sys_val);
+            stats_format_value(udp_val, sizeof(udp_val), i < UDP_VALUE_COUNT, i < UDP_VALUE_COUNT ? udp_values[i] : 0.0f);
+            stats_format_value(sys_val, sizeof(sys_val), i < SYSTEM_VALUE_COUNT,
+                               i < SYSTEM_VALUE_COUNT ? system_values[i] : 0.0f);
+            lv_snprintf(line, sizeof(line), " %d v=%s | s=%s", i, udp_val, sys_val);
+            stats_line_set(&n, line);
         }
 
         rows = UDP_TEXT_COUNT > SYSTEM_TEXT_COUNT ? UDP_TEXT_COUNT : SYSTEM_TEXT_COUNT;
-        off += lv_snprintf(buf + off, sizeof(buf) - off, "\nTexts (t=UDP s=SYS):");
-        for (int i = 0; i < rows && off < (int)sizeof(buf) - 20; i++) {
-            const char *udp_t = (i < UDP_TEXT_COUNT && udp_texts[i][0]) ? udp_texts[i] : "-";
+        stats_line_set(&n, "Texts (t=UDP s=SYS):");
+        for (int i = 0; i < rows; i++) {
+            const char *udp_t = (i < UDP_TEXT_COUNT && udp_texts[i].len) ? udp_texts[i].text : "-";
             const char *sys_t = (i < SYSTEM_TEXT_COUNT && system_texts[i][0]) ? system_texts[i] : "-";
-            off += lv_snprintf(buf + off, sizeof(buf) - off, "\n %d t=%s | s=%s", i, udp_t, sys_t);
+            lv_snprintf(line, sizeof(line), " %d t=%s | s=%s", i, udp_t, sys_t);
+            stats_line_set(&n, line);
         }
     }
 
-    if (stats_label) {
-        lv_label_set_text(stats_label, buf);
-        if (g_cfg.show_stats) {
-            lv_obj_clear_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
+    stats_lines_finish(n);
+}
+
+
+
+// -------------------------
+// Load governor
+// -------------------------
+/*
+ * With governor enabled every new system sample is checked against the CPU
+ * load and encoder FPS marks. Crossing a high mark engages the governor at
+ * once: channel pushes drop to governor_push_ms, the stats widget refreshes
+ * every governor_stats_ms, and assets marked noncritical are hidden and stop
+ * sampling. It releases only after both inputs have stayed below their
+ * release marks for governor_hold_ms, so a load hovering around a threshold
+ * does not make the OSD flap.
+ */
+static void asset_set_shed(asset_t *asset, int hide)
+{
+    lv_obj_t *root = asset->container_obj ? asset->container_obj : asset->obj;
+    lv_obj_t *extra = asset->container_obj ? NULL : asset->label_obj;
+    lv_obj_t *objs[2] = {root, extra};
+    for (int k = 0; k < 2; k++) {
+        if (!objs[k] || lv_obj_has_flag(objs[k], LV_OBJ_FLAG_HIDDEN) == (hide != 0)) continue;
+        if (hide) {
+            lv_obj_add_flag(objs[k], LV_OBJ_FLAG_HIDDEN);
         } else {
-            lv_obj_add_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_clear_flag(objs[k], LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+// Re-applied on every sample because asset_updates may rebuild a shed visual
+static void governor_enforce(void)
+{
+    uint64_t want = 0;
+    int n = asset_count < MAX_ASSETS ? asset_count : MAX_ASSETS;
+    if (g_gov.active) {
+        for (int i = 0; i < n; i++) {
+            if (assets[i].cfg.enabled && assets[i].cfg.noncritical) want |= 1ull << i;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        uint64_t bit = 1ull << i;
+        if (want & bit) {
+            asset_set_shed(&assets[i], 1);
+        } else if (g_gov.shed & bit) {
+            asset_set_shed(&assets[i], assets[i].rule_hidden);
+            mark_asset_refresh(&assets[i]);  // catch up on what changed while hidden
         }
     }
+    if (want != g_gov.shed) g_region_replan = 1;
+    g_gov.shed = want;
+}
+
+static void governor_set(int active)
+{
+    if (g_gov.active != active) {
+        printf("Governor %s (cpu %d%%, encoder %d fps)\n", active ? "engaged" : "released",
+               (int)g_sys_cpu_load, (int)g_sys_enc_fps);
+        g_gov.active = active;
+        g_gov.calm_since_ms = 0;
+        if (stats_timer) lv_timer_set_period(stats_timer, active ? (uint32_t)g_cfg.governor_stats_ms : STATS_REFRESH_MS);
+    }
+    governor_enforce();
+}
+
+static void governor_update(uint64_t now)
+{
+    if (!g_cfg.governor) {
+        if (g_gov.active) governor_set(0);
+        return;
+    }
+    double cpu = g_sys_cpu_load;
+    double fps = g_sys_enc_fps;
+    // An encoder FPS of 0 means no reading, not a stall
+    int fps_short = g_cfg.governor_fps_min > 0 && fps > 0.0 && fps < (double)g_cfg.governor_fps_min;
+    if (cpu >= (double)g_cfg.governor_cpu_high || fps_short) {
+        governor_set(1);
+        return;
+    }
+    if (!g_gov.active) return;
+    if (cpu >= (double)g_cfg.governor_cpu_low) {
+        g_gov.calm_since_ms = 0;
+    } else if (g_gov.calm_since_ms == 0) {
+        g_gov.calm_since_ms = now;
+    }
+    if (g_gov.calm_since_ms != 0 && now - g_gov.calm_since_ms >= (uint64_t)g_cfg.governor_hold_ms) {
+        governor_set(0);
+        return;
+    }
+    governor_enforce();
+}
+
+static int push_interval_ms(void)
+{
+    return g_gov.active ? g_cfg.governor_push_ms : max_ms;
+}
+
+// One channel push: recompose the assets whose inputs changed
+static void push_channel_updates(void)
+{
+    uint32_t refr_before = g_refr_requests;
+    latency_push_begin();
+    PROF_BEGIN(prof_t0);
+    asset_updates_commit();
+    update_assets_from_channels();
+    PROF_END(PROF_UPDATE, prof_t0);
+    latency_push_end(refr_before);
 }
 
+// Replans regions if needed, lets LVGL render (force refreshes right away
+// instead of waiting for the refresh timer) and commits a dirty canvas
+static void render_and_commit(int force)
+{
+    if (g_region_auto && g_region_replan) {
+        g_region_replan = 0;
+        region_replan();
+    }
+    static_layers_refresh();
+    PROF_BEGIN(prof_render_t0);
+    if (force) {
+        lv_refr_now(g_display);
+    } else {
+        lvgl_service(monotonic_ms64());
+    }
+    seg_sprites_reap();
+    if (!g_canvas_dirty) return;
+#if OSD_PROFILE_ENABLED
+    uint64_t handler_us = monotonic_us64() - prof_render_t0;
+    prof_add(PROF_RENDER, handler_us > g_prof_frame_flush_us ? handler_us - g_prof_frame_flush_us : 0, 0);
+    prof_add(PROF_FLUSH, g_prof_frame_flush_us, g_prof_frame_pixels);
+    g_prof_cur[PROF_FLUSH].flushes += (uint64_t)g_frame_flush_count;
+    g_prof_frame_flush_us = 0;
+    g_prof_frame_pixels = 0;
+#endif
+    PROF_BEGIN(prof_commit_t0);
+    uint64_t commit_t0 = monotonic_us64();
+    commit_canvas();
+    g_hitch_cur.commit_us += (uint32_t)(monotonic_us64() - commit_t0);
+    PROF_END(PROF_COMMIT, prof_commit_t0);
+    latency_commit();
+    g_canvas_dirty = 0;
+    g_frame_flush_count = 0;
+    if (g_region_auto && !region_plan_covers_visuals()) g_region_replan = 1;
+}
 
+// Lightweight stats in top-left: a column of per-line labels on one panel
+static void stats_panel_create(void)
+{
+    stats_label = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(stats_label);
+    lv_obj_clear_flag(stats_label, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(stats_label, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(stats_label, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_row(stats_label, 0, LV_PART_MAIN);
+    lv_obj_set_style_text_color(stats_label, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
+    lv_obj_set_style_text_opa(stats_label, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(stats_label, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(stats_label, LV_OPA_70, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(stats_label, 4, LV_PART_MAIN);
+    lv_obj_align(stats_label, LV_ALIGN_TOP_LEFT, to_canvas_x(4), to_canvas_y(4));
+    int stats_n = 0;
+    stats_line_set(&stats_n, "OSD stats");
+    stats_lines_finish(stats_n);
+    if (!g_cfg.show_stats) {
+        lv_obj_add_flag(stats_label, LV_OBJ_FLAG_HIDDEN);
+    } else if (g_region_auto) {
+        g_region_replan = 1;  // the first plan was made without the panel
+    }
+}
 
 // -------------------------
 // Main
 // -------------------------
 int main(void)
 {
-    load_config();
+    boot_phase(NULL);
+    if (asset_pool_init() != 0) {
+        fprintf(stderr, "Failed to allocate the asset/channel pool\n");
+        return 1;
+    }
+    reset_channels();
+    boot_phase("pool");
+    load_config(assets, &asset_count);
+    system_texts_label();
+    snapshot_restore();
+    boot_phase("config");
     compute_osd_geometry();
+    process_tuning_apply();
     struct sigaction sa;
     memset(&sa, 0, sizeof(sa));
     sa.sa_handler = handle_sigint;
     sigaction(SIGINT, &sa, NULL);
     sa.sa_handler = handle_sighup;
     sigaction(SIGHUP, &sa, NULL);
+#if OSD_PROFILE_ENABLED
+    sa.sa_handler = handle_sigusr1;
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
 
     udp_sock = setup_udp_socket();
+    metrics_apply_config();
+    if (g_cfg.shm_transport) shm_transport_init();
+    boot_phase("io");
 
     printf("Initializing OSD region...\n");
     mi_region_init();
+    boot_phase("region");
 
     printf("Initializing LVGL...\n");
     init_lvgl();
+    if (g_cfg.rx_thread) rx_thread_start();  // after init_lvgl so it inherits render_cpus
+    boot_phase("lvgl");
 
     // Transparent screen
     lv_obj_set_style_bg_opa(lv_scr_act(), LV_OPA_TRANSP, LV_PART_MAIN);
 
     create_assets();
+    if (g_region_auto) region_replan();
+    boot_phase("assets");
 
-    // Lightweight stats in top-left
-    stats_label = lv_label_create(lv_scr_act());
-    lv_obj_set_style_text_color(stats_label, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
-    lv_obj_set_style_text_opa(stats_label, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_bg_color(stats_label, lv_color_hex(0x000000), LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(stats_label, LV_OPA_70, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(stats_label, 4, LV_PART_MAIN);
-    lv_obj_align(stats_label, LV_ALIGN_TOP_LEFT, to_canvas_x(4), to_canvas_y(4));
-    lv_label_set_text(stats_label, "OSD stats");
+    // First frame with whatever the channels hold; the rest of startup waits for it
+    shm_poll();
+    update_assets_from_channels();
+    render_and_commit(1);
+    boot_phase("first frame");
+    g_boot.first_commit_us = (uint32_t)(monotonic_us64() - g_boot.start_us);
+
+    stats_panel_create();
+    prefault_render_memory();
+    heap_sample(monotonic_ms64(), 1);
 
     // Timers (throttled to ~10 Hz)
-    stats_timer = lv_timer_create(stats_timer_cb, 250, NULL);
+    stats_timer = lv_timer_create(stats_timer_cb, STATS_REFRESH_MS, NULL);
+    idle_init();
+    idle_apply_config();
 
-    refresh_system_values();
-    update_assets_from_channels();
-    pending_channel_flush = false;
+    system_sampler_start();
+    pending_channel_flush = refresh_system_values();
     last_channel_push_ms = monotonic_ms64();
+    boot_phase("deferred");
+    g_boot.ready_us = (uint32_t)(monotonic_us64() - g_boot.start_us);
+    boot_report();
 
     idle_cap_ms = clamp_int(g_cfg.idle_ms, 10, 1000);
     idle_ms_applied = idle_cap_ms;
 
+    uint64_t graph_next_ms = 0;
+    uint64_t ease_next_ms = 0;
+
     // Main loop paced by a simple UDP poll cap
     while (!stop_requested) {
         if (reload_requested) {
@@ -2209,62 +10122,152 @@ int main(void)
             reload_config_runtime();
         }
 
-        uint64_t loop_start = monotonic_ms64();
+        uint64_t loop_start_us = monotonic_us64();
+        uint64_t loop_start = loop_start_us / 1000;
 
-        if (refresh_system_values()) pending_channel_flush = true;
+        bool sys_changed = refresh_system_values();
+        g_hitch_cur.sys_us += (uint32_t)(monotonic_us64() - loop_start_us);
+        if (sys_changed) {
+            pending_channel_flush = true;
+            governor_update(loop_start);
+        }
+        frame_timer_update();
 
         uint64_t now_for_wait = monotonic_ms64();
-        int wait_ms = idle_cap_ms;
-        if (pending_channel_flush && last_channel_push_ms != 0) {
-            uint64_t earliest_push = last_channel_push_ms + (uint64_t)max_ms;
-            if (earliest_push > now_for_wait) {
-                uint64_t remaining = earliest_push - now_for_wait;
-                int until_push = clamp_int((int)remaining, 0, wait_ms);
-                wait_ms = until_push;
-            }
+        int wait_ms = idle_wait_base();
+        if (g_frame_timer_fd < 0 && pending_channel_flush && last_channel_push_ms != 0) {
+            wait_ms = cap_wait(wait_ms, last_channel_push_ms + (uint64_t)push_interval_ms(), now_for_wait);
+        }
+        wait_ms = cap_wait(wait_ms, graph_next_ms, now_for_wait);
+        wait_ms = cap_wait(wait_ms, ease_next_ms, now_for_wait);
+        if (g_asset_deferred) wait_ms = cap_wait(wait_ms, g_asset_deferred_ms, now_for_wait);
+        if (g_cfg.deep_idle) {
+            wait_ms = cap_wait(wait_ms, g_lvgl_next_ms, now_for_wait);
+            wait_ms = cap_wait(wait_ms, system_refresh_deadline(), now_for_wait);
         }
+        wait_ms = cap_wait(wait_ms, snapshot_deadline(), now_for_wait);
+        if (g_region_auto && g_region_replan) wait_ms = 0;
 
-        struct pollfd pfd = {0};
+        struct pollfd pfds[5];
         nfds_t nfds = 0;
-        if (udp_sock >= 0) {
-            pfd.fd = udp_sock;
-            pfd.events = POLLIN;
-            nfds = 1;
-        }
-
-        uint64_t poll_start = monotonic_ms64();
-        int ret = poll(nfds ? &pfd : NULL, nfds, wait_ms);
-        uint64_t poll_spent = monotonic_ms64() - poll_start;
-        idle_ms_applied = clamp_int((int)poll_spent, 0, idle_cap_ms);
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            if (poll_udp()) {
+        int udp_idx = -1;
+        int metrics_idx = -1;
+        int shm_idx = -1;
+        int sample_idx = -1;
+        int frame_idx = -1;
+        if (g_rx_running) {
+            pfds[nfds].fd = g_rx_wake[0];
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            udp_idx = (int)nfds++;
+        } else if (udp_sock >= 0) {
+            pfds[nfds].fd = udp_sock;
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            udp_idx = (int)nfds++;
+        }
+        if (g_shm_wake_fd >= 0) {
+            pfds[nfds].fd = g_shm_wake_fd;
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            shm_idx = (int)nfds++;
+        }
+        if (g_sample_wake[0] >= 0) {
+            pfds[nfds].fd = g_sample_wake[0];
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            sample_idx = (int)nfds++;
+        }
+        if (g_frame_timer_fd >= 0) {
+            pfds[nfds].fd = g_frame_timer_fd;
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            frame_idx = (int)nfds++;
+        }
+        if (g_metrics_sock >= 0) {
+            pfds[nfds].fd = g_metrics_sock;
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            metrics_idx = (int)nfds++;
+        }
+
+        if (nfds == 0 && wait_ms < 0) wait_ms = idle_cap_ms;
+
+        uint64_t poll_start_us = monotonic_us64();
+        int ret = poll(nfds ? pfds : NULL, nfds, wait_ms);
+        uint64_t poll_end_us = monotonic_us64();
+        g_hitch_cur.poll_us = (uint32_t)(poll_end_us - poll_start_us);
+        uint64_t poll_spent = g_hitch_cur.poll_us / 1000;
+        idle_ms_applied = clamp_int((int)poll_spent, 0, g_cfg.deep_idle ? 60000 : idle_cap_ms);
+        if (ret > 0 && udp_idx >= 0 && (pfds[udp_idx].revents & POLLIN)) {
+            if (g_rx_running ? rx_ring_drain() : poll_udp()) {
+                pending_channel_flush = true;
+            }
+        }
+        if (g_shm && (g_shm_wake_fd < 0 || (ret > 0 && shm_idx >= 0 && (pfds[shm_idx].revents & POLLIN)))) {
+            shm_drain_wake();
+            if (shm_poll()) pending_channel_flush = true;
+        }
+        if (ret > 0 && sample_idx >= 0 && (pfds[sample_idx].revents & POLLIN)) {
+            system_sampler_drain_wake();
+            uint64_t sys_t0 = monotonic_us64();
+            sys_changed = refresh_system_values();
+            g_hitch_cur.sys_us += (uint32_t)(monotonic_us64() - sys_t0);
+            if (sys_changed) {
                 pending_channel_flush = true;
+                governor_update(monotonic_ms64());
             }
         }
 
+        if (ret > 0 && metrics_idx >= 0 && (pfds[metrics_idx].revents & POLLIN)) metrics_poll();
+
+        int frame_tick = ret > 0 && frame_idx >= 0 && (pfds[frame_idx].revents & POLLIN) && frame_timer_consume();
+
         uint64_t now = monotonic_ms64();
+        if (g_asset_deferred && now >= g_asset_deferred_ms) pending_channel_flush = true;
         if (pending_channel_flush) {
-            if (last_channel_push_ms == 0 || now - last_channel_push_ms >= (uint64_t)max_ms) {
-                update_assets_from_channels();
+            int interval_due = last_channel_push_ms == 0 || now - last_channel_push_ms >= (uint64_t)push_interval_ms();
+            // frame_sync pushes on the video tick; the governor thins those ticks out too
+            int push_due = g_frame_timer_fd >= 0 ? frame_tick && (!g_gov.active || interval_due) : interval_due;
+            if (!push_due) push_due = channel_push_urgent();
+            if (push_due) {
+                rx_ring_drain();  // fold in whatever arrived while the last frame rendered
+                push_channel_updates();
                 pending_channel_flush = false;
                 last_channel_push_ms = now;
             }
         }
 
-        uint64_t frame_start = monotonic_ms64();
-        lv_timer_handler();
-        if (g_canvas_dirty) {
-            MI_RGN_UpdateCanvas(hRgnHandle);
-            g_canvas_dirty = 0;
-            g_canvas_info_valid = 0;
-            memset(&g_cached_canvas_info, 0, sizeof(g_cached_canvas_info));
+        // with frame_sync bars step on the video tick, which also wakes the loop
+        if (g_frame_timer_fd < 0) {
+            ease_next_ms = bars_ease_tick(now);
+        } else {
+            ease_next_ms = 0;
+            if (frame_tick) bars_ease_tick(now);
         }
-        fps_frames++;
-        last_frame_ms = (uint32_t)(monotonic_ms64() - frame_start);
+        graph_next_ms = graphs_tick(now);
+        heap_sample(now, 0);
+        snapshot_tick(now);
 
-        last_loop_ms = (uint32_t)(monotonic_ms64() - loop_start);
+        uint64_t frame_start_us = monotonic_us64();
+        render_and_commit(0);
+        fps_frames++;
+        uint64_t loop_end_us = monotonic_us64();
+        g_hitch_cur.frame_us = (uint32_t)(loop_end_us - frame_start_us);
+        last_frame_ms = g_hitch_cur.frame_us / 1000;
+
+        last_loop_ms = (uint32_t)((loop_end_us - loop_start_us) / 1000);
+        hitch_record(loop_start_us, loop_end_us);
+#if OSD_PROFILE_ENABLED
+        prof_tick(monotonic_us64());
+        if (g_prof_dump_requested) {
+            g_prof_dump_requested = 0;
+            prof_dump();
+        }
+#endif
     }
 
+    snapshot_flush();
     cleanup_resources();
 
     return 0;
@@ -0,0 +1,19 @@
+/*
+ * osd_fonts.h - subsetted low-bpp label fonts generated by `make fonts`
+ * (lv_font_conv, Montserrat, printable ASCII plus the non-ASCII glyphs the
+ * configs use). Built into the OSD with FONTS=1; assets pick one with
+ * font_size and font_bpp.
+ */
+#ifndef OSD_FONTS_H
+#define OSD_FONTS_H
+
+#include "lvgl/lvgl.h"
+
+LV_FONT_DECLARE(osd_font_12_1)
+LV_FONT_DECLARE(osd_font_14_1)
+LV_FONT_DECLARE(osd_font_16_1)
+LV_FONT_DECLARE(osd_font_12_2)
+LV_FONT_DECLARE(osd_font_14_2)
+LV_FONT_DECLARE(osd_font_16_2)
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * osd_image.h - pre-converted icon blobs for image assets. Layout shared by
+ * main.c and the img2osd converter (tools/img2osd.c).
+ *
+ * A blob is a 16-byte header followed by `frames` images of width x height
+ * ARGB4444 pixels, little-endian, AAAA RRRR GGGG BBBB per 16-bit word. That is
+ * the canvas format the OSD flushes into, so the renderer maps the file and
+ * copies rows straight out of it. Frames are stored back to back; the OSD picks
+ * one per value.
+ */
+#ifndef OSD_IMAGE_H
+#define OSD_IMAGE_H
+
+#include <stdint.h>
+
+#define OSD_IMAGE_MAGIC     0x4D494257u /* "WBIM" */
+#define OSD_IMAGE_VERSION   1
+#define OSD_IMAGE_ARGB4444  0
+#define OSD_IMAGE_DIM_MAX   1024
+#define OSD_IMAGE_FRAMES_MAX 64
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t format;         /* OSD_IMAGE_ARGB4444 */
+    uint16_t width;
+    uint16_t height;
+    uint16_t frames;
+    uint32_t reserved;
+} osd_image_header_t;
+
+/* Bytes of pixel data following the header */
+static inline uint32_t osd_image_data_size(const osd_image_header_t *h)
+{
+    return (uint32_t)h->width * h->height * h->frames * 2u;
+}
+
+#endif
@@ -39,40 +39,71 @@
  *       - null (ignored)
  *       - empty (i=) => "" (clear text slot)
  *
+ *   --binary             send the compact binary frame (CONTRACT.md) instead of JSON
+ *   --shm                write slots into the OSD's shared-memory segment (osd_shm.h) instead of UDP
+ *
  * Missing @ini_key handling (send & watch):
  *   - missing key => null (ignored) (script-friendly)
  *
  * Watch mode:
  *   - Poll ini file every --interval ms (default 64)
+ *   - Polls run on an absolute timerfd schedule; overruns are reported
+ *   - --inotify: block until an ini file changes instead (control sources still
+ *     refresh every --interval ms); --min-spacing <ms> bounds the send rate
+ *   - --keepalive <ms>: resend the full state when nothing changed for <ms>
+ *   - --exec <cmd>: keys streamed as key=value lines by one long-lived child
  *   - Sends initial baseline for all watched indices
- *   - On change: sends only changed indices (positional arrays with null padding)
+ *   - On change: sends only changed indices (positional arrays with null padding,
+ *     or the binary masks); --full-every <ms> forces a periodic full state
  *   - If ini key disappears => null (ignored)
  *   - If ini key becomes empty (key=) => "" (clear)
+ *   - --values "i=@key|op|..." transforms a numeric slot before change detection:
+ *     rate (per second), scale:<k>, offset:<k>, clamp:<lo>:<hi>, then
+ *     deadband:<d> (sent only once it moved at least d from the last send)
  *
  * Verbose:
  *   - --verbose / -v prints details about what is being sent and why.
  *
+ * Record / replay:
+ *   - record --out <file> logs received datagrams with monotonic gaps and source address
+ *   - replay --in <file> re-sends them at original, --speed scaled or --max rate
+ *
  * Build:
  *   gcc -O2 -Wall -Wextra -o waybeam waybeam.c
  */
 
+#define _GNU_SOURCE  /* sendmmsg */
 #include <arpa/inet.h>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <dirent.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <sys/wait.h>
+#include <net/if.h>
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/nl80211.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "osd_shm.h"
+
 #define MAX_PAYLOAD      1280
 #define BUILD_BUF        1900
 
@@ -81,21 +112,49 @@
 #define INI_MAX_KV       512
 #define INI_KEY_MAX      64
 #define INI_VAL_MAX      256
+#define INI_HASH_SLOTS   1024   /* open-addressing index, power of two > 2 * INI_MAX_KV */
 
 #define MAX_INI_PATHS    32
 #define DEFAULT_DEST_IP  "127.0.0.1"
+#define MAX_DESTS        8
 #define DEFAULT_PORT     7777
 #define DEFAULT_INTERVAL 64
 
 typedef struct {
     char key[INI_KEY_MAX];
     char val[INI_VAL_MAX];
+    const char *ext;    /* value inside the caller's file buffer (ini_parse_buffer), NULL = val[] */
+    uint32_t hash;
+    uint32_t epoch;     /* parse pass that last set this key */
 } IniKV;
 
+/*
+ * Hashes of the @keys a watch actually references. A filtered parse interns
+ * only these, so a large sidecar file costs a few kv[] entries instead of one
+ * per line. `all` = too many to track, keep everything.
+ */
+#define INI_FILTER_MAX 64
+
+typedef struct {
+    uint32_t hash[INI_FILTER_MAX];
+    int count;
+    int all;
+} IniFilter;
+
+/*
+ * Keys are interned once into kv[] and found through a linear-probing hash
+ * index. Re-parsing the same file bumps `epoch` and overwrites values in
+ * place, so slots stay put; keys not seen in the current epoch read as
+ * missing. `gen` changes whenever a lookup could resolve differently than
+ * before (new key, reset, compaction), which is what IniRef caches key on.
+ */
 typedef struct {
     IniKV kv[INI_MAX_KV];
+    uint16_t index[INI_HASH_SLOTS];  /* kv position + 1, 0 = empty */
     int count;
     int loaded;
+    uint32_t epoch;
+    uint32_t gen;
 } IniStore;
 
 /* Values can be: absent (not included), null (ignored), number, or "" (clear-to-0 on backend) */
@@ -248,34 +307,124 @@ static char *xstrdup(const char *s)
 
 static void ini_init(IniStore *ini) { memset(ini, 0, sizeof(*ini)); }
 
-static int ini_set(IniStore *ini, const char *k, const char *v)
+/* Drop every key without touching kv[]; gen keeps counting so caches notice */
+static void ini_reset(IniStore *ini)
 {
-    if (!k || !*k) return 0;
+    ini->count = 0;
+    ini->loaded = 0;
+    memset(ini->index, 0, sizeof(ini->index));
+    ini->gen++;
+}
+
+/* Start a re-parse: keys the new pass does not set read as missing afterwards */
+static void ini_begin_parse(IniStore *ini)
+{
+    ini->epoch++;
+}
+
+/* FNV-1a over the truncated key, matching what kv[].key stores */
+static uint32_t ini_hash(const char *k)
+{
+    uint32_t h = 2166136261u;
+    for (int i = 0; k[i] && i < INI_KEY_MAX - 1; i++) {
+        h ^= (uint8_t)k[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Index slot holding k, or the empty slot where it would go */
+static unsigned ini_probe(const IniStore *ini, const char *k, uint32_t hash)
+{
+    unsigned slot = hash & (INI_HASH_SLOTS - 1);
+    for (;;) {
+        uint16_t e = ini->index[slot];
+        if (e == 0) return slot;
+        const IniKV *kv = &ini->kv[e - 1];
+        if (kv->hash == hash && !strncmp(kv->key, k, INI_KEY_MAX - 1)) return slot;
+        slot = (slot + 1) & (INI_HASH_SLOTS - 1);
+    }
+}
+
+/* kv position of k, or -1; ignores whether the key is live in this epoch */
+static int ini_find(const IniStore *ini, const char *k, uint32_t hash)
+{
+    uint16_t e = ini->index[ini_probe(ini, k, hash)];
+    return e ? e - 1 : -1;
+}
 
+/* Full table with keys from earlier passes: squeeze them out and re-index */
+static void ini_compact(IniStore *ini)
+{
+    int n = 0;
     for (int i = 0; i < ini->count; i++) {
-        if (!strcmp(ini->kv[i].key, k)) {
-            strncpy(ini->kv[i].val, v ? v : "", INI_VAL_MAX - 1);
-            ini->kv[i].val[INI_VAL_MAX - 1] = '\0';
-            return 1;
+        if (ini->kv[i].epoch != ini->epoch) continue;
+        if (n != i) ini->kv[n] = ini->kv[i];
+        n++;
+    }
+    ini->count = n;
+    memset(ini->index, 0, sizeof(ini->index));
+    for (int i = 0; i < n; i++) ini->index[ini_probe(ini, ini->kv[i].key, ini->kv[i].hash)] = (uint16_t)(i + 1);
+    ini->gen++;
+}
+
+static int ini_set_hashed(IniStore *ini, const char *k, uint32_t hash, const char *v)
+{
+    unsigned slot = ini_probe(ini, k, hash);
+    if (ini->index[slot] == 0) {
+        if (ini->count >= INI_MAX_KV) {
+            ini_compact(ini);
+            if (ini->count >= INI_MAX_KV) return 0;
+            slot = ini_probe(ini, k, hash);
         }
+        IniKV *kv = &ini->kv[ini->count];
+        strncpy(kv->key, k, INI_KEY_MAX - 1);
+        kv->key[INI_KEY_MAX - 1] = '\0';
+        kv->hash = hash;
+        ini->index[slot] = (uint16_t)(++ini->count);
+        ini->gen++;
     }
+    IniKV *kv = &ini->kv[ini->index[slot] - 1];
+    strncpy(kv->val, v ? v : "", INI_VAL_MAX - 1);
+    kv->val[INI_VAL_MAX - 1] = '\0';
+    kv->ext = NULL;
+    kv->epoch = ini->epoch;
+    return 1;
+}
 
-    if (ini->count >= INI_MAX_KV) return 0;
-    strncpy(ini->kv[ini->count].key, k, INI_KEY_MAX - 1);
-    ini->kv[ini->count].key[INI_KEY_MAX - 1] = '\0';
-    strncpy(ini->kv[ini->count].val, v ? v : "", INI_VAL_MAX - 1);
-    ini->kv[ini->count].val[INI_VAL_MAX - 1] = '\0';
-    ini->count++;
+/* Like ini_set_hashed, but the value stays in the caller's buffer (no copy) */
+static int ini_set_span(IniStore *ini, const char *k, uint32_t hash, const char *v)
+{
+    unsigned slot = ini_probe(ini, k, hash);
+    if (ini->index[slot] == 0) {
+        if (!ini_set_hashed(ini, k, hash, "")) return 0;
+        slot = ini_probe(ini, k, hash);
+    }
+    IniKV *kv = &ini->kv[ini->index[slot] - 1];
+    kv->ext = v;
+    kv->epoch = ini->epoch;
     return 1;
 }
 
+static int ini_set(IniStore *ini, const char *k, const char *v)
+{
+    if (!k || !*k) return 0;
+    return ini_set_hashed(ini, k, ini_hash(k), v);
+}
+
+/* Value at kv position pos if that key is live, else NULL */
+static const char *ini_value_at(const IniStore *ini, int pos)
+{
+    if (!ini->loaded || pos < 0 || pos >= ini->count) return NULL;
+    const IniKV *kv = &ini->kv[pos];
+    if (kv->epoch != ini->epoch) return NULL;
+    return kv->ext ? kv->ext : kv->val;
+}
+
 static const char *ini_get(const IniStore *ini, const char *k)
 {
     if (!ini || !ini->loaded || !k || !*k) return NULL;
-    for (int i = 0; i < ini->count; i++) {
-        if (!strcmp(ini->kv[i].key, k)) return ini->kv[i].val;
-    }
-    return NULL;
+    return ini_value_at(ini, ini_find(ini, k, ini_hash(k)));
 }
 
 static void strip_quotes_inplace(char *s)
@@ -314,6 +463,58 @@ static int ini_parse_stream(IniStore *ini, FILE *fp)
     return 1;
 }
 
+static void ini_filter_add(IniFilter *f, const char *rhs)
+{
+    if (!f || !rhs || rhs[0] != '@' || !rhs[1]) return;
+    uint32_t h = ini_hash(rhs + 1);
+    for (int i = 0; i < f->count; i++) if (f->hash[i] == h) return;
+    if (f->count >= INI_FILTER_MAX) {
+        f->all = 1;
+        return;
+    }
+    f->hash[f->count++] = h;
+}
+
+static int ini_filter_match(const IniFilter *f, uint32_t h)
+{
+    if (!f || f->all) return 1;
+    for (int i = 0; i < f->count; i++) if (f->hash[i] == h) return 1;
+    return 0;
+}
+
+/*
+ * Parses a whole file image in place: lines are split and trimmed inside buf
+ * and values are stored as pointers into it, so buf must stay untouched
+ * until the next parse into the same store. Only keys passing `want` (NULL =
+ * all) are interned.
+ */
+static int ini_parse_buffer(IniStore *ini, char *buf, const IniFilter *want)
+{
+    if (!ini || !buf) return 0;
+    ini->loaded = 1;
+
+    for (char *p = buf; p && *p;) {
+        char *nl = strchr(p, '\n');
+        if (nl) *nl = '\0';
+        char *t = trim(p);
+        p = nl ? nl + 1 : NULL;
+        if (!*t || *t == '#' || *t == ';' || *t == '[') continue;
+
+        char *eq = strchr(t, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        char *k = trim(t);
+        if (!*k) continue;
+        uint32_t h = ini_hash(k);
+        if (!ini_filter_match(want, h)) continue;
+        char *v = trim(eq + 1);
+        strip_quotes_inplace(v);
+        if (strlen(v) >= INI_VAL_MAX) v[INI_VAL_MAX - 1] = '\0';
+        (void)ini_set_span(ini, k, h, v);
+    }
+    return 1;
+}
+
 static int ini_add_file(IniStore *ini, const char *path)
 {
     if (!ini || !path || !*path) return 0;
@@ -350,14 +551,103 @@ static void ini_merge(IniStore *dst, const IniStore *src)
 {
     if (!dst || !src || !src->loaded) return;
     for (int i = 0; i < src->count; i++) {
-        (void)ini_set(dst, src->kv[i].key, src->kv[i].val);
+        const IniKV *kv = &src->kv[i];
+        if (kv->epoch == src->epoch) (void)ini_set_hashed(dst, kv->key, kv->hash, kv->ext ? kv->ext : kv->val);
     }
     dst->loaded = 1;
 }
 
-static int ini_parse_kv_buffer(IniStore *ini, const char *buf)
+/*
+ * Store of one live link source (hostapd, wpa_supplicant, 8812eu, nl80211),
+ * sized for that source and kept across passes. A source emits the same keys
+ * in the same order every pass, so src_set checks the slot after the previous
+ * key first and overwrites its value in place; the table is only searched
+ * when the key set changes. src_publish hands the keys of the current pass to
+ * the cli store as spans, so values are copied once per pass.
+ */
+#define SRC_VAL_MAX 128
+
+typedef struct {
+    char key[INI_KEY_MAX];
+    char val[SRC_VAL_MAX];
+    uint32_t hash;
+    uint32_t epoch;
+} SrcKV;
+
+typedef struct {
+    SrcKV *kv;
+    int cap;
+    int count;
+    int cursor;         /* slot after the key set last */
+    int live;           /* keys set in this epoch */
+    uint32_t epoch;
+} SrcStore;
+
+#define SRC_STORE(name, n)          \
+    static SrcKV name##_kv[n];      \
+    static SrcStore name = {name##_kv, n, 0, 0, 0, 0}
+
+static void src_begin(SrcStore *s)
+{
+    s->epoch++;
+    s->cursor = 0;
+    s->live = 0;
+}
+
+/* Full table: drop keys the current pass has not set */
+static void src_compact(SrcStore *s)
 {
-    if (!ini || !buf) return 0;
+    int n = 0;
+    for (int i = 0; i < s->count; i++) {
+        if (s->kv[i].epoch != s->epoch) continue;
+        if (n != i) s->kv[n] = s->kv[i];
+        n++;
+    }
+    s->count = n;
+    s->cursor = n;
+}
+
+static int src_set(SrcStore *s, const char *k, const char *v)
+{
+    if (!k || !*k) return 0;
+    uint32_t h = ini_hash(k);
+    int pos = -1;
+    if (s->cursor < s->count && s->kv[s->cursor].hash == h && !strncmp(s->kv[s->cursor].key, k, INI_KEY_MAX - 1)) {
+        pos = s->cursor;
+    }
+    for (int i = 0; pos < 0 && i < s->count; i++) {
+        if (s->kv[i].hash == h && !strncmp(s->kv[i].key, k, INI_KEY_MAX - 1)) pos = i;
+    }
+    if (pos < 0) {
+        if (s->count >= s->cap) src_compact(s);
+        if (s->count >= s->cap) return 0;
+        pos = s->count++;
+        strncpy(s->kv[pos].key, k, INI_KEY_MAX - 1);
+        s->kv[pos].key[INI_KEY_MAX - 1] = '\0';
+        s->kv[pos].hash = h;
+    }
+    SrcKV *kv = &s->kv[pos];
+    strncpy(kv->val, v ? v : "", SRC_VAL_MAX - 1);
+    kv->val[SRC_VAL_MAX - 1] = '\0';
+    if (kv->epoch != s->epoch) s->live++;
+    kv->epoch = s->epoch;
+    s->cursor = pos + 1;
+    return 1;
+}
+
+/* Spans stay valid until the source is read again, which follows dst's next ini_begin_parse */
+static void src_publish(IniStore *dst, const SrcStore *s)
+{
+    for (int i = 0; i < s->count; i++) {
+        const SrcKV *kv = &s->kv[i];
+        if (kv->epoch == s->epoch) (void)ini_set_span(dst, kv->key, kv->hash, kv->val);
+    }
+    dst->loaded = 1;
+}
+
+static int src_parse_kv_buffer(SrcStore *s, const char *buf)
+{
+    if (!s || !buf) return 0;
 
     int added = 0;
     const char *p = buf;
@@ -380,11 +670,25 @@ static int ini_parse_kv_buffer(IniStore *ini, const char *buf)
         *eq = '\0';
         char *k = trim(t);
         char *v = trim(eq + 1);
-        if (ini_set(ini, k, v)) added++;
+        if (src_set(s, k, v)) added++;
     }
     return added;
 }
 
+static uint64_t mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000L);
+}
+
+static uint64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+}
+
 static int build_local_ctrl(char *path, size_t path_sz)
 {
     static int counter = 0;
@@ -394,31 +698,114 @@ static int build_local_ctrl(char *path, size_t path_sz)
     return 1;
 }
 
-static int ctrl_request_unix(const char *dst_path, const char *cmd, char *out, size_t out_sz, int timeout_ms, int verbose)
+/*
+ * Control-socket sessions: one bound + connected AF_UNIX socket per daemon
+ * socket path, kept across watch intervals so a poll is a send + recv.
+ * A session is dropped and rebuilt only when a request fails (daemon
+ * restarted: its socket is a new inode and send() gets ECONNREFUSED).
+ */
+#define CTRL_SESSION_MAX 8
+
+typedef struct {
+    int fd;                 /* -1 = free */
+    char dst[108];
+    char local[108];
+    const char **owner;     /* dirs list that last resolved to this path (auto-select) */
+} CtrlSession;
+
+static CtrlSession g_ctrl_sessions[CTRL_SESSION_MAX];
+static int g_ctrl_sessions_init = 0;
+
+static void ctrl_session_close(CtrlSession *cs)
 {
-    if (!dst_path || !cmd || !out || out_sz == 0) return 0;
+    if (cs->fd >= 0) {
+        close(cs->fd);
+        unlink(cs->local);
+    }
+    cs->fd = -1;
+    cs->dst[0] = '\0';
+    cs->local[0] = '\0';
+    cs->owner = NULL;
+}
+
+static void ctrl_sessions_close_all(void)
+{
+    for (int i = 0; i < CTRL_SESSION_MAX; i++) ctrl_session_close(&g_ctrl_sessions[i]);
+}
+
+/* watch has no exit path other than a signal: remove the bound paths first */
+static void ctrl_sessions_signal(int sig)
+{
+    for (int i = 0; i < CTRL_SESSION_MAX; i++) {
+        if (g_ctrl_sessions[i].fd >= 0) unlink(g_ctrl_sessions[i].local);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void ctrl_sessions_setup(void)
+{
+    if (g_ctrl_sessions_init) return;
+    g_ctrl_sessions_init = 1;
+    for (int i = 0; i < CTRL_SESSION_MAX; i++) {
+        g_ctrl_sessions[i].fd = -1;
+        g_ctrl_sessions[i].dst[0] = '\0';
+        g_ctrl_sessions[i].local[0] = '\0';
+        g_ctrl_sessions[i].owner = NULL;
+    }
+    atexit(ctrl_sessions_close_all);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = ctrl_sessions_signal;
+    sigemptyset(&sa.sa_mask);
+    struct sigaction old;
+    if (sigaction(SIGINT, NULL, &old) == 0 && old.sa_handler == SIG_DFL) sigaction(SIGINT, &sa, NULL);
+    if (sigaction(SIGTERM, NULL, &old) == 0 && old.sa_handler == SIG_DFL) sigaction(SIGTERM, &sa, NULL);
+}
+
+static CtrlSession *ctrl_session_find(const char *dst_path)
+{
+    for (int i = 0; i < CTRL_SESSION_MAX; i++) {
+        if (g_ctrl_sessions[i].fd >= 0 && !strcmp(g_ctrl_sessions[i].dst, dst_path)) return &g_ctrl_sessions[i];
+    }
+    return NULL;
+}
+
+static CtrlSession *ctrl_session_open(const char *dst_path, int verbose)
+{
+    ctrl_sessions_setup();
+    CtrlSession *cs = ctrl_session_find(dst_path);
+    if (cs) return cs;
 
-    int s = socket(AF_UNIX, SOCK_DGRAM, 0);
+    for (int i = 0; i < CTRL_SESSION_MAX && !cs; i++) {
+        if (g_ctrl_sessions[i].fd < 0) cs = &g_ctrl_sessions[i];
+    }
+    if (!cs) {
+        /* table full (auto-select probing many sockets): recycle the last slot */
+        cs = &g_ctrl_sessions[CTRL_SESSION_MAX - 1];
+        ctrl_session_close(cs);
+    }
+
+    int s = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
     if (s < 0) {
         if (verbose) perror("socket(AF_UNIX)");
-        return 0;
+        return NULL;
     }
 
-    char local_path[108];
     struct sockaddr_un local;
     memset(&local, 0, sizeof(local));
     local.sun_family = AF_UNIX;
-    if (!build_local_ctrl(local_path, sizeof(local_path))) {
+    if (!build_local_ctrl(cs->local, sizeof(cs->local))) {
         close(s);
-        return 0;
+        return NULL;
     }
-    strncpy(local.sun_path, local_path, sizeof(local.sun_path) - 1);
+    strncpy(local.sun_path, cs->local, sizeof(local.sun_path) - 1);
     unlink(local.sun_path);
     if (bind(s, (struct sockaddr *)&local, sizeof(local)) < 0) {
         if (verbose) perror("bind(ctrl local)");
         close(s);
         unlink(local.sun_path);
-        return 0;
+        return NULL;
     }
 
     struct sockaddr_un dst;
@@ -430,43 +817,93 @@ static int ctrl_request_unix(const char *dst_path, const char *cmd, char *out, s
         if (verbose) perror("connect(ctrl)");
         close(s);
         unlink(local.sun_path);
-        return 0;
+        return NULL;
     }
 
-    if (timeout_ms < 0) timeout_ms = 1000;
-    struct timeval tv;
-    tv.tv_sec = timeout_ms / 1000;
-    tv.tv_usec = (timeout_ms % 1000) * 1000;
-    if (setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
-        if (verbose) perror("setsockopt(SO_RCVTIMEO)");
+    cs->fd = s;
+    strncpy(cs->dst, dst_path, sizeof(cs->dst) - 1);
+    cs->dst[sizeof(cs->dst) - 1] = '\0';
+    cs->owner = NULL;
+    if (verbose) fprintf(stderr, "[ctrl] session %s via %s\n", cs->dst, cs->local);
+    return cs;
+}
+
+/* One request on an open session; 0 = failed, caller drops the session */
+static int ctrl_session_request(CtrlSession *cs, const char *cmd, char *out, size_t out_sz, int timeout_ms, int verbose)
+{
+    /* A reply that missed an earlier timeout must not be taken for this one */
+    char stale[256];
+    while (recv(cs->fd, stale, sizeof(stale), MSG_DONTWAIT) > 0) {
     }
 
     size_t cmd_len = strlen(cmd);
-    if (send(s, cmd, cmd_len, 0) != (ssize_t)cmd_len) {
+    if (send(cs->fd, cmd, cmd_len, 0) != (ssize_t)cmd_len) {
         if (verbose) perror("send(ctrl)");
-        close(s);
-        unlink(local.sun_path);
         return 0;
     }
 
-    ssize_t r = recv(s, out, out_sz - 1, 0);
-    if (r < 0) {
-        if (verbose) perror("recv(ctrl)");
-        close(s);
-        unlink(local.sun_path);
-        return 0;
+    if (timeout_ms < 0) timeout_ms = 1000;
+    for (;;) {
+        struct pollfd pfd = {cs->fd, POLLIN, 0};
+        int pr = poll(&pfd, 1, timeout_ms);
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) {
+            if (verbose) fprintf(stderr, "[ctrl] %s: no reply within %d ms\n", cs->dst, timeout_ms);
+            return 0;
+        }
+        ssize_t r = recv(cs->fd, out, out_sz - 1, 0);
+        if (r < 0) {
+            if (verbose) perror("recv(ctrl)");
+            return 0;
+        }
+        out[r] = '\0';
+        /* Unsolicited "<level>event" messages only arrive after ATTACH; skip them anyway */
+        if (r > 0 && out[0] == '<') continue;
+        return 1;
     }
-    out[r] = '\0';
+}
 
-    close(s);
-    unlink(local.sun_path);
-    return 1;
+static int ctrl_request_unix(const char *dst_path, const char *cmd, char *out, size_t out_sz, int timeout_ms, int verbose)
+{
+    if (!dst_path || !cmd || !out || out_sz == 0) return 0;
+
+    CtrlSession *cs = ctrl_session_find(dst_path);
+    int reused = cs != NULL;
+    if (!cs) cs = ctrl_session_open(dst_path, verbose);
+    if (!cs) return 0;
+    if (ctrl_session_request(cs, cmd, out, out_sz, timeout_ms, verbose)) return 1;
+
+    ctrl_session_close(cs);
+    if (!reused) return 0;
+    /* The daemon may have restarted under the same path: reconnect once */
+    if (verbose) fprintf(stderr, "[ctrl] %s: reconnecting\n", dst_path);
+    cs = ctrl_session_open(dst_path, verbose);
+    if (!cs) return 0;
+    if (ctrl_session_request(cs, cmd, out, out_sz, timeout_ms, verbose)) return 1;
+    ctrl_session_close(cs);
+    return 0;
 }
 
 static int ctrl_request_with_dirs(const char **dirs, const char *ifname, const char *cmd, char *out, size_t out_sz, int timeout_ms, int verbose)
 {
     if (!dirs || !cmd || !out || out_sz == 0) return 0;
 
+    /* Auto-select: ask the socket that answered last time before rescanning */
+    if (!(ifname && *ifname)) {
+        for (int i = 0; i < CTRL_SESSION_MAX; i++) {
+            CtrlSession *cs = &g_ctrl_sessions[i];
+            if (!g_ctrl_sessions_init || cs->fd < 0 || cs->owner != dirs) continue;
+            char cached[108];
+            snprintf(cached, sizeof(cached), "%s", cs->dst);
+            if (ctrl_request_unix(cached, cmd, out, out_sz, timeout_ms, verbose)) {
+                CtrlSession *again = ctrl_session_find(cached);
+                if (again) again->owner = dirs;
+                return 1;
+            }
+            break;
+        }
+    }
+
     char path[256];
     for (int i = 0; dirs[i]; i++) {
         if (ifname && *ifname) {
@@ -484,6 +921,8 @@ static int ctrl_request_with_dirs(const char **dirs, const char *ifname, const c
             int n = snprintf(path, sizeof(path), "%s/%s", dirs[i], de->d_name);
             if (n <= 0 || (size_t)n >= sizeof(path)) continue;
             if (ctrl_request_unix(path, cmd, out, out_sz, timeout_ms, verbose)) {
+                CtrlSession *cs = ctrl_session_find(path);
+                if (cs) cs->owner = dirs;
                 closedir(d);
                 return 1;
             }
@@ -522,137 +961,697 @@ static void parse_hostapd_opt(const char *arg, char *iface_out, size_t iface_sz,
     }
 }
 
-static int load_hostapd_metrics(IniStore *out, const char *ifname, const char *sta_mac, int verbose)
-{
-    if (!out) return 0;
-    ini_init(out);
-    if (!sta_mac || !*sta_mac) return 0;
-
+/*
+ * One in-flight control request. refresh_cli_store starts every query with a
+ * non-blocking send and gathers all replies in one poll() against a shared
+ * deadline, so a wedged daemon costs at most that deadline and never delays
+ * the other sources.
+ */
+typedef struct {
+    const char *tag;        /* log prefix, e.g. "hostapd" */
+    const char **dirs;
+    const char *ifname;
     char cmd[128];
-    snprintf(cmd, sizeof(cmd), "STA %s", sta_mac);
-
-    static const char *dirs[] = { "/run/hostapd", "/var/run/hostapd", NULL };
+    CtrlSession *cs;
+    int state;              /* CTRL_Q_* */
     char buf[2048];
-    if (!ctrl_request_with_dirs(dirs, ifname, cmd, buf, sizeof(buf), 1000, verbose)) {
-        if (verbose) fprintf(stderr, "[hostapd] control request failed\n");
-        return 0;
-    }
+} CtrlQuery;
 
-    out->loaded = 1;
-    (void)ini_parse_kv_buffer(out, buf);
-    if (verbose) fprintf(stderr, "[hostapd] parsed %d fields\n", out->count);
-    return 1;
-}
+enum { CTRL_Q_IDLE = 0, CTRL_Q_PENDING, CTRL_Q_DONE, CTRL_Q_FAILED };
 
-static int load_wpa_metrics(IniStore *out, const char *iface, int verbose)
-{
-    if (!out) return 0;
-    ini_init(out);
-    if (!iface || !*iface) return 0;
+static const char *g_hostapd_dirs[] = { "/run/hostapd", "/var/run/hostapd", NULL };
+static const char *g_wpa_dirs[] = { "/run/wpa_supplicant", "/var/run/wpa_supplicant", NULL };
 
-    static const char *dirs[] = { "/run/wpa_supplicant", "/var/run/wpa_supplicant", NULL };
-    char buf[2048];
-    if (!ctrl_request_with_dirs(dirs, iface, "SIGNAL_POLL", buf, sizeof(buf), 1000, verbose)) {
-        if (verbose) fprintf(stderr, "[wpa] control request failed\n");
+static int ctrl_query_send(CtrlQuery *q, CtrlSession *cs, int verbose)
+{
+    char stale[256];
+    while (recv(cs->fd, stale, sizeof(stale), MSG_DONTWAIT) > 0) {
+    }
+    size_t len = strlen(q->cmd);
+    if (send(cs->fd, q->cmd, len, MSG_DONTWAIT) != (ssize_t)len) {
+        if (verbose) fprintf(stderr, "[%s] send(%s): %s\n", q->tag, cs->dst, strerror(errno));
+        ctrl_session_close(cs);
         return 0;
     }
-
-    out->loaded = 1;
-    (void)ini_parse_kv_buffer(out, buf);
-    if (verbose) fprintf(stderr, "[wpa] parsed %d fields\n", out->count);
+    q->cs = cs;
+    q->state = CTRL_Q_PENDING;
     return 1;
 }
 
-static int load_8812eu_metrics(IniStore *out, const char *iface, int verbose)
+static void ctrl_query_start(CtrlQuery *q, const char *tag, const char **dirs, const char *ifname, int verbose)
 {
-    if (!out) return 0;
-    ini_init(out);
-    if (!iface || !*iface) return 0;
-
-    char path_a[256];
-    char path_b[256];
-    snprintf(path_a, sizeof(path_a), "/proc/net/rtl88x2eu/%s/rssi_a", iface);
-    snprintf(path_b, sizeof(path_b), "/proc/net/rtl88x2eu/%s/rssi_b", iface);
+    q->tag = tag;
+    q->dirs = dirs;
+    q->ifname = ifname;
+    q->cs = NULL;
+    q->state = CTRL_Q_FAILED;
+
+    if (!(ifname && *ifname)) {
+        /* Auto-select: reuse the socket that answered before, else scan (blocking, once) */
+        for (int i = 0; g_ctrl_sessions_init && i < CTRL_SESSION_MAX; i++) {
+            CtrlSession *cs = &g_ctrl_sessions[i];
+            if (cs->fd >= 0 && cs->owner == dirs) {
+                if (ctrl_query_send(q, cs, verbose)) return;
+                break;
+            }
+        }
+        if (ctrl_request_with_dirs(dirs, NULL, q->cmd, q->buf, sizeof(q->buf), 1000, verbose)) q->state = CTRL_Q_DONE;
+        return;
+    }
 
-    FILE *fa = fopen(path_a, "r");
-    FILE *fb = fopen(path_b, "r");
-    if (!fa && !fb) {
-        if (verbose) fprintf(stderr, "[8812eu] rssi files missing for %s\n", iface);
-        if (fa) fclose(fa);
-        if (fb) fclose(fb);
-        return 0;
+    char path[256];
+    for (int i = 0; dirs[i]; i++) {
+        int n = snprintf(path, sizeof(path), "%s/%s", dirs[i], ifname);
+        if (n <= 0 || (size_t)n >= sizeof(path)) continue;
+        CtrlSession *cs = ctrl_session_open(path, verbose);
+        if (!cs) continue;
+        if (ctrl_query_send(q, cs, verbose)) return;
+        /* send failed on a kept session: the daemon restarted, try a fresh one */
+        cs = ctrl_session_open(path, verbose);
+        if (cs && ctrl_query_send(q, cs, verbose)) return;
     }
+    if (verbose) fprintf(stderr, "[ctrl] no control socket found for %s\n", ifname);
+}
 
-    char buf[64];
-    if (fa) {
-        if (fgets(buf, sizeof(buf), fa)) {
-            char *t = trim(buf);
-            (void)ini_set(out, "rssi_a", t);
+static void ctrl_query_collect(CtrlQuery *qs, int count, int timeout_ms, int verbose)
+{
+    uint64_t now = mono_ms();
+    uint64_t deadline = now + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+    for (;;) {
+        struct pollfd pfd[4];
+        CtrlQuery *owner[4];
+        int n = 0;
+        for (int i = 0; i < count && n < 4; i++) {
+            if (qs[i].state != CTRL_Q_PENDING) continue;
+            pfd[n].fd = qs[i].cs->fd;
+            pfd[n].events = POLLIN;
+            pfd[n].revents = 0;
+            owner[n++] = &qs[i];
         }
-        fclose(fa);
-    }
-    if (fb) {
-        if (fgets(buf, sizeof(buf), fb)) {
-            char *t = trim(buf);
-            (void)ini_set(out, "rssi_b", t);
+        if (n == 0) return;
+        now = mono_ms();
+        int wait = now >= deadline ? 0 : (int)(deadline - now);
+        int r = poll(pfd, (nfds_t)n, wait);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        for (int i = 0; i < n; i++) {
+            if (!pfd[i].revents) continue;
+            CtrlQuery *q = owner[i];
+            ssize_t got = recv(q->cs->fd, q->buf, sizeof(q->buf) - 1, MSG_DONTWAIT);
+            if (got < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
+                if (verbose) fprintf(stderr, "[%s] recv: %s\n", q->tag, strerror(errno));
+                ctrl_session_close(q->cs);
+                q->state = CTRL_Q_FAILED;
+                continue;
+            }
+            q->buf[got] = '\0';
+            if (got > 0 && q->buf[0] == '<') continue;  /* unsolicited event line */
+            if (!(q->ifname && *q->ifname)) q->cs->owner = q->dirs;
+            q->state = CTRL_Q_DONE;
         }
-        fclose(fb);
     }
+    for (int i = 0; i < count; i++) {
+        if (qs[i].state != CTRL_Q_PENDING) continue;
+        /* Keep the session: the late reply is discarded before the next request */
+        if (verbose) fprintf(stderr, "[%s] no reply within %d ms, keys stale -> null\n", qs[i].tag, timeout_ms);
+        qs[i].state = CTRL_Q_FAILED;
+    }
+}
 
-    out->loaded = 1;
-    if (verbose) fprintf(stderr, "[8812eu] parsed rssi fields for %s (a=%s, b=%s)\n",
-        iface,
-        ini_get(out, "rssi_a") ? ini_get(out, "rssi_a") : "null",
-        ini_get(out, "rssi_b") ? ini_get(out, "rssi_b") : "null");
+static int ctrl_query_publish(SrcStore *out, const CtrlQuery *q, int verbose)
+{
+    src_begin(out);
+    if (q->state != CTRL_Q_DONE) {
+        if (verbose) fprintf(stderr, "[%s] control request failed\n", q->tag);
+        return 0;
+    }
+    (void)src_parse_kv_buffer(out, q->buf);
+    if (verbose) fprintf(stderr, "[%s] parsed %d fields\n", q->tag, out->live);
     return 1;
 }
 
-static void refresh_cli_store(IniStore *cli, const char *hostapd_iface, const char *hostapd_sta, const char *wpa_iface, const char *rtl8812_iface, int verbose)
-{
-    if (!cli) return;
-    ini_init(cli);
+/*
+ * The rtl88x2eu rssi files stay open and are re-read with pread at offset 0,
+ * which makes procfs regenerate them. A read error (driver reloaded, iface
+ * gone) closes the file so the next pass opens it again.
+ */
+static int g_8812_fd[2] = {-1, -1};
+static char g_8812_iface[IF_NAMESIZE + 1];
 
-    IniStore tmp;
-    int any = 0;
+static void rtl8812_close(void)
+{
+    for (int i = 0; i < 2; i++) {
+        if (g_8812_fd[i] >= 0) close(g_8812_fd[i]);
+        g_8812_fd[i] = -1;
+    }
+}
 
-    if (hostapd_sta && *hostapd_sta) {
-        if (load_hostapd_metrics(&tmp, hostapd_iface, hostapd_sta, verbose)) {
-            ini_merge(cli, &tmp);
-            any = 1;
-        }
+static int rtl8812_read(int chain, const char *iface, char *buf, size_t buf_sz)
+{
+    int *fd = &g_8812_fd[chain];
+    if (*fd < 0) {
+        char path[256];
+        snprintf(path, sizeof(path), "/proc/net/rtl88x2eu/%s/rssi_%c", iface, chain ? 'b' : 'a');
+        *fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (*fd < 0) return 0;
     }
+    ssize_t n = pread(*fd, buf, buf_sz - 1, 0);
+    if (n <= 0) {
+        close(*fd);
+        *fd = -1;
+        return 0;
+    }
+    buf[n] = '\0';
+    char *nl = strchr(buf, '\n');
+    if (nl) *nl = '\0';
+    return 1;
+}
 
-    if (wpa_iface && *wpa_iface) {
-        if (load_wpa_metrics(&tmp, wpa_iface, verbose)) {
-            ini_merge(cli, &tmp);
-            any = 1;
-        }
+static int load_8812eu_metrics(SrcStore *out, const char *iface, int verbose)
+{
+    if (!out) return 0;
+    src_begin(out);
+    if (!iface || !*iface) return 0;
+    if (strncmp(g_8812_iface, iface, sizeof(g_8812_iface))) {
+        rtl8812_close();
+        snprintf(g_8812_iface, sizeof(g_8812_iface), "%s", iface);
     }
 
-    if (rtl8812_iface && *rtl8812_iface) {
-        if (load_8812eu_metrics(&tmp, rtl8812_iface, verbose)) {
-            ini_merge(cli, &tmp);
-            any = 1;
-        }
+    char buf[64];
+    int found = 0;
+    if (rtl8812_read(0, iface, buf, sizeof(buf))) found += src_set(out, "rssi_a", trim(buf));
+    if (rtl8812_read(1, iface, buf, sizeof(buf))) found += src_set(out, "rssi_b", trim(buf));
+    if (g_8812_fd[0] < 0 && g_8812_fd[1] < 0) {
+        if (verbose) fprintf(stderr, "[8812eu] rssi files missing for %s\n", iface);
+        return 0;
     }
 
-    if (!any) ini_init(cli);
+    if (verbose) fprintf(stderr, "[8812eu] parsed %d rssi field(s) for %s\n", found, iface);
+    return 1;
 }
 
+/*
+ * nl80211 station statistics over a persistent generic-netlink socket. One
+ * NL80211_CMD_GET_STATION dump per pass; binary attributes are decoded
+ * straight into nl_* keys, e.g. nl_signal, nl_chain0, nl_tx_bitrate (Mbit/s),
+ * nl_tx_retries. Works with any mac80211 driver and needs no daemon.
+ */
+static int g_nl_fd = -1;
+static uint16_t g_nl_family = 0;
+static uint32_t g_nl_seq = 0;
 
-/* ------------------------- payload ------------------------- */
-
-static void payload_init(Payload *p) { memset(p, 0, sizeof(*p)); }
+#define NL_BUF 16384
 
-static int set_value_num(Payload *p, int idx, double v)
+static void nl_close(void)
 {
-    if (idx < 0 || idx > 7) return 0;
-    p->values_state[idx] = VS_NUM;
-    p->values[idx] = v;
-    return 1;
+    if (g_nl_fd >= 0) close(g_nl_fd);
+    g_nl_fd = -1;
+    g_nl_family = 0;
 }
 
-static int set_value_null(Payload *p, int idx)
+static size_t nl_put_attr(char *msg, size_t len, size_t cap, uint16_t type, const void *data, uint16_t dlen)
+{
+    size_t need = NLA_ALIGN(NLA_HDRLEN + dlen);
+    if (len + need > cap) return len;
+    struct nlattr *a = (struct nlattr *)(msg + len);
+    a->nla_type = type;
+    a->nla_len = (uint16_t)(NLA_HDRLEN + dlen);
+    memcpy((char *)a + NLA_HDRLEN, data, dlen);
+    memset((char *)a + NLA_HDRLEN + dlen, 0, need - NLA_HDRLEN - dlen);
+    return len + need;
+}
+
+/* tb[type] = attribute, for types <= max; later duplicates win */
+static void nl_parse_attrs(const void *start, size_t len, const struct nlattr **tb, int max)
+{
+    memset(tb, 0, sizeof(*tb) * (size_t)(max + 1));
+    const char *p = (const char *)start;
+    while (len >= NLA_HDRLEN) {
+        const struct nlattr *a = (const struct nlattr *)p;
+        if (a->nla_len < NLA_HDRLEN || a->nla_len > len) break;
+        int type = a->nla_type & NLA_TYPE_MASK;
+        if (type <= max) tb[type] = a;
+        size_t step = NLA_ALIGN(a->nla_len);
+        if (step > len) break;
+        p += step;
+        len -= step;
+    }
+}
+
+static const void *nl_data(const struct nlattr *a) { return (const char *)a + NLA_HDRLEN; }
+static size_t nl_len(const struct nlattr *a) { return (size_t)a->nla_len - NLA_HDRLEN; }
+
+static uint32_t nl_u32(const struct nlattr *a)
+{
+    uint32_t v = 0;
+    size_t n = nl_len(a);
+    if (n >= 4) memcpy(&v, nl_data(a), 4);
+    else if (n >= 2) { uint16_t s; memcpy(&s, nl_data(a), 2); v = s; }
+    else if (n >= 1) v = *(const uint8_t *)nl_data(a);
+    return v;
+}
+
+static int nl_send(uint16_t type, uint16_t flags, uint8_t cmd, const char *attrs, size_t attrs_len)
+{
+    char msg[256];
+    if (NLMSG_HDRLEN + GENL_HDRLEN + attrs_len > sizeof(msg)) return 0;
+    struct nlmsghdr *n = (struct nlmsghdr *)msg;
+    memset(msg, 0, NLMSG_HDRLEN + GENL_HDRLEN);
+    n->nlmsg_len = (uint32_t)(NLMSG_HDRLEN + GENL_HDRLEN + attrs_len);
+    n->nlmsg_type = type;
+    n->nlmsg_flags = (uint16_t)(NLM_F_REQUEST | flags);
+    n->nlmsg_seq = ++g_nl_seq;
+    struct genlmsghdr *g = (struct genlmsghdr *)(msg + NLMSG_HDRLEN);
+    g->cmd = cmd;
+    g->version = 1;
+    memcpy(msg + NLMSG_HDRLEN + GENL_HDRLEN, attrs, attrs_len);
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    return sendto(g_nl_fd, msg, n->nlmsg_len, 0, (struct sockaddr *)&kernel, sizeof(kernel)) == (ssize_t)n->nlmsg_len;
+}
+
+/*
+ * Reads replies to the last request until NLMSG_DONE / the ACK, handing
+ * every genl payload to cb. Returns 1 on success, 0 on error or timeout.
+ */
+static int nl_recv(int timeout_ms, void (*cb)(const struct genlmsghdr *g, size_t len, void *arg), void *arg)
+{
+    static char buf[NL_BUF] __attribute__((aligned(4)));
+    uint64_t deadline = mono_ms() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+    for (;;) {
+        uint64_t now = mono_ms();
+        struct pollfd pfd = {g_nl_fd, POLLIN, 0};
+        int pr = poll(&pfd, 1, now >= deadline ? 0 : (int)(deadline - now));
+        if (pr < 0 && errno == EINTR) continue;
+        if (pr <= 0) return 0;
+        ssize_t r = recv(g_nl_fd, buf, sizeof(buf), 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        size_t left = (size_t)r;
+        for (struct nlmsghdr *n = (struct nlmsghdr *)buf; NLMSG_OK(n, left); n = NLMSG_NEXT(n, left)) {
+            if (n->nlmsg_seq != g_nl_seq) continue;  /* answer to an abandoned request */
+            if (n->nlmsg_type == NLMSG_DONE) return 1;
+            if (n->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *e = (const struct nlmsgerr *)NLMSG_DATA(n);
+                if (e->error == 0) return 1;
+                errno = -e->error;
+                return 0;
+            }
+            if (n->nlmsg_len < NLMSG_HDRLEN + GENL_HDRLEN) continue;
+            cb((const struct genlmsghdr *)NLMSG_DATA(n), n->nlmsg_len - NLMSG_HDRLEN, arg);
+            if (!(n->nlmsg_flags & NLM_F_MULTI)) return 1;
+        }
+    }
+}
+
+static void nl_family_cb(const struct genlmsghdr *g, size_t len, void *arg)
+{
+    const struct nlattr *tb[CTRL_ATTR_MAX + 1];
+    nl_parse_attrs((const char *)g + GENL_HDRLEN, len - GENL_HDRLEN, tb, CTRL_ATTR_MAX);
+    if (tb[CTRL_ATTR_FAMILY_ID]) *(uint16_t *)arg = (uint16_t)nl_u32(tb[CTRL_ATTR_FAMILY_ID]);
+}
+
+static int nl_open(int timeout_ms, int verbose)
+{
+    if (g_nl_fd >= 0 && g_nl_family) return 1;
+    nl_close();
+    g_nl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (g_nl_fd < 0) {
+        if (verbose) perror("socket(NETLINK_GENERIC)");
+        return 0;
+    }
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    if (bind(g_nl_fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        if (verbose) perror("bind(netlink)");
+        nl_close();
+        return 0;
+    }
+
+    char attrs[32];
+    size_t alen = nl_put_attr(attrs, 0, sizeof(attrs), CTRL_ATTR_FAMILY_NAME, NL80211_GENL_NAME, sizeof(NL80211_GENL_NAME));
+    uint16_t family = 0;
+    if (!nl_send(GENL_ID_CTRL, NLM_F_ACK, CTRL_CMD_GETFAMILY, attrs, alen) || !nl_recv(timeout_ms, nl_family_cb, &family) || !family) {
+        if (verbose) fprintf(stderr, "[nl80211] family lookup failed (%s)\n", strerror(errno));
+        nl_close();
+        return 0;
+    }
+    g_nl_family = family;
+    return 1;
+}
+
+typedef struct {
+    SrcStore *out;
+    const uint8_t *mac;   /* NULL = first station */
+    int found;
+} NlStationCtx;
+
+static void nl_set_num(SrcStore *out, const char *key, long long v)
+{
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "%lld", v);
+    (void)src_set(out, key, tmp);
+}
+
+/* Bitrate in Mbit/s with one decimal, plus the MCS index when the rate has one */
+static void nl_set_rate(SrcStore *out, const struct nlattr *rate, const char *bitrate_key, const char *mcs_key)
+{
+    const struct nlattr *tb[NL80211_RATE_INFO_MAX + 1];
+    nl_parse_attrs(nl_data(rate), nl_len(rate), tb, NL80211_RATE_INFO_MAX);
+    uint32_t r100k = 0;
+    if (tb[NL80211_RATE_INFO_BITRATE32]) r100k = nl_u32(tb[NL80211_RATE_INFO_BITRATE32]);
+    else if (tb[NL80211_RATE_INFO_BITRATE]) r100k = nl_u32(tb[NL80211_RATE_INFO_BITRATE]);
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "%u.%u", r100k / 10, r100k % 10);
+    (void)src_set(out, bitrate_key, tmp);
+
+    const struct nlattr *mcs = tb[NL80211_RATE_INFO_MCS];
+    if (!mcs) mcs = tb[NL80211_RATE_INFO_VHT_MCS];
+    if (!mcs) mcs = tb[NL80211_RATE_INFO_HE_MCS];
+    if (mcs) nl_set_num(out, mcs_key, (long long)nl_u32(mcs));
+}
+
+static void nl_station_cb(const struct genlmsghdr *g, size_t len, void *arg)
+{
+    NlStationCtx *sc = (NlStationCtx *)arg;
+    if (sc->found) return;
+    const struct nlattr *tb[NL80211_ATTR_MAX + 1];
+    nl_parse_attrs((const char *)g + GENL_HDRLEN, len - GENL_HDRLEN, tb, NL80211_ATTR_MAX);
+    if (!tb[NL80211_ATTR_STA_INFO]) return;
+    if (sc->mac && (!tb[NL80211_ATTR_MAC] || nl_len(tb[NL80211_ATTR_MAC]) < 6 || memcmp(nl_data(tb[NL80211_ATTR_MAC]), sc->mac, 6))) return;
+    sc->found = 1;
+
+    const struct nlattr *si[NL80211_STA_INFO_MAX + 1];
+    nl_parse_attrs(nl_data(tb[NL80211_ATTR_STA_INFO]), nl_len(tb[NL80211_ATTR_STA_INFO]), si, NL80211_STA_INFO_MAX);
+    SrcStore *out = sc->out;
+    if (si[NL80211_STA_INFO_SIGNAL]) nl_set_num(out, "nl_signal", (int8_t)nl_u32(si[NL80211_STA_INFO_SIGNAL]));
+    if (si[NL80211_STA_INFO_SIGNAL_AVG]) nl_set_num(out, "nl_signal_avg", (int8_t)nl_u32(si[NL80211_STA_INFO_SIGNAL_AVG]));
+    if (si[NL80211_STA_INFO_CHAIN_SIGNAL]) {
+        const char *p = (const char *)nl_data(si[NL80211_STA_INFO_CHAIN_SIGNAL]);
+        size_t left = nl_len(si[NL80211_STA_INFO_CHAIN_SIGNAL]);
+        int chain = 0;
+        while (left >= NLA_HDRLEN && chain < 4) {
+            const struct nlattr *a = (const struct nlattr *)p;
+            if (a->nla_len < NLA_HDRLEN || a->nla_len > left) break;
+            char key[16];
+            snprintf(key, sizeof(key), "nl_chain%d", chain++);
+            nl_set_num(out, key, (int8_t)nl_u32(a));
+            size_t step = NLA_ALIGN(a->nla_len);
+            if (step > left) break;
+            p += step;
+            left -= step;
+        }
+    }
+    if (si[NL80211_STA_INFO_TX_BITRATE]) nl_set_rate(out, si[NL80211_STA_INFO_TX_BITRATE], "nl_tx_bitrate", "nl_tx_mcs");
+    if (si[NL80211_STA_INFO_RX_BITRATE]) nl_set_rate(out, si[NL80211_STA_INFO_RX_BITRATE], "nl_rx_bitrate", "nl_rx_mcs");
+    if (si[NL80211_STA_INFO_RX_PACKETS]) nl_set_num(out, "nl_rx_packets", nl_u32(si[NL80211_STA_INFO_RX_PACKETS]));
+    if (si[NL80211_STA_INFO_TX_PACKETS]) nl_set_num(out, "nl_tx_packets", nl_u32(si[NL80211_STA_INFO_TX_PACKETS]));
+    if (si[NL80211_STA_INFO_TX_RETRIES]) nl_set_num(out, "nl_tx_retries", nl_u32(si[NL80211_STA_INFO_TX_RETRIES]));
+    if (si[NL80211_STA_INFO_TX_FAILED]) nl_set_num(out, "nl_tx_failed", nl_u32(si[NL80211_STA_INFO_TX_FAILED]));
+    if (si[NL80211_STA_INFO_INACTIVE_TIME]) nl_set_num(out, "nl_inactive_ms", nl_u32(si[NL80211_STA_INFO_INACTIVE_TIME]));
+}
+
+/* spec: "<iface>[,<station mac>]"; without a MAC the first station is used */
+static int load_nl80211_metrics(SrcStore *out, const char *spec, int timeout_ms, int verbose)
+{
+    if (!out) return 0;
+    src_begin(out);
+    if (!spec || !*spec) return 0;
+
+    char iface[IF_NAMESIZE + 1];
+    uint8_t mac[6];
+    int have_mac = 0;
+    const char *comma = strchr(spec, ',');
+    size_t n = comma ? (size_t)(comma - spec) : strlen(spec);
+    if (n >= sizeof(iface)) n = sizeof(iface) - 1;
+    memcpy(iface, spec, n);
+    iface[n] = '\0';
+    if (comma) {
+        unsigned int b[6];
+        if (sscanf(comma + 1, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+            for (int i = 0; i < 6; i++) mac[i] = (uint8_t)b[i];
+            have_mac = 1;
+        }
+    }
+
+    uint32_t ifindex = if_nametoindex(iface);
+    if (!ifindex) {
+        if (verbose) fprintf(stderr, "[nl80211] no interface %s\n", iface);
+        return 0;
+    }
+    if (!nl_open(timeout_ms, verbose)) return 0;
+
+    char attrs[32];
+    size_t alen = nl_put_attr(attrs, 0, sizeof(attrs), NL80211_ATTR_IFINDEX, &ifindex, sizeof(ifindex));
+    NlStationCtx sc = {out, have_mac ? mac : NULL, 0};
+    if (!nl_send(g_nl_family, NLM_F_DUMP, NL80211_CMD_GET_STATION, attrs, alen) || !nl_recv(timeout_ms, nl_station_cb, &sc)) {
+        if (verbose) fprintf(stderr, "[nl80211] station dump on %s failed (%s)\n", iface, strerror(errno));
+        /* socket state unknown after an error: start over next pass */
+        nl_close();
+        return 0;
+    }
+    if (!sc.found) {
+        if (verbose) fprintf(stderr, "[nl80211] no station on %s\n", iface);
+        return 0;
+    }
+    if (verbose) fprintf(stderr, "[nl80211] parsed %d fields for %s\n", out->live, iface);
+    return 1;
+}
+
+/* A hostapd STA reply runs to ~40 keys; the nl80211 dump sets at most 15 */
+SRC_STORE(g_src_hostapd, 64);
+SRC_STORE(g_src_wpa, 32);
+SRC_STORE(g_src_8812eu, 2);
+SRC_STORE(g_src_nl80211, 16);
+
+/*
+ * --exec <cmd>: one long-lived "sh -c <cmd>" child that streams key=value
+ * lines on stdout, for metrics without a built-in source. The pipe is read
+ * non-blocking at every pass (and wakes --inotify waits); only complete
+ * lines are parsed. Keys keep their last streamed value until overwritten,
+ * so the store never starts a new epoch while the child runs. When the
+ * child exits its keys are dropped (slots go null) and it is restarted
+ * after EXEC_RESPAWN_MS.
+ */
+#define EXEC_RESPAWN_MS 1000
+
+typedef struct {
+    const char *cmd;
+    pid_t pid;
+    int fd;               /* our non-blocking end of its stdout, -1 while not running */
+    uint64_t respawn_ms;  /* earliest restart after an exit */
+    size_t len;           /* bytes of an unfinished line held in buf */
+    char buf[4096];
+} ExecSource;
+
+static ExecSource g_exec = {NULL, -1, -1, 0, 0, {0}};
+SRC_STORE(g_src_exec, 64);
+
+static int exec_source_spawn(int verbose)
+{
+    int p[2];
+    if (pipe(p) < 0) {
+        perror("pipe(exec)");
+        return 0;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork(exec)");
+        close(p[0]);
+        close(p[1]);
+        return 0;
+    }
+    if (pid == 0) {
+        close(p[0]);
+        if (p[1] != STDOUT_FILENO) {
+            dup2(p[1], STDOUT_FILENO);
+            close(p[1]);
+        }
+        int null_fd = open("/dev/null", O_RDONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            if (null_fd != STDIN_FILENO) close(null_fd);
+        }
+        execl("/bin/sh", "sh", "-c", g_exec.cmd, (char *)NULL);
+        _exit(127);
+    }
+    close(p[1]);
+    fcntl(p[0], F_SETFL, fcntl(p[0], F_GETFL) | O_NONBLOCK);
+    fcntl(p[0], F_SETFD, FD_CLOEXEC);
+    g_exec.pid = pid;
+    g_exec.fd = p[0];
+    g_exec.len = 0;
+    src_begin(&g_src_exec);  /* a new child starts without keys */
+    if (verbose) fprintf(stderr, "[exec] started pid %d: %s\n", (int)pid, g_exec.cmd);
+    return 1;
+}
+
+static void exec_source_reap(int verbose)
+{
+    int status = 0;
+    close(g_exec.fd);
+    g_exec.fd = -1;
+    /* A child that only closed its stdout is no use either */
+    pid_t r = waitpid(g_exec.pid, &status, WNOHANG);
+    if (r == 0) {
+        kill(g_exec.pid, SIGTERM);
+        r = waitpid(g_exec.pid, &status, 0);
+    }
+    if (r > 0) {
+        if (WIFEXITED(status)) fprintf(stderr, "[exec] child exited with status %d\n", WEXITSTATUS(status));
+        else if (WIFSIGNALED(status)) fprintf(stderr, "[exec] child killed by signal %d\n", WTERMSIG(status));
+    }
+    g_exec.pid = -1;
+    g_exec.respawn_ms = mono_ms() + EXEC_RESPAWN_MS;
+    src_begin(&g_src_exec);  /* nothing refreshes the streamed keys any more */
+    if (verbose) fprintf(stderr, "[exec] restarting in %d ms\n", EXEC_RESPAWN_MS);
+}
+
+static int exec_source_start(const char *cmd, int verbose)
+{
+    if (!cmd || !*cmd) return 0;
+    g_exec.cmd = cmd;
+    return exec_source_spawn(verbose);
+}
+
+/* Descriptor to add to a wait, -1 when no child is running */
+static int exec_source_fd(void) { return g_exec.fd; }
+
+/* Restart deadline while the child is down, 0 otherwise */
+static uint64_t exec_source_deadline(void)
+{
+    if (!g_exec.cmd || g_exec.fd >= 0) return 0;
+    return g_exec.respawn_ms;
+}
+
+/*
+ * Reads whatever the child wrote since the last call and publishes the
+ * keys of its complete lines into cli. Returns the number of keys set.
+ */
+static int exec_source_poll(IniStore *cli, int verbose)
+{
+    if (!g_exec.cmd) return 0;
+    if (g_exec.fd < 0) {
+        if (mono_ms() < g_exec.respawn_ms || !exec_source_spawn(verbose)) return 0;
+    }
+
+    int set = 0;
+    for (;;) {
+        ssize_t n = read(g_exec.fd, g_exec.buf + g_exec.len, sizeof(g_exec.buf) - 1 - g_exec.len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;  /* EAGAIN: drained */
+        if (n == 0) {
+            exec_source_reap(verbose);
+            break;
+        }
+        g_exec.len += (size_t)n;
+        g_exec.buf[g_exec.len] = '\0';
+
+        char *last_nl = strrchr(g_exec.buf, '\n');
+        if (!last_nl) {
+            if (g_exec.len >= sizeof(g_exec.buf) - 1) {
+                if (verbose) fprintf(stderr, "[exec] line over %zu bytes dropped\n", sizeof(g_exec.buf) - 1);
+                g_exec.len = 0;
+            }
+            continue;
+        }
+        *last_nl = '\0';
+        set += src_parse_kv_buffer(&g_src_exec, g_exec.buf);
+        size_t rest = g_exec.len - (size_t)(last_nl + 1 - g_exec.buf);
+        memmove(g_exec.buf, last_nl + 1, rest);
+        g_exec.len = rest;
+    }
+    if (set && cli) src_publish(cli, &g_src_exec);
+    if (set && verbose) fprintf(stderr, "[exec] %d key(s) updated\n", set);
+    return set;
+}
+
+static void exec_source_stop(void)
+{
+    if (g_exec.pid > 0) {
+        kill(g_exec.pid, SIGTERM);
+        waitpid(g_exec.pid, NULL, 0);
+    }
+    if (g_exec.fd >= 0) close(g_exec.fd);
+    g_exec.pid = -1;
+    g_exec.fd = -1;
+    g_exec.cmd = NULL;
+}
+
+static void refresh_cli_store(IniStore *cli, const char *hostapd_iface, const char *hostapd_sta, const char *wpa_iface, const char *rtl8812_iface,
+                              const char *nl_spec, int timeout_ms, int verbose)
+{
+    if (!cli) return;
+    ini_begin_parse(cli);
+
+    static CtrlQuery qs[2];
+    int nq = 0;
+    int hostapd_q = -1, wpa_q = -1;
+    int any = 0;
+
+    if (hostapd_sta && *hostapd_sta) {
+        hostapd_q = nq++;
+        snprintf(qs[hostapd_q].cmd, sizeof(qs[hostapd_q].cmd), "STA %s", hostapd_sta);
+        ctrl_query_start(&qs[hostapd_q], "hostapd", g_hostapd_dirs, hostapd_iface, verbose);
+    }
+    if (wpa_iface && *wpa_iface) {
+        wpa_q = nq++;
+        snprintf(qs[wpa_q].cmd, sizeof(qs[wpa_q].cmd), "SIGNAL_POLL");
+        ctrl_query_start(&qs[wpa_q], "wpa", g_wpa_dirs, wpa_iface, verbose);
+    }
+    ctrl_query_collect(qs, nq, timeout_ms, verbose);
+
+    if (hostapd_q >= 0 && ctrl_query_publish(&g_src_hostapd, &qs[hostapd_q], verbose)) {
+        src_publish(cli, &g_src_hostapd);
+        any = 1;
+    }
+    if (wpa_q >= 0 && ctrl_query_publish(&g_src_wpa, &qs[wpa_q], verbose)) {
+        src_publish(cli, &g_src_wpa);
+        any = 1;
+    }
+
+    if (rtl8812_iface && *rtl8812_iface) {
+        if (load_8812eu_metrics(&g_src_8812eu, rtl8812_iface, verbose)) {
+            src_publish(cli, &g_src_8812eu);
+            any = 1;
+        }
+    }
+
+    if (nl_spec && *nl_spec) {
+        if (load_nl80211_metrics(&g_src_nl80211, nl_spec, timeout_ms, verbose)) {
+            src_publish(cli, &g_src_nl80211);
+            any = 1;
+        }
+    }
+
+    /* Streamed keys outlive the pass; the store is only republished into the fresh epoch */
+    if (g_src_exec.live) {
+        src_publish(cli, &g_src_exec);
+        any = 1;
+    }
+
+    if (!any) cli->loaded = 0;
+}
+
+
+/* ------------------------- payload ------------------------- */
+
+static void payload_init(Payload *p) { memset(p, 0, sizeof(*p)); }
+
+static int set_value_num(Payload *p, int idx, double v)
+{
+    if (idx < 0 || idx > 7) return 0;
+    p->values_state[idx] = VS_NUM;
+    p->values[idx] = v;
+    return 1;
+}
+
+static int set_value_null(Payload *p, int idx)
 {
     if (idx < 0 || idx > 7) return 0;
     p->values_state[idx] = VS_NULL;
@@ -752,6 +1751,62 @@ static int serialize_payload(const Payload *p, char *out, size_t out_cap)
     return len;
 }
 
+/*
+ * Binary frame (see CONTRACT.md): 'W' 'B' version flags value_mask text_mask,
+ * little-endian float32 per present value, u8 length + bytes per present text.
+ * VS_EMPTY is sent as 0.0 (the backend's clear-to-zero); null/absent slots are
+ * simply left out of the mask.
+ */
+#define BIN_MAGIC0  'W'
+#define BIN_MAGIC1  'B'
+#define BIN_VERSION 1
+
+static int serialize_payload_binary(const Payload *p, char *out, size_t out_cap)
+{
+    uint8_t *o = (uint8_t *)out;
+    size_t len = 6;
+    uint8_t value_mask = 0, text_mask = 0;
+
+    if (out_cap < len) return -1;
+    for (int i = 0; i < 8; i++) {
+        if (p->values_state[i] != VS_NUM && p->values_state[i] != VS_EMPTY) continue;
+        if (len + 4 > out_cap) return -1;
+        float f = p->values_state[i] == VS_NUM ? (float)p->values[i] : 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        o[len++] = (uint8_t)bits;
+        o[len++] = (uint8_t)(bits >> 8);
+        o[len++] = (uint8_t)(bits >> 16);
+        o[len++] = (uint8_t)(bits >> 24);
+        value_mask |= (uint8_t)(1u << i);
+    }
+    for (int i = 0; i < 8; i++) {
+        if (p->texts_state[i] != TS_STR) continue;
+        size_t n = strlen(p->texts[i]);
+        if (n > MAX_TEXT_LEN) n = MAX_TEXT_LEN;
+        if (len + 1 + n > out_cap) return -1;
+        o[len++] = (uint8_t)n;
+        memcpy(o + len, p->texts[i], n);
+        len += n;
+        text_mask |= (uint8_t)(1u << i);
+    }
+
+    o[0] = BIN_MAGIC0;
+    o[1] = BIN_MAGIC1;
+    o[2] = BIN_VERSION;
+    o[3] = 0; /* flags: no asset updates from the CLI */
+    o[4] = value_mask;
+    o[5] = text_mask;
+
+    if (len > MAX_PAYLOAD) return -2;
+    return (int)len;
+}
+
+static int encode_payload(const Payload *p, int binary, char *out, size_t out_cap)
+{
+    return binary ? serialize_payload_binary(p, out, out_cap) : serialize_payload(p, out, out_cap);
+}
+
 /* ------------------------- parsing specs ------------------------- */
 
 static int parse_index_value_pair(const char *s, int *idx, char *val_buf, size_t val_sz)
@@ -921,19 +1976,172 @@ static int apply_texts_list_send(Payload *p, const IniStore *ini, const char *sp
 
 static int open_udp_socket(void) { return socket(AF_INET, SOCK_DGRAM, 0); }
 
-static int send_udp(int sock, const char *dest_ip, int port, const char *buf, size_t len)
+/* Resolved --dest list; every payload goes to all of them in one sendmmsg() */
+typedef struct {
+    struct sockaddr_in addr[MAX_DESTS];
+    int count;
+} DestList;
+
+/* Adds "ip" or "ip:port" (default_port when the port is omitted) */
+static int dest_list_add(DestList *dl, const char *spec, int default_port)
 {
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons((uint16_t)port);
-    if (inet_pton(AF_INET, dest_ip, &addr.sin_addr) != 1) {
-        fprintf(stderr, "Invalid IP address: %s\n", dest_ip);
-        return -1;
+    if (dl->count >= MAX_DESTS) {
+        fprintf(stderr, "Warning: too many destinations, ignoring %s\n", spec);
+        return 1;
+    }
+    char ip[64];
+    int port = default_port;
+    const char *colon = strchr(spec, ':');
+    size_t n = colon ? (size_t)(colon - spec) : strlen(spec);
+    if (n >= sizeof(ip)) n = sizeof(ip) - 1;
+    memcpy(ip, spec, n);
+    ip[n] = '\0';
+    if (colon) port = atoi(colon + 1);
+    if (port <= 0 || port > 65535) {
+        fprintf(stderr, "Error: invalid port in destination %s\n", spec);
+        return 0;
+    }
+
+    struct sockaddr_in *a = &dl->addr[dl->count];
+    memset(a, 0, sizeof(*a));
+    a->sin_family = AF_INET;
+    a->sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, ip, &a->sin_addr) != 1) {
+        fprintf(stderr, "Invalid IP address: %s\n", ip);
+        return 0;
+    }
+    dl->count++;
+    return 1;
+}
+
+static const char *dest_list_str(const DestList *dl, char *buf, size_t sz)
+{
+    int len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < dl->count; i++) {
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &dl->addr[i].sin_addr, ip, sizeof(ip));
+        if (!appendf(buf, sz, &len, "%s%s:%u", i ? "," : "", ip, (unsigned)ntohs(dl->addr[i].sin_port))) break;
     }
+    return buf;
+}
+
+/*
+ * One datagram to every destination with a single sendmmsg(). A destination
+ * that fails is skipped (logged once per call) so one dead route cannot
+ * starve the others; returns -1 only when nothing went out.
+ */
+static int send_udp_all(int sock, const DestList *dl, const char *buf, size_t len)
+{
+    struct mmsghdr msgs[MAX_DESTS];
+    struct iovec iov;
+    iov.iov_base = (void *)buf;
+    iov.iov_len = len;
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < dl->count; i++) {
+        msgs[i].msg_hdr.msg_name = (void *)&dl->addr[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(dl->addr[i]);
+        msgs[i].msg_hdr.msg_iov = &iov;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int delivered = 0;
+    int at = 0;
+    while (at < dl->count) {
+        int r = sendmmsg(sock, msgs + at, (unsigned int)(dl->count - at), 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 && errno == ENOSYS) {
+            for (; at < dl->count; at++) {
+                if (sendto(sock, buf, len, 0, (const struct sockaddr *)&dl->addr[at], sizeof(dl->addr[at])) >= 0) delivered++;
+            }
+            break;
+        }
+        if (r <= 0) {
+            /* msgs[at] failed: report it and carry on with the rest */
+            char ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &dl->addr[at].sin_addr, ip, sizeof(ip));
+            fprintf(stderr, "sendto %s:%u: %s\n", ip, (unsigned)ntohs(dl->addr[at].sin_port), strerror(errno));
+            at++;
+            continue;
+        }
+        delivered += r;
+        at += r;
+    }
+    return delivered > 0 ? 0 : -1;
+}
+
+/* ------------------------- shared memory ------------------------- */
+
+/* Map the segment the OSD created with "shm_transport": true */
+static osd_shm_t *shm_attach(void)
+{
+    int fd = open(OSD_SHM_PATH, O_RDWR);
+    if (fd < 0) {
+        fprintf(stderr, "Error: %s not available (%s); is shm_transport enabled on the OSD?\n", OSD_SHM_PATH, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(osd_shm_t)) {
+        fprintf(stderr, "Error: %s has an unexpected size\n", OSD_SHM_PATH);
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, sizeof(osd_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    osd_shm_t *shm = (osd_shm_t *)map;
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != OSD_SHM_MAGIC || shm->version != OSD_SHM_VERSION) {
+        fprintf(stderr, "Error: %s has an unknown layout\n", OSD_SHM_PATH);
+        munmap(map, sizeof(osd_shm_t));
+        return NULL;
+    }
+    return shm;
+}
+
+static void shm_detach(osd_shm_t *shm)
+{
+    if (shm) munmap(shm, sizeof(osd_shm_t));
+}
 
-    ssize_t sent = sendto(sock, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
-    return (sent < 0) ? -1 : 0;
+/* Same semantics as the UDP arrays: null/absent slots are left alone, "" clears */
+static int shm_write_payload(osd_shm_t *shm, const Payload *p)
+{
+    int written = 0;
+    for (int i = 0; i < 8 && i < OSD_SHM_VALUE_SLOTS; i++) {
+        if (p->values_state[i] != VS_NUM && p->values_state[i] != VS_EMPTY) continue;
+        osd_shm_value_t *slot = &shm->values[i];
+        uint32_t locked = osd_shm_write_begin(&slot->seq);
+        slot->value = (p->values_state[i] == VS_NUM) ? p->values[i] : 0.0;
+        osd_shm_write_end(&slot->seq, locked);
+        written++;
+    }
+    for (int i = 0; i < 8 && i < OSD_SHM_TEXT_SLOTS; i++) {
+        if (p->texts_state[i] != TS_STR) continue;
+        osd_shm_text_t *slot = &shm->texts[i];
+        size_t n = strlen(p->texts[i]);
+        if (n > OSD_SHM_TEXT_MAX) n = OSD_SHM_TEXT_MAX;
+        uint32_t locked = osd_shm_write_begin(&slot->seq);
+        memcpy(slot->text, p->texts[i], n);
+        slot->text[n] = '\0';
+        slot->len = (uint32_t)n;
+        osd_shm_write_end(&slot->seq, locked);
+        written++;
+    }
+    if (written == 0) return 0;
+
+    /* One byte wakes the OSD poll(); a full FIFO already has a wakeup pending */
+    int fd = open(OSD_SHM_WAKE_PATH, O_WRONLY | O_NONBLOCK);
+    if (fd >= 0) {
+        char b = 1;
+        ssize_t r = write(fd, &b, 1);
+        int err = errno;
+        close(fd);
+        if (r < 0 && err != EAGAIN) return -1;
+    }
+    return written;
 }
 
 /* ------------------------- usage ------------------------- */
@@ -946,21 +2154,35 @@ static void usage_main(const char *prog)
         "Usage:\n"
         "  %s send  [options]\n"
         "  %s watch [options]\n"
+        "  %s daemon --config <file>          (many watch specs, one process; see README)\n"
+        "  %s record --out <file> [options]   (capture datagrams; record --help)\n"
+        "  %s replay --in <file> [options]    (re-send a capture; replay --help)\n"
         "\n"
         "Options (send/watch):\n"
         "  --ini <file>              ini key=value file\n"
-        "  --dest <ip|@key>          destination IP (default: %s)\n"
+        "  --dest <ip[:port]|@key>   destination (default: %s); repeat for up to 8 destinations\n"
         "  --port <n|@key>           UDP port (default: %d)\n"
         "  --values \"i=v,...\"        set values (v: number | @key | null | empty => \"\")\n"
         "  --texts  \"i=s,...\"        set texts  (s: text   | @key | null | empty => \"\")\n"
         "  --hostapd <[iface,]sta>   pull hostapd STA stats via control socket (overrides ini keys)\n"
         "  --wpa-cli <iface>         pull wpa_supplicant signal_poll via control socket (overrides ini keys)\n"
         "  --8812eu <iface>          pull rtl88x2eu RSSI files (/proc/net/rtl88x2eu/<iface>/rssi_*)\n"
-        "  --print-json              (send) print JSON instead of sending\n"
+        "  --nl80211 <iface[,mac]>   pull nl80211 station stats (nl_signal, nl_chain0.., nl_tx_bitrate, ...)\n"
+        "  --binary                  send compact binary frames instead of JSON\n"
+        "  --shm                     write into the OSD shared-memory segment instead of UDP\n"
+        "  --ctrl-timeout <ms>       shared reply deadline for control sockets (send: 1000, watch: interval)\n"
+        "  --print-json              (send) print JSON (hex with --binary) instead of sending\n"
         "  --verbose, -v             extra debug output\n"
         "\n"
         "Watch-only:\n"
-        "  --interval <ms>           poll interval (default: %d)\n"
+        "  --interval <ms>           poll interval (default: %d); control-socket refresh with --inotify\n"
+        "  --inotify                 re-read INI files when inotify reports a change instead of polling\n"
+        "  --min-spacing <ms>        (--inotify) minimum gap between change-triggered sends\n"
+        "  --keepalive <ms>          resend the full state after <ms> without a change (default: off)\n"
+        "  --full-every <ms>         send the full state at least every <ms>, even while deltas flow (default: off)\n"
+        "  --exec <cmd>              run <cmd> once under sh and take key=value lines streamed on its stdout\n"
+        "  value transforms          --values \"i=@key|op|...\", ops: rate, scale:<k>, offset:<k>,\n"
+        "                            clamp:<lo>:<hi>, deadband:<d> (e.g. \"0=@nl_rx_packets|rate|deadband:5\")\n"
         "\n"
         "Backend semantics reminder:\n"
         "  - null entries are ignored (slot keeps previous)\n"
@@ -974,16 +2196,70 @@ static void usage_main(const char *prog)
         "    --texts  \"0=@used_source,1=@gs_string\"\n"
         "  %s watch --ini /tmp/aalink_ext.msg --dest 10.6.0.1 --port 7777 --interval 64 \\\n"
         "    --values \"0=@used_rssi,1=@mcs\" --texts \"0=@used_source\"\n",
-        prog, prog,
+        prog, prog, prog, prog, prog,
         DEFAULT_DEST_IP, DEFAULT_PORT, DEFAULT_INTERVAL,
         prog, prog, prog);
 }
 
 /* ------------------------- watch spec ------------------------- */
 
+/*
+ * A resolved @key reference: per source (0 = CLI store, 1.. = ini files) the
+ * kv position found last time and the store gen it was found under. While a
+ * store's gen is unchanged the cached position is reused without hashing.
+ */
+typedef struct {
+    const char *key;   /* NULL = not an @key reference */
+    uint32_t hash;
+    int pos[MAX_INI_PATHS + 1];
+    uint32_t gen[MAX_INI_PATHS + 1];
+    uint8_t cached[MAX_INI_PATHS + 1];
+} IniRef;
+
+static void iniref_bind(IniRef *ref, const char *rhs)
+{
+    memset(ref, 0, sizeof(*ref));
+    if (!rhs || rhs[0] != '@' || !rhs[1]) return;
+    ref->key = rhs + 1;
+    ref->hash = ini_hash(ref->key);
+}
+
+static const char *iniref_lookup_store(IniRef *ref, int src, const IniStore *ini)
+{
+    if (!ini->loaded) return NULL;
+    if (!ref->cached[src] || ref->gen[src] != ini->gen) {
+        ref->pos[src] = ini_find(ini, ref->key, ref->hash);
+        ref->gen[src] = ini->gen;
+        ref->cached[src] = 1;
+    }
+    return ini_value_at(ini, ref->pos[src]);
+}
+
+/*
+ * Per-slot value transform of watch/daemon, written after the source as
+ * "@key|op|op..." in --values. Stages run in a fixed order whatever the
+ * order written: rate (per second, from monotonic deltas of a counter),
+ * scale, offset, clamp. deadband then decides whether the result differs
+ * enough from the value last sent to count as a change.
+ */
+typedef struct {
+    int active;
+    int rate;
+    double scale;
+    double offset;
+    int clamp;
+    double lo;
+    double hi;
+    double deadband;    /* 0 = any change is sent */
+    double prev_raw;    /* rate: previous counter reading */
+    uint64_t prev_us;
+    int have_prev;
+} ValueXform;
+
 typedef struct {
     char *value_rhs[8];
     char *text_rhs[8];
+    ValueXform value_xf[8];
     int value_used[8];
     int text_used[8];
 
@@ -992,6 +2268,9 @@ typedef struct {
 
     TextState last_t_state[8];
     char last_t[8][MAX_TEXT_LEN + 1];
+
+    IniRef value_ref[8];
+    IniRef text_ref[8];
 } WatchSpec;
 
 static void watchspec_init(WatchSpec *w) { memset(w, 0, sizeof(*w)); }
@@ -1017,8 +2296,66 @@ typedef struct {
     time_t mtime;
     off_t size;
     ino_t inode;
+    int wd;             /* inotify watch on the parent directory, -1 = none */
+    const char *base;   /* file name inside that directory */
+    int dirty;          /* inotify reported a change since the last reload */
+    char *buf;          /* file image the store's values point into */
+    size_t buf_cap;
+    const IniFilter *want;  /* keys worth interning, NULL = all */
 } IniContext;
 
+/* pread()s the open file into the context's reusable buffer and parses it */
+static void ini_context_parse(IniContext *c)
+{
+    int fd = fileno(c->fp);
+    struct stat st;
+    size_t want = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) want = (size_t)st.st_size;
+    if (want + 1 > c->buf_cap) {
+        size_t cap = c->buf_cap ? c->buf_cap : 4096;
+        while (cap < want + 1) cap *= 2;
+        char *grown = realloc(c->buf, cap);
+        if (!grown) return;
+        c->buf = grown;
+        c->buf_cap = cap;
+    }
+    size_t got = 0;
+    while (got + 1 < c->buf_cap) {
+        ssize_t r = pread(fd, c->buf + got, c->buf_cap - 1 - got, (off_t)got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        got += (size_t)r;
+    }
+    c->buf[got] = '\0';
+    ini_begin_parse(&c->store);
+    ini_parse_buffer(&c->store, c->buf, c->want);
+}
+
+static void ini_context_free(IniContext *c)
+{
+    if (c->fp) fclose(c->fp);
+    c->fp = NULL;
+    free(c->buf);
+    c->buf = NULL;
+    c->buf_cap = 0;
+}
+
+/* Same precedence as lookup_from_sources, through the reference's cache */
+static const char *lookup_ref(IniRef *ref, const IniStore *cli, const IniContext *ctx, int ctx_count)
+{
+    if (!ref->key) return NULL;
+
+    const char *v = NULL;
+    if (cli) v = iniref_lookup_store(ref, 0, cli);
+    if (v) return v;
+
+    for (int i = ctx_count - 1; i >= 0; i--) {
+        v = iniref_lookup_store(ref, i + 1, &ctx[i].store);
+        if (v) return v;
+    }
+    return NULL;
+}
+
 static const char *lookup_from_sources(const IniStore *cli, const IniContext *ctx, int ctx_count, const char *key)
 {
     if (!key || !*key) return NULL;
@@ -1034,9 +2371,61 @@ static const char *lookup_from_sources(const IniStore *cli, const IniContext *ct
     return NULL;
 }
 
-static int parse_and_store_list_rhs(char **rhs_arr, int used_arr[8], const char *spec)
+/* Cuts "|op..." off rhs and parses it into xf; 0 on an unknown op */
+static int value_xform_parse(ValueXform *xf, char *rhs)
 {
-    if (!spec) return 0;
+    memset(xf, 0, sizeof(*xf));
+    xf->scale = 1.0;
+    char *bar = strchr(rhs, '|');
+    if (!bar) return 1;
+    *bar = '\0';
+    for (char *end = bar; end > rhs && isspace((unsigned char)end[-1]); end--) end[-1] = '\0';
+    xf->active = 1;
+
+    char *save = NULL;
+    for (char *op = strtok_r(bar + 1, "|", &save); op; op = strtok_r(NULL, "|", &save)) {
+        op = trim(op);
+        int ok = 1;
+        if (!strcmp(op, "rate")) xf->rate = 1;
+        else if (!strncmp(op, "scale:", 6)) ok = parse_double(op + 6, &xf->scale);
+        else if (!strncmp(op, "offset:", 7)) ok = parse_double(op + 7, &xf->offset);
+        else if (!strncmp(op, "clamp:", 6)) ok = xf->clamp = sscanf(op + 6, "%lf:%lf", &xf->lo, &xf->hi) == 2 && xf->lo <= xf->hi;
+        else if (!strncmp(op, "deadband:", 9)) ok = parse_double(op + 9, &xf->deadband) && xf->deadband >= 0.0;
+        else ok = 0;
+        if (!ok) {
+            fprintf(stderr, "Bad value transform: %s\n", op);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Runs a numeric reading through the transform. Returns VS_NULL while a rate
+ * has no earlier reading to difference against; a counter that went
+ * backwards (driver reload, wrap) restarts the rate the same way.
+ */
+static ValueState value_xform_apply(ValueXform *xf, double raw, double *out)
+{
+    double v = raw;
+    if (xf->rate) {
+        uint64_t now = mono_us();
+        int valid = xf->have_prev && raw >= xf->prev_raw && now > xf->prev_us;
+        if (valid) v = (raw - xf->prev_raw) * 1e6 / (double)(now - xf->prev_us);
+        xf->prev_raw = raw;
+        xf->prev_us = now;
+        xf->have_prev = 1;
+        if (!valid) return VS_NULL;
+    }
+    v = v * xf->scale + xf->offset;
+    if (xf->clamp) v = v < xf->lo ? xf->lo : (v > xf->hi ? xf->hi : v);
+    *out = v;
+    return VS_NUM;
+}
+
+static int parse_and_store_list_rhs(char **rhs_arr, int used_arr[8], ValueXform *xf, const char *spec)
+{
+    if (!spec) return 0;
 
     char buf[900];
     strncpy(buf, spec, sizeof(buf) - 1);
@@ -1053,6 +2442,7 @@ static int parse_and_store_list_rhs(char **rhs_arr, int used_arr[8], const char
             fprintf(stderr, "Bad list entry: %s\n", tok);
             return 0;
         }
+        if (xf && !value_xform_parse(&xf[idx], rhs)) return 0;
 
         free(rhs_arr[idx]);
         rhs_arr[idx] = xstrdup(rhs);
@@ -1069,21 +2459,219 @@ static int parse_and_store_list_rhs(char **rhs_arr, int used_arr[8], const char
  *  - numeric parse -> number
  */
 
+/* ------------------------- watch sources ------------------------- */
+
+/* Re-open/re-parse one watched file, following replacement and removal */
+static void watch_reload_file(IniContext *c, int i, int verbose)
+{
+    struct stat st;
+    /* Check if file on disk changed (external modification/move) */
+    if (stat(c->path, &st) == 0) {
+        int changed = 0;
+        /* If file exists but we have no handle, open it */
+        if (!c->fp) {
+            c->fp = fopen(c->path, "r");
+            if (c->fp) {
+                changed = 1;
+                if (verbose) fprintf(stderr, "[watch] file %d (%s) appeared, loading...\n", i, c->path);
+            }
+        } else {
+            /* Handle has inode? */
+            if (st.st_ino != c->inode) {
+                /* File replaced (mv) */
+                if (verbose) fprintf(stderr, "[watch] file %d (%s) replaced, reloading...\n", i, c->path);
+                fclose(c->fp);
+                c->fp = fopen(c->path, "r");
+                changed = 1;
+            }
+        }
+
+        /* Force changed=1 if file present, to support fast updates (poor mtime resolution) */
+        if (c->fp) changed = 1;
+
+        if (changed && c->fp) {
+            /* Re-read and re-parse unconditionally; unchanged keys keep their slots */
+            ini_context_parse(c);
+
+            /* Refresh stats for inode check */
+            if (fstat(fileno(c->fp), &st) == 0) {
+                 c->mtime = st.st_mtime;
+                 c->size = st.st_size;
+                 c->inode = st.st_ino;
+            }
+        }
+    } else {
+        /* File missing */
+        if (c->fp) {
+            if (verbose) fprintf(stderr, "[watch] file %d (%s) gone, clearing...\n", i, c->path);
+            fclose(c->fp);
+            c->fp = NULL;
+            ini_reset(&c->store);
+            c->mtime = 0;
+            c->size = 0;
+            c->inode = 0;
+        }
+    }
+}
+
+/*
+ * inotify watches the parent directory of every INI path rather than the
+ * file, so writers that replace the file by rename (new inode) and files that
+ * appear later are both seen. Returns the inotify fd or -1.
+ */
+static int watch_notify_init(IniContext *ctx, int ctx_count, int verbose)
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return -1;
+    int watched = 0;
+    for (int i = 0; i < ctx_count; i++) {
+        char dir[512];
+        const char *slash = strrchr(ctx[i].path, '/');
+        if (!slash) {
+            snprintf(dir, sizeof(dir), ".");
+            ctx[i].base = ctx[i].path;
+        } else {
+            size_t n = (size_t)(slash - ctx[i].path);
+            if (n == 0) n = 1;  /* file directly under / */
+            if (n >= sizeof(dir)) n = sizeof(dir) - 1;
+            memcpy(dir, ctx[i].path, n);
+            dir[n] = '\0';
+            ctx[i].base = slash + 1;
+        }
+        ctx[i].wd = inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+        if (ctx[i].wd < 0) {
+            fprintf(stderr, "[watch] inotify on %s failed: %s\n", dir, strerror(errno));
+            continue;
+        }
+        watched++;
+        if (verbose) fprintf(stderr, "[watch] inotify %s for %s\n", dir, ctx[i].base);
+    }
+    if (watched == 0 && ctx_count > 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Marks the files named by queued events dirty; returns how many matched */
+static int watch_notify_drain(int fd, IniContext *ctx, int ctx_count)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int hits = 0;
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (char *p = buf; p < buf + n;) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(*ev) + ev->len;
+            for (int i = 0; i < ctx_count; i++) {
+                if (ev->mask & IN_Q_OVERFLOW) {
+                    ctx[i].dirty = 1;
+                    hits++;
+                } else if (ev->wd == ctx[i].wd && ev->len && !strcmp(ev->name, ctx[i].base)) {
+                    ctx[i].dirty = 1;
+                    hits++;
+                }
+            }
+        }
+    }
+    return hits;
+}
+
+/*
+ * Sleeps until a watched file changes, the --exec child writes (exec_fd,
+ * -1 = none) or deadline_ms passes (control-socket refresh, keepalive or
+ * child restart; 0 = none). A change within min_spacing_ms of the last
+ * send waits out the rest of the spacing, folding further edits in.
+ */
+static void watch_wait_events(int fd, int exec_fd, IniContext *ctx, int ctx_count, uint64_t deadline_ms,
+                              uint64_t last_send_ms, int min_spacing_ms, int verbose)
+{
+    for (;;) {
+        int timeout = -1;
+        uint64_t now = mono_ms();
+        if (deadline_ms) {
+            if (now >= deadline_ms) return;
+            timeout = (int)(deadline_ms - now);
+        }
+        struct pollfd pfd[2] = {{fd, POLLIN, 0}, {exec_fd, POLLIN, 0}};
+        int r = poll(pfd, exec_fd >= 0 ? 2 : 1, timeout);
+        if (r < 0 && errno != EINTR) return;
+        if (r <= 0) continue;
+        int hits = pfd[0].revents ? watch_notify_drain(fd, ctx, ctx_count) : 0;
+        if (hits == 0 && !(exec_fd >= 0 && pfd[1].revents)) continue;
+        break;
+    }
+
+    uint64_t now = mono_ms();
+    uint64_t earliest = last_send_ms + (uint64_t)(min_spacing_ms > 0 ? min_spacing_ms : 0);
+    if (now < earliest) {
+        if (verbose) fprintf(stderr, "[watch] change held %llu ms for --min-spacing\n", (unsigned long long)(earliest - now));
+        usleep((useconds_t)((earliest - now) * 1000));
+        watch_notify_drain(fd, ctx, ctx_count);
+    }
+}
+
+/*
+ * Polling cadence: an absolute CLOCK_MONOTONIC timerfd, so the period does
+ * not stretch by the time a pass spends collecting sources. Returns -1 when
+ * timerfd is unavailable (the caller falls back to usleep).
+ */
+static int watch_tick_init(int interval_ms)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (fd < 0) return -1;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_sec = interval_ms / 1000;
+    its.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    its.it_value.tv_sec = now.tv_sec + its.it_interval.tv_sec;
+    its.it_value.tv_nsec = now.tv_nsec + its.it_interval.tv_nsec;
+    if (its.it_value.tv_nsec >= 1000000000L) {
+        its.it_value.tv_sec++;
+        its.it_value.tv_nsec -= 1000000000L;
+    }
+    if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Blocks until the next tick; returns how many ticks elapsed (>1 = overrun) */
+static uint64_t watch_tick_wait(int fd)
+{
+    uint64_t ticks = 0;
+    for (;;) {
+        ssize_t r = read(fd, &ticks, sizeof(ticks));
+        if (r == (ssize_t)sizeof(ticks)) return ticks;
+        if (r < 0 && errno == EINTR) continue;
+        return 1;
+    }
+}
+
 /* ------------------------- SEND ------------------------- */
 
 static int cmd_send(int argc, char **argv, const char *prog)
 {
-    const char *dest_raw = NULL;
+    const char *dest_raws[MAX_DESTS];
+    int dest_count = 0;
     const char *port_raw = NULL;
     const char *ini_paths[MAX_INI_PATHS];
     int ini_count = 0;
     const char *values_spec = NULL;
     const char *texts_spec = NULL;
     int print_json = 0;
+    int binary = 0;
+    int use_shm = 0;
+    int ctrl_timeout_ms = 0;
     int verbose = 0;
     const char *hostapd_opt = NULL;
     const char *wpa_iface = NULL;
     const char *rtl8812_iface = NULL;
+    const char *nl_spec = NULL;
     char hostapd_iface[64] = {0};
     char hostapd_sta[64] = {0};
 
@@ -1104,7 +2692,11 @@ static int cmd_send(int argc, char **argv, const char *prog)
         {"hostapd", required_argument, 0, 11},
         {"wpa-cli", required_argument, 0, 12},
         {"8812eu", required_argument, 0, 13},
+        {"nl80211", required_argument, 0, 21},
         {"print-json", no_argument, 0, 9},
+        {"binary", no_argument, 0, 14},
+        {"shm", no_argument, 0, 15},
+        {"ctrl-timeout", required_argument, 0, 18},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0,0,0,0}
@@ -1138,7 +2730,10 @@ static int cmd_send(int argc, char **argv, const char *prog)
     idx = 0;
     while ((opt = getopt_long(argc, argv, "hv", opts, &idx)) != -1) {
         switch (opt) {
-        case 1: dest_raw = optarg; break;
+        case 1:
+            if (dest_count < MAX_DESTS) dest_raws[dest_count++] = optarg;
+            else fprintf(stderr, "Warning: too many destinations, ignoring %s\n", optarg);
+            break;
         case 2: port_raw = optarg; break;
         case 3: /* already handled */ break;
         case 5: values_spec = optarg; break;
@@ -1146,7 +2741,11 @@ static int cmd_send(int argc, char **argv, const char *prog)
         case 11: hostapd_opt = optarg; break;
         case 12: wpa_iface = optarg; break;
         case 13: rtl8812_iface = optarg; break;
+        case 21: nl_spec = optarg; break;
         case 9: print_json = 1; break;
+        case 14: binary = 1; break;
+        case 15: use_shm = 1; break;
+        case 18: ctrl_timeout_ms = atoi(optarg); break;
         case 'v': verbose = 1; break;
         case 'h':
         default:
@@ -1156,27 +2755,11 @@ static int cmd_send(int argc, char **argv, const char *prog)
     }
 
     parse_hostapd_opt(hostapd_opt, hostapd_iface, sizeof(hostapd_iface), hostapd_sta, sizeof(hostapd_sta));
-    refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, verbose);
+    if (ctrl_timeout_ms <= 0) ctrl_timeout_ms = 1000;
+    refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, nl_spec, ctrl_timeout_ms, verbose);
     ini_merge(&ini, &cli_store);
 
-    if (!dest_raw) dest_raw = DEFAULT_DEST_IP;
-
-    char dest[64];
-    if (dest_raw[0] == '@') {
-        const char *v = ini_get(&ini, dest_raw + 1);
-        if (!v || !*v) {
-            /* default if missing */
-            strncpy(dest, DEFAULT_DEST_IP, sizeof(dest) - 1);
-            dest[sizeof(dest) - 1] = '\0';
-            if (verbose) fprintf(stderr, "[send] --dest %s missing => default %s\n", dest_raw, dest);
-        } else {
-            strncpy(dest, v, sizeof(dest) - 1);
-            dest[sizeof(dest) - 1] = '\0';
-        }
-    } else {
-        strncpy(dest, dest_raw, sizeof(dest) - 1);
-        dest[sizeof(dest) - 1] = '\0';
-    }
+    if (dest_count == 0) dest_raws[dest_count++] = DEFAULT_DEST_IP;
 
     int port = DEFAULT_PORT;
     if (port_raw) {
@@ -1194,6 +2777,22 @@ static int cmd_send(int argc, char **argv, const char *prog)
         return 1;
     }
 
+    DestList dests;
+    dests.count = 0;
+    for (int i = 0; i < dest_count; i++) {
+        const char *d = dest_raws[i];
+        if (d[0] == '@') {
+            const char *v = ini_get(&ini, d + 1);
+            if (!v || !*v) {
+                /* default if missing */
+                if (verbose) fprintf(stderr, "[send] --dest %s missing => default %s\n", d, DEFAULT_DEST_IP);
+                v = DEFAULT_DEST_IP;
+            }
+            d = v;
+        }
+        if (!dest_list_add(&dests, d, port)) return 1;
+    }
+
     if (values_spec) {
         if (!apply_values_list_send(&payload, &ini, values_spec, verbose)) return 1;
     }
@@ -1201,8 +2800,21 @@ static int cmd_send(int argc, char **argv, const char *prog)
         if (!apply_texts_list_send(&payload, &ini, texts_spec, verbose)) return 1;
     }
 
+    if (use_shm && !print_json) {
+        osd_shm_t *shm = shm_attach();
+        if (!shm) return 1;
+        int n = shm_write_payload(shm, &payload);
+        shm_detach(shm);
+        if (n < 0) {
+            perror("shm wake");
+            return 1;
+        }
+        if (verbose) fprintf(stderr, "[send] shm slots=%d\n", n);
+        return 0;
+    }
+
     char out[BUILD_BUF];
-    int out_len = serialize_payload(&payload, out, sizeof(out));
+    int out_len = encode_payload(&payload, binary, out, sizeof(out));
     if (out_len == -2) {
         fprintf(stderr, "Error: payload exceeds %d bytes\n", MAX_PAYLOAD);
         return 1;
@@ -1212,18 +2824,25 @@ static int cmd_send(int argc, char **argv, const char *prog)
         return 1;
     }
 
-    if (verbose) fprintf(stderr, "[send] dst=%s:%d len=%d json=%s\n", dest, port, out_len, out);
+    if (verbose) {
+        char dbuf[MAX_DESTS * 24];
+        fprintf(stderr, "[send] dst=%s len=%d json=%s\n", dest_list_str(&dests, dbuf, sizeof(dbuf)), out_len, binary ? "<binary>" : out);
+    }
 
     if (print_json) {
-        printf("%s\n", out);
+        if (binary) {
+            for (int i = 0; i < out_len; i++) printf("%02x", (unsigned char)out[i]);
+            printf("\n");
+        } else {
+            printf("%s\n", out);
+        }
         return 0;
     }
 
     int sock = open_udp_socket();
     if (sock < 0) { perror("socket"); return 1; }
 
-    if (send_udp(sock, dest, port, out, (size_t)out_len) < 0) {
-        perror("sendto");
+    if (send_udp_all(sock, &dests, out, (size_t)out_len) < 0) {
         close(sock);
         return 1;
     }
@@ -1234,17 +2853,156 @@ static int cmd_send(int argc, char **argv, const char *prog)
 
 /* ------------------------- WATCH ------------------------- */
 
+/*
+ * Resolves every watched slot against the sources and records it in
+ * w->last_*. With baseline set every slot goes into pb; otherwise only slots
+ * whose state or value changed. Returns 1 if pb got anything.
+ */
+static int watch_resolve_pass(WatchSpec *w, const IniStore *cli, const IniContext *ctx, int ctx_count,
+                              Payload *pb, int baseline, int verbose)
+{
+    int any_changed = 0;
+    for (int i = 0; i < 8; i++) {
+        if (w->value_used[i] && w->value_rhs[i]) {
+            double dv = 0.0;
+            ValueState st = VS_NULL;
+            const char *rhs = w->value_rhs[i];
+            if (is_literal_null(rhs)) st = VS_NULL;
+            else if (rhs[0] == '\0') st = VS_EMPTY;
+            else if (rhs[0] == '@') {
+                const char *found = lookup_ref(&w->value_ref[i], cli, ctx, ctx_count);
+                if (!found) {
+                    if (verbose) fprintf(stderr, "[watch] values[%d] missing %s => null\n", i, rhs);
+                    st = VS_NULL;
+                } else if (found[0] == '\0') {
+                    st = VS_EMPTY;
+                } else if (is_literal_null(found)) {
+                    st = VS_NULL;
+                } else if (parse_double(found, &dv)) {
+                    st = VS_NUM;
+                } else {
+                    if (verbose && baseline) fprintf(stderr, "[watch] values[%d] non-numeric '%s' from %s => null\n", i, found, rhs);
+                    st = VS_NULL;
+                }
+            } else {
+                if (parse_double(rhs, &dv)) st = VS_NUM;
+            }
+            ValueXform *xf = &w->value_xf[i];
+            if (xf->active) {
+                if (st == VS_NUM) st = value_xform_apply(xf, dv, &dv);
+                else xf->have_prev = 0;
+            }
+
+            int changed = baseline;
+            if (st != w->last_v_state[i]) changed = 1;
+            else if (st == VS_NUM && dv != w->last_v[i]) {
+                double d = dv - w->last_v[i];
+                /* hysteresis: small moves accumulate until they add up to the deadband */
+                changed = !xf->active || (d < 0.0 ? -d : d) >= xf->deadband;
+            }
+
+            if (changed) {
+                if (verbose && !baseline) {
+                    if (st == VS_NUM) fprintf(stderr, "[watch] change values[%d]=%.3f\n", i, dv);
+                    else if (st == VS_EMPTY) fprintf(stderr, "[watch] change values[%d]=\"\" (clear)\n", i);
+                    else fprintf(stderr, "[watch] change values[%d]=null (ignore)\n", i);
+                }
+
+                w->last_v_state[i] = st;
+                if (st == VS_NUM) { w->last_v[i] = dv; set_value_num(pb, i, dv); }
+                else if (st == VS_EMPTY) { set_value_empty(pb, i); }
+                else { set_value_null(pb, i); }
+                any_changed = 1;
+            }
+        }
+
+        if (w->text_used[i] && w->text_rhs[i]) {
+            char t[MAX_TEXT_LEN + 1];
+            t[0] = '\0';
+            TextState st = TS_NULL;
+            const char *rhs = w->text_rhs[i];
+            if (is_literal_null(rhs)) st = TS_NULL;
+            else if (rhs[0] == '\0') st = TS_STR;
+            else if (rhs[0] == '@') {
+                const char *found = lookup_ref(&w->text_ref[i], cli, ctx, ctx_count);
+                if (!found) {
+                    if (verbose) fprintf(stderr, "[watch] texts[%d] missing %s => null\n", i, rhs);
+                    st = TS_NULL;
+                } else if (is_literal_null(found)) {
+                    st = TS_NULL;
+                } else {
+                    clamp_textN(found, t, MAX_TEXT_LEN + 1);
+                    st = TS_STR;
+                }
+            } else {
+                clamp_textN(rhs, t, MAX_TEXT_LEN + 1);
+                st = TS_STR;
+            }
+
+            int changed = baseline;
+            if (st != w->last_t_state[i]) changed = 1;
+            else if (st == TS_STR && strcmp(t, w->last_t[i]) != 0) changed = 1;
+
+            if (changed) {
+                if (verbose && !baseline) {
+                    if (st == TS_STR) fprintf(stderr, "[watch] change texts[%d]=\"%s\"\n", i, t);
+                    else fprintf(stderr, "[watch] change texts[%d]=null (ignore)\n", i);
+                }
+
+                w->last_t_state[i] = st;
+                if (st == TS_STR) {
+                    strncpy(w->last_t[i], t, MAX_TEXT_LEN);
+                    w->last_t[i][MAX_TEXT_LEN] = '\0';
+                    set_text_str(pb, i, t);
+                } else {
+                    w->last_t[i][0] = '\0';
+                    set_text_null(pb, i);
+                }
+                any_changed = 1;
+            }
+        }
+    }
+    return any_changed;
+}
+
+/* Rebuilds every watched slot from the last resolved state (keepalive) */
+static void watch_full_payload(WatchSpec *w, Payload *pb)
+{
+    payload_init(pb);
+    for (int i = 0; i < 8; i++) {
+        if (w->value_used[i] && w->value_rhs[i]) {
+            if (w->last_v_state[i] == VS_NUM) set_value_num(pb, i, w->last_v[i]);
+            else if (w->last_v_state[i] == VS_EMPTY) set_value_empty(pb, i);
+            else set_value_null(pb, i);
+        }
+        if (w->text_used[i] && w->text_rhs[i]) {
+            if (w->last_t_state[i] == TS_STR) set_text_str(pb, i, w->last_t[i]);
+            else set_text_null(pb, i);
+        }
+    }
+}
+
 static int cmd_watch(int argc, char **argv, const char *prog)
 {
-    const char *dest_raw = NULL;
+    const char *dest_raws[MAX_DESTS];
+    int dest_count = 0;
     const char *port_raw = NULL;
     const char *ini_paths[MAX_INI_PATHS];
     int ini_count = 0;
     int interval_ms = DEFAULT_INTERVAL;
+    int binary = 0;
+    int use_shm = 0;
+    int ctrl_timeout_ms = 0;
+    int use_inotify = 0;
+    int min_spacing_ms = 0;
+    int keepalive_ms = 0;
+    int full_every_ms = 0;
     int verbose = 0;
     const char *hostapd_opt = NULL;
     const char *wpa_iface = NULL;
     const char *rtl8812_iface = NULL;
+    const char *nl_spec = NULL;
+    const char *exec_cmd = NULL;
     char hostapd_iface[64] = {0};
     char hostapd_sta[64] = {0};
     IniStore cli_store;
@@ -1263,6 +3021,15 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         {"hostapd", required_argument, 0, 11},
         {"wpa-cli", required_argument, 0, 12},
         {"8812eu", required_argument, 0, 13},
+        {"nl80211", required_argument, 0, 21},
+        {"exec", required_argument, 0, 22},
+        {"binary", no_argument, 0, 14},
+        {"shm", no_argument, 0, 15},
+        {"inotify", no_argument, 0, 16},
+        {"min-spacing", required_argument, 0, 17},
+        {"ctrl-timeout", required_argument, 0, 18},
+        {"keepalive", required_argument, 0, 19},
+        {"full-every", required_argument, 0, 20},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0,0,0,0}
@@ -1272,7 +3039,10 @@ static int cmd_watch(int argc, char **argv, const char *prog)
     int opt, idx = 0;
     while ((opt = getopt_long(argc, argv, "hv", opts, &idx)) != -1) {
         switch (opt) {
-        case 1: dest_raw = optarg; break;
+        case 1:
+            if (dest_count < MAX_DESTS) dest_raws[dest_count++] = optarg;
+            else fprintf(stderr, "Warning: too many destinations, ignoring %s\n", optarg);
+            break;
         case 2: port_raw = optarg; break;
         case 3:
             if (ini_count < MAX_INI_PATHS) {
@@ -1282,10 +3052,10 @@ static int cmd_watch(int argc, char **argv, const char *prog)
             }
             break;
         case 5:
-            if (!parse_and_store_list_rhs(w.value_rhs, w.value_used, optarg)) { watchspec_free(&w); return 1; }
+            if (!parse_and_store_list_rhs(w.value_rhs, w.value_used, w.value_xf, optarg)) { watchspec_free(&w); return 1; }
             break;
         case 7:
-            if (!parse_and_store_list_rhs(w.text_rhs, w.text_used, optarg)) { watchspec_free(&w); return 1; }
+            if (!parse_and_store_list_rhs(w.text_rhs, w.text_used, NULL, optarg)) { watchspec_free(&w); return 1; }
             break;
         case 10:
             interval_ms = atoi(optarg);
@@ -1299,6 +3069,33 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         case 13:
             rtl8812_iface = optarg;
             break;
+        case 21:
+            nl_spec = optarg;
+            break;
+        case 22:
+            exec_cmd = optarg;
+            break;
+        case 14:
+            binary = 1;
+            break;
+        case 15:
+            use_shm = 1;
+            break;
+        case 16:
+            use_inotify = 1;
+            break;
+        case 17:
+            min_spacing_ms = atoi(optarg);
+            break;
+        case 18:
+            ctrl_timeout_ms = atoi(optarg);
+            break;
+        case 19:
+            keepalive_ms = atoi(optarg);
+            break;
+        case 20:
+            full_every_ms = atoi(optarg);
+            break;
         case 'v':
             verbose = 1;
             break;
@@ -1311,6 +3108,13 @@ static int cmd_watch(int argc, char **argv, const char *prog)
     }
 
     if (interval_ms < 5) interval_ms = 5;
+    /* A wedged daemon may hold up a pass by at most one interval (20..1000 ms) */
+    if (ctrl_timeout_ms <= 0) ctrl_timeout_ms = interval_ms < 20 ? 20 : (interval_ms > 1000 ? 1000 : interval_ms);
+
+    for (int i = 0; i < 8; i++) {
+        iniref_bind(&w.value_ref[i], w.value_used[i] ? w.value_rhs[i] : NULL);
+        iniref_bind(&w.text_ref[i], w.text_used[i] ? w.text_rhs[i] : NULL);
+    }
 
     if (!watchspec_any(&w)) {
         fprintf(stderr, "Error: watch needs at least one --values or --texts\n");
@@ -1319,15 +3123,17 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         return 1;
     }
 
-    int has_cli_source = (hostapd_opt && *hostapd_opt) || (wpa_iface && *wpa_iface) || (rtl8812_iface && *rtl8812_iface);
-    if (ini_count == 0 && !has_cli_source) {
-        fprintf(stderr, "Error: at least one --ini, --hostapd, or --wpa-cli must be specified\n");
+    int has_cli_source = (hostapd_opt && *hostapd_opt) || (wpa_iface && *wpa_iface) || (rtl8812_iface && *rtl8812_iface) ||
+                         (nl_spec && *nl_spec);
+    int has_exec = exec_cmd && *exec_cmd;
+    if (ini_count == 0 && !has_cli_source && !has_exec) {
+        fprintf(stderr, "Error: at least one --ini, --hostapd, --wpa-cli or --exec must be specified\n");
         usage_main(prog);
         watchspec_free(&w);
         return 1;
     }
 
-    if (!dest_raw) dest_raw = DEFAULT_DEST_IP;
+    if (dest_count == 0) dest_raws[dest_count++] = DEFAULT_DEST_IP;
 
     IniContext *ctx = NULL;
     if (ini_count > 0) {
@@ -1339,16 +3145,28 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         }
     }
 
+    /* Only the keys this watch can ever look up are interned from the files */
+    static IniFilter want;
+    memset(&want, 0, sizeof(want));
+    for (int i = 0; i < 8; i++) {
+        if (w.value_used[i]) ini_filter_add(&want, w.value_rhs[i]);
+        if (w.text_used[i]) ini_filter_add(&want, w.text_rhs[i]);
+    }
+    for (int i = 0; i < dest_count; i++) ini_filter_add(&want, dest_raws[i]);
+    ini_filter_add(&want, port_raw);
+
     /* Initial load of all files */
     int have_ini0 = 0;
     for (int i = 0; i < ini_count; i++) {
         ctx[i].path = ini_paths[i];
+        ctx[i].wd = -1;
+        ctx[i].want = &want;
         ini_init(&ctx[i].store);
 
         /* Open and parse */
         ctx[i].fp = fopen(ctx[i].path, "r");
         if (ctx[i].fp) {
-            ini_parse_stream(&ctx[i].store, ctx[i].fp);
+            ini_context_parse(&ctx[i]);
             have_ini0 = 1;
 
             struct stat st;
@@ -1363,25 +3181,8 @@ static int cmd_watch(int argc, char **argv, const char *prog)
     }
 
     parse_hostapd_opt(hostapd_opt, hostapd_iface, sizeof(hostapd_iface), hostapd_sta, sizeof(hostapd_sta));
-    refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, verbose);
-
-    char dest[64];
-    if (dest_raw[0] == '@') {
-        const char *k = dest_raw + 1;
-        const char *found = lookup_from_sources(&cli_store, ctx, ini_count, k);
-
-        if (!found || !*found) {
-            strncpy(dest, DEFAULT_DEST_IP, sizeof(dest) - 1);
-            dest[sizeof(dest) - 1] = '\0';
-            if (verbose) fprintf(stderr, "[watch] --dest %s missing => default %s\n", dest_raw, dest);
-        } else {
-            strncpy(dest, found, sizeof(dest) - 1);
-            dest[sizeof(dest) - 1] = '\0';
-        }
-    } else {
-        strncpy(dest, dest_raw, sizeof(dest) - 1);
-        dest[sizeof(dest) - 1] = '\0';
-    }
+    refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, nl_spec, ctrl_timeout_ms, verbose);
+    if (has_exec) exec_source_start(exec_cmd, verbose);
 
     int port = DEFAULT_PORT;
     if (port_raw) {
@@ -1417,18 +3218,50 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         return 1;
     }
 
-    int sock = open_udp_socket();
-    if (sock < 0) {
+    DestList dests;
+    dests.count = 0;
+    for (int i = 0; i < dest_count; i++) {
+        const char *d = dest_raws[i];
+        if (d[0] == '@') {
+            const char *found = lookup_from_sources(&cli_store, ctx, ini_count, d + 1);
+            if (!found || !*found) {
+                if (verbose) fprintf(stderr, "[watch] --dest %s missing => default %s\n", d, DEFAULT_DEST_IP);
+                found = DEFAULT_DEST_IP;
+            }
+            d = found;
+        }
+        if (!dest_list_add(&dests, d, port)) {
+            watchspec_free(&w);
+            for (int j = 0; j < ini_count; j++) ini_context_free(&ctx[j]);
+            free(ctx);
+            return 1;
+        }
+    }
+
+    osd_shm_t *shm = NULL;
+    if (use_shm) {
+        shm = shm_attach();
+        if (!shm) {
+            watchspec_free(&w);
+            for (int i=0; i<ini_count; i++) ini_context_free(&ctx[i]);
+            free(ctx);
+            return 1;
+        }
+    }
+
+    int sock = shm ? -1 : open_udp_socket();
+    if (!shm && sock < 0) {
         perror("socket");
         watchspec_free(&w);
         /* Cleanup contexts including open files */
-        for (int i=0; i<ini_count; i++) if (ctx[i].fp) fclose(ctx[i].fp);
+        for (int i=0; i<ini_count; i++) ini_context_free(&ctx[i]);
         free(ctx);
         return 1;
     }
 
     if (verbose) {
-        fprintf(stderr, "[watch] start dst=%s:%d ini=%d files interval=%dms\n", dest, port, ini_count, interval_ms);
+        char dbuf[MAX_DESTS * 24];
+        fprintf(stderr, "[watch] start dst=%s ini=%d files interval=%dms\n", dest_list_str(&dests, dbuf, sizeof(dbuf)), ini_count, interval_ms);
     }
 
     /* baseline send */
@@ -1439,284 +3272,898 @@ static int cmd_watch(int argc, char **argv, const char *prog)
         if (verbose && ini_count > 0 && !have_ini0) fprintf(stderr, "[watch] baseline: ini unreadable -> all watched @keys treated as null\n");
         if (verbose && ini_count == 0 && has_cli_source) fprintf(stderr, "[watch] baseline: using control-socket data only (no ini files)\n");
 
-        /* We must duplicate the logic here or make a helper. Inline for now. */
-        for (int i = 0; i < 8; i++) {
-            if (w.value_used[i] && w.value_rhs[i]) {
-                double dv = 0.0;
-                /* Manual resolve loop for baseline */
-                ValueState st = VS_NULL;
-                const char *rhs = w.value_rhs[i];
-                /* Copied resolve logic */
-                if (!rhs) st = VS_NULL;
-                else if (is_literal_null(rhs)) st = VS_NULL;
-                else if (rhs[0] == '\0') st = VS_EMPTY;
-                else if (rhs[0] == '@') {
-                    const char *k = rhs + 1;
-                    const char *found = lookup_from_sources(&cli_store, ctx, ini_count, k);
-                    if (!found) {
-                        if (verbose) fprintf(stderr, "[watch] values[%d] missing %s => null\n", i, rhs);
-                        st = VS_NULL;
-                    } else if (found[0] == '\0') {
-                        st = VS_EMPTY;
-                    } else if (is_literal_null(found)) {
-                        st = VS_NULL;
-                    } else {
-                        if (parse_double(found, &dv)) st = VS_NUM;
-                        else {
-                            if (verbose) fprintf(stderr, "[watch] values[%d] non-numeric '%s' from %s => null\n", i, found, rhs);
-                            st = VS_NULL;
-                        }
-                    }
-                } else {
-                    if (parse_double(rhs, &dv)) st = VS_NUM;
-                }
+        (void)watch_resolve_pass(&w, &cli_store, ctx, ini_count, &pb, 1, verbose);
 
-                w.last_v_state[i] = st;
-                if (st == VS_NUM) { w.last_v[i] = dv; set_value_num(&pb, i, dv); }
-                else if (st == VS_EMPTY) { set_value_empty(&pb, i); }
-                else { set_value_null(&pb, i); }
+        if (shm) {
+            int n = shm_write_payload(shm, &pb);
+            if (verbose) fprintf(stderr, "[watch] baseline shm slots=%d\n", n);
+        } else {
+            char out[BUILD_BUF];
+            int out_len = encode_payload(&pb, binary, out, sizeof(out));
+            if (out_len < 0) {
+                fprintf(stderr, "Error: baseline payload build failed\n");
+                close(sock);
+                watchspec_free(&w);
+                for (int i=0; i<ini_count; i++) ini_context_free(&ctx[i]);
+                free(ctx);
+                return 1;
             }
-            if (w.text_used[i] && w.text_rhs[i]) {
-                char t[MAX_TEXT_LEN + 1];
-                TextState st = TS_NULL;
-                const char *rhs = w.text_rhs[i];
-                if (!rhs) st = TS_NULL;
-                else if (is_literal_null(rhs)) st = TS_NULL;
-                else if (rhs[0] == '\0') { t[0]='\0'; st = TS_STR; }
-                else if (rhs[0] == '@') {
-                    const char *k = rhs + 1;
-                    const char *found = lookup_from_sources(&cli_store, ctx, ini_count, k);
-                    if (!found) {
-                        if (verbose) fprintf(stderr, "[watch] texts[%d] missing %s => null\n", i, rhs);
-                        st = TS_NULL;
-                    } else if (is_literal_null(found)) {
-                        st = TS_NULL;
-                    } else {
-                        clamp_textN(found, t, MAX_TEXT_LEN + 1);
-                        st = TS_STR;
-                    }
-                } else {
-                    clamp_textN(rhs, t, MAX_TEXT_LEN + 1);
-                    st = TS_STR;
+
+            if (verbose) fprintf(stderr, "[watch] baseline send len=%d json=%s\n", out_len, binary ? "<binary>" : out);
+
+            if (send_udp_all(sock, &dests, out, (size_t)out_len) < 0) {
+                fprintf(stderr, "[watch] baseline send failed\n");
+                close(sock);
+                watchspec_free(&w);
+                for (int i=0; i<ini_count; i++) ini_context_free(&ctx[i]);
+                free(ctx);
+                return 1;
+            }
+        }
+    }
+
+    int notify_fd = use_inotify ? watch_notify_init(ctx, ini_count, verbose) : -1;
+    uint64_t cli_due_ms = 0;  /* refresh control sources on the first pass */
+    uint64_t last_send_ms = mono_ms();
+    if (use_inotify && notify_fd < 0) fprintf(stderr, "[watch] inotify unavailable, polling every %d ms\n", interval_ms);
+    int tick_fd = notify_fd < 0 ? watch_tick_init(interval_ms) : -1;
+    uint64_t overrun_ticks = 0;
+    uint64_t last_full_ms = last_send_ms;  /* the baseline is a full state */
+    uint64_t overrun_report_ms = 0;
+
+    /* poll loop */
+    for (;;) {
+        uint64_t pass_start_ms = mono_ms();
+        for (int i = 0; i < ini_count; i++) {
+            if (notify_fd >= 0 && !ctx[i].dirty) continue;
+            ctx[i].dirty = 0;
+            watch_reload_file(&ctx[i], i, verbose);
+        }
+
+        uint64_t now_ms = mono_ms();
+        if (notify_fd < 0 || now_ms >= cli_due_ms) {
+            refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, nl_spec, ctrl_timeout_ms, verbose);
+            cli_due_ms = now_ms + (uint64_t)interval_ms;
+        }
+        exec_source_poll(&cli_store, verbose);
+
+        Payload pb;
+        payload_init(&pb);
+
+        int any_changed = watch_resolve_pass(&w, &cli_store, ctx, ini_count, &pb, 0, verbose);
+
+        uint64_t send_ms = mono_ms();
+        if (!any_changed && keepalive_ms > 0 && send_ms - last_send_ms >= (uint64_t)keepalive_ms) {
+            /* Idle: repeat the full state so a lost datagram heals within one keepalive */
+            watch_full_payload(&w, &pb);
+            any_changed = 1;
+            last_full_ms = send_ms;
+            if (verbose) fprintf(stderr, "[watch] keepalive\n");
+        } else if (full_every_ms > 0 && send_ms - last_full_ms >= (uint64_t)full_every_ms) {
+            /* Busy slots keep sending deltas; fold in the slots a lost delta left stale */
+            watch_full_payload(&w, &pb);
+            any_changed = 1;
+            last_full_ms = send_ms;
+            if (verbose) fprintf(stderr, "[watch] full-state refresh\n");
+        }
+
+        if (any_changed && shm) {
+            if (shm_write_payload(shm, &pb) < 0) perror("shm wake(watch)");
+            else if (verbose) fprintf(stderr, "[watch] shm update\n");
+        } else if (any_changed) {
+            char out[BUILD_BUF];
+            int out_len = encode_payload(&pb, binary, out, sizeof(out));
+            if (out_len == -2) {
+                fprintf(stderr, "[watch] payload exceeds %d bytes, skipping\n", MAX_PAYLOAD);
+            } else if (out_len < 0) {
+                fprintf(stderr, "[watch] failed to serialize payload\n");
+            } else {
+                if (verbose) fprintf(stderr, "[watch] send len=%d json=%s\n", out_len, binary ? "<binary>" : out);
+                if (send_udp_all(sock, &dests, out, (size_t)out_len) < 0) {
+                    fprintf(stderr, "[watch] send failed on every destination\n");
+                    break;
                 }
+            }
+        }
+        if (any_changed) last_send_ms = mono_ms();
 
-                w.last_t_state[i] = st;
-                if (st == TS_STR) {
-                    strncpy(w.last_t[i], t, MAX_TEXT_LEN);
-                    w.last_t[i][MAX_TEXT_LEN] = '\0';
-                    set_text_str(&pb, i, t);
-                } else {
-                    w.last_t[i][0] = '\0';
-                    set_text_null(&pb, i);
+        if (notify_fd < 0) {
+            if (tick_fd < 0) {
+                usleep((useconds_t)interval_ms * 1000);
+                continue;
+            }
+            uint64_t ticks = watch_tick_wait(tick_fd);
+            if (ticks > 1) {
+                overrun_ticks += ticks - 1;
+                uint64_t now = mono_ms();
+                if (now - overrun_report_ms >= 1000) {
+                    fprintf(stderr, "[watch] overrun: pass took %llu ms, %llu tick(s) of %d ms skipped so far\n",
+                            (unsigned long long)(now - pass_start_ms), (unsigned long long)overrun_ticks, interval_ms);
+                    overrun_report_ms = now;
                 }
             }
+            continue;
         }
+        uint64_t deadline_ms = has_cli_source ? cli_due_ms : 0;
+        if (keepalive_ms > 0) {
+            uint64_t ka = last_send_ms + (uint64_t)keepalive_ms;
+            if (!deadline_ms || ka < deadline_ms) deadline_ms = ka;
+        }
+        uint64_t respawn_ms = exec_source_deadline();
+        if (respawn_ms && (!deadline_ms || respawn_ms < deadline_ms)) deadline_ms = respawn_ms;
+        watch_wait_events(notify_fd, exec_source_fd(), ctx, ini_count, deadline_ms, last_send_ms, min_spacing_ms, verbose);
+    }
 
-        char out[BUILD_BUF];
-        int out_len = serialize_payload(&pb, out, sizeof(out));
-        if (out_len < 0) {
-            fprintf(stderr, "Error: baseline payload build failed\n");
-            close(sock);
-            watchspec_free(&w);
-            for (int i=0; i<ini_count; i++) if (ctx[i].fp) fclose(ctx[i].fp);
-            free(ctx);
-            return 1;
+    if (sock >= 0) close(sock);
+    if (tick_fd >= 0) close(tick_fd);
+    if (notify_fd >= 0) close(notify_fd);
+    exec_source_stop();
+    shm_detach(shm);
+    watchspec_free(&w);
+    for (int i=0; i<ini_count; i++) ini_context_free(&ctx[i]);
+    free(ctx);
+    return 0;
+}
+
+/* ------------------------- DAEMON ------------------------- */
+
+/*
+ * daemon --config <file>: several watch specs in one process. INI files and
+ * control-socket sources are declared once at the top of the file and
+ * collected once per wakeup for every spec that is due; each spec keeps its
+ * own slots, destinations, interval and keepalive. One timerfd, armed at the
+ * earliest spec deadline, drives the whole loop.
+ *
+ *   ini = /tmp/radio.ini          (shared sources, before any section)
+ *   hostapd = wlan0,aa:bb:cc:dd:ee:ff
+ *   [air]                         (one section per spec)
+ *   dest = 127.0.0.1:7777
+ *   values = 0=@signal,1=@mcs
+ *   interval = 64
+ */
+#define MAX_DAEMON_SPECS 16
+
+typedef struct {
+    char name[32];
+    WatchSpec w;
+    const char *dest_raws[MAX_DESTS];
+    int dest_count;
+    const char *port_raw;
+    DestList dests;
+    int interval_ms;
+    int keepalive_ms;
+    int full_every_ms;
+    int binary;
+    uint64_t due_ms;
+    uint64_t last_send_ms;
+    uint64_t last_full_ms;
+    uint64_t overruns;
+    uint64_t overrun_report_ms;
+} DaemonSpec;
+
+typedef struct {
+    const char *ini_paths[MAX_INI_PATHS];
+    int ini_count;
+    const char *hostapd_opt;
+    const char *wpa_iface;
+    const char *rtl8812_iface;
+    const char *nl_spec;
+    const char *exec_cmd;
+    int ctrl_timeout_ms;
+    DaemonSpec *specs[MAX_DAEMON_SPECS];
+    int spec_count;
+    char *strings;     /* the config file text; every const char * above points into it */
+} DaemonConfig;
+
+static void daemon_config_free(DaemonConfig *dc)
+{
+    for (int i = 0; i < dc->spec_count; i++) {
+        watchspec_free(&dc->specs[i]->w);
+        free(dc->specs[i]);
+    }
+    free(dc->strings);
+}
+
+static int daemon_config_key(DaemonConfig *dc, DaemonSpec *sp, const char *path, int line, char *k, char *v)
+{
+    if (!sp) {
+        if (!strcmp(k, "ini")) {
+            if (dc->ini_count < MAX_INI_PATHS) dc->ini_paths[dc->ini_count++] = v;
+            else fprintf(stderr, "Warning: too many ini files, ignoring %s\n", v);
+        } else if (!strcmp(k, "hostapd")) {
+            dc->hostapd_opt = v;
+        } else if (!strcmp(k, "wpa-cli")) {
+            dc->wpa_iface = v;
+        } else if (!strcmp(k, "8812eu")) {
+            dc->rtl8812_iface = v;
+        } else if (!strcmp(k, "nl80211")) {
+            dc->nl_spec = v;
+        } else if (!strcmp(k, "exec")) {
+            dc->exec_cmd = v;
+        } else if (!strcmp(k, "ctrl-timeout")) {
+            dc->ctrl_timeout_ms = atoi(v);
+        } else {
+            fprintf(stderr, "%s:%d: unknown shared key '%s'\n", path, line, k);
+            return 0;
         }
+        return 1;
+    }
 
-        if (verbose) fprintf(stderr, "[watch] baseline send len=%d json=%s\n", out_len, out);
+    if (!strcmp(k, "dest")) {
+        if (sp->dest_count < MAX_DESTS) sp->dest_raws[sp->dest_count++] = v;
+        else fprintf(stderr, "Warning: too many destinations, ignoring %s\n", v);
+    } else if (!strcmp(k, "port")) {
+        sp->port_raw = v;
+    } else if (!strcmp(k, "values")) {
+        if (!parse_and_store_list_rhs(sp->w.value_rhs, sp->w.value_used, sp->w.value_xf, v)) return 0;
+    } else if (!strcmp(k, "texts")) {
+        if (!parse_and_store_list_rhs(sp->w.text_rhs, sp->w.text_used, NULL, v)) return 0;
+    } else if (!strcmp(k, "interval")) {
+        sp->interval_ms = atoi(v);
+    } else if (!strcmp(k, "keepalive")) {
+        sp->keepalive_ms = atoi(v);
+    } else if (!strcmp(k, "full-every")) {
+        sp->full_every_ms = atoi(v);
+    } else if (!strcmp(k, "binary")) {
+        sp->binary = atoi(v) != 0;
+    } else {
+        fprintf(stderr, "%s:%d: unknown key '%s' in [%s]\n", path, line, k, sp->name);
+        return 0;
+    }
+    return 1;
+}
 
-        if (send_udp(sock, dest, port, out, (size_t)out_len) < 0) {
-            perror("sendto(baseline)");
-            close(sock);
-            watchspec_free(&w);
-            for (int i=0; i<ini_count; i++) if (ctx[i].fp) fclose(ctx[i].fp);
-            free(ctx);
-            return 1;
+static int daemon_config_load(DaemonConfig *dc, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    rewind(f);
+    if (sz < 0 || sz > 1024 * 1024) {
+        fclose(f);
+        fprintf(stderr, "Error: %s is not a usable config\n", path);
+        return 0;
+    }
+    dc->strings = malloc((size_t)sz + 1);
+    if (!dc->strings) {
+        fclose(f);
+        return 0;
+    }
+    size_t got = fread(dc->strings, 1, (size_t)sz, f);
+    fclose(f);
+    dc->strings[got] = '\0';
+
+    DaemonSpec *sp = NULL;
+    int line = 0;
+    for (char *p = dc->strings; p && *p;) {
+        char *nl = strchr(p, '\n');
+        if (nl) *nl = '\0';
+        line++;
+        char *t = trim(p);
+        p = nl ? nl + 1 : NULL;
+        if (!*t || *t == '#' || *t == ';') continue;
+
+        if (*t == '[') {
+            char *end = strchr(t, ']');
+            if (!end) {
+                fprintf(stderr, "%s:%d: unterminated section\n", path, line);
+                return 0;
+            }
+            if (dc->spec_count >= MAX_DAEMON_SPECS) {
+                fprintf(stderr, "%s:%d: more than %d specs\n", path, line, MAX_DAEMON_SPECS);
+                return 0;
+            }
+            *end = '\0';
+            sp = calloc(1, sizeof(*sp));
+            if (!sp) return 0;
+            watchspec_init(&sp->w);
+            snprintf(sp->name, sizeof(sp->name), "%s", trim(t + 1));
+            sp->interval_ms = DEFAULT_INTERVAL;
+            dc->specs[dc->spec_count++] = sp;
+            continue;
+        }
+
+        char *eq = strchr(t, '=');
+        if (!eq) {
+            fprintf(stderr, "%s:%d: expected key = value\n", path, line);
+            return 0;
         }
+        *eq = '\0';
+        if (!daemon_config_key(dc, sp, path, line, trim(t), trim(eq + 1))) return 0;
     }
+    return 1;
+}
 
-    /* poll loop */
-    for (;;) {
-        for (int i = 0; i < ini_count; i++) {
-            struct stat st;
-            /* Check if file on disk changed (external modification/move) */
-            if (stat(ctx[i].path, &st) == 0) {
-                int changed = 0;
-                /* If file exists but we have no handle, open it */
-                if (!ctx[i].fp) {
-                    ctx[i].fp = fopen(ctx[i].path, "r");
-                    if (ctx[i].fp) {
-                        changed = 1;
-                        if (verbose) fprintf(stderr, "[watch] file %d (%s) appeared, loading...\n", i, ctx[i].path);
-                    }
-                } else {
-                    /* Handle has inode? */
-                    if (st.st_ino != ctx[i].inode) {
-                        /* File replaced (mv) */
-                        if (verbose) fprintf(stderr, "[watch] file %d (%s) replaced, reloading...\n", i, ctx[i].path);
-                        fclose(ctx[i].fp);
-                        ctx[i].fp = fopen(ctx[i].path, "r");
-                        changed = 1;
-                    }
-                }
+/* Absolute CLOCK_MONOTONIC ms -> one-shot timerfd expiry */
+static void daemon_arm(int fd, uint64_t due_ms)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(due_ms / 1000);
+    its.it_value.tv_nsec = (long)(due_ms % 1000) * 1000000L;
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+    timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
 
-                /* Force changed=1 if file present, to support fast updates (poor mtime resolution) */
-                if (ctx[i].fp) changed = 1;
-
-                if (changed && ctx[i].fp) {
-                    /* Rewind and re-parse unconditionally */
-                    rewind(ctx[i].fp);
-                    ini_init(&ctx[i].store);
-                    ini_parse_stream(&ctx[i].store, ctx[i].fp);
-
-                    /* Refresh stats for inode check */
-                    if (fstat(fileno(ctx[i].fp), &st) == 0) {
-                         ctx[i].mtime = st.st_mtime;
-                         ctx[i].size = st.st_size;
-                         ctx[i].inode = st.st_ino;
-                    }
-                }
-            } else {
-                /* File missing */
-                if (ctx[i].fp) {
-                    if (verbose) fprintf(stderr, "[watch] file %d (%s) gone, clearing...\n", i, ctx[i].path);
-                    fclose(ctx[i].fp);
-                    ctx[i].fp = NULL;
-                    ini_init(&ctx[i].store);
-                    ctx[i].mtime = 0;
-                    ctx[i].size = 0;
-                    ctx[i].inode = 0;
+static void daemon_send(DaemonSpec *sp, int sock, Payload *pb, int verbose)
+{
+    char out[BUILD_BUF];
+    int out_len = encode_payload(pb, sp->binary, out, sizeof(out));
+    if (out_len == -2) {
+        fprintf(stderr, "[daemon] %s: payload exceeds %d bytes, skipping\n", sp->name, MAX_PAYLOAD);
+        return;
+    }
+    if (out_len < 0) {
+        fprintf(stderr, "[daemon] %s: failed to serialize payload\n", sp->name);
+        return;
+    }
+    if (verbose) fprintf(stderr, "[daemon] %s: send len=%d json=%s\n", sp->name, out_len, sp->binary ? "<binary>" : out);
+    if (send_udp_all(sock, &sp->dests, out, (size_t)out_len) < 0) {
+        fprintf(stderr, "[daemon] %s: send failed on every destination\n", sp->name);
+    }
+}
+
+/* One pass of a due spec: deltas, keepalive and full-state refresh as in watch */
+static void daemon_pass(DaemonSpec *sp, int sock, const IniStore *cli, const IniContext *ctx, int ctx_count,
+                        uint64_t now, int verbose)
+{
+    Payload pb;
+    payload_init(&pb);
+    int send = watch_resolve_pass(&sp->w, cli, ctx, ctx_count, &pb, 0, verbose);
+    if (!send && sp->keepalive_ms > 0 && now - sp->last_send_ms >= (uint64_t)sp->keepalive_ms) {
+        watch_full_payload(&sp->w, &pb);
+        send = 1;
+        sp->last_full_ms = now;
+    } else if (sp->full_every_ms > 0 && now - sp->last_full_ms >= (uint64_t)sp->full_every_ms) {
+        watch_full_payload(&sp->w, &pb);
+        send = 1;
+        sp->last_full_ms = now;
+    }
+    if (!send) return;
+    daemon_send(sp, sock, &pb, verbose);
+    sp->last_send_ms = now;
+}
+
+/* Resolves ports/destinations, sends the baselines, then runs the shared loop */
+static int daemon_run(DaemonConfig *dc, IniContext *ctx, IniStore *cli, const char *hostapd_iface,
+                      const char *hostapd_sta, int verbose)
+{
+    int min_interval = 1000;
+    for (int s = 0; s < dc->spec_count; s++) {
+        DaemonSpec *sp = dc->specs[s];
+        if (sp->interval_ms < 5) sp->interval_ms = 5;
+        if (sp->interval_ms < min_interval) min_interval = sp->interval_ms;
+    }
+    if (dc->ctrl_timeout_ms <= 0) dc->ctrl_timeout_ms = min_interval < 20 ? 20 : min_interval;
+    refresh_cli_store(cli, hostapd_iface, hostapd_sta, dc->wpa_iface, dc->rtl8812_iface, dc->nl_spec, dc->ctrl_timeout_ms, verbose);
+    exec_source_start(dc->exec_cmd, verbose);
+
+    for (int s = 0; s < dc->spec_count; s++) {
+        DaemonSpec *sp = dc->specs[s];
+        if (!watchspec_any(&sp->w)) {
+            fprintf(stderr, "Error: [%s] needs values or texts\n", sp->name);
+            return 1;
+        }
+        for (int i = 0; i < 8; i++) {
+            iniref_bind(&sp->w.value_ref[i], sp->w.value_used[i] ? sp->w.value_rhs[i] : NULL);
+            iniref_bind(&sp->w.text_ref[i], sp->w.text_used[i] ? sp->w.text_rhs[i] : NULL);
+        }
+
+        int port = DEFAULT_PORT;
+        if (sp->port_raw) {
+            const char *v = sp->port_raw;
+            if (v[0] == '@') v = lookup_from_sources(cli, ctx, dc->ini_count, v + 1);
+            if (v) port = atoi(v);
+            else if (verbose) fprintf(stderr, "[daemon] %s: port %s missing => default %d\n", sp->name, sp->port_raw, port);
+        }
+        if (port <= 0 || port > 65535) {
+            fprintf(stderr, "Error: [%s] invalid port\n", sp->name);
+            return 1;
+        }
+        if (sp->dest_count == 0) sp->dest_raws[sp->dest_count++] = DEFAULT_DEST_IP;
+        for (int i = 0; i < sp->dest_count; i++) {
+            const char *d = sp->dest_raws[i];
+            if (d[0] == '@') {
+                const char *found = lookup_from_sources(cli, ctx, dc->ini_count, d + 1);
+                if (!found || !*found) {
+                    if (verbose) fprintf(stderr, "[daemon] %s: dest %s missing => default %s\n", sp->name, d, DEFAULT_DEST_IP);
+                    found = DEFAULT_DEST_IP;
                 }
+                d = found;
             }
+            if (!dest_list_add(&sp->dests, d, port)) return 1;
         }
+    }
 
-        refresh_cli_store(&cli_store, hostapd_iface, hostapd_sta, wpa_iface, rtl8812_iface, verbose);
+    int sock = open_udp_socket();
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    int tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tick_fd < 0) {
+        perror("timerfd_create");
+        close(sock);
+        return 1;
+    }
 
-        int any_changed = 0;
+    uint64_t now = mono_ms();
+    for (int s = 0; s < dc->spec_count; s++) {
+        DaemonSpec *sp = dc->specs[s];
         Payload pb;
         payload_init(&pb);
+        (void)watch_resolve_pass(&sp->w, cli, ctx, dc->ini_count, &pb, 1, verbose);
+        daemon_send(sp, sock, &pb, verbose);
+        sp->last_send_ms = now;
+        sp->last_full_ms = now;
+        sp->due_ms = now + (uint64_t)sp->interval_ms;
+        if (verbose) {
+            char dbuf[MAX_DESTS * 24];
+            fprintf(stderr, "[daemon] %s: dst=%s interval=%dms\n", sp->name, dest_list_str(&sp->dests, dbuf, sizeof(dbuf)), sp->interval_ms);
+        }
+    }
 
-        for (int i = 0; i < 8; i++) {
-            if (w.value_used[i] && w.value_rhs[i]) {
-                double dv = 0.0;
-                /* Inline resolve logic again since we can't use helper easily with ctx array */
-                ValueState st = VS_NULL;
-                const char *rhs = w.value_rhs[i];
-                if (!rhs) st = VS_NULL;
-                else if (is_literal_null(rhs)) st = VS_NULL;
-                else if (rhs[0] == '\0') st = VS_EMPTY;
-                else if (rhs[0] == '@') {
-                    const char *k = rhs + 1;
-                    const char *found = lookup_from_sources(&cli_store, ctx, ini_count, k);
-                    if (!found) {
-                        /* Keep silent if missing, or verbose? Previous log had verbose */
-                         if (verbose) fprintf(stderr, "[watch] values[%d] missing %s => null\n", i, rhs);
-                        st = VS_NULL;
-                    } else if (found[0] == '\0') {
-                        st = VS_EMPTY;
-                    } else if (is_literal_null(found)) {
-                        st = VS_NULL;
-                    } else {
-                        if (parse_double(found, &dv)) st = VS_NUM;
-                        else st = VS_NULL;
-                    }
-                } else {
-                    if (parse_double(rhs, &dv)) st = VS_NUM;
-                }
+    for (;;) {
+        uint64_t next = dc->specs[0]->due_ms;
+        for (int s = 1; s < dc->spec_count; s++) {
+            if (dc->specs[s]->due_ms < next) next = dc->specs[s]->due_ms;
+        }
+        daemon_arm(tick_fd, next);
+        uint64_t ticks;
+        if (read(tick_fd, &ticks, sizeof(ticks)) < 0 && errno != EINTR) {
+            perror("read(timerfd)");
+            break;
+        }
 
-                int changed = 0;
-                if (st != w.last_v_state[i]) changed = 1;
-                else if (st == VS_NUM && dv != w.last_v[i]) changed = 1;
-
-                if (changed) {
-                    if (verbose) {
-                        if (st == VS_NUM) fprintf(stderr, "[watch] change values[%d]=%.3f\n", i, dv);
-                        else if (st == VS_EMPTY) fprintf(stderr, "[watch] change values[%d]=\"\" (clear)\n", i);
-                        else fprintf(stderr, "[watch] change values[%d]=null (ignore)\n", i);
-                    }
-
-                    w.last_v_state[i] = st;
-                    if (st == VS_NUM) { w.last_v[i] = dv; set_value_num(&pb, i, dv); }
-                    else if (st == VS_EMPTY) { set_value_empty(&pb, i); }
-                    else { set_value_null(&pb, i); }
-                    any_changed = 1;
+        /* Sources are collected once for every spec due at this wakeup */
+        now = mono_ms();
+        int collected = 0;
+        for (int s = 0; s < dc->spec_count; s++) {
+            DaemonSpec *sp = dc->specs[s];
+            if (now < sp->due_ms) continue;
+            if (!collected) {
+                for (int i = 0; i < dc->ini_count; i++) watch_reload_file(&ctx[i], i, verbose);
+                refresh_cli_store(cli, hostapd_iface, hostapd_sta, dc->wpa_iface, dc->rtl8812_iface, dc->nl_spec, dc->ctrl_timeout_ms, verbose);
+                exec_source_poll(cli, verbose);
+                collected = 1;
+            }
+            daemon_pass(sp, sock, cli, ctx, dc->ini_count, now, verbose);
+
+            sp->due_ms += (uint64_t)sp->interval_ms;
+            uint64_t after = mono_ms();
+            if (sp->due_ms <= after) {
+                /* Overran: keep the phase, skip the ticks already missed */
+                uint64_t missed = (after - sp->due_ms) / (uint64_t)sp->interval_ms + 1;
+                sp->due_ms += missed * (uint64_t)sp->interval_ms;
+                sp->overruns += missed;
+                if (after - sp->overrun_report_ms >= 1000) {
+                    fprintf(stderr, "[daemon] %s: overrun, %llu tick(s) of %d ms skipped so far\n",
+                            sp->name, (unsigned long long)sp->overruns, sp->interval_ms);
+                    sp->overrun_report_ms = after;
                 }
             }
+        }
+    }
 
-            if (w.text_used[i] && w.text_rhs[i]) {
-                char t[MAX_TEXT_LEN + 1];
-                TextState st = TS_NULL;
-                const char *rhs = w.text_rhs[i];
-                if (!rhs) st = TS_NULL;
-                else if (is_literal_null(rhs)) st = TS_NULL;
-                else if (rhs[0] == '\0') { t[0]='\0'; st = TS_STR; }
-                else if (rhs[0] == '@') {
-                    const char *k = rhs + 1;
-                    const char *found = lookup_from_sources(&cli_store, ctx, ini_count, k);
-                    if (!found) {
-                        if (verbose) fprintf(stderr, "[watch] texts[%d] missing %s => null\n", i, rhs);
-                        st = TS_NULL;
-                    } else if (is_literal_null(found)) {
-                        st = TS_NULL;
-                    } else {
-                        clamp_textN(found, t, MAX_TEXT_LEN + 1);
-                        st = TS_STR;
-                    }
-                } else {
-                    clamp_textN(rhs, t, MAX_TEXT_LEN + 1);
-                    st = TS_STR;
-                }
+    exec_source_stop();
+    close(tick_fd);
+    close(sock);
+    return 1;
+}
 
-                int changed = 0;
-                if (st != w.last_t_state[i]) changed = 1;
-                else if (st == TS_STR && strcmp(t, w.last_t[i]) != 0) changed = 1;
-
-                if (changed) {
-                    if (verbose) {
-                        if (st == TS_STR) fprintf(stderr, "[watch] change texts[%d]=\"%s\"\n", i, t);
-                        else fprintf(stderr, "[watch] change texts[%d]=null (ignore)\n", i);
-                    }
-
-                    w.last_t_state[i] = st;
-                    if (st == TS_STR) {
-                        strncpy(w.last_t[i], t, MAX_TEXT_LEN);
-                        w.last_t[i][MAX_TEXT_LEN] = '\0';
-                        set_text_str(&pb, i, t);
-                    } else {
-                        w.last_t[i][0] = '\0';
-                        set_text_null(&pb, i);
-                    }
-                    any_changed = 1;
-                }
-            }
+static int cmd_daemon(int argc, char **argv, const char *prog)
+{
+    const char *config_path = NULL;
+    int verbose = 0;
+
+    static struct option opts[] = {
+        {"config", required_argument, 0, 1},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+
+    optind = 1;
+    int opt, idx = 0;
+    while ((opt = getopt_long(argc, argv, "hv", opts, &idx)) != -1) {
+        switch (opt) {
+        case 1:
+            config_path = optarg;
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        case 'h':
+        default:
+            usage_main(prog);
+            return (opt == 'h') ? 0 : 1;
         }
+    }
+    if (!config_path) {
+        fprintf(stderr, "Error: daemon needs --config <file>\n");
+        return 1;
+    }
 
-        if (any_changed) {
-            char out[BUILD_BUF];
-            int out_len = serialize_payload(&pb, out, sizeof(out));
-            if (out_len == -2) {
-                fprintf(stderr, "[watch] payload exceeds %d bytes, skipping\n", MAX_PAYLOAD);
-            } else if (out_len < 0) {
-                fprintf(stderr, "[watch] failed to serialize payload\n");
-            } else {
-                if (verbose) fprintf(stderr, "[watch] send len=%d json=%s\n", out_len, out);
-                if (send_udp(sock, dest, port, out, (size_t)out_len) < 0) {
-                    perror("sendto(watch)");
-                    break;
-                }
-            }
+    static DaemonConfig dc;
+    memset(&dc, 0, sizeof(dc));
+    if (!daemon_config_load(&dc, config_path)) {
+        daemon_config_free(&dc);
+        return 1;
+    }
+    if (dc.spec_count == 0) {
+        fprintf(stderr, "Error: %s defines no [spec] sections\n", config_path);
+        daemon_config_free(&dc);
+        return 1;
+    }
+
+    IniContext *ctx = NULL;
+    if (dc.ini_count > 0) {
+        ctx = (IniContext *)calloc((size_t)dc.ini_count, sizeof(IniContext));
+        if (!ctx) {
+            perror("calloc");
+            daemon_config_free(&dc);
+            return 1;
+        }
+    }
+    static IniFilter want;
+    memset(&want, 0, sizeof(want));
+    for (int s = 0; s < dc.spec_count; s++) {
+        DaemonSpec *sp = dc.specs[s];
+        for (int i = 0; i < 8; i++) {
+            if (sp->w.value_used[i]) ini_filter_add(&want, sp->w.value_rhs[i]);
+            if (sp->w.text_used[i]) ini_filter_add(&want, sp->w.text_rhs[i]);
         }
+        for (int i = 0; i < sp->dest_count; i++) ini_filter_add(&want, sp->dest_raws[i]);
+        ini_filter_add(&want, sp->port_raw);
+    }
+    for (int i = 0; i < dc.ini_count; i++) {
+        ctx[i].path = dc.ini_paths[i];
+        ctx[i].wd = -1;
+        ctx[i].want = &want;
+        ini_init(&ctx[i].store);
+        watch_reload_file(&ctx[i], i, verbose);
+    }
+
+    char hostapd_iface[64] = {0};
+    char hostapd_sta[64] = {0};
+    parse_hostapd_opt(dc.hostapd_opt, hostapd_iface, sizeof(hostapd_iface), hostapd_sta, sizeof(hostapd_sta));
+    static IniStore cli_store;
+    ini_init(&cli_store);
+
+    int rc = daemon_run(&dc, ctx, &cli_store, hostapd_iface, hostapd_sta, verbose);
+
+    for (int i = 0; i < dc.ini_count; i++) ini_context_free(&ctx[i]);
+    free(ctx);
+    daemon_config_free(&dc);
+    return rc;
+}
+
+/* ------------------------- RECORD / REPLAY ------------------------- */
+
+/*
+ * Capture file: an 8-byte header ("WBRC", u16 version, u16 reserved) followed
+ * by one record per datagram. Integers are little-endian:
+ *   u32 delta_us (since the previous record, saturating), u32 src IPv4,
+ *   u16 src port (both as on the wire), u16 length, then the payload bytes.
+ */
+#define CAPTURE_MAGIC      "WBRC"
+#define CAPTURE_VERSION    1
+#define CAPTURE_HDR_LEN    8
+#define CAPTURE_REC_LEN    12
+#define REPLAY_MAX_SOURCES 16
+
+static volatile sig_atomic_t g_capture_stop = 0;
+
+static void capture_handle_stop(int sig)
+{
+    (void)sig;
+    g_capture_stop = 1;
+}
+
+static void put_le16(uint8_t *p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put_le32(uint8_t *p, uint32_t v) { put_le16(p, v); put_le16(p + 2, v >> 16); }
+static uint32_t get_le16(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t get_le32(const uint8_t *p) { return get_le16(p) | (get_le16(p + 2) << 16); }
+
+static void usage_record(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s record --out <file> [--port <n>] [--bind <ip>] [--count <n>] [--duration <s>] [-v]\n"
+        "  Listens on UDP (default 0.0.0.0:%d; stop the OSD or point senders at another port)\n"
+        "  and logs every datagram with its monotonic arrival time until SIGINT/SIGTERM,\n"
+        "  --count datagrams or --duration seconds.\n",
+        prog, DEFAULT_PORT);
+}
+
+static void usage_replay(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s replay --in <file> [--dest <ip[:port]>] [--port <n>] [--speed <x> | --max] [--loop <n>] [--single-source] [-v]\n"
+        "  Re-sends a capture to %s:%d by default. --speed scales the original gaps (2 = twice as fast),\n"
+        "  --max sends back to back, --loop repeats (0 = forever). Each original sender gets its own\n"
+        "  socket (up to %d) so the OSD sees the same sender mix; --single-source uses one.\n",
+        prog, DEFAULT_DEST_IP, DEFAULT_PORT, REPLAY_MAX_SOURCES);
+}
 
-        usleep((useconds_t)interval_ms * 1000);
+static int cmd_record(int argc, char **argv, const char *prog)
+{
+    const char *out_path = NULL;
+    const char *bind_ip = "0.0.0.0";
+    int port = DEFAULT_PORT;
+    long max_count = 0;
+    int duration_s = 0;
+    int verbose = 0;
+
+    static struct option opts[] = {
+        {"out", required_argument, 0, 1},
+        {"port", required_argument, 0, 2},
+        {"bind", required_argument, 0, 3},
+        {"count", required_argument, 0, 4},
+        {"duration", required_argument, 0, 5},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+
+    optind = 1;
+    int opt, idx = 0;
+    while ((opt = getopt_long(argc, argv, "hv", opts, &idx)) != -1) {
+        switch (opt) {
+        case 1: out_path = optarg; break;
+        case 2: port = atoi(optarg); break;
+        case 3: bind_ip = optarg; break;
+        case 4: max_count = atol(optarg); break;
+        case 5: duration_s = atoi(optarg); break;
+        case 'v': verbose = 1; break;
+        case 'h':
+        default:
+            usage_record(prog);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!out_path || port <= 0 || port > 65535) {
+        usage_record(prog);
+        return 1;
     }
 
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, bind_ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid IP address: %s\n", bind_ip);
+        return 1;
+    }
+    int sock = open_udp_socket();
+    if (sock < 0) { perror("socket"); return 1; }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "bind %s:%d: %s\n", bind_ip, port, strerror(errno));
+        close(sock);
+        return 1;
+    }
+
+    FILE *fp = fopen(out_path, "wb");
+    if (!fp) {
+        fprintf(stderr, "open %s: %s\n", out_path, strerror(errno));
+        close(sock);
+        return 1;
+    }
+    uint8_t hdr[CAPTURE_HDR_LEN];
+    memcpy(hdr, CAPTURE_MAGIC, 4);
+    put_le16(hdr + 4, CAPTURE_VERSION);
+    put_le16(hdr + 6, 0);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = capture_handle_stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    uint64_t start = mono_us();
+    uint64_t last = start;
+    long count = 0;
+    uint64_t bytes = 0;
+    char buf[65536];
+    while (!g_capture_stop && (max_count <= 0 || count < max_count)) {
+        int timeout = 250;
+        if (duration_s > 0) {
+            uint64_t end = start + (uint64_t)duration_s * 1000000ULL;
+            uint64_t now = mono_us();
+            if (now >= end) break;
+            if ((end - now) / 1000 < (uint64_t)timeout) timeout = (int)((end - now) / 1000) + 1;
+        }
+        struct pollfd pfd = {sock, POLLIN, 0};
+        if (poll(&pfd, 1, timeout) <= 0) continue;
+
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t r = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len);
+        if (r < 0) continue;
+        uint64_t now = mono_us();
+        uint64_t delta = now - last;
+        last = now;
+
+        uint8_t rec[CAPTURE_REC_LEN];
+        put_le32(rec, delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta);
+        memcpy(rec + 4, &from.sin_addr.s_addr, 4);
+        memcpy(rec + 8, &from.sin_port, 2);
+        put_le16(rec + 10, (uint32_t)r);
+        if (fwrite(rec, 1, sizeof(rec), fp) != sizeof(rec) || fwrite(buf, 1, (size_t)r, fp) != (size_t)r) {
+            perror("write");
+            break;
+        }
+        count++;
+        bytes += (uint64_t)r;
+        if (verbose) {
+            char ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &from.sin_addr, ip, sizeof(ip));
+            fprintf(stderr, "[record] +%lluus %s:%u len=%zd\n", (unsigned long long)delta, ip, ntohs(from.sin_port), r);
+        }
+    }
+
+    fclose(fp);
     close(sock);
-    watchspec_free(&w);
-    for (int i=0; i<ini_count; i++) if (ctx[i].fp) fclose(ctx[i].fp);
-    free(ctx);
+    double secs = (double)(mono_us() - start) / 1e6;
+    fprintf(stderr, "[record] %ld datagrams, %llu bytes in %.1f s -> %s\n",
+            count, (unsigned long long)bytes, secs, out_path);
     return 0;
 }
 
+typedef struct {
+    uint32_t addr;
+    uint16_t port;
+    int sock;
+} ReplaySource;
+
+/* One socket per original sender so multi-sender captures keep their mix */
+static int replay_socket_for(ReplaySource *src, int *count, uint32_t addr, uint16_t port, int shared)
+{
+    for (int i = 0; i < *count; i++) {
+        if (src[i].addr == addr && src[i].port == port) return src[i].sock;
+    }
+    if (*count >= REPLAY_MAX_SOURCES) return shared;
+    int sock = open_udp_socket();
+    if (sock < 0) return shared;
+    src[*count].addr = addr;
+    src[*count].port = port;
+    src[*count].sock = sock;
+    (*count)++;
+    return sock;
+}
+
+static int cmd_replay(int argc, char **argv, const char *prog)
+{
+    const char *in_path = NULL;
+    const char *dest = DEFAULT_DEST_IP;
+    int port = DEFAULT_PORT;
+    double speed = 1.0;
+    int max_speed = 0;
+    long loops = 1;
+    int single_source = 0;
+    int verbose = 0;
+
+    static struct option opts[] = {
+        {"in", required_argument, 0, 1},
+        {"dest", required_argument, 0, 2},
+        {"port", required_argument, 0, 3},
+        {"speed", required_argument, 0, 4},
+        {"max", no_argument, 0, 5},
+        {"loop", required_argument, 0, 6},
+        {"single-source", no_argument, 0, 7},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+
+    optind = 1;
+    int opt, idx = 0;
+    while ((opt = getopt_long(argc, argv, "hv", opts, &idx)) != -1) {
+        switch (opt) {
+        case 1: in_path = optarg; break;
+        case 2: dest = optarg; break;
+        case 3: port = atoi(optarg); break;
+        case 4: if (!parse_double(optarg, &speed) || speed <= 0.0) { usage_replay(prog); return 1; } break;
+        case 5: max_speed = 1; break;
+        case 6: loops = atol(optarg); break;
+        case 7: single_source = 1; break;
+        case 'v': verbose = 1; break;
+        case 'h':
+        default:
+            usage_replay(prog);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!in_path || port <= 0 || port > 65535) {
+        usage_replay(prog);
+        return 1;
+    }
+
+    /* Same ip[:port] form as send/watch; --port applies when the destination has no port */
+    DestList dests;
+    dests.count = 0;
+    if (!dest_list_add(&dests, dest, port)) return 1;
+    struct sockaddr_in addr = dests.addr[0];
+
+    FILE *fp = fopen(in_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "open %s: %s\n", in_path, strerror(errno));
+        return 1;
+    }
+    uint8_t hdr[CAPTURE_HDR_LEN];
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) || memcmp(hdr, CAPTURE_MAGIC, 4) != 0 ||
+        get_le16(hdr + 4) != CAPTURE_VERSION) {
+        fprintf(stderr, "%s: not a waybeam capture (version %d)\n", in_path, CAPTURE_VERSION);
+        fclose(fp);
+        return 1;
+    }
+
+    int shared = open_udp_socket();
+    if (shared < 0) { perror("socket"); fclose(fp); return 1; }
+    ReplaySource sources[REPLAY_MAX_SOURCES];
+    int source_count = 0;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = capture_handle_stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    uint64_t start = mono_us();
+    long sent = 0;
+    long failed = 0;
+    uint64_t bytes = 0;
+    char buf[65536];
+    for (long pass = 0; !g_capture_stop && (loops <= 0 || pass < loops); pass++) {
+        if (fseek(fp, CAPTURE_HDR_LEN, SEEK_SET) != 0) break;
+        /* Gaps accumulate against one clock per pass so sleep jitter never drifts */
+        uint64_t pass_start = mono_us();
+        double offset_us = 0.0;
+        uint8_t rec[CAPTURE_REC_LEN];
+        while (!g_capture_stop && fread(rec, 1, sizeof(rec), fp) == sizeof(rec)) {
+            uint32_t delta = get_le32(rec);
+            uint32_t src_addr;
+            uint16_t src_port;
+            memcpy(&src_addr, rec + 4, 4);
+            memcpy(&src_port, rec + 8, 2);
+            size_t len = get_le16(rec + 10);
+            if (fread(buf, 1, len, fp) != len) break;
+
+            if (!max_speed) {
+                offset_us += (double)delta / speed;
+                uint64_t due = pass_start + (uint64_t)offset_us;
+                uint64_t now = mono_us();
+                if (due > now) {
+                    struct timespec ts = {(time_t)((due - now) / 1000000ULL), (long)((due - now) % 1000000ULL) * 1000L};
+                    nanosleep(&ts, NULL);
+                }
+            }
+            int sock = single_source ? shared : replay_socket_for(sources, &source_count, src_addr, src_port, shared);
+            if (sendto(sock, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+                failed++;
+                if (verbose) perror("sendto");
+                continue;
+            }
+            sent++;
+            bytes += len;
+        }
+    }
+
+    double secs = (double)(mono_us() - start) / 1e6;
+    fprintf(stderr, "[replay] %ld datagrams (%ld failed), %llu bytes in %.3f s = %.0f pkt/s, %d source socket(s)\n",
+            sent, failed, (unsigned long long)bytes, secs, secs > 0.0 ? (double)sent / secs : 0.0,
+            single_source ? 1 : (source_count ? source_count : 1));
+
+    for (int i = 0; i < source_count; i++) close(sources[i].sock);
+    close(shared);
+    fclose(fp);
+    return failed && !sent ? 1 : 0;
+}
+
 /* ------------------------- main ------------------------- */
 
 int main(int argc, char **argv)
@@ -1734,6 +4181,15 @@ int main(int argc, char **argv)
     if (!strcmp(argv[1], "watch")) {
         return cmd_watch(argc - 1, argv + 1, prog);
     }
+    if (!strcmp(argv[1], "daemon")) {
+        return cmd_daemon(argc - 1, argv + 1, prog);
+    }
+    if (!strcmp(argv[1], "record")) {
+        return cmd_record(argc - 1, argv + 1, prog);
+    }
+    if (!strcmp(argv[1], "replay")) {
+        return cmd_replay(argc - 1, argv + 1, prog);
+    }
 
     if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help") || !strcmp(argv[1], "help")) {
         usage_main(prog);
@@ -0,0 +1,81 @@
+/*
+ * osd_shm.h - shared-memory channel transport between co-located producers
+ * (waybeam --shm) and the OSD. Layout shared by main.c and osd_send.c.
+ *
+ * The OSD creates OSD_SHM_PATH and the OSD_SHM_WAKE_PATH FIFO when
+ * "shm_transport" is enabled. Producers update slots in place and write one
+ * byte to the FIFO; the OSD polls the FIFO next to its UDP socket and picks up
+ * every slot whose sequence counter moved.
+ *
+ * Each slot is a seqlock: a writer moves seq from even to odd with a CAS (which
+ * also serialises concurrent writers), stores the payload, then releases seq
+ * to the next even number. Readers retry while seq is odd or changed under them.
+ */
+#ifndef OSD_SHM_H
+#define OSD_SHM_H
+
+#include <stdint.h>
+
+#define OSD_SHM_PATH       "/dev/shm/waybeam_osd"
+#define OSD_SHM_WAKE_PATH  "/dev/shm/waybeam_osd.wake"
+#define OSD_SHM_MAGIC      0x4F534457u /* "WDSO" */
+#define OSD_SHM_VERSION    1
+
+#define OSD_SHM_VALUE_SLOTS 8   /* UDP value bank 0-7 */
+#define OSD_SHM_TEXT_SLOTS  8   /* UDP text bank 0-7 */
+#define OSD_SHM_TEXT_MAX    96
+
+typedef struct {
+    uint32_t seq;
+    uint32_t reserved;
+    double value;
+} osd_shm_value_t;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t len;
+    char text[OSD_SHM_TEXT_MAX + 1];
+} osd_shm_text_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t value_slots;
+    uint32_t text_slots;
+    osd_shm_value_t values[OSD_SHM_VALUE_SLOTS];
+    osd_shm_text_t texts[OSD_SHM_TEXT_SLOTS];
+} osd_shm_t;
+
+/* Writer side: lock a slot, returning the odd sequence to pass to unlock */
+static inline uint32_t osd_shm_write_begin(uint32_t *seq)
+{
+    for (;;) {
+        uint32_t cur = __atomic_load_n(seq, __ATOMIC_RELAXED);
+        if (!(cur & 1u) &&
+            __atomic_compare_exchange_n(seq, &cur, cur + 1u, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            /* Seqlock write barrier: the odd seq is visible before any of the slot's new data */
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            return cur + 1u;
+        }
+    }
+}
+
+static inline void osd_shm_write_end(uint32_t *seq, uint32_t locked)
+{
+    __atomic_store_n(seq, locked + 1u, __ATOMIC_RELEASE);
+}
+
+/* Reader side: returns the even sequence to re-check, or 0 while a write is in flight */
+static inline uint32_t osd_shm_read_begin(const uint32_t *seq)
+{
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    return (s & 1u) ? 0 : s;
+}
+
+static inline int osd_shm_read_retry(const uint32_t *seq, uint32_t begin)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(seq, __ATOMIC_RELAXED) != begin;
+}
+
+#endif /* OSD_SHM_H */
@@ -0,0 +1,104 @@
+/*
+ * fontsyms.c - glyph subset helper for the low-bpp label fonts (`make fonts`).
+ *
+ * Prints every non-ASCII character found in the given files (normally the
+ * OSD configs, whose labels and inline separators are the only source of
+ * glyphs outside printable ASCII) once each, UTF-8 encoded, as the --symbols
+ * argument for lv_font_conv. Printable ASCII is always converted separately
+ * because UDP texts are only known at runtime.
+ *
+ *   fontsyms waybeam_osd.json [more.json ...] > fonts/symbols.txt
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FONTSYMS_MAX 512
+
+static uint32_t g_syms[FONTSYMS_MAX];
+static int g_sym_count = 0;
+
+static void add_sym(uint32_t cp)
+{
+    for (int i = 0; i < g_sym_count; i++) {
+        if (g_syms[i] == cp) return;
+    }
+    if (g_sym_count < FONTSYMS_MAX) g_syms[g_sym_count++] = cp;
+}
+
+// Decodes one UTF-8 sequence; returns its length or 0 if it is malformed
+static int utf8_decode(const unsigned char *s, size_t left, uint32_t *cp)
+{
+    int len = s[0] >= 0xF0 ? 4 : s[0] >= 0xE0 ? 3 : s[0] >= 0xC0 ? 2 : 0;
+    if (len == 0 || (size_t)len > left) return 0;
+    uint32_t v = s[0] & (0x3Fu >> (len - 1));
+    for (int i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) return 0;
+        v = (v << 6) | (s[i] & 0x3Fu);
+    }
+    *cp = v;
+    return len;
+}
+
+static void put_utf8(uint32_t cp)
+{
+    if (cp < 0x800) {
+        putchar((int)(0xC0 | (cp >> 6)));
+    } else if (cp < 0x10000) {
+        putchar((int)(0xE0 | (cp >> 12)));
+        putchar((int)(0x80 | ((cp >> 6) & 0x3F)));
+    } else {
+        putchar((int)(0xF0 | (cp >> 18)));
+        putchar((int)(0x80 | ((cp >> 12) & 0x3F)));
+        putchar((int)(0x80 | ((cp >> 6) & 0x3F)));
+    }
+    putchar((int)(0x80 | (cp & 0x3F)));
+}
+
+static int scan_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    unsigned char buf[4096 + 4];
+    size_t have = 0;
+    size_t n;
+    while ((n = fread(buf + have, 1, sizeof(buf) - have, f)) > 0) {
+        have += n;
+        size_t i = 0;
+        while (i < have) {
+            if (buf[i] < 0x80) {
+                i++;
+                continue;
+            }
+            uint32_t cp;
+            int len = utf8_decode(buf + i, have - i, &cp);
+            if (len == 0 && have - i < 4 && !feof(f)) break;  // sequence split across reads
+            if (len == 0) {
+                i++;
+                continue;
+            }
+            add_sym(cp);
+            i += (size_t)len;
+        }
+        memmove(buf, buf + i, have - i);
+        have -= i;
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s config.json [more.json ...]\n", argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (scan_file(argv[i]) != 0) return 1;
+    }
+    for (int i = 0; i < g_sym_count; i++) put_utf8(g_syms[i]);
+    return 0;
+}
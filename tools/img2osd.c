@@ -0,0 +1,193 @@
+/*
+ * img2osd.c - build-time converter for image asset blobs (`make img2osd`).
+ *
+ * Reads one or more binary Netpbm images (P6 PPM, or P7 PAM with RGB,
+ * RGB_ALPHA, GRAYSCALE or GRAYSCALE_ALPHA tuples, maxval 255), all of the same
+ * size, and writes them as consecutive frames of an osd_image.h blob. Export
+ * PNGs with e.g. `convert icon.png icon.pam`. PPM input has no alpha; pixels
+ * matching -k RRGGBB become transparent.
+ *
+ *   img2osd [-k RRGGBB] out.osdimg frame0.pam [frame1.pam ...]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "../osd_image.h"
+
+typedef struct {
+    int w;
+    int h;
+    int depth;              // bytes per input pixel
+    int has_alpha;
+    uint8_t *px;
+} netpbm_t;
+
+static int pbm_token(FILE *f, char *buf, size_t sz)
+{
+    int c = fgetc(f);
+    for (;;) {
+        while (c != EOF && isspace(c)) c = fgetc(f);
+        if (c != '#') break;
+        while (c != EOF && c != '\n') c = fgetc(f);
+    }
+    size_t n = 0;
+    while (c != EOF && !isspace(c) && n + 1 < sz) {
+        buf[n++] = (char)c;
+        c = fgetc(f);
+    }
+    buf[n] = '\0';
+    return n > 0 ? 0 : -1;
+}
+
+static int read_ppm_header(FILE *f, netpbm_t *img)
+{
+    char tok[32];
+    int maxval = 0;
+    if (pbm_token(f, tok, sizeof(tok)) != 0) return -1;
+    img->w = atoi(tok);
+    if (pbm_token(f, tok, sizeof(tok)) != 0) return -1;
+    img->h = atoi(tok);
+    if (pbm_token(f, tok, sizeof(tok)) != 0) return -1;
+    maxval = atoi(tok);
+    img->depth = 3;
+    img->has_alpha = 0;
+    return maxval == 255 ? 0 : -1;
+}
+
+static int read_pam_header(FILE *f, netpbm_t *img)
+{
+    char tok[32];
+    int maxval = 0;
+    char tuple[32] = "";
+    while (pbm_token(f, tok, sizeof(tok)) == 0) {
+        if (strcmp(tok, "ENDHDR") == 0) break;
+        char val[32];
+        if (pbm_token(f, val, sizeof(val)) != 0) return -1;
+        if (strcmp(tok, "WIDTH") == 0) img->w = atoi(val);
+        else if (strcmp(tok, "HEIGHT") == 0) img->h = atoi(val);
+        else if (strcmp(tok, "DEPTH") == 0) img->depth = atoi(val);
+        else if (strcmp(tok, "MAXVAL") == 0) maxval = atoi(val);
+        else if (strcmp(tok, "TUPLTYPE") == 0) snprintf(tuple, sizeof(tuple), "%s", val);
+    }
+    img->has_alpha = strstr(tuple, "ALPHA") != NULL;
+    if (maxval != 255 || img->depth < 1 || img->depth > 4) return -1;
+    return 0;
+}
+
+static int read_netpbm(const char *path, netpbm_t *img)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    memset(img, 0, sizeof(*img));
+    char magic[4];
+    int ok = pbm_token(f, magic, sizeof(magic)) == 0;
+    if (ok && strcmp(magic, "P6") == 0) ok = read_ppm_header(f, img) == 0;
+    else if (ok && strcmp(magic, "P7") == 0) ok = read_pam_header(f, img) == 0;
+    else ok = 0;
+    if (ok) ok = img->w > 0 && img->h > 0 && img->w <= OSD_IMAGE_DIM_MAX && img->h <= OSD_IMAGE_DIM_MAX;
+    size_t bytes = (size_t)img->w * (size_t)img->h * (size_t)img->depth;
+    if (ok) img->px = malloc(bytes);
+    if (ok) ok = img->px && fread(img->px, 1, bytes, f) == bytes;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: not a supported 8-bit P6/P7 image\n", path);
+        free(img->px);
+        img->px = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static uint16_t nibble(unsigned v)
+{
+    return (uint16_t)((v * 15u + 127u) / 255u);
+}
+
+static uint16_t to_argb4444(const netpbm_t *img, const uint8_t *p, long key)
+{
+    unsigned r, g, b, a = 255;
+    if (img->depth >= 3) {
+        r = p[0];
+        g = p[1];
+        b = p[2];
+        if (img->has_alpha) a = p[3];
+    } else {
+        r = g = b = p[0];
+        if (img->has_alpha) a = p[1];
+    }
+    if (!img->has_alpha && key >= 0 && (long)((r << 16) | (g << 8) | b) == key) a = 0;
+    if (nibble(a) == 0) return 0;
+    return (uint16_t)((nibble(a) << 12) | (nibble(r) << 8) | (nibble(g) << 4) | nibble(b));
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-k RRGGBB] out.osdimg frame0.pam [frame1.pam ...]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    long key = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "k:h")) != -1) {
+        if (opt == 'k') {
+            key = strtol(optarg, NULL, 16);
+            continue;
+        }
+        usage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+    int frames = argc - optind - 1;
+    if (frames < 1 || frames > OSD_IMAGE_FRAMES_MAX) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    osd_image_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = OSD_IMAGE_MAGIC;
+    hdr.version = OSD_IMAGE_VERSION;
+    hdr.format = OSD_IMAGE_ARGB4444;
+    hdr.frames = (uint16_t)frames;
+    uint16_t *out = NULL;
+
+    for (int i = 0; i < frames; i++) {
+        netpbm_t img;
+        if (read_netpbm(argv[optind + 1 + i], &img) != 0) return 1;
+        if (i == 0) {
+            hdr.width = (uint16_t)img.w;
+            hdr.height = (uint16_t)img.h;
+            out = malloc(osd_image_data_size(&hdr));
+            if (!out) return 1;
+        } else if (img.w != hdr.width || img.h != hdr.height) {
+            fprintf(stderr, "%s: %dx%d, expected %ux%u like the first frame\n", argv[optind + 1 + i], img.w, img.h,
+                    (unsigned)hdr.width, (unsigned)hdr.height);
+            return 1;
+        }
+        size_t n = (size_t)img.w * (size_t)img.h;
+        uint16_t *dst = out + n * (size_t)i;
+        for (size_t p = 0; p < n; p++) dst[p] = to_argb4444(&img, img.px + p * (size_t)img.depth, key);
+        free(img.px);
+    }
+
+    FILE *f = fopen(argv[optind], "wb");
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    int ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(out, osd_image_data_size(&hdr), 1, f) == 1;
+    ok = fclose(f) == 0 && ok;
+    free(out);
+    if (!ok) {
+        fprintf(stderr, "%s: write failed\n", argv[optind]);
+        return 1;
+    }
+    printf("%s: %ux%u, %d frame(s)\n", argv[optind], (unsigned)hdr.width, (unsigned)hdr.height, frames);
+    return 0;
+}